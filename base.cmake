@@ -16,7 +16,6 @@ macro(rg_setup_compile_options)
     endif()
 
     if(RG_ENABLE_PROFILING)
-        # Still debating whether -fno-inline is necessary or not...
-        component_compile_options(-DRG_ENABLE_PROFILING -finstrument-functions)
+        component_compile_options(-DRG_ENABLE_PROFILING)
     endif()
 endmacro()
@@ -6,11 +6,16 @@
 CC="gcc"
 # BUILD_INFO="RG:$(git describe) / SDL:$(sdl2-config --version)"
 CFLAGS="-no-pie -DRG_TARGET_SDL2 -DRETRO_GO -DCJSON_HIDE_SYMBOLS -DSDL_MAIN_HANDLED=1 -DRG_BUILD_INFO=\"SDL2\" -Dapp_main=SDL_Main $(sdl2-config --cflags)"
-INCLUDES="-Icomponents/retro-go -Icomponents/retro-go/libs/cJSON -Icomponents/retro-go/libs/lodepng"
+INCLUDES="-Icomponents/retro-go -Icomponents/retro-go/libs/cJSON -Icomponents/retro-go/libs/lodepng -Icomponents/retro-go/libs/netplay"
 SRCFILES="components/retro-go/*.c components/retro-go/drivers/audio/*.c components/retro-go/fonts/*.c
-		  components/retro-go/libs/cJSON/*.c components/retro-go/libs/lodepng/*.c"
+		  components/retro-go/libs/cJSON/*.c components/retro-go/libs/lodepng/*.c components/retro-go/libs/netplay/*.c"
 LIBS="$(sdl2-config --libs) -lstdc++"
 
+# NETPLAY=1 ./build_sdl2.sh enables netplay over UDP (see components/retro-go/libs/netplay/NETPLAY.md)
+if [ "$NETPLAY" = "1" ]; then
+	CFLAGS="$CFLAGS -DRG_ENABLE_NETPLAY"
+fi
+
 echo "Cleaning..."
 rm -f launcher.exe retro-core.exe gmon.out
 
@@ -101,6 +101,19 @@
 #define RG_PATH_MAX 255
 #endif
 
+// Whether a folder's mtime changes when its content does (FatFs only sets it at creation)
+#ifndef RG_STORAGE_DIR_MTIME
+#ifdef ESP_PLATFORM
+#define RG_STORAGE_DIR_MTIME 0
+#else
+#define RG_STORAGE_DIR_MTIME 1
+#endif
+#endif
+
+#ifndef RG_SCANDIR_THREADS
+#define RG_SCANDIR_THREADS 4
+#endif
+
 #ifndef RG_RECOVERY_BTN
 #define RG_RECOVERY_BTN RG_KEY_ANY
 #endif
@@ -117,6 +130,10 @@
 #define RG_BATTERY_UPDATE_THRESHOLD 1.0f
 #endif
 
+#ifndef RG_INPUT_POLL_INTERVAL
+#define RG_INPUT_POLL_INTERVAL 10
+#endif
+
 #ifndef RG_BATTERY_UPDATE_THRESHOLD_VOLT
 #define RG_BATTERY_UPDATE_THRESHOLD_VOLT 0.010f
 #endif
@@ -1,22 +1,30 @@
 #ifdef RG_ENABLE_NETPLAY
 
-#include <freertos/FreeRTOS.h>
-#include <lwip/ip_addr.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
-#include <esp_system.h>
-#include <esp_event.h>
-#include <esp_wifi.h>
-#include <esp_log.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <assert.h>
 #include <netdb.h>
 
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <lwip/ip_addr.h>
+#include <esp_system.h>
+#include <esp_event.h>
+#include <esp_wifi.h>
+#include <esp_log.h>
+#else
+#include <arpa/inet.h>
+#include <sys/select.h>
+#endif
+
 #include "rg_system.h"
 #include "rg_netplay.h"
 
-#define NETPLAY_VERSION 0x01
+#define NETPLAY_VERSION 0x02
+#define NETPLAY_TIMEOUT 10000 // ms
 #define MAX_PLAYERS 8
 
 #define BROADCAST (inet_addr(WIFI_BROADCAST_ADDR))
@@ -27,24 +35,68 @@
 #define WIFI_BROADCAST_ADDR "192.168.4.255"
 #define WIFI_NETPLAY_PORT 1234
 
+#ifdef ESP_PLATFORM
+#define PLAYER_PORT(id) (WIFI_NETPLAY_PORT)
+#else
+// Without an access point all players share one address (loopback unless RG_NETPLAY_PEER
+// is set) so each of them listens on its own port instead.
+#define NETPLAY_PEER_ADDR "127.0.0.1"
+#define PLAYER_PORT(id) (WIFI_NETPLAY_PORT + (id))
+#endif
+
+// Rollback mode keeps one snapshot per frame for the last ROLLBACK_FRAMES frames. It is also
+// how far ahead of the last confirmed remote input we let ourselves run before stalling.
+#define ROLLBACK_FRAMES 8
+#define ROLLBACK_HISTORY 64 // Input ring, power of two and > 2 * ROLLBACK_FRAMES
+#define NO_FRAME UINT32_MAX
+
 // Test to skip the network task and semaphores
 #define NETPLAY_SYNCHRONOUS_TEST
 
 static netplay_status_t netplay_status = NETPLAY_STATUS_NOT_INIT;
 static netplay_mode_t netplay_mode = NETPLAY_MODE_NONE;
 static netplay_callback_t netplay_callback = NULL;
-static SemaphoreHandle_t netplay_sync;
+static rg_mutex_t *netplay_sync;
 // static bool netplay_available = false;
 
 static netplay_player_t players[MAX_PLAYERS];
 static netplay_player_t *local_player;
 static netplay_player_t *remote_player; // This only works in 2 player mode
 
+#ifdef ESP_PLATFORM
 static tcpip_adapter_ip_info_t local_if;
 static wifi_config_t wifi_config;
+#endif
 
 static int rx_sock, tx_sock;
 
+typedef struct
+{
+    uint32_t frame;
+    uint8_t data[16]; // Same as netplay_player_t.sync_data
+} input_slot_t;
+
+static struct
+{
+    netplay_rollback_t handlers;
+    size_t state_size;
+    uint8_t *snapshots;
+    size_t snapshot_size[ROLLBACK_FRAMES];
+    uint32_t snapshot_frame[ROLLBACK_FRAMES];
+    input_slot_t local[ROLLBACK_HISTORY];
+    input_slot_t remote[ROLLBACK_HISTORY];    // Received from the peer
+    input_slot_t predicted[ROLLBACK_HISTORY]; // What the core was actually given
+    uint32_t frame;       // Next frame to emulate
+    uint32_t confirmed;   // All remote inputs before this frame have been received
+    uint32_t remote_ack;  // The peer has received all our inputs before this frame
+    uint32_t rollback_to; // Oldest mispredicted frame, or NO_FRAME
+    uint8_t data_len;
+    bool enabled;
+} rollback;
+
+static netplay_stats_t stats;
+static uint32_t netplay_lag; // Artificial input delay (frames) to exercise rollback over loopback
+
 
 static void dummy_netplay_callback(netplay_event_t event, void *arg)
 {
@@ -58,29 +110,29 @@ static void network_cleanup()
     if (tx_sock) close(tx_sock);
 
     rx_sock = tx_sock = 0;
+#ifdef ESP_PLATFORM
     memset(&local_if, 0, sizeof(local_if));
+#endif
 }
 
 
-static void network_setup(tcpip_adapter_if_t tcpip_if)
+static void network_setup(int player_id, uint32_t ip_addr)
 {
-    tcpip_adapter_get_ip_info(tcpip_if, &local_if);
-
-    int player_id = ((local_if.ip.addr >> 24) & 0xF) - 1;
+    const char *rom_name = rg_basename(rg_system_get_app()->romPath);
     struct sockaddr_in rx_addr;
     int bc_val = 1;
 
     local_player = &players[player_id];
     local_player->id = player_id;
     local_player->version = NETPLAY_VERSION;
-    local_player->game_id = rg_system_get_app()->romCRC32;
-    local_player->ip_addr = local_if.ip.addr;
+    local_player->game_id = rg_crc32(0, (const uint8_t *)rom_name, strlen(rom_name));
+    local_player->ip_addr = ip_addr;
 
     RG_LOGI("netplay: Local player ID: %d\n", local_player->id);
 
     rx_addr.sin_family = AF_INET;
     rx_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    rx_addr.sin_port = htons(WIFI_NETPLAY_PORT);
+    rx_addr.sin_port = htons(PLAYER_PORT(player_id));
 
     rx_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
     tx_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
@@ -96,12 +148,43 @@ static void network_setup(tcpip_adapter_if_t tcpip_if)
 }
 
 
+#ifdef ESP_PLATFORM
+static void network_setup_if(tcpip_adapter_if_t tcpip_if)
+{
+    tcpip_adapter_get_ip_info(tcpip_if, &local_if);
+    network_setup(((local_if.ip.addr >> 24) & 0xF) - 1, local_if.ip.addr);
+}
+#endif
+
+
+static void rollback_reset(void)
+{
+    for (int i = 0; i < ROLLBACK_HISTORY; i++)
+    {
+        rollback.local[i].frame = NO_FRAME;
+        rollback.remote[i].frame = NO_FRAME;
+        rollback.predicted[i].frame = NO_FRAME;
+    }
+    for (int i = 0; i < ROLLBACK_FRAMES; i++)
+        rollback.snapshot_frame[i] = NO_FRAME;
+    rollback.frame = 0;
+    rollback.confirmed = 0;
+    rollback.remote_ack = 0;
+    rollback.rollback_to = NO_FRAME;
+    memset(&stats, 0, sizeof(stats));
+}
+
+
 static void set_status(netplay_status_t status)
 {
     bool changed = status != netplay_status;
 
     netplay_status = status;
 
+    // Both peers start counting frames from the moment they see the connection
+    if (changed && status == NETPLAY_STATUS_CONNECTED)
+        rollback_reset();
+
     if (changed)
     {
         (*netplay_callback)(RG_EVENT_TYPE_NETPLAY|NETPLAY_EVENT_STATUS_CHANGED, &netplay_status);
@@ -109,25 +192,58 @@ static void set_status(netplay_status_t status)
 }
 
 
-static inline bool receive_packet(netplay_packet_t *packet, int timeout)
+// Returns true if a valid packet from another player was received within timeout (ms)
+static bool receive_packet(netplay_packet_t *packet, int timeout)
 {
+    struct timeval tv = {timeout / 1000, (timeout % 1000) * 1000};
+    struct sockaddr_in from_addr;
+    socklen_t from_len = sizeof(from_addr);
     fd_set read_fd_set;
+    int len, expected_len;
 
     FD_ZERO(&read_fd_set);
     FD_SET(rx_sock, &read_fd_set);
 
-    int sel = select(FD_SETSIZE, &read_fd_set, NULL, NULL, NULL);
+    int sel = select(rx_sock + 1, &read_fd_set, NULL, NULL, timeout < 0 ? NULL : &tv);
 
-    if (sel > 0)
+    if (sel < 0)
+    {
+        RG_LOGE("netplay: select() failed\n");
+        return false;
+    }
+    else if (sel == 0)
     {
-        return recv(rx_sock, &packet, sizeof packet, 0) >= 0;
+        return false;
     }
-    else if (sel < 0)
+
+    if ((len = recvfrom(rx_sock, packet, sizeof(*packet), 0, (struct sockaddr *)&from_addr, &from_len)) <= 0)
     {
-        RG_LOGE("netplay: select() failed\n");
+        RG_LOGE("netplay: Socket disconnected! (recv() failed)\n");
+        return false;
     }
 
-    return false;
+    expected_len = sizeof(*packet) - sizeof(packet->data) + packet->data_len;
+
+    if (expected_len != len)
+    {
+        RG_LOGE("netplay: Packet size mismatch. expected=%d received=%d\n", expected_len, len);
+        return false;
+    }
+    else if (packet->player_id >= MAX_PLAYERS)
+    {
+        RG_LOGE("netplay: Packet invalid player id: %d\n", packet->player_id);
+        return false;
+    }
+    else if (packet->player_id == local_player->id)
+    {
+        RG_LOGE("netplay: Received echo!\n");
+        return false;
+    }
+
+    players[packet->player_id].ip_addr = from_addr.sin_addr.s_addr;
+    players[packet->player_id].last_contact = rg_system_timer();
+
+    return true;
 }
 
 
@@ -145,7 +261,7 @@ static inline void send_packet(uint32_t dest, uint8_t cmd, uint8_t arg, void *da
     if (dest < MAX_PLAYERS)
     {
         tx_addr.sin_family = AF_INET;
-        tx_addr.sin_port = htons(WIFI_NETPLAY_PORT);
+        tx_addr.sin_port = htons(PLAYER_PORT(dest));
         tx_addr.sin_addr.s_addr = players[dest].ip_addr;
     }
     else
@@ -162,13 +278,14 @@ static inline void send_packet(uint32_t dest, uint8_t cmd, uint8_t arg, void *da
     }
 }
 
+#ifdef ESP_PLATFORM
 static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT)
     {
         if (event_id == WIFI_EVENT_AP_START)
         {
-            network_setup(TCPIP_ADAPTER_IF_AP);
+            network_setup_if(TCPIP_ADAPTER_IF_AP);
             set_status(NETPLAY_STATUS_LISTENING);
         }
         else if (event_id == WIFI_EVENT_AP_STOP || event_id == WIFI_EVENT_STA_STOP)
@@ -188,7 +305,7 @@ static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_
     {
         if (event_id == IP_EVENT_STA_GOT_IP)
         {
-            network_setup(TCPIP_ADAPTER_IF_STA);
+            network_setup_if(TCPIP_ADAPTER_IF_STA);
             set_status(NETPLAY_STATUS_HANDSHAKE);
         }
         else if (event_id == IP_EVENT_AP_STAIPASSIGNED)
@@ -201,11 +318,11 @@ static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_
         }
     }
 }
+#endif
 
 
 static void netplay_task()
 {
-    int len, expected_len;
     netplay_packet_t packet;
 
     RG_LOGI("netplay: Task started!\n");
@@ -215,43 +332,27 @@ static void netplay_task()
         memset(&packet, 0, sizeof(netplay_packet_t));
 
     #ifdef NETPLAY_SYNCHRONOUS_TEST
-        if (!rx_sock || netplay_status != NETPLAY_STATUS_HANDSHAKE)
+        if (!rx_sock || netplay_status < NETPLAY_STATUS_LISTENING || netplay_status == NETPLAY_STATUS_CONNECTED)
     #else
-        if (!rx_sock || netplay_status < NETPLAY_STATUS_HANDSHAKE)
+        if (!rx_sock || netplay_status < NETPLAY_STATUS_LISTENING)
     #endif
         {
             rg_task_delay(100);
             continue;
         }
 
-        // if ((len = recv(client_sock, &packet, sizeof packet, 0)) <= 0)
-        if ((len = recvfrom(rx_sock, &packet, sizeof packet, 0, NULL, 0)) <= 0)
-        {
-            RG_LOGE("netplay: Socket disconnected! (recv() failed)\n");
-            rg_task_delay(100);
-            continue;
-        }
-
-        expected_len = sizeof(packet) - sizeof(packet.data) + packet.data_len;
-
-        if (expected_len != len)
-        {
-            RG_LOGE("netplay: Packet size mismatch. expected=%d received=%d\n", expected_len, len);
-            continue;
-        }
-        else if (packet.player_id >= MAX_PLAYERS)
-        {
-            RG_LOGE("netplay: Packet invalid player id: %d\n", packet.player_id);
-            continue;
-        }
-        else if (packet.player_id == local_player->id)
+        if (!receive_packet(&packet, 500))
         {
-            RG_LOGE("netplay: Received echo!\n");
+        #ifndef ESP_PLATFORM
+            // There is no access point to tell the host about us, keep knocking until it answers
+            if (netplay_mode == NETPLAY_MODE_GUEST && netplay_status == NETPLAY_STATUS_HANDSHAKE)
+                send_packet(0, NETPLAY_PACKET_INFO, 0, (void*)local_player, sizeof(netplay_player_t));
+        #endif
             continue;
         }
 
         netplay_player_t *packet_from = &players[packet.player_id];
-        packet_from->last_contact = rg_system_timer();
+        uint32_t ip_addr = packet_from->ip_addr;
 
         switch (packet.cmd)
         {
@@ -259,11 +360,12 @@ static void netplay_task()
                 if (packet.data_len != sizeof(netplay_player_t))
                 {
                     RG_LOGE("netplay: Player struct size mismatch. expected=%d received=%d\n",
-                            sizeof(netplay_player_t), packet.data_len);
+                            (int)sizeof(netplay_player_t), packet.data_len);
                     break;
                 }
 
                 memcpy(packet_from, packet.data, packet.data_len);
+                packet_from->ip_addr = ip_addr; // What the peer thinks its address is isn't always reachable
                 remote_player = packet_from;
 
                 RG_LOGI("netplay: Remote client info player_id=%d game_id=%08X version=%02X\n",
@@ -275,16 +377,18 @@ static void netplay_task()
                     break;
                 }
 
+                // arg 0 asks for the peer's info in return, arg 1 is that answer
+                if (packet.arg == 0)
+                {
+                    send_packet(packet_from->id, NETPLAY_PACKET_INFO, 1, (void*)local_player, sizeof(netplay_player_t));
+                }
+
                 if (netplay_mode == NETPLAY_MODE_HOST)
                 {
                     // Check if all players are ready (at the moment only 1, no need to check) then send NETPLAY_PACKET_READY
                     send_packet(packet_from->id, NETPLAY_PACKET_READY, 0, 0, 0);
                     set_status(NETPLAY_STATUS_CONNECTED);
                 }
-                else
-                {
-                    send_packet(packet_from->id, NETPLAY_PACKET_INFO, 1, (void*)local_player, sizeof(netplay_player_t));
-                }
                 break;
 
             case NETPLAY_PACKET_READY: // HOST -> GUEST
@@ -301,7 +405,7 @@ static void netplay_task()
 
             case NETPLAY_PACKET_SYNC_REQ: // HOST -> GUEST
                 memcpy(&packet_from->sync_data, packet.data, packet.data_len);
-                xSemaphoreGive(netplay_sync);
+                rg_mutex_give(netplay_sync);
                 break;
 
             case NETPLAY_PACKET_SYNC_ACK: // GUEST -> HOST
@@ -309,11 +413,11 @@ static void netplay_task()
 
                 // if received all players ACK then:
                 send_packet(remote_player->id, NETPLAY_PACKET_SYNC_DONE, packet.arg, 0, 0);
-                xSemaphoreGive(netplay_sync);
+                rg_mutex_give(netplay_sync);
                 break;
 
             case NETPLAY_PACKET_SYNC_DONE: // HOST -> GUEST
-                xSemaphoreGive(netplay_sync);
+                rg_mutex_give(netplay_sync);
                 break;
 
             default:
@@ -332,8 +436,9 @@ static void netplay_init()
         netplay_status = NETPLAY_STATUS_STOPPED;
         netplay_callback = netplay_callback ?: dummy_netplay_callback;
         netplay_mode = NETPLAY_MODE_NONE;
-        netplay_sync = xSemaphoreCreateMutex();
+        netplay_sync = rg_mutex_create();
 
+    #ifdef ESP_PLATFORM
         tcpip_adapter_init();
 
         esp_event_loop_create_default();
@@ -344,8 +449,9 @@ static void netplay_init()
         ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL));
         ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_NONE)); // Improves latency a lot
         ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+    #endif
 
-        rg_task_create("rg_netplay", &netplay_task, NULL, 4096, RG_TASK_PRIORITY - 2, 1);
+        rg_task_create("rg_netplay", &netplay_task, NULL, 4096, RG_TASK_PRIORITY_2, 1);
     }
 }
 
@@ -437,7 +543,7 @@ bool rg_netplay_start(netplay_mode_t mode)
 {
     RG_LOGI("%s called.\n", __func__);
 
-    esp_err_t ret = ESP_FAIL;
+    bool ret = false;
 
     if (netplay_status == NETPLAY_STATUS_NOT_INIT)
     {
@@ -452,6 +558,7 @@ bool rg_netplay_start(netplay_mode_t mode)
     local_player = NULL;
     remote_player = NULL;
 
+#ifdef ESP_PLATFORM
     if (mode == NETPLAY_MODE_GUEST)
     {
         RG_LOGI("netplay: Starting in guest mode.\n");
@@ -461,7 +568,7 @@ bool rg_netplay_start(netplay_mode_t mode)
         ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
         ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
         ESP_ERROR_CHECK(esp_wifi_start());
-        ret = esp_wifi_connect();
+        ret = esp_wifi_connect() == ESP_OK;
         netplay_mode = NETPLAY_MODE_GUEST;
     }
     else if (mode == NETPLAY_MODE_HOST)
@@ -474,15 +581,40 @@ bool rg_netplay_start(netplay_mode_t mode)
         wifi_config.ap.max_connection = MAX_PLAYERS - 1;
         ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_AP));
         ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_AP, &wifi_config));
-        ret = esp_wifi_start();
+        ret = esp_wifi_start() == ESP_OK;
         netplay_mode = NETPLAY_MODE_HOST;
     }
+#else
+    if (mode == NETPLAY_MODE_GUEST || mode == NETPLAY_MODE_HOST)
+    {
+        const char *peer = getenv("RG_NETPLAY_PEER") ?: NETPLAY_PEER_ADDR;
+        int player_id = mode == NETPLAY_MODE_HOST ? 0 : 1;
+
+        RG_LOGI("netplay: Starting in %s mode, peer is %s.\n", mode == NETPLAY_MODE_HOST ? "host" : "guest", peer);
+
+        netplay_lag = RG_MIN(atoi(getenv("RG_NETPLAY_LAG") ?: "0"), ROLLBACK_FRAMES - 1);
+        players[player_id ^ 1].ip_addr = inet_addr(peer);
+        network_setup(player_id, inet_addr(peer));
+        netplay_mode = mode;
+        ret = true;
+
+        if (mode == NETPLAY_MODE_GUEST)
+        {
+            set_status(NETPLAY_STATUS_HANDSHAKE);
+            send_packet(0, NETPLAY_PACKET_INFO, 0, (void*)local_player, sizeof(netplay_player_t));
+        }
+        else
+        {
+            set_status(NETPLAY_STATUS_LISTENING);
+        }
+    }
+#endif
     else
     {
         RG_PANIC("netplay: Error: Unknown mode!");
     }
 
-    return ret == ESP_OK;
+    return ret;
 }
 
 
@@ -490,18 +622,270 @@ bool rg_netplay_stop(void)
 {
     RG_LOGI("%s called.\n", __func__);
 
-    esp_err_t ret = ESP_FAIL;
+    bool ret = false;
 
     if (netplay_mode != NETPLAY_MODE_NONE)
     {
         network_cleanup();
-        ret = esp_wifi_stop();
+    #ifdef ESP_PLATFORM
+        ret = esp_wifi_stop() == ESP_OK;
+    #else
+        ret = true;
+    #endif
         netplay_status = NETPLAY_STATUS_STOPPED;
         netplay_mode = NETPLAY_MODE_NONE;
-        xSemaphoreGive(netplay_sync);
+        rg_mutex_give(netplay_sync);
+    }
+
+    return ret;
+}
+
+
+static const uint8_t *rollback_remote_input(uint32_t frame)
+{
+    static const uint8_t neutral[sizeof(((input_slot_t *)0)->data)];
+    const input_slot_t *slot = &rollback.remote[frame % ROLLBACK_HISTORY];
+
+    if (slot->frame == frame)
+        return slot->data;
+
+    // Prediction: the peer keeps doing whatever it did last
+    if (rollback.confirmed > 0)
+        return rollback.remote[(rollback.confirmed - 1) % ROLLBACK_HISTORY].data;
+
+    return neutral;
+}
+
+
+static bool rollback_save(uint32_t frame)
+{
+    int slot = frame % ROLLBACK_FRAMES;
+    size_t size = rollback.handlers.saveState(rollback.snapshots + slot * rollback.state_size, rollback.state_size);
+
+    rollback.snapshot_frame[slot] = size ? frame : NO_FRAME;
+    rollback.snapshot_size[slot] = size;
+
+    return size > 0;
+}
+
+
+static void rollback_send_inputs(void)
+{
+    uint8_t buffer[sizeof(((netplay_packet_t *)0)->data)];
+    netplay_input_t *header = (netplay_input_t *)buffer;
+    size_t max_count = (sizeof(buffer) - sizeof(netplay_input_t)) / rollback.data_len;
+    uint32_t first = rollback.remote_ack;
+    uint32_t last = rollback.frame - netplay_lag; // Inclusive
+
+    if (rollback.frame < netplay_lag || last < first)
+        return;
+
+    // Resend everything the peer hasn't acknowledged yet (oldest first), UDP may have dropped it
+    if (last - first >= max_count)
+        last = first + max_count - 1;
+
+    header->frame = first;
+    header->ack = rollback.confirmed;
+    header->count = 0;
+
+    for (uint32_t frame = first; frame <= last; frame++)
+    {
+        const input_slot_t *slot = &rollback.local[frame % ROLLBACK_HISTORY];
+        if (slot->frame != frame)
+            break;
+        memcpy(buffer + sizeof(netplay_input_t) + header->count++ * rollback.data_len, slot->data, rollback.data_len);
+    }
+
+    send_packet(remote_player->id, NETPLAY_PACKET_INPUT, rollback.frame & 0xFF, buffer,
+                sizeof(netplay_input_t) + header->count * rollback.data_len);
+}
+
+
+static void rollback_receive_inputs(const netplay_packet_t *packet)
+{
+    const netplay_input_t *header = (const netplay_input_t *)packet->data;
+    const uint8_t *data = packet->data + sizeof(netplay_input_t);
+
+    if (packet->cmd != NETPLAY_PACKET_INPUT)
+    {
+        RG_LOGW("netplay: Ignoring packet type 0x%02x during rollback\n", packet->cmd);
+        return;
+    }
+
+    if (packet->data_len < sizeof(netplay_input_t)
+        || packet->data_len != sizeof(netplay_input_t) + header->count * rollback.data_len)
+    {
+        RG_LOGE("netplay: Input packet size mismatch (%d)\n", packet->data_len);
+        return;
+    }
+
+    if (header->ack > rollback.remote_ack)
+        rollback.remote_ack = header->ack;
+
+    for (int i = 0; i < header->count; i++, data += rollback.data_len)
+    {
+        uint32_t frame = header->frame + i;
+        input_slot_t *slot = &rollback.remote[frame % ROLLBACK_HISTORY];
+        const input_slot_t *used = &rollback.predicted[frame % ROLLBACK_HISTORY];
+
+        if (frame < rollback.confirmed || slot->frame == frame)
+            continue;
+
+        // Keep the last confirmed input around, it's what we predict with
+        if (frame - rollback.confirmed >= ROLLBACK_HISTORY - 1)
+            break;
+
+        slot->frame = frame;
+        memcpy(slot->data, data, rollback.data_len);
+
+        // The frame has already been emulated with a different input, it will have to be redone
+        if (used->frame == frame && memcmp(used->data, data, rollback.data_len) != 0 && frame < rollback.rollback_to)
+            rollback.rollback_to = frame;
+    }
+
+    while (rollback.remote[rollback.confirmed % ROLLBACK_HISTORY].frame == rollback.confirmed)
+        rollback.confirmed++;
+}
+
+
+static bool rollback_resimulate(void)
+{
+    uint32_t from = rollback.rollback_to;
+    int slot = from % ROLLBACK_FRAMES;
+    int64_t start_time = rg_system_timer();
+
+    rollback.rollback_to = NO_FRAME;
+
+    if (rollback.snapshot_frame[slot] != from
+        || !rollback.handlers.loadState(rollback.snapshots + slot * rollback.state_size, rollback.snapshot_size[slot]))
+    {
+        RG_LOGE("netplay: Unable to roll back to frame %u (now at %u)\n", (unsigned)from, (unsigned)rollback.frame);
+        return false;
+    }
+
+    for (uint32_t frame = from; frame < rollback.frame; frame++)
+    {
+        input_slot_t *used = &rollback.predicted[frame % ROLLBACK_HISTORY];
+
+        // Snapshots past the restored one are now wrong, but we only need those we may return to
+        if (frame > from && frame >= rollback.confirmed)
+            rollback_save(frame);
+
+        used->frame = frame;
+        memcpy(used->data, rollback_remote_input(frame), rollback.data_len);
+        rollback.handlers.runFrame(rollback.local[frame % ROLLBACK_HISTORY].data, used->data);
+    }
+
+    uint32_t depth = rollback.frame - from;
+    stats.rollbacks++;
+    stats.resimulated += depth;
+    stats.max_depth = RG_MAX(stats.max_depth, depth);
+    stats.resim_time += rg_system_timer() - start_time;
+
+    return true;
+}
+
+
+static void rollback_sync(void *data_in, void *data_out, uint8_t data_len)
+{
+    static netplay_packet_t packet;
+    uint32_t frame = rollback.frame;
+    input_slot_t *local = &rollback.local[frame % ROLLBACK_HISTORY];
+    input_slot_t *used = &rollback.predicted[frame % ROLLBACK_HISTORY];
+
+    RG_ASSERT(data_len > 0 && data_len <= sizeof(local->data), "Invalid sync data length");
+
+    rollback.data_len = data_len;
+    local->frame = frame;
+    memcpy(local->data, data_in, data_len);
+
+    while (receive_packet(&packet, 0))
+        rollback_receive_inputs(&packet);
+
+    rollback_send_inputs();
+
+    // We can't predict further than we have snapshots, wait for the peer to catch up
+    if ((int32_t)(frame - rollback.confirmed) >= ROLLBACK_FRAMES)
+    {
+        int64_t start_time = rg_system_timer();
+
+        stats.stalls++;
+
+        while ((int32_t)(frame - rollback.confirmed) >= ROLLBACK_FRAMES)
+        {
+            if (receive_packet(&packet, 5))
+            {
+                rollback_receive_inputs(&packet);
+                continue;
+            }
+
+            if (rg_system_timer() - start_time > NETPLAY_TIMEOUT * 1000)
+            {
+                RG_LOGE("netplay: Lost sync...\n");
+                rg_netplay_stop();
+                return;
+            }
+
+            rollback_send_inputs();
+        }
+
+        stats.wait_time += rg_system_timer() - start_time;
+    }
+
+    if (rollback.rollback_to != NO_FRAME && !rollback_resimulate())
+    {
+        rg_netplay_stop();
+        return;
+    }
+
+    used->frame = frame;
+    memcpy(used->data, rollback_remote_input(frame), data_len);
+    memcpy(data_out, used->data, data_len);
+
+    // Only frames that start on a guess can ever be rolled back to
+    if (frame >= rollback.confirmed)
+    {
+        stats.predicted++;
+        if (!rollback_save(frame))
+            RG_LOGE("netplay: Snapshot of frame %u failed!\n", (unsigned)frame);
+    }
+
+    rollback.frame++;
+
+    if (++stats.frames % 60 == 0)
+    {
+        RG_LOGD("netplay: frame=%u ahead=%d predicted=%u rollbacks=%u depth=%.1f/%u resim=%.3fms stalls=%u\n",
+            (unsigned)rollback.frame, (int)(rollback.frame - rollback.confirmed), (unsigned)stats.predicted,
+            (unsigned)stats.rollbacks, stats.rollbacks ? (float)stats.resimulated / stats.rollbacks : 0.f,
+            (unsigned)stats.max_depth, stats.rollbacks ? (float)stats.resim_time / stats.rollbacks / 1000 : 0.f,
+            (unsigned)stats.stalls);
     }
+}
+
+
+bool rg_netplay_set_rollback(const netplay_rollback_t *handlers, size_t state_size)
+{
+    free(rollback.snapshots);
+    rollback.snapshots = NULL;
+    rollback.enabled = false;
+
+    if (!handlers)
+        return true;
+
+    RG_ASSERT_ARG(handlers->saveState && handlers->loadState && handlers->runFrame && state_size > 0);
+
+    if (!(rollback.snapshots = rg_alloc(state_size * ROLLBACK_FRAMES, MEM_SLOW|MEM_NOPANIC)))
+    {
+        RG_LOGE("netplay: Not enough memory for %d snapshots of %d bytes\n", ROLLBACK_FRAMES, (int)state_size);
+        return false;
+    }
+
+    rollback.handlers = *handlers;
+    rollback.state_size = state_size;
+    rollback.enabled = true;
+    rollback_reset();
 
-    return ret == ESP_OK;
+    return true;
 }
 
 
@@ -515,6 +899,12 @@ void rg_netplay_sync(void *data_in, void *data_out, uint8_t data_len)
         return;
     }
 
+    if (rollback.enabled)
+    {
+        rollback_sync(data_in, data_out, data_len);
+        return;
+    }
+
     start_time = rg_system_timer();
 
     memcpy(&local_player->sync_data, data_in, data_len);
@@ -525,27 +915,27 @@ void rg_netplay_sync(void *data_in, void *data_out, uint8_t data_len)
     }
 
 #ifdef NETPLAY_SYNCHRONOUS_TEST
-    if (netplay_mode == NETPLAY_MODE_HOST)
-    {
-        do {
-            recv(rx_sock, &packet, sizeof packet, 0); // ACK
-        } while (packet.cmd != NETPLAY_PACKET_SYNC_ACK);
-        // send_packet(remote_player->id, NETPLAY_PACKET_SYNC_DONE, packet.arg, 0, 0);
-    }
-    else
+    int expected = netplay_mode == NETPLAY_MODE_HOST ? NETPLAY_PACKET_SYNC_ACK : NETPLAY_PACKET_SYNC_REQ;
+
+    do {
+        if (!receive_packet(&packet, NETPLAY_TIMEOUT))
+        {
+            RG_LOGE("netplay: Lost sync...\n");
+            rg_netplay_stop();
+            return;
+        }
+    } while (packet.cmd != expected);
+
+    if (netplay_mode == NETPLAY_MODE_GUEST)
     {
-        do {
-            recv(rx_sock, &packet, sizeof packet, 0); // REQ
-        } while (packet.cmd != NETPLAY_PACKET_SYNC_REQ);
         send_packet(remote_player->id, NETPLAY_PACKET_SYNC_ACK, 0, (void*)data_in, data_len);
-        // recv(rx_sock, &packet, sizeof packet, 0); // DONE
     }
 
     memcpy(&remote_player->sync_data, packet.data, packet.data_len);
     memcpy(data_out, remote_player->sync_data, data_len);
 #else
     // wait to receive/send NETPLAY_PACKET_SYNC_DONE
-    if (xSemaphoreTake(netplay_sync, 10000 / portTICK_PERIOD_MS) != pdPASS)
+    if (!rg_mutex_take(netplay_sync, NETPLAY_TIMEOUT))
     {
         RG_LOGE("netplay: Lost sync...\n");
         rg_netplay_stop();
@@ -558,11 +948,13 @@ void rg_netplay_sync(void *data_in, void *data_out, uint8_t data_len)
     {
         send_packet(remote_player->id, NETPLAY_PACKET_SYNC_ACK, 0,
                     local_player->sync_data, sizeof(local_player->sync_data));
-        xSemaphoreTake(netplay_sync, 1000 / portTICK_PERIOD_MS);
+        rg_mutex_take(netplay_sync, 1000);
     }
 #endif
 
     sync_time += rg_system_timer() - start_time;
+    stats.wait_time += rg_system_timer() - start_time;
+    stats.frames++;
 
     if (++sync_count == 60)
     {
@@ -572,6 +964,12 @@ void rg_netplay_sync(void *data_in, void *data_out, uint8_t data_len)
 }
 
 
+netplay_stats_t rg_netplay_get_stats(void)
+{
+    return stats;
+}
+
+
 netplay_mode_t rg_netplay_mode()
 {
     return netplay_mode;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef enum {
@@ -62,15 +63,45 @@ typedef struct __attribute__ ((packed)) {
     uint8_t  sync_data[16];
 } netplay_player_t;
 
+typedef struct __attribute__ ((packed)) {
+    uint32_t frame; // Frame of the first input in the packet
+    uint32_t ack;   // Sender has received all of our inputs before this frame
+    uint8_t  count; // Number of inputs that follow, oldest first
+} netplay_input_t;
+
+typedef struct {
+    uint32_t frames;      // Frames synchronized since connection
+    uint32_t predicted;   // Frames that started with a predicted remote input
+    uint32_t rollbacks;   // Mispredictions that required restoring a snapshot
+    uint32_t resimulated; // Frames emulated again after a rollback
+    uint32_t max_depth;   // Deepest rollback, in frames
+    uint32_t stalls;      // Frames that had to wait for the peer
+    int64_t  resim_time;  // Time spent restoring and resimulating (us)
+    int64_t  wait_time;   // Time spent blocked on the network (us)
+} netplay_stats_t;
+
 typedef void (*netplay_callback_t)(netplay_event_t event, void *arg);
 typedef netplay_callback_t rg_netplay_handler_t;
 
+// Rollback handlers. Snapshots live in RAM and are taken every frame, they must be fast.
+typedef size_t (*netplay_save_handler_t)(void *buffer, size_t size);      // Returns bytes used, 0 on failure
+typedef bool (*netplay_load_handler_t)(const void *buffer, size_t size);
+typedef void (*netplay_run_handler_t)(const void *data_in, const void *data_out); // One frame, no video/audio
+
+typedef struct {
+    netplay_save_handler_t saveState;
+    netplay_load_handler_t loadState;
+    netplay_run_handler_t runFrame;
+} netplay_rollback_t;
+
 void rg_netplay_init(netplay_callback_t callback);
 void rg_netplay_deinit(void);
 bool rg_netplay_quick_start(void);
 bool rg_netplay_start(netplay_mode_t mode);
 bool rg_netplay_stop(void);
 void rg_netplay_sync(void *data_in, void *data_out, uint8_t data_len);
+bool rg_netplay_set_rollback(const netplay_rollback_t *handlers, size_t state_size);
+netplay_stats_t rg_netplay_get_stats(void);
 
 netplay_mode_t rg_netplay_mode();
 netplay_status_t rg_netplay_status();
@@ -133,6 +133,7 @@ void rg_audio_deinit(void)
 
 void rg_audio_submit(const rg_audio_frame_t *frames, size_t count)
 {
+    RG_STAGE_ZONE(RG_STAGE_AUDIO);
     const int64_t time_start = rg_system_timer();
 
     if (!audio.driver)
@@ -15,8 +15,44 @@ static rg_surface_t *border;
 static rg_display_t display;
 static int16_t map_viewport_to_source_x[RG_SCREEN_WIDTH + 1];
 static int16_t map_viewport_to_source_y[RG_SCREEN_HEIGHT + 1];
+static int32_t map_viewport_to_source_offset[RG_SCREEN_WIDTH + 1]; // Rotated sources only
 static uint32_t screen_line_checksum[RG_SCREEN_HEIGHT + 1];
 
+typedef struct
+{
+    const rg_surface_t *surface;
+    uint32_t dirty_lines[RG_DISPLAY_MAX_SOURCE_LINES / 32];
+    uint32_t rotation; // RG_DISPLAY_ROTATE_*
+    bool partial;
+    int64_t input_changed; // From rg_input_claim_change()
+} submission_t;
+
+#define OVERLAY_ROW_HEIGHT 3
+static bool overlay_enabled;
+
+// One slot is being drawn by the display task while the other waits in its queue
+static submission_t submissions[2];
+static int submission_index;
+
+enum
+{
+    DISPLAY_MSG_SUBMIT = 0, // dataPtr is a submission_t
+    DISPLAY_MSG_PRESENT,    // A frame is waiting in the ring
+    DISPLAY_MSG_SYNC,       // Nothing to do, it only marks a point in the queue
+};
+
+static struct
+{
+    rg_surface_t *frames[RG_DISPLAY_MAX_FRAMES];
+    int count;
+    int acquired;   // Frame being drawn by the core, or -1
+    int pending;    // Newest presented frame not yet picked up, or -1
+    int displaying; // Frame being sent to the screen, or -1
+    int64_t input_changed[RG_DISPLAY_MAX_FRAMES]; // Oldest input change each frame responds to
+    bool notified;  // A DISPLAY_MSG_PRESENT is in the queue
+    rg_mutex_t *lock;
+} ring = {.acquired = -1, .pending = -1, .displaying = -1};
+
 #define LINE_IS_REPEATED(Y) (map_viewport_to_source_y[(Y)] == map_viewport_to_source_y[(Y) - 1])
 // This is to avoid flooring a number that is approximated to .9999999 and be explicit about it
 #define FLOAT_TO_INT(x) ((int)((x) + 0.1f))
@@ -54,8 +90,23 @@ static inline unsigned blend_pixels(unsigned a, unsigned b)
     // return (((a ^ b) & 0b1101111011110110U) >> 1) + (a & b);
 }
 
-static inline void write_update(const rg_surface_t *update)
+static inline bool block_is_clean(const uint32_t *dirty_lines, int crop_top, int draw_top, int y, int count)
 {
+    for (int i = y; i < y + count; ++i)
+    {
+        int line = crop_top + map_viewport_to_source_y[i];
+        if (line < 0 || line >= RG_DISPLAY_MAX_SOURCE_LINES || (dirty_lines[line >> 5] & (1u << (line & 31))))
+            return false;
+        // The screen line was overwritten or never drawn, the hint cannot be trusted
+        if (screen_line_checksum[draw_top + i] == 0)
+            return false;
+    }
+    return true;
+}
+
+static inline void write_update(const rg_surface_t *update, const uint32_t *dirty_lines, uint32_t rotation)
+{
+    RG_STAGE_ZONE(RG_STAGE_CONVERT);
     const int64_t time_start = rg_system_timer();
 
     bool filter_x = display.viewport.filter_x;
@@ -87,6 +138,24 @@ static inline void write_update(const rg_surface_t *update)
     const void *data = update->data + update->offset + (crop_top * stride) + (crop_left * RG_PIXEL_GET_SIZE(format));
     const uint16_t *palette = update->palette;
 
+    // Rotated sources are read one column per screen line, the offset of every column is computed once here
+    const void *rotated_data = update->data + update->offset;
+    int rotated_row_base = 0, rotated_row_step = 0;
+    if (rotation & RG_DISPLAY_ROTATE_LEFT)
+    {
+        rotated_row_base = (update->width - 1 - crop_top) * RG_PIXEL_GET_SIZE(format);
+        rotated_row_step = -RG_PIXEL_GET_SIZE(format);
+        for (int xx = 0; xx < draw_width; ++xx)
+            map_viewport_to_source_offset[xx] = (crop_left + map_viewport_to_source_x[xx]) * stride;
+    }
+    else if (rotation & RG_DISPLAY_ROTATE_RIGHT)
+    {
+        rotated_row_base = crop_top * RG_PIXEL_GET_SIZE(format);
+        rotated_row_step = RG_PIXEL_GET_SIZE(format);
+        for (int xx = 0; xx < draw_width; ++xx)
+            map_viewport_to_source_offset[xx] = (update->height - 1 - crop_left - map_viewport_to_source_x[xx]) * stride;
+    }
+
     int lines_per_buffer = LCD_BUFFER_LENGTH / draw_width;
     int lines_remaining = draw_height;
     int lines_updated = 0;
@@ -108,7 +177,18 @@ static inline void write_update(const rg_surface_t *update)
                 --lines_to_copy;
         }
 
+        // Skip the conversion and checksum entirely when the source told us nothing changed
+        if (dirty_lines && block_is_clean(dirty_lines, crop_top, draw_top, y, lines_to_copy))
+        {
+            y += lines_to_copy;
+            lines_remaining -= lines_to_copy;
+            continue;
+        }
+
+        rg_stage_zone_t transfer;
+        rg_system_stage_begin(&transfer, RG_STAGE_TRANSFER);
         uint16_t *line_buffer = lcd_get_buffer(LCD_BUFFER_LENGTH);
+        rg_system_stage_end(&transfer);
         uint16_t *line_buffer_ptr = line_buffer;
 
         uint32_t checksum = 0xFFFFFFFF;
@@ -130,7 +210,24 @@ static inline void write_update(const rg_surface_t *update)
                         *line_buffer_ptr++ = (PIXEL); \
                     } \
                 }
-                if (format & RG_PIXEL_PALETTE)
+                #define RENDER_ROTATED_LINE(PTR_TYPE, PIXEL) { \
+                    const void *column = rotated_data + rotated_row_base + map_viewport_to_source_y[y] * rotated_row_step;\
+                    for (int xx = 0; xx < draw_width; ++xx) { \
+                        const PTR_TYPE *buffer = (const PTR_TYPE *)(column + map_viewport_to_source_offset[xx]); \
+                        const int x = 0; \
+                        *line_buffer_ptr++ = (PIXEL); \
+                    } \
+                }
+                if (rotation)
+                {
+                    if (format & RG_PIXEL_PALETTE)
+                        RENDER_ROTATED_LINE(uint8_t, palette[buffer[x]])
+                    else if (format == RG_PIXEL_565_LE)
+                        RENDER_ROTATED_LINE(uint16_t, (buffer[x] << 8) | (buffer[x] >> 8))
+                    else
+                        RENDER_ROTATED_LINE(uint16_t, buffer[x])
+                }
+                else if (format & RG_PIXEL_PALETTE)
                     RENDER_LINE(uint8_t, palette[buffer[x]])
                 else if (format == RG_PIXEL_565_LE)
                     RENDER_LINE(uint16_t, (buffer[x] << 8) | (buffer[x] >> 8))
@@ -185,6 +282,7 @@ static inline void write_update(const rg_surface_t *update)
             }
         }
 
+        rg_system_stage_begin(&transfer, RG_STAGE_TRANSFER);
         if (need_update)
         {
             int left = display.screen.margin_left + draw_left;
@@ -200,6 +298,7 @@ static inline void write_update(const rg_surface_t *update)
             // Return unused buffer
             lcd_send_buffer(line_buffer, 0);
         }
+        rg_system_stage_end(&transfer);
 
         lines_remaining -= lines_to_copy;
     }
@@ -296,12 +395,77 @@ static bool load_border_file(const char *filename)
     return false;
 }
 
+// One row per stage at the bottom of the screen: the bar is the average time per frame and the white
+// mark the p99, the gray mark in the middle is one frame's worth of time at the core's tick rate.
+static void draw_overlay(void)
+{
+    static const uint16_t colors[RG_STAGE_COUNT] = {C_GREEN, C_YELLOW, C_CYAN, C_ORANGE, C_MAGENTA, C_RED};
+    const rg_stats_t stats = rg_system_get_counters();
+    const int frame_time = 1000000 / RG_MAX(rg_system_get_app()->tickRate, 1);
+    const int width = display.screen.width;
+    const int height = RG_STAGE_COUNT * OVERLAY_ROW_HEIGHT;
+    const int top = display.screen.height - height;
+
+    lcd_set_window(display.screen.margin_left, display.screen.margin_top + top, width, height);
+
+    for (int y = 0; y < height;)
+    {
+        uint16_t *buffer = lcd_get_buffer(LCD_BUFFER_LENGTH);
+        int num_lines = RG_MIN(LCD_BUFFER_LENGTH / width, height - y);
+        for (int line = 0; line < num_lines; ++line, ++y)
+        {
+            const rg_stage_stats_t *stage = &stats.stages[y / OVERLAY_ROW_HEIGHT];
+            uint16_t color = colors[y / OVERLAY_ROW_HEIGHT];
+            int bar = (int64_t)stage->avg * (width / 2) / frame_time;
+            int mark = (int64_t)stage->p99 * (width / 2) / frame_time;
+            uint16_t *row = buffer + line * width;
+            for (int x = 0; x < width; ++x)
+            {
+                uint16_t pixel = (x < bar) ? color : C_BLACK;
+                if (x == mark || x == mark + 1)
+                    pixel = C_WHITE;
+                else if (x == width / 2)
+                    pixel = C_GRAY;
+                row[x] = (pixel << 8) | (pixel >> 8);
+            }
+            // The next frame must draw over the overlay if it gets disabled
+            screen_line_checksum[top + y] = 0;
+        }
+        lcd_send_buffer(buffer, width * num_lines);
+    }
+}
+
+static inline int64_t earliest_change(int64_t a, int64_t b)
+{
+    return (a && (!b || a < b)) ? a : b;
+}
+
+static void display_frames(void)
+{
+    rg_mutex_take(ring.lock, -1);
+    ring.notified = false;
+    while (ring.pending >= 0)
+    {
+        int64_t input_changed = ring.input_changed[ring.pending];
+        ring.input_changed[ring.pending] = 0;
+        ring.displaying = ring.pending;
+        ring.pending = -1;
+        rg_mutex_give(ring.lock);
+        write_update(ring.frames[ring.displaying], NULL, 0);
+        rg_input_report_presented(input_changed);
+        counters.presentedFrames++;
+        rg_mutex_take(ring.lock, -1);
+        ring.displaying = -1;
+    }
+    rg_mutex_give(ring.lock);
+}
+
 IRAM_ATTR
 static void display_task(void *arg)
 {
     rg_task_msg_t msg;
 
-    while (rg_task_peek(&msg))
+    while (rg_task_peek(&msg, -1))
     {
         // Received a shutdown request!
         if (msg.type == RG_TASK_MSG_STOP)
@@ -320,14 +484,44 @@ static void display_task(void *arg)
             display.changed = false;
         }
 
-        write_update(msg.dataPtr);
-
-        rg_task_receive(&msg);
+        if (msg.type == DISPLAY_MSG_PRESENT)
+        {
+            // Take the notification first, so that rg_display_present() can queue another while we draw
+            rg_task_receive(&msg, -1);
+            display_frames();
+            if (overlay_enabled)
+                draw_overlay();
+        }
+        else if (msg.type == DISPLAY_MSG_SUBMIT)
+        {
+            const submission_t *submission = msg.dataPtr;
+            write_update(submission->surface, submission->partial ? submission->dirty_lines : NULL, submission->rotation);
+            rg_input_report_presented(submission->input_changed);
+            if (overlay_enabled)
+                draw_overlay();
+            rg_task_receive(&msg, -1);
+        }
+        else
+        {
+            rg_task_receive(&msg, -1);
+        }
 
+        RG_STAGE_ZONE(RG_STAGE_TRANSFER);
         lcd_sync();
     }
 }
 
+void rg_display_set_overlay(bool enable)
+{
+    overlay_enabled = enable;
+    rg_display_force_redraw();
+}
+
+bool rg_display_get_overlay(void)
+{
+    return overlay_enabled;
+}
+
 void rg_display_force_redraw(void)
 {
     display.changed = true;
@@ -431,21 +625,146 @@ char *rg_display_get_border(void)
 
 void rg_display_submit(const rg_surface_t *update, uint32_t flags)
 {
+    rg_display_submit_lines(update, NULL, flags);
+}
+
+void rg_display_submit_lines(const rg_surface_t *update, const uint32_t *dirty_lines, uint32_t flags)
+{
+    RG_STAGE_ZONE(RG_STAGE_SYNC);
     const int64_t time_start = rg_system_timer();
 
     // Those things should probably be asserted, but this is a new system let's be forgiving...
     if (!update || !update->data)
         return;
 
-    if (display.source.width != update->width || display.source.height != update->height)
+    uint32_t rotation = flags & (RG_DISPLAY_ROTATE_LEFT | RG_DISPLAY_ROTATE_RIGHT);
+    int width = rotation ? update->height : update->width;
+    int height = rotation ? update->width : update->height;
+
+    if (display.source.width != width || display.source.height != height)
+    {
+        rg_display_sync(true);
+        display.source.width = width;
+        display.source.height = height;
+        display.changed = true;
+    }
+
+    // This slot was last used two submissions ago, the display task is done with it by now
+    submission_index = (submission_index + 1) % RG_COUNT(submissions);
+    submission_t *submission = &submissions[submission_index];
+    submission->surface = update;
+    submission->rotation = rotation;
+    // Dirty lines are source lines, they don't match screen lines once rotated
+    submission->partial = dirty_lines && !rotation && update->height <= RG_DISPLAY_MAX_SOURCE_LINES;
+    if (submission->partial)
+        memcpy(submission->dirty_lines, dirty_lines, ((update->height + 31) / 32) * 4);
+    submission->input_changed = rg_input_claim_change();
+
+    rg_task_send(display_task_queue, &(rg_task_msg_t){.type = DISPLAY_MSG_SUBMIT, .dataPtr = submission}, -1);
+
+    counters.blockTime += rg_system_timer() - time_start;
+    counters.totalFrames++;
+}
+
+bool rg_display_create_frames(int width, int height, int format, int count)
+{
+    RG_ASSERT_ARG(count >= 2 && count <= RG_DISPLAY_MAX_FRAMES);
+
+    rg_display_sync(true);
+
+    for (int i = 0; i < ring.count; ++i)
+        rg_surface_free(ring.frames[i]);
+    ring.count = 0;
+    ring.acquired = ring.pending = ring.displaying = -1;
+    memset(ring.input_changed, 0, sizeof(ring.input_changed));
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (!(ring.frames[i] = rg_surface_create(width, height, format, MEM_FAST)))
+        {
+            while (--i >= 0)
+                rg_surface_free(ring.frames[i]);
+            return false;
+        }
+        // The core only ever sees one palette
+        if (i > 0)
+            ring.frames[i]->palette = ring.frames[0]->palette;
+    }
+    ring.count = count;
+
+    return true;
+}
+
+rg_surface_t *rg_display_acquire(void)
+{
+    RG_ASSERT(ring.count > 0, "rg_display_create_frames() wasn't called");
+    rg_mutex_take(ring.lock, -1);
+    for (int i = 0; i < ring.count && ring.acquired < 0; ++i)
+    {
+        if (i != ring.pending && i != ring.displaying)
+        {
+            ring.input_changed[i] = 0;
+            ring.acquired = i;
+        }
+    }
+    // Only possible with two frames: the display is busy and a frame waits behind it. It's stale, take it back.
+    if (ring.acquired < 0)
+    {
+        ring.acquired = ring.pending;
+        ring.pending = -1;
+        counters.droppedFrames++;
+    }
+    rg_surface_t *frame = ring.frames[ring.acquired];
+    rg_mutex_give(ring.lock);
+    return frame;
+}
+
+void rg_display_present(rg_surface_t *frame)
+{
+    RG_STAGE_ZONE(RG_STAGE_SYNC);
+    const int64_t time_start = rg_system_timer();
+    int index = -1;
+
+    for (int i = 0; i < ring.count; ++i)
+    {
+        if (ring.frames[i] == frame)
+            index = i;
+    }
+    RG_ASSERT(index >= 0, "Frame doesn't belong to the ring");
+
+    if (display.source.width != frame->width || display.source.height != frame->height)
     {
         rg_display_sync(true);
-        display.source.width = update->width;
-        display.source.height = update->height;
+        display.source.width = frame->width;
+        display.source.height = frame->height;
         display.changed = true;
     }
 
-    rg_task_send(display_task_queue, &(rg_task_msg_t){.dataPtr = update});
+    // Presenting the frame on screen again (a redraw), let the display task finish with it first
+    if (index == ring.displaying)
+        rg_display_sync(true);
+
+    int64_t input_changed = rg_input_claim_change();
+
+    rg_mutex_take(ring.lock, -1);
+    // Input changes carried by an earlier frame (dropped or reclaimed) are only answered by this one
+    if (ring.pending >= 0 && ring.pending != index)
+    {
+        input_changed = earliest_change(input_changed, ring.input_changed[ring.pending]);
+        ring.input_changed[ring.pending] = 0;
+        counters.droppedFrames++;
+    }
+    ring.input_changed[index] = earliest_change(input_changed, ring.input_changed[index]);
+    if (ring.acquired == index)
+        ring.acquired = -1;
+    ring.pending = index;
+    bool notify = !ring.notified;
+    ring.notified = true;
+    rg_mutex_give(ring.lock);
+
+    // The display task takes notifications before drawing, this won't wait for it
+    if (notify)
+        rg_task_send(display_task_queue, &(rg_task_msg_t){.type = DISPLAY_MSG_PRESENT}, -1);
 
     counters.blockTime += rg_system_timer() - time_start;
     counters.totalFrames++;
@@ -453,9 +772,21 @@ void rg_display_submit(const rg_surface_t *update, uint32_t flags)
 
 bool rg_display_sync(bool block)
 {
-    while (block && rg_task_messages_waiting(display_task_queue))
-        continue; // We should probably yield?
-    return !rg_task_messages_waiting(display_task_queue);
+    rg_mutex_take(ring.lock, -1);
+    bool ring_busy = ring.pending >= 0 || ring.displaying >= 0 || ring.notified;
+    rg_mutex_give(ring.lock);
+
+    if (!block)
+        return !ring_busy && !rg_task_messages_waiting(display_task_queue);
+
+    RG_STAGE_ZONE(RG_STAGE_SYNC);
+
+    // Ring frames are drawn after their message is gone from the queue, so the queue
+    // being empty isn't enough. Anything queued behind them is only read once they're done.
+    if (ring_busy)
+        rg_task_send(display_task_queue, &(rg_task_msg_t){.type = DISPLAY_MSG_SYNC}, -1);
+
+    return rg_task_wait_empty(display_task_queue, -1);
 }
 
 void rg_display_write(int left, int top, int width, int height, int stride, const uint16_t *buffer, uint32_t flags)
@@ -543,7 +874,7 @@ void rg_display_clear(uint16_t color_le)
 
 void rg_display_deinit(void)
 {
-    rg_task_send(display_task_queue, &(rg_task_msg_t){.type = RG_TASK_MSG_STOP});
+    rg_task_send(display_task_queue, &(rg_task_msg_t){.type = RG_TASK_MSG_STOP}, -1);
     lcd_deinit();
     RG_LOGI("Display terminated.\n");
 }
@@ -572,6 +903,7 @@ void rg_display_init(void)
         .changed = true,
     };
     lcd_init();
+    ring.lock = rg_mutex_create();
     display_task_queue = rg_task_create("rg_display", &display_task, NULL, 4 * 1024, RG_TASK_PRIORITY_6, 1);
     if (config.border_file)
         load_border_file(config.border_file);
@@ -40,8 +40,16 @@ enum
 {
     RG_DISPLAY_WRITE_NOSYNC = (1 << 0),
     RG_DISPLAY_WRITE_NOSWAP = (1 << 1),
+    // rg_display_submit: draw the surface rotated 90 degrees counterclockwise (left) or clockwise (right)
+    RG_DISPLAY_ROTATE_LEFT = (1 << 2),
+    RG_DISPLAY_ROTATE_RIGHT = (1 << 3),
 };
 
+// Largest source surface height that can carry a dirty lines hint
+#define RG_DISPLAY_MAX_SOURCE_LINES 512
+// Largest frame ring rg_display_create_frames() will allocate
+#define RG_DISPLAY_MAX_FRAMES 3
+
 typedef struct
 {
     display_rotation_t rotation;
@@ -57,6 +65,8 @@ typedef struct
     int32_t totalFrames;
     int32_t fullFrames;
     int32_t partFrames;
+    int32_t presentedFrames; // Ring frames that reached the screen
+    int32_t droppedFrames;   // Ring frames replaced by a newer one before the display got to them
     int64_t blockTime;
     int64_t busyTime;
 } rg_display_counters_t;
@@ -105,7 +115,18 @@ void rg_display_write(int left, int top, int width, int height, int stride, cons
 void rg_display_clear(uint16_t color_le);
 bool rg_display_sync(bool block);
 void rg_display_force_redraw(void);
+// Draws per-stage frame timing bars (see rg_stage_t) at the bottom of the screen
+void rg_display_set_overlay(bool enable);
+bool rg_display_get_overlay(void);
 void rg_display_submit(const rg_surface_t *update, uint32_t flags);
+// Same as rg_display_submit, but only source lines set in dirty_lines (one bit per line) need to be redrawn
+void rg_display_submit_lines(const rg_surface_t *update, const uint32_t *dirty_lines, uint32_t flags);
+// Display-owned ring of 2-3 frames, as an alternative to managing surfaces and rg_display_sync() by hand.
+// rg_display_acquire() never blocks, its content is undefined and all frames share the same palette.
+// rg_display_present() never waits for the display either: a frame still waiting is dropped for the new one.
+bool rg_display_create_frames(int width, int height, int format, int count);
+rg_surface_t *rg_display_acquire(void);
+void rg_display_present(rg_surface_t *frame);
 
 rg_display_counters_t rg_display_get_counters(void);
 const rg_display_t *rg_display_get_info(void);
@@ -1226,6 +1226,20 @@ static rg_gui_event_t speedup_update_cb(rg_gui_option_t *option, rg_gui_event_t
     return RG_DIALOG_VOID;
 }
 
+static rg_gui_event_t idle_skip_update_cb(rg_gui_option_t *option, rg_gui_event_t event)
+{
+    rg_idle_t *idle = rg_idle_get_attached();
+    if (event == RG_DIALOG_PREV || event == RG_DIALOG_NEXT)
+    {
+        rg_idle_set_enabled(!idle->enabled);
+    }
+    if (idle->enabled && idle->cycles > 0)
+        sprintf(option->value, "On (%d%%)", (int)(idle->skipped * 100 / idle->cycles));
+    else
+        strcpy(option->value, idle->enabled ? "On " : "Off");
+    return RG_DIALOG_VOID;
+}
+
 static rg_gui_event_t led_indicator_opt_cb(rg_gui_option_t *option, rg_gui_event_t event)
 {
     if (event == RG_DIALOG_PREV || event == RG_DIALOG_NEXT)
@@ -1513,6 +1527,8 @@ void rg_gui_options_menu(void)
         *opt++ = (rg_gui_option_t){0, "Filter",    "-", RG_DIALOG_FLAG_NORMAL, &filter_update_cb};
         *opt++ = (rg_gui_option_t){0, "Border",    "-", RG_DIALOG_FLAG_NORMAL, &border_update_cb};
         *opt++ = (rg_gui_option_t){0, "Speed",     "-", RG_DIALOG_FLAG_NORMAL, &speedup_update_cb};
+        if (rg_idle_get_attached())
+            *opt++ = (rg_gui_option_t){0, "Idle skip", "-", RG_DIALOG_FLAG_NORMAL, &idle_skip_update_cb};
     }
 
     size_t extra_options = get_dialog_items_count(app->options);
@@ -1566,7 +1582,7 @@ void rg_gui_about_menu(const rg_gui_option_t *extra_options)
                 rg_gui_alert("Credits", RG_PROJECT_CREDITS);
                 break;
             case 2:
-                rg_gui_debug_menu(NULL);
+                rg_gui_debug_menu(app->debugOptions);
                 break;
             case 3:
                 if (rg_gui_confirm("Reset all settings?", NULL, false)) {
@@ -1590,10 +1606,10 @@ void rg_gui_debug_menu(const rg_gui_option_t *extra_options)
     char screen_res[20], source_res[20], scaled_res[20];
     char stack_hwm[20], heap_free[20], block_free[20];
     char local_time[32], timezone[32], uptime[20];
-    char battery_info[25], frame_time[32];
+    char battery_info[25], frame_time[32], frames_info[32], input_lag[32], io_info[32];
     char app_name[32], network_str[64];
 
-    const rg_gui_option_t options[] = {
+    rg_gui_option_t options[48] = {
         {0, "Screen res", screen_res,   RG_DIALOG_FLAG_NORMAL, NULL},
         {0, "Source res", source_res,   RG_DIALOG_FLAG_NORMAL, NULL},
         {0, "Scaled res", scaled_res,   RG_DIALOG_FLAG_NORMAL, NULL},
@@ -1607,17 +1623,32 @@ void rg_gui_debug_menu(const rg_gui_option_t *extra_options)
         {0, "Uptime    ", uptime,       RG_DIALOG_FLAG_NORMAL, NULL},
         {0, "Battery   ", battery_info, RG_DIALOG_FLAG_NORMAL, NULL},
         {0, "Blit time ", frame_time,   RG_DIALOG_FLAG_NORMAL, NULL},
-        RG_DIALOG_SEPARATOR,
-        {0, "Overclock", "-", RG_DIALOG_FLAG_NORMAL, &overclock_update_cb},
-        {1, "Reboot to firmware", NULL, RG_DIALOG_FLAG_NORMAL, NULL},
-        {2, "Clear cache    ", NULL, RG_DIALOG_FLAG_NORMAL, NULL},
-        {3, "Save screenshot", NULL, RG_DIALOG_FLAG_NORMAL, NULL},
-        {4, "Save trace", NULL, RG_DIALOG_FLAG_NORMAL, NULL},
-        {5, "Cheats    ", NULL, RG_DIALOG_FLAG_NORMAL, NULL},
-        {6, "Crash     ", NULL, RG_DIALOG_FLAG_NORMAL, NULL},
-        {7, "Log=debug ", NULL, RG_DIALOG_FLAG_NORMAL, NULL},
+        {0, "Frames    ", frames_info,  RG_DIALOG_FLAG_NORMAL, NULL},
+        {0, "Input lag ", input_lag,    RG_DIALOG_FLAG_NORMAL, NULL},
+        {0, "Storage IO", io_info,      RG_DIALOG_FLAG_NORMAL, NULL},
         RG_DIALOG_END
     };
+    rg_gui_option_t *opt = options + get_dialog_items_count(options);
+
+    size_t extra_options_count = get_dialog_items_count(extra_options);
+    for (size_t i = 0; i < extra_options_count && i < 16; i++)
+        *opt++ = extra_options[i];
+
+    *opt++ = (rg_gui_option_t)RG_DIALOG_SEPARATOR;
+    *opt++ = (rg_gui_option_t){0, "Overclock", "-", RG_DIALOG_FLAG_NORMAL, &overclock_update_cb};
+    *opt++ = (rg_gui_option_t){1, "Reboot to firmware", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+    *opt++ = (rg_gui_option_t){2, "Clear cache    ", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+    *opt++ = (rg_gui_option_t){3, "Save screenshot", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+    *opt++ = (rg_gui_option_t){4, "Save trace", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+    *opt++ = (rg_gui_option_t){5, "Cheats    ", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+    *opt++ = (rg_gui_option_t){6, "Crash     ", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+    *opt++ = (rg_gui_option_t){7, "Log=debug ", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+    *opt++ = (rg_gui_option_t){10, "Export settings", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+    *opt++ = (rg_gui_option_t){9, "Perf overlay", rg_display_get_overlay() ? "On " : "Off", RG_DIALOG_FLAG_NORMAL, NULL};
+#ifdef RG_ENABLE_PROFILING
+    *opt++ = (rg_gui_option_t){8, "Save profile", NULL, RG_DIALOG_FLAG_NORMAL, NULL};
+#endif
+    *opt++ = (rg_gui_option_t)RG_DIALOG_END;
 
     const rg_display_t *display = rg_display_get_info();
     rg_display_counters_t display_stats = rg_display_get_counters();
@@ -1637,6 +1668,15 @@ void rg_gui_debug_menu(const rg_gui_option_t *extra_options)
     }
     else
         snprintf(frame_time, 20, "N/A");
+    rg_input_stats_t input_stats = rg_input_get_stats();
+    if (input_stats.presented > 0)
+        snprintf(input_lag, 32, "%dms avg, %dms max", (int)(input_stats.totalLatency / input_stats.presented / 1000),
+                 (int)(input_stats.maxLatency / 1000));
+    else
+        snprintf(input_lag, 32, "N/A");
+    rg_io_stats_t io_stats = rg_storage_get_io_stats();
+    snprintf(io_info, 32, "%d req, %dms max", (int)io_stats.requests, (int)(io_stats.maxLatency / 1000));
+    snprintf(frames_info, 32, "%d shown, %d dropped", (int)display_stats.presentedFrames, (int)display_stats.droppedFrames);
     snprintf(stack_hwm, 20, "%d", stats.freeStackMain);
     snprintf(heap_free, 20, "%d+%d", stats.freeMemoryInt, stats.freeMemoryExt);
     snprintf(block_free, 20, "%d+%d", stats.freeBlockInt, stats.freeBlockExt);
@@ -1688,6 +1728,19 @@ void rg_gui_debug_menu(const rg_gui_option_t *extra_options)
     case 7:
         rg_system_set_log_level(RG_LOG_DEBUG);
         break;
+#ifdef RG_ENABLE_PROFILING
+    case 8:
+        rg_system_save_profile(RG_STORAGE_ROOT "/profile.json");
+        break;
+#endif
+    case 9:
+        rg_display_set_overlay(!rg_display_get_overlay());
+        break;
+    case 10:
+        rg_settings_export(NS_GLOBAL, NULL);
+        rg_settings_export(NS_APP, NULL);
+        rg_settings_commit();
+        break;
     }
 }
 
@@ -0,0 +1,47 @@
+#include "rg_system.h"
+
+static const char *SETTING_IDLE_SKIP = "IdleSkip";       // Per game, 0 when the game is opted out
+static const char *SETTING_IDLE_CYCLES = "IdleSkipped"; // Per game, total cycles skipped so far
+
+static rg_idle_t *attached;
+
+void rg_idle_attach(rg_idle_t *idle)
+{
+    if (attached && attached != idle && attached->cycles > 0)
+    {
+        double total = rg_settings_get_number(NS_FILE, SETTING_IDLE_CYCLES, 0) + attached->skipped;
+        rg_settings_set_number(NS_FILE, SETTING_IDLE_CYCLES, total);
+        RG_LOGI("Skipped %dM of %dM cycles (%d%%) in %d idle loops", (int)(attached->skipped / 1000000),
+                (int)(attached->cycles / 1000000), (int)(attached->skipped * 100 / attached->cycles),
+                (int)attached->loops);
+    }
+
+    if (idle && idle != attached)
+    {
+        rg_idle_reset(idle);
+        idle->enabled = rg_settings_get_number(NS_FILE, SETTING_IDLE_SKIP, 1);
+        idle->cycles = idle->skipped = idle->loops = 0;
+        if (!idle->enabled)
+            RG_LOGI("Idle loop skipping is disabled for this game");
+    }
+
+    attached = idle;
+}
+
+rg_idle_t *rg_idle_get_attached(void)
+{
+    return attached;
+}
+
+void rg_idle_set_enabled(bool enabled)
+{
+    if (!attached)
+        return;
+    rg_idle_reset(attached);
+    attached->enabled = enabled;
+    // Only opted out games are listed, the default is to skip
+    if (enabled)
+        rg_settings_delete(NS_FILE, SETTING_IDLE_SKIP);
+    else
+        rg_settings_set_number(NS_FILE, SETTING_IDLE_SKIP, 0);
+}
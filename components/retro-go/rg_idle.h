@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Idle loop detection shared by the CPU cores. Games often spin on a status register or a RAM flag set by an
+// interrupt handler, the CPU cores report every short backward jump to rg_idle_branch and once the loop has
+// gone around a few times with the exact same registers and no memory writes, it is known to be waiting for
+// something external. The core can then skip whole iterations up to its next scheduled event (end of the
+// scanline, timer, ...) and end up in the exact state it would have reached by running them.
+//
+// The hot path is inline and has no dependencies so that it can be used by the cores directly.
+// Cores must call rg_idle_reset on anything that could make the next iteration behave differently: memory
+// writes (including stack pushes), interrupts, DMA, and reads of registers that change within a time slice.
+
+#define RG_IDLE_NONE       UINT32_MAX
+#define RG_IDLE_MAX_LENGTH 32  // Maximum distance between the jump and its target, in bytes
+#define RG_IDLE_MAX_PERIOD 512 // Maximum duration of one iteration, in cycles
+#define RG_IDLE_MIN_PASSES 2   // Identical iterations needed before the loop is considered idle
+
+typedef struct
+{
+    bool enabled;
+    uint32_t head;   // Target of the candidate loop, RG_IDLE_NONE if there's none
+    uint64_t state;  // Registers the last time the loop head was reached
+    uint32_t stamp;  // Cycle counter the last time the loop head was reached
+    int32_t passes;  // Consecutive identical iterations
+    // Statistics for the current game
+    uint64_t cycles;  // Cycles emulated, including skipped ones (maintained by the core)
+    uint64_t skipped; // Cycles fast-forwarded
+    uint32_t loops;   // Number of fast-forwards
+} rg_idle_t;
+
+static inline void rg_idle_reset(rg_idle_t *idle)
+{
+    idle->head = RG_IDLE_NONE;
+}
+
+// Called when a backward jump from `pc` to `target` is taken. `state` must uniquely identify the registers
+// (a hash for wide register files), `now` is a cycle counter that increases as the CPU runs (it may wrap),
+// and `budget` is the number of cycles left until the next event. Returns the number of cycles to skip,
+// which is always a whole number of iterations.
+static inline int rg_idle_branch(rg_idle_t *idle, uint32_t pc, uint32_t target, uint64_t state, uint32_t now, int32_t budget)
+{
+    if (pc - target > RG_IDLE_MAX_LENGTH || !idle->enabled)
+        return 0;
+
+    if (target != idle->head || state != idle->state)
+    {
+        idle->head = target;
+        idle->state = state;
+        idle->stamp = now;
+        idle->passes = 0;
+        return 0;
+    }
+
+    int32_t period = (int32_t)(now - idle->stamp);
+    idle->stamp = now;
+
+    if (++idle->passes < RG_IDLE_MIN_PASSES || period <= 0 || period > RG_IDLE_MAX_PERIOD || budget < period)
+        return 0;
+
+    int32_t skip = budget - budget % period;
+    idle->stamp += skip;
+    idle->skipped += skip;
+    idle->loops++;
+    return skip;
+}
+
+// Registers the detector of the running game, its enabled state is restored from the game's opt-out setting.
+// Passing NULL saves the per-game counters and detaches it.
+void rg_idle_attach(rg_idle_t *idle);
+rg_idle_t *rg_idle_get_attached(void);
+// Adds or removes the running game from the opt-out list
+void rg_idle_set_enabled(bool enabled);
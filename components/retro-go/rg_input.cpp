@@ -7,6 +7,8 @@
 #include "TouchKeyboardV2.h"
 
 #ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <driver/gpio.h>
 #include <driver/adc.h>
 #else
@@ -36,11 +38,29 @@ static rg_keymap_serial_t keymap_serial[] = RG_GAMEPAD_SERIAL_MAP;
 #ifdef RG_GAMEPAD_VIRT_MAP
 static rg_keymap_virt_t keymap_virt[] = RG_GAMEPAD_VIRT_MAP;
 #endif
+// Edges can only wake up the input task when every key is on a plain GPIO
+#if defined(ESP_PLATFORM) && defined(RG_GAMEPAD_GPIO_MAP) && !defined(RG_GAMEPAD_ADC_MAP) \
+    && !defined(RG_GAMEPAD_I2C_MAP) && !defined(RG_GAMEPAD_SERIAL_MAP)
+#define GPIO_WAKEUP 1
+#endif
 static bool input_task_running = false;
 static uint32_t gamepad_state = -1; // _Atomic
 static uint32_t touch_keyb = 0; // _Atomic
 static uint32_t gamepad_mapped = 0;
 static rg_battery_t battery_state = {0};
+static rg_input_poll_mode_t poll_mode = RG_INPUT_POLL_NORMAL;
+#ifdef ESP_PLATFORM
+static TaskHandle_t input_task_handle;
+#endif
+
+// current_sample is only written by input_task, sample_seq is odd while it does
+static rg_input_sample_t current_sample;
+static volatile uint32_t sample_seq;
+// latched_sample is only used by the thread calling rg_input_latch()
+static rg_input_sample_t latched_sample;
+static rg_input_stats_t input_stats;
+static int64_t unclaimed_change;
+static rg_mutex_t *stats_lock;
 
 static TouchKeyboardV2 *touchKeyboard = NULL;
 
@@ -195,6 +215,63 @@ bool rg_input_read_gamepad_raw(uint32_t *out)
     return true;
 }
 
+static void wake_input_task(void)
+{
+#ifdef ESP_PLATFORM
+    if (poll_mode == RG_INPUT_POLL_FAST && input_task_handle)
+        xTaskNotifyGive(input_task_handle);
+#endif
+}
+
+#ifdef GPIO_WAKEUP
+static void IRAM_ATTR gpio_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    if (input_task_handle)
+        vTaskNotifyGiveFromISR(input_task_handle, &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+#endif
+
+static void input_wait(int ms)
+{
+#ifdef ESP_PLATFORM
+    // Returns early when notified by wake_input_task or gpio_isr
+    ulTaskNotifyTake(pdTRUE, RG_MAX(pdMS_TO_TICKS(ms), (TickType_t)1));
+#else
+    rg_task_delay(ms);
+#endif
+}
+
+static void publish_sample(uint32_t state, int64_t now)
+{
+    sample_seq++;
+    __sync_synchronize();
+    if (state != current_sample.state)
+        current_sample.changed = now;
+    current_sample.state = state;
+    current_sample.sampled = now;
+    __sync_synchronize();
+    sample_seq++;
+    gamepad_state = state;
+}
+
+static rg_input_sample_t read_sample(void)
+{
+    rg_input_sample_t sample;
+    uint32_t seq;
+    do
+    {
+        while ((seq = sample_seq) & 1)
+            continue;
+        __sync_synchronize();
+        sample = current_sample;
+        __sync_synchronize();
+    } while (seq != sample_seq);
+    return sample;
+}
+
 static void input_task(void *arg)
 {
     const uint8_t debounce_level = 0x03;
@@ -204,10 +281,15 @@ static void input_task(void *arg)
     int64_t next_battery_update = 0;
 
     memset(debounce, debounce_level, sizeof(debounce));
+#ifdef ESP_PLATFORM
+    input_task_handle = xTaskGetCurrentTaskHandle();
+#endif
     input_task_running = true;
 
     while (input_task_running)
     {
+        bool settling = false;
+
         if (rg_input_read_gamepad_raw(&state))
         {
             for (int i = 0; i < RG_KEY_COUNT; ++i)
@@ -223,8 +305,12 @@ static void input_task(void *arg)
                 {
                     local_gamepad_state &= ~(1 << i);
                 }
+                else
+                {
+                    settling = true;
+                }
             }
-            gamepad_state = local_gamepad_state;
+            publish_sample(local_gamepad_state, rg_system_timer());
         }
 
         if (rg_system_timer() >= next_battery_update)
@@ -241,10 +327,20 @@ static void input_task(void *arg)
             next_battery_update = rg_system_timer() + 2 * 1000000; // update every 2 seconds
         }
 
-        rg_task_delay(10);
+        if (poll_mode != RG_INPUT_POLL_FAST)
+            input_wait(RG_INPUT_POLL_INTERVAL);
+    #ifdef GPIO_WAKEUP
+        else if (!settling)
+            input_wait(RG_INPUT_POLL_INTERVAL); // An edge will wake us up
+    #endif
+        else
+            input_wait(1);
     }
 
     input_task_running = false;
+#ifdef ESP_PLATFORM
+    input_task_handle = NULL;
+#endif
     gamepad_state = -1;
 }
 
@@ -316,6 +412,7 @@ void rg_input_init(void)
                 {
                     touch_keyb &= ~rg_key;
                 }
+                wake_input_task();
             }
         }
       },
@@ -401,10 +498,16 @@ void rg_input_init(void)
     // The first read returns bogus data in some drivers, waste it.
     rg_input_read_gamepad_raw(NULL);
 
+    stats_lock = rg_mutex_create();
+
     // Start background polling
     rg_task_create("rg_input", &input_task, NULL, 3 * 1024, RG_TASK_PRIORITY_6, 1);
     while (gamepad_state == -1)
         rg_task_yield();
+#ifdef GPIO_WAKEUP
+    // Waking up on edges costs nothing when idle, no reason not to
+    rg_input_set_poll_mode(RG_INPUT_POLL_FAST);
+#endif
     RG_LOGI("Input ready. state=" PRINTF_BINARY_16 "\n", PRINTF_BINVAL_16(gamepad_state));
 }
 
@@ -424,6 +527,99 @@ uint32_t rg_input_read_gamepad(void)
     return gamepad_state;
 }
 
+uint32_t rg_input_latch(void)
+{
+#ifdef RG_TARGET_SDL2
+    SDL_PumpEvents();
+#endif
+    rg_input_sample_t sample = read_sample();
+    sample.latched = rg_system_timer();
+    if (stats_lock)
+    {
+        rg_mutex_take(stats_lock, -1);
+        input_stats.latches++;
+        if (sample.state != latched_sample.state)
+        {
+            input_stats.changes++;
+            unclaimed_change = sample.changed;
+        }
+        rg_mutex_give(stats_lock);
+    }
+    latched_sample = sample;
+    return sample.state;
+}
+
+rg_input_sample_t rg_input_get_latched(void)
+{
+    return latched_sample;
+}
+
+void rg_input_set_poll_mode(rg_input_poll_mode_t mode)
+{
+#ifdef GPIO_WAKEUP
+    static bool isr_installed = false;
+    if (mode == RG_INPUT_POLL_FAST && !isr_installed)
+    {
+        gpio_install_isr_service(0); // Fails harmlessly if another driver already installed it
+        for (size_t i = 0; i < RG_COUNT(keymap_gpio); ++i)
+        {
+            gpio_set_intr_type(gpio_num_t(keymap_gpio[i].num), GPIO_INTR_ANYEDGE);
+            gpio_isr_handler_add(gpio_num_t(keymap_gpio[i].num), &gpio_isr, NULL);
+        }
+        isr_installed = true;
+    }
+    for (size_t i = 0; i < RG_COUNT(keymap_gpio) && isr_installed; ++i)
+    {
+        if (mode == RG_INPUT_POLL_FAST)
+            gpio_intr_enable(gpio_num_t(keymap_gpio[i].num));
+        else
+            gpio_intr_disable(gpio_num_t(keymap_gpio[i].num));
+    }
+#endif
+    RG_LOGI("Poll mode: %s", mode == RG_INPUT_POLL_FAST ? "fast" : "normal");
+    poll_mode = mode;
+    wake_input_task();
+}
+
+rg_input_stats_t rg_input_get_stats(void)
+{
+    rg_input_stats_t stats = {};
+    if (stats_lock)
+    {
+        rg_mutex_take(stats_lock, -1);
+        stats = input_stats;
+        rg_mutex_give(stats_lock);
+    }
+    return stats;
+}
+
+int64_t rg_input_claim_change(void)
+{
+    int64_t changed = 0;
+    if (stats_lock)
+    {
+        rg_mutex_take(stats_lock, -1);
+        changed = unclaimed_change;
+        unclaimed_change = 0;
+        rg_mutex_give(stats_lock);
+    }
+    return changed;
+}
+
+void rg_input_report_presented(int64_t changed)
+{
+    if (!stats_lock || !changed)
+        return;
+    int64_t latency = rg_system_timer() - changed;
+    rg_mutex_take(stats_lock, -1);
+    input_stats.presented++;
+    input_stats.totalLatency += latency;
+    input_stats.lastLatency = latency;
+    if (latency > input_stats.maxLatency)
+        input_stats.maxLatency = latency;
+    rg_mutex_give(stats_lock);
+}
+
 bool rg_input_key_is_pressed(rg_key_t mask)
 {
     return (bool)(rg_input_read_gamepad() & mask);
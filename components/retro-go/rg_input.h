@@ -89,6 +89,30 @@ typedef struct
     char data[];
 } rg_keyboard_map_t;
 
+typedef enum
+{
+    RG_INPUT_POLL_NORMAL = 0, // Poll every RG_INPUT_POLL_INTERVAL ms
+    RG_INPUT_POLL_FAST,       // Poll every 1ms, or wake up on GPIO edges when the gamepad driver allows it
+} rg_input_poll_mode_t;
+
+typedef struct
+{
+    uint32_t state;  // Debounced gamepad state
+    int64_t changed; // rg_system_timer() of the poll that first saw this state
+    int64_t sampled; // rg_system_timer() of the last poll
+    int64_t latched; // rg_system_timer() of the rg_input_latch() that captured it
+} rg_input_sample_t;
+
+typedef struct
+{
+    int32_t latches;      // rg_input_latch() calls
+    int32_t changes;      // Latches that captured a new state
+    int32_t presented;    // Changes that made it to the screen
+    int64_t totalLatency; // Sum of input-to-present times in us, from the poll that saw the change to the end of the frame
+    int64_t maxLatency;
+    int64_t lastLatency;
+} rg_input_stats_t;
+
 void rg_input_init(void);
 void rg_input_deinit(void);
 bool rg_input_key_is_pressed(rg_key_t mask);
@@ -101,3 +125,14 @@ rg_battery_t rg_input_read_battery(void);
 bool rg_input_read_gamepad_raw(uint32_t *out);
 bool rg_input_read_keyboard_raw(int *out);
 bool rg_input_read_battery_raw(rg_battery_t *out);
+
+// Capture the gamepad state to use for this frame, ideally right before the emulated game reads its input.
+// Every frame submitted after a latch that captured a new state contributes to the latency stats.
+uint32_t rg_input_latch(void);
+rg_input_sample_t rg_input_get_latched(void);
+void rg_input_set_poll_mode(rg_input_poll_mode_t mode);
+rg_input_stats_t rg_input_get_stats(void);
+// Used by rg_display: claim the time of the change captured by the last latch (0 if none or already
+// claimed) when a frame is submitted, then report it once that frame is on screen.
+int64_t rg_input_claim_change(void);
+void rg_input_report_presented(int64_t changed);
@@ -2,15 +2,513 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
 #include <string.h>
 #include <cJSON.h>
 
-static cJSON *config_root = NULL;
+/**
+ * Each namespace is stored in `<name>.bin`, a journal of typed key/value records. Setting a value only
+ * touches the in-memory index, rg_settings_commit() appends the changed entries to the journal and the
+ * journal is rewritten (temp file + rename) once it holds too many stale records. A torn record at the
+ * end of the journal (power loss during an append) is detected by its checksum and simply dropped.
+ *
+ * `<name>.json` is rewritten by every compaction, just before the new journal replaces the old one. It is
+ * a snapshot as of the last compaction: values appended to the journal since then are not in it. The
+ * journal header holds the checksum of the json written along with it, the json is only imported when
+ * there is no journal yet or when its content no longer matches, meaning it was edited or restored by hand.
+ * Timestamps can't be used for that, the clock goes back after a power loss (it's only saved on shutdown).
+ */
 
+#define JOURNAL_MAGIC       "RGS2"
+#define JOURNAL_MAGIC_V1    "RGS1" // No json checksum, the json was imported if it was newer
+#define JOURNAL_MAGIC_LEN   4
+#define JOURNAL_HEADER_LEN  (JOURNAL_MAGIC_LEN + 4)
+#define KEYS_BUCKETS        64
 
-static cJSON *json_root(const char *name, bool set_dirty)
+typedef enum
 {
-    if (!config_root)
+    VALUE_DELETED = 0,
+    VALUE_NULL,
+    VALUE_NUMBER,
+    VALUE_STRING,
+} value_type_t;
+
+typedef struct __attribute__((packed))
+{
+    uint8_t type;
+    uint8_t key_len;
+    uint16_t value_len;
+    uint32_t checksum;
+    // char key[key_len];
+    // uint8_t value[value_len];
+} record_t;
+
+typedef struct
+{
+    const char *key; // Interned, can be compared by address
+    value_type_t type;
+    bool dirty;
+    union {
+        double number;
+        char *string;
+    };
+} entry_t;
+
+typedef struct namespace_s
+{
+    struct namespace_s *next;
+    entry_t *entries;
+    size_t count;
+    size_t capacity;
+    size_t records; // Number of records in the journal on disk
+    uint32_t json_checksum; // Checksum of the json written with the journal, 0 if unknown
+    bool changed;   // At least one entry is dirty
+    bool compact;   // The journal must be rewritten on next commit
+    char name[];
+} namespace_t;
+
+typedef struct interned_key_s
+{
+    struct interned_key_s *next;
+    char key[];
+} interned_key_t;
+
+static interned_key_t *keys[KEYS_BUCKETS];
+static namespace_t *namespaces = NULL;
+static bool initialized = false;
+
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *ptr = data;
+    while (len--)
+        hash = (hash ^ *ptr++) * 16777619;
+    return hash;
+}
+
+static uint32_t record_checksum(const record_t *rec, const void *key, const void *value)
+{
+    record_t header = *rec;
+    header.checksum = 0;
+    uint32_t hash = fnv1a(2166136261, &header, sizeof(header));
+    hash = fnv1a(hash, key, rec->key_len);
+    return fnv1a(hash, value, rec->value_len);
+}
+
+static const char *intern_key(const char *key, bool create)
+{
+    size_t key_len = strlen(key);
+    interned_key_t **bucket = &keys[fnv1a(2166136261, key, key_len) % KEYS_BUCKETS];
+
+    for (interned_key_t *k = *bucket; k; k = k->next)
+    {
+        if (strcmp(k->key, key) == 0)
+            return k->key;
+    }
+
+    if (!create)
+        return NULL;
+
+    interned_key_t *k = malloc(sizeof(interned_key_t) + key_len + 1);
+    if (!k)
+        return NULL;
+    memcpy(k->key, key, key_len + 1);
+    k->next = *bucket;
+    *bucket = k;
+    return k->key;
+}
+
+static void make_path(char *pathbuf, const char *name, const char *ext)
+{
+    snprintf(pathbuf, RG_PATH_MAX, "%s/%s%s", RG_BASE_PATH_CONFIG, name, ext);
+}
+
+static entry_t *find_entry(namespace_t *ns, const char *key, bool create)
+{
+    if (!ns || !key || !(key = intern_key(key, create)))
+        return NULL;
+
+    for (size_t i = 0; i < ns->count; i++)
+    {
+        if (ns->entries[i].key == key)
+            return &ns->entries[i];
+    }
+
+    if (!create)
+        return NULL;
+
+    if (ns->count == ns->capacity)
+    {
+        size_t capacity = ns->capacity ? ns->capacity * 2 : 16;
+        entry_t *entries = realloc(ns->entries, capacity * sizeof(entry_t));
+        if (!entries)
+            return NULL;
+        ns->entries = entries;
+        ns->capacity = capacity;
+    }
+
+    entry_t *entry = &ns->entries[ns->count++];
+    *entry = (entry_t){.key = key, .type = VALUE_DELETED};
+    return entry;
+}
+
+static void update_entry(namespace_t *ns, const char *key, value_type_t type, double number, const char *string, bool dirty)
+{
+    if (!ns || !key)
+        return;
+
+    if (strlen(key) > 255 || (type == VALUE_STRING && strlen(string) > 0xFFFF))
+    {
+        RG_LOGW("Key or value too long for '%s', ignored.", key);
+        return;
+    }
+
+    entry_t *entry = find_entry(ns, key, type != VALUE_DELETED);
+    if (!entry)
+        return;
+
+    if (entry->type == type)
+    {
+        if (type == VALUE_NUMBER && entry->number == number)
+            return;
+        if (type == VALUE_STRING && strcmp(entry->string, string) == 0)
+            return;
+        if (type == VALUE_NULL || type == VALUE_DELETED)
+            return;
+    }
+
+    char *new_string = (type == VALUE_STRING) ? strdup(string) : NULL;
+    if (type == VALUE_STRING && !new_string)
+        return;
+
+    if (entry->type == VALUE_STRING)
+        free(entry->string);
+
+    entry->type = type;
+    if (type == VALUE_STRING)
+        entry->string = new_string;
+    else
+        entry->number = number;
+
+    if (dirty)
+    {
+        entry->dirty = true;
+        ns->changed = true;
+    }
+}
+
+static size_t replay_journal(namespace_t *ns, const uint8_t *data, size_t data_len)
+{
+    size_t pos;
+
+    if (data_len >= JOURNAL_HEADER_LEN && memcmp(data, JOURNAL_MAGIC, JOURNAL_MAGIC_LEN) == 0)
+    {
+        memcpy(&ns->json_checksum, data + JOURNAL_MAGIC_LEN, 4);
+        pos = JOURNAL_HEADER_LEN;
+    }
+    else if (data_len >= JOURNAL_MAGIC_LEN && memcmp(data, JOURNAL_MAGIC_V1, JOURNAL_MAGIC_LEN) == 0)
+        pos = JOURNAL_MAGIC_LEN;
+    else
+        return 0;
+
+    while (pos + sizeof(record_t) <= data_len)
+    {
+        record_t rec;
+        memcpy(&rec, data + pos, sizeof(rec));
+
+        const uint8_t *key_ptr = data + pos + sizeof(rec);
+        const uint8_t *value_ptr = key_ptr + rec.key_len;
+        size_t rec_len = sizeof(rec) + rec.key_len + rec.value_len;
+
+        if (pos + rec_len > data_len || rec.key_len == 0 || rec.type > VALUE_STRING)
+            break;
+        if (rec.type == VALUE_NUMBER && rec.value_len != sizeof(double))
+            break;
+        if (record_checksum(&rec, key_ptr, value_ptr) != rec.checksum)
+            break;
+
+        char key[256];
+        memcpy(key, key_ptr, rec.key_len);
+        key[rec.key_len] = 0;
+
+        if (rec.type == VALUE_STRING)
+        {
+            char *string = malloc(rec.value_len + 1);
+            if (string)
+            {
+                memcpy(string, value_ptr, rec.value_len);
+                string[rec.value_len] = 0;
+                update_entry(ns, key, VALUE_STRING, 0, string, false);
+                free(string);
+            }
+        }
+        else if (rec.type == VALUE_NUMBER)
+        {
+            double number;
+            memcpy(&number, value_ptr, sizeof(number));
+            update_entry(ns, key, VALUE_NUMBER, number, NULL, false);
+        }
+        else
+        {
+            update_entry(ns, key, rec.type, 0, NULL, false);
+        }
+
+        ns->records++;
+        pos += rec_len;
+    }
+
+    return pos;
+}
+
+static bool write_record(FILE *fp, const entry_t *entry)
+{
+    const void *value = NULL;
+    record_t rec = {.type = entry->type, .key_len = strlen(entry->key)};
+
+    if (entry->type == VALUE_NUMBER)
+    {
+        value = &entry->number;
+        rec.value_len = sizeof(double);
+    }
+    else if (entry->type == VALUE_STRING)
+    {
+        value = entry->string;
+        rec.value_len = strlen(entry->string);
+    }
+    rec.checksum = record_checksum(&rec, entry->key, value);
+
+    return fwrite(&rec, sizeof(rec), 1, fp)
+        && fwrite(entry->key, rec.key_len, 1, fp)
+        && (!rec.value_len || fwrite(value, rec.value_len, 1, fp));
+}
+
+static bool append_journal(namespace_t *ns)
+{
+    char pathbuf[RG_PATH_MAX];
+    make_path(pathbuf, ns->name, ".bin");
+
+    FILE *fp = fopen(pathbuf, "ab");
+    if (!fp)
+    {
+        RG_LOGE("Fopen failed (%d): '%s'", errno, pathbuf);
+        return false;
+    }
+
+    bool success = true;
+    size_t records = 0;
+    for (size_t i = 0; i < ns->count && success; i++)
+    {
+        if (!ns->entries[i].dirty)
+            continue;
+        success = write_record(fp, &ns->entries[i]);
+        records++;
+    }
+    success = (fclose(fp) == 0) && success;
+
+    if (!success)
+    {
+        // Whatever made it to the disk is now garbage we can't append after
+        RG_LOGE("Journal append failed: '%s'", pathbuf);
+        ns->compact = true;
+        return false;
+    }
+
+    ns->records += records;
+    return true;
+}
+
+static bool write_json(namespace_t *ns, const char *path, uint32_t *checksum)
+{
+    cJSON *values = cJSON_CreateObject();
+    for (size_t i = 0; i < ns->count; i++)
+    {
+        entry_t *entry = &ns->entries[i];
+        if (entry->type == VALUE_NUMBER)
+            cJSON_AddNumberToObject(values, entry->key, entry->number);
+        else if (entry->type == VALUE_STRING)
+            cJSON_AddStringToObject(values, entry->key, entry->string);
+        else if (entry->type == VALUE_NULL)
+            cJSON_AddNullToObject(values, entry->key);
+    }
+
+    char *buffer = cJSON_Print(values);
+    cJSON_Delete(values);
+    if (!buffer)
+        return false;
+
+    bool success = rg_storage_write_file(path, buffer, strlen(buffer), 0) ||
+        (rg_storage_mkdir(rg_dirname(path)) && rg_storage_write_file(path, buffer, strlen(buffer), 0));
+    if (checksum)
+        *checksum = fnv1a(2166136261, buffer, strlen(buffer));
+    cJSON_free(buffer);
+
+    return success;
+}
+
+static bool compact_journal(namespace_t *ns)
+{
+    char pathbuf[RG_PATH_MAX];
+    char tempname[RG_PATH_MAX + 8];
+    uint32_t json_checksum = 0;
+    bool success = false;
+
+    // Keep the json in sync, a stale one must not stay around as its checksum wouldn't be recorded
+    make_path(pathbuf, ns->name, ".json");
+    if (!write_json(ns, pathbuf, &json_checksum))
+    {
+        RG_LOGW("Unable to update '%s'", pathbuf);
+        remove(pathbuf);
+        json_checksum = 0;
+    }
+
+    make_path(pathbuf, ns->name, ".bin");
+
+    #define tempname(ext) strcat(strcpy(tempname, pathbuf), ext)
+
+    FILE *fp = fopen(tempname(".new"), "wb");
+    if (!fp && rg_storage_mkdir(RG_BASE_PATH_CONFIG))
+        fp = fopen(tempname(".new"), "wb");
+    if (!fp)
+    {
+        RG_LOGE("Fopen failed (%d): '%s'", errno, tempname);
+        return false;
+    }
+
+    size_t records = 0;
+    success = fwrite(JOURNAL_MAGIC, JOURNAL_MAGIC_LEN, 1, fp) && fwrite(&json_checksum, 4, 1, fp);
+    for (size_t i = 0; i < ns->count && success; i++)
+    {
+        if (ns->entries[i].type == VALUE_DELETED)
+            continue;
+        success = write_record(fp, &ns->entries[i]);
+        records++;
+    }
+    success = (fclose(fp) == 0) && success;
+
+    if (success)
+    {
+        remove(tempname(".bak"));
+        rename(pathbuf, tempname(".bak"));
+        success = rename(tempname(".new"), pathbuf) == 0;
+        if (success)
+            remove(tempname(".bak"));
+        else
+            rename(tempname(".bak"), pathbuf);
+    }
+
+    if (!success)
+    {
+        RG_LOGE("Journal compaction failed: '%s'", pathbuf);
+        remove(tempname(".new"));
+        return false;
+    }
+
+    #undef tempname
+
+    RG_LOGI("Journal compacted: '%s' (%d records)", pathbuf, (int)records);
+    ns->json_checksum = json_checksum;
+    ns->records = records;
+    ns->compact = false;
+    return true;
+}
+
+static bool import_json(namespace_t *ns, const char *path)
+{
+    void *data; size_t data_len;
+    if (!rg_storage_read_file(path, &data, &data_len, 0))
+        return false;
+
+    cJSON *values = cJSON_Parse((char *)data);
+    free(data);
+
+    if (!cJSON_IsObject(values))
+    {
+        RG_LOGE("Config file parsing failed: '%s'", path);
+        cJSON_Delete(values);
+        return false;
+    }
+
+    for (cJSON *item = values->child; item; item = item->next)
+    {
+        if (cJSON_IsString(item))
+            update_entry(ns, item->string, VALUE_STRING, 0, item->valuestring, true);
+        else if (cJSON_IsNumber(item))
+            update_entry(ns, item->string, VALUE_NUMBER, item->valuedouble, NULL, true);
+        else if (cJSON_IsBool(item))
+            update_entry(ns, item->string, VALUE_NUMBER, cJSON_IsTrue(item), NULL, true);
+        else if (cJSON_IsNull(item))
+            update_entry(ns, item->string, VALUE_NULL, 0, NULL, true);
+        else
+            RG_LOGW("Unsupported value type for key '%s', ignored.", item->string);
+    }
+
+    cJSON_Delete(values);
+    RG_LOGI("Config file imported: '%s'", path);
+    return true;
+}
+
+static bool json_modified(namespace_t *ns, const char *path)
+{
+    void *data; size_t data_len;
+    if (!rg_storage_read_file(path, &data, &data_len, 0))
+        return false;
+    uint32_t checksum = fnv1a(2166136261, data, data_len);
+    free(data);
+    return checksum != ns->json_checksum;
+}
+
+static void load_namespace(namespace_t *ns)
+{
+    char pathbuf[RG_PATH_MAX];
+    char tempname[RG_PATH_MAX + 8];
+
+    make_path(pathbuf, ns->name, ".bin");
+
+    rg_stat_t journal = rg_storage_stat(pathbuf);
+    if (!journal.exists)
+    {
+        // A crash during compaction may have left us with only the backup
+        snprintf(tempname, sizeof(tempname), "%s.bak", pathbuf);
+        if (rename(tempname, pathbuf) == 0)
+        {
+            RG_LOGW("Journal restored from backup: '%s'", pathbuf);
+            journal = rg_storage_stat(pathbuf);
+        }
+    }
+    if (journal.exists)
+    {
+        uint8_t *data = malloc(journal.size + 1);
+        FILE *fp = fopen(pathbuf, "rb");
+        size_t data_len = (fp && data) ? fread(data, 1, journal.size, fp) : 0;
+        size_t valid_len = replay_journal(ns, data, data_len);
+        if (fp)
+            fclose(fp);
+        free(data);
+
+        if (valid_len != data_len || data_len == 0)
+        {
+            RG_LOGW("Journal '%s' truncated at %d/%d bytes", pathbuf, (int)valid_len, (int)data_len);
+            ns->compact = true;
+        }
+        RG_LOGI("Config journal loaded: '%s' (%d records)", pathbuf, (int)ns->records);
+    }
+
+    make_path(pathbuf, ns->name, ".json");
+    rg_stat_t json = rg_storage_stat(pathbuf);
+    bool import = json.exists && !journal.exists;
+    if (json.exists && journal.exists)
+        import = ns->json_checksum ? json_modified(ns, pathbuf) : json.mtime > journal.mtime;
+    if (import)
+    {
+        // Rewrite the journal even if nothing changed so that it records the new json's checksum
+        if (import_json(ns, pathbuf))
+            ns->compact = true;
+    }
+}
+
+static namespace_t *get_namespace(const char *name)
+{
+    if (!initialized)
         return NULL;
 
     if (name == NS_GLOBAL)
@@ -24,91 +522,77 @@ static cJSON *json_root(const char *name, bool set_dirty)
     else if (name == NS_BOOT)
         name = "boot";
 
-    cJSON *branch = cJSON_GetObjectItem(config_root, name);
-    if (!branch)
+    for (namespace_t *ns = namespaces; ns; ns = ns->next)
     {
-        branch = cJSON_AddObjectToObject(config_root, name);
-        cJSON_AddStringToObject(branch, "namespace", name);
-        cJSON_AddNumberToObject(branch, "changed", 0);
-
-        void *data; size_t data_len;
-        char pathbuf[RG_PATH_MAX];
-        snprintf(pathbuf, RG_PATH_MAX, "%s/%s.json", RG_BASE_PATH_CONFIG, name);
-        if (rg_storage_read_file(pathbuf, &data, &data_len, 0))
-        {
-            cJSON *values = cJSON_Parse((char *)data);
-            if (values)
-            {
-                RG_LOGI("Config file loaded: '%s'", pathbuf);
-                cJSON_AddItemToObject(branch, "values", values);
-            }
-            else
-                RG_LOGE("Config file parsing failed: '%s'", pathbuf);
-            free(data);
-        }
+        if (strcmp(ns->name, name) == 0)
+            return ns;
     }
 
-    cJSON *root = cJSON_GetObjectItem(branch, "values");
-    if (!cJSON_IsObject(root))
-    {
-        cJSON_DeleteItemFromObject(branch, "values");
-        root = cJSON_AddObjectToObject(branch, "values");
-    }
+    namespace_t *ns = calloc(1, sizeof(namespace_t) + strlen(name) + 1);
+    if (!ns)
+        return NULL;
+    strcpy(ns->name, name);
+    ns->next = namespaces;
+    namespaces = ns;
 
-    if (set_dirty)
-    {
-        cJSON_SetNumberHelper(cJSON_GetObjectItem(branch, "changed"), 1);
-    }
+    load_namespace(ns);
 
-    return root;
+    return ns;
 }
 
-static void update_value(const char *section, const char *key, cJSON *new_value)
+static void free_namespaces(void)
 {
-    cJSON *obj = cJSON_GetObjectItem(json_root(section, 0), key);
-    if (obj == NULL)
-        cJSON_AddItemToObject(json_root(section, 1), key, new_value);
-    else if (!cJSON_Compare(obj, new_value, true))
-        cJSON_ReplaceItemInObject(json_root(section, 1), key, new_value);
-    else
-        cJSON_Delete(new_value);
+    while (namespaces)
+    {
+        namespace_t *ns = namespaces;
+        namespaces = ns->next;
+        for (size_t i = 0; i < ns->count; i++)
+        {
+            if (ns->entries[i].type == VALUE_STRING)
+                free(ns->entries[i].string);
+        }
+        free(ns->entries);
+        free(ns);
+    }
 }
 
 void rg_settings_init(void)
 {
-    config_root = cJSON_CreateObject();
-    json_root(NS_GLOBAL, 0);
-    json_root(NS_BOOT, 0);
+    initialized = true;
+    get_namespace(NS_GLOBAL);
+    get_namespace(NS_BOOT);
 }
 
 void rg_settings_commit(void)
 {
-    if (!config_root)
+    if (!initialized)
         return;
 
-    for (cJSON *branch = config_root->child; branch; branch = branch->next)
+    for (namespace_t *ns = namespaces; ns; ns = ns->next)
     {
-        char *name = cJSON_GetStringValue(cJSON_GetObjectItem(branch, "namespace"));
-        int changed = cJSON_GetNumberValue(cJSON_GetObjectItem(branch, "changed"));
-
-        if (!changed)
+        if (!ns->changed && !ns->compact)
             continue;
 
-        char *buffer = cJSON_Print(cJSON_GetObjectItem(branch, "values"));
-        if (!buffer)
-            continue;
+        size_t live = 0;
+        for (size_t i = 0; i < ns->count; i++)
+            live += ns->entries[i].type != VALUE_DELETED;
+
+        // A journal that is mostly stale records is worth rewriting, it also keeps loading fast
+        if (ns->records == 0 || ns->records > live * 2 + 32)
+            ns->compact = true;
 
-        size_t buffer_len = strlen(buffer) + 1;
+        if (!(ns->compact ? compact_journal(ns) : append_journal(ns)))
+            continue;
 
-        char pathbuf[RG_PATH_MAX];
-        snprintf(pathbuf, RG_PATH_MAX, "%s/%s.json", RG_BASE_PATH_CONFIG, name);
-        if (rg_storage_write_file(pathbuf, buffer, buffer_len, 0) ||
-            (rg_storage_mkdir(rg_dirname(pathbuf)) && rg_storage_write_file(pathbuf, buffer, buffer_len, 0)))
+        size_t count = 0;
+        for (size_t i = 0; i < ns->count; i++)
         {
-            cJSON_SetNumberHelper(cJSON_GetObjectItem(branch, "changed"), 0);
+            ns->entries[i].dirty = false;
+            if (ns->entries[i].type != VALUE_DELETED)
+                ns->entries[count++] = ns->entries[i];
         }
-
-        cJSON_free(buffer);
+        ns->count = count;
+        ns->changed = false;
     }
 
     rg_storage_commit();
@@ -119,38 +603,76 @@ void rg_settings_reset(void)
     RG_LOGI("Clearing settings...\n");
     rg_storage_delete(RG_BASE_PATH_CONFIG);
     rg_storage_mkdir(RG_BASE_PATH_CONFIG);
-    if (config_root)
+    free_namespaces();
+}
+
+bool rg_settings_import(const char *section, const char *path)
+{
+    namespace_t *ns = get_namespace(section);
+    char pathbuf[RG_PATH_MAX];
+
+    if (!ns)
+        return false;
+
+    if (!path)
     {
-        cJSON_Delete(config_root);
-        config_root = cJSON_CreateObject();
+        make_path(pathbuf, ns->name, ".json");
+        path = pathbuf;
     }
+
+    return import_json(ns, path);
+}
+
+bool rg_settings_export(const char *section, const char *path)
+{
+    namespace_t *ns = get_namespace(section);
+    char pathbuf[RG_PATH_MAX];
+
+    if (!ns)
+        return false;
+
+    if (!path)
+    {
+        make_path(pathbuf, ns->name, ".json");
+        path = pathbuf;
+        // Make sure the journal will record the checksum of the file we're about to write
+        ns->compact = true;
+    }
+
+    bool success = write_json(ns, path, NULL);
+    if (success)
+        RG_LOGI("Config file exported: '%s'", path);
+    return success;
 }
 
 double rg_settings_get_number(const char *section, const char *key, double default_value)
 {
-    cJSON *obj = cJSON_GetObjectItem(json_root(section, 0), key);
-    return obj ? obj->valuedouble : default_value;
+    entry_t *entry = find_entry(get_namespace(section), key, false);
+    return (entry && entry->type == VALUE_NUMBER) ? entry->number : default_value;
 }
 
 void rg_settings_set_number(const char *section, const char *key, double value)
 {
-    update_value(section, key, cJSON_CreateNumber(value));
+    update_entry(get_namespace(section), key, VALUE_NUMBER, value, NULL, true);
 }
 
 char *rg_settings_get_string(const char *section, const char *key, const char *default_value)
 {
-    cJSON *obj = cJSON_GetObjectItem(json_root(section, 0), key);
-    if (cJSON_IsString(obj))
-        return strdup(obj->valuestring);
+    entry_t *entry = find_entry(get_namespace(section), key, false);
+    if (entry && entry->type == VALUE_STRING)
+        return strdup(entry->string);
     return default_value ? strdup(default_value) : NULL;
 }
 
 void rg_settings_set_string(const char *section, const char *key, const char *value)
 {
-    update_value(section, key, value ? cJSON_CreateString(value) : cJSON_CreateNull());
+    if (value)
+        update_entry(get_namespace(section), key, VALUE_STRING, 0, value, true);
+    else
+        update_entry(get_namespace(section), key, VALUE_NULL, 0, NULL, true);
 }
 
 void rg_settings_delete(const char *section, const char *key)
 {
-    cJSON_DeleteItemFromObject(json_root(section, 1), key);
+    update_entry(get_namespace(section), key, VALUE_DELETED, 0, NULL, true);
 }
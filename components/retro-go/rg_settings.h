@@ -13,6 +13,9 @@
 void rg_settings_init(void);
 void rg_settings_commit(void);
 void rg_settings_reset(void);
+// JSON import/export of a namespace, path defaults to the namespace's `<name>.json` in the config dir
+bool rg_settings_import(const char *section, const char *path);
+bool rg_settings_export(const char *section, const char *path);
 double rg_settings_get_number(const char *section, const char *key, double default_value);
 void rg_settings_set_number(const char *section, const char *key, double value);
 void rg_settings_set_string(const char *section, const char *key, const char *value);
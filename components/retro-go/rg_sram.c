@@ -0,0 +1,368 @@
+#include "rg_system.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define JOURNAL_MAGIC 0x314A5352 // "RSJ1"
+
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint32_t file_size;
+    uint32_t count;
+    uint32_t checksum; // crc32 of everything that follows the header
+} journal_header_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t offset;
+    uint32_t length;
+} journal_entry_t;
+
+struct rg_sram_s
+{
+    struct
+    {
+        uint8_t *data;
+        size_t size;
+        size_t offset; // In the file
+    } regions[RG_SRAM_MAX_REGIONS];
+    size_t regions_count;
+    size_t size;
+    size_t synced;        // The file is known to match memory below this offset (before tracking)
+    uint32_t *dirty;      // One bit per page
+    size_t pages;
+    size_t dirty_pages;
+    uint32_t writes;      // Bumped by every rg_sram_mark_dirty, for debouncing
+    uint32_t last_writes;
+    int64_t first_change;
+    int64_t last_change;
+    int64_t debounce;
+    rg_sram_flush_cb_t *flush_cb;
+    void *flush_arg;
+    int pending;          // Storage request of the flush in flight
+    volatile bool failed; // Set by the storage task, everything is marked dirty again on the next flush
+    char *journal;
+    char path[];
+};
+
+static bool apply_journal(const char *path, const uint8_t *journal, size_t journal_len)
+{
+    const journal_header_t *header = (const journal_header_t *)journal;
+    if (journal_len < sizeof(journal_header_t) || header->magic != JOURNAL_MAGIC)
+        return false;
+
+    size_t body_len = journal_len - sizeof(journal_header_t);
+    if (header->count > body_len / sizeof(journal_entry_t))
+        return false;
+    if (rg_crc32(0, journal + sizeof(journal_header_t), body_len) != header->checksum)
+        return false;
+
+    const journal_entry_t *entries = (const journal_entry_t *)(header + 1);
+    const uint8_t *payload = (const uint8_t *)(entries + header->count);
+    size_t payload_len = body_len - header->count * sizeof(journal_entry_t);
+
+    for (size_t i = 0, total = 0; i < header->count; i++)
+    {
+        total += entries[i].length;
+        if (total > payload_len || entries[i].offset + entries[i].length > header->file_size)
+            return false;
+    }
+
+    FILE *fp = fopen(path, "r+b");
+    if (!fp)
+        fp = fopen(path, "w+b");
+    if (!fp)
+    {
+        RG_LOGE("Fopen failed: '%s'", path);
+        return false;
+    }
+
+    bool success = true;
+    for (size_t i = 0; i < header->count && success; i++)
+    {
+        success = fseek(fp, entries[i].offset, SEEK_SET) == 0 && fwrite(payload, entries[i].length, 1, fp) == 1;
+        payload += entries[i].length;
+    }
+    success = success && rg_storage_sync_file(fp);
+    fclose(fp);
+
+    return success;
+}
+
+static void journal_written_cb(const rg_io_result_t *result, void *arg)
+{
+    rg_sram_t *sram = arg;
+
+    // The journal is complete and durable, a crash from now on will be repaired by the next load
+    if (!result->success || !apply_journal(sram->path, result->data, result->data_len))
+    {
+        RG_LOGE("Failed to save '%s'", sram->path);
+        sram->failed = true;
+        return;
+    }
+
+    rg_storage_delete(sram->journal);
+    RG_LOGD("Saved %d bytes to '%s' in %dms", (int)result->data_len, sram->path, (int)(result->latency / 1000));
+}
+
+static void mark_range(rg_sram_t *sram, size_t offset, size_t length)
+{
+    if (!length || offset >= sram->size)
+        return;
+
+    size_t first = offset / RG_SRAM_PAGE_SIZE;
+    size_t last = RG_MIN(offset + length - 1, sram->size - 1) / RG_SRAM_PAGE_SIZE;
+    for (size_t page = first; page <= last; page++)
+    {
+        uint32_t bit = 1u << (page & 31);
+        if (!(sram->dirty[page >> 5] & bit))
+        {
+            sram->dirty[page >> 5] |= bit;
+            sram->dirty_pages++;
+        }
+    }
+}
+
+static void copy_range(rg_sram_t *sram, size_t offset, uint8_t *dest, size_t length)
+{
+    for (size_t i = 0; i < sram->regions_count && length; i++)
+    {
+        size_t start = sram->regions[i].offset, end = start + sram->regions[i].size;
+        if (offset < start || offset >= end)
+            continue;
+        size_t count = RG_MIN(length, end - offset);
+        memcpy(dest, sram->regions[i].data + (offset - start), count);
+        dest += count, offset += count, length -= count;
+    }
+}
+
+rg_sram_t *rg_sram_create(const char *path, int debounceMS)
+{
+    RG_ASSERT_ARG(path && *path);
+
+    size_t path_len = strlen(path);
+    rg_sram_t *sram = calloc(1, sizeof(rg_sram_t) + path_len * 2 + 6);
+    if (!sram)
+        return NULL;
+
+    strcpy(sram->path, path);
+    sram->journal = sram->path + path_len + 1;
+    sprintf(sram->journal, "%s.jnl", path);
+    sram->debounce = debounceMS * 1000LL;
+
+    return sram;
+}
+
+void rg_sram_free(rg_sram_t *sram)
+{
+    if (!sram)
+        return;
+    rg_sram_flush(sram, true);
+    free(sram->dirty);
+    free(sram);
+}
+
+bool rg_sram_add_region(rg_sram_t *sram, void *data, size_t size)
+{
+    RG_ASSERT_ARG(sram && data && size);
+
+    if (sram->regions_count >= RG_SRAM_MAX_REGIONS)
+        return false;
+
+    size_t pages = (sram->size + size + RG_SRAM_PAGE_SIZE - 1) / RG_SRAM_PAGE_SIZE;
+    uint32_t *dirty = calloc((pages + 31) / 32, sizeof(uint32_t));
+    if (!dirty)
+        return false;
+    if (sram->dirty)
+        memcpy(dirty, sram->dirty, (sram->pages + 31) / 32 * sizeof(uint32_t));
+    free(sram->dirty);
+
+    sram->regions[sram->regions_count].data = data;
+    sram->regions[sram->regions_count].size = size;
+    sram->regions[sram->regions_count].offset = sram->size;
+    sram->regions_count++;
+    if (sram->synced == sram->size)
+        sram->synced += size;
+    sram->size += size;
+    sram->dirty = dirty;
+    sram->pages = pages;
+
+    return true;
+}
+
+size_t rg_sram_load(rg_sram_t *sram)
+{
+    RG_ASSERT_ARG(sram);
+
+    if (sram->pending > 0)
+        rg_storage_wait(sram->pending, -1);
+    sram->pending = 0;
+
+    // A journal means that the last flush was interrupted, the file might be partially patched
+    if (rg_storage_exists(sram->journal))
+    {
+        void *data = NULL;
+        size_t data_len = 0;
+        if (rg_storage_read_file(sram->journal, &data, &data_len, 0) && apply_journal(sram->path, data, data_len))
+            RG_LOGW("Recovered interrupted save from '%s'", sram->journal);
+        else
+            RG_LOGW("Discarded incomplete journal '%s'", sram->journal);
+        rg_storage_delete(sram->journal);
+        free(data);
+    }
+
+    size_t loaded = 0;
+    FILE *fp = fopen(sram->path, "rb");
+    if (fp)
+    {
+        for (size_t i = 0; i < sram->regions_count; i++)
+        {
+            size_t count = fread(sram->regions[i].data, 1, sram->regions[i].size, fp);
+            loaded += count;
+            if (count < sram->regions[i].size)
+                break;
+        }
+        fclose(fp);
+        RG_LOGI("Loaded %d bytes from '%s'", (int)loaded, sram->path);
+    }
+
+    // Memory now matches the file, except for what's past the end of it. That part will be included
+    // in the next flush, otherwise the file could end up with holes in it.
+    memset(sram->dirty, 0, (sram->pages + 31) / 32 * sizeof(uint32_t));
+    sram->dirty_pages = 0;
+    sram->first_change = 0;
+    sram->synced = loaded;
+
+    return loaded;
+}
+
+void rg_sram_mark_dirty(rg_sram_t *sram, const void *ptr, size_t length)
+{
+    for (size_t i = 0; i < sram->regions_count; i++)
+    {
+        size_t pos = (uintptr_t)ptr - (uintptr_t)sram->regions[i].data;
+        if (pos < sram->regions[i].size)
+        {
+            mark_range(sram, sram->regions[i].offset + pos, RG_MIN(length, sram->regions[i].size - pos));
+            sram->writes++;
+            return;
+        }
+    }
+}
+
+bool rg_sram_is_dirty(rg_sram_t *sram)
+{
+    return sram && (sram->dirty_pages || sram->failed);
+}
+
+void rg_sram_set_debounce(rg_sram_t *sram, int debounceMS)
+{
+    RG_ASSERT_ARG(sram);
+    sram->debounce = debounceMS * 1000LL;
+}
+
+void rg_sram_set_flush_callback(rg_sram_t *sram, rg_sram_flush_cb_t *callback, void *arg)
+{
+    RG_ASSERT_ARG(sram);
+    sram->flush_cb = callback;
+    sram->flush_arg = arg;
+}
+
+void rg_sram_tick(rg_sram_t *sram)
+{
+    if (!sram || sram->debounce <= 0 || !rg_sram_is_dirty(sram))
+        return;
+
+    int64_t now = rg_system_timer();
+    if (sram->writes != sram->last_writes)
+    {
+        sram->last_writes = sram->writes;
+        sram->last_change = now;
+    }
+    if (!sram->first_change)
+        sram->first_change = now;
+
+    // Wait for the game to be done writing, but don't let a game that writes continuously starve the flush
+    if (now - sram->last_change >= sram->debounce || now - sram->first_change >= sram->debounce * 4)
+        rg_sram_flush(sram, false);
+}
+
+bool rg_sram_flush(rg_sram_t *sram, bool wait)
+{
+    if (!sram)
+        return false;
+
+    // Only one flush is in flight at a time, so that pages can't be reordered by the storage task
+    if (sram->pending > 0 && !rg_storage_wait(sram->pending, wait ? -1 : 0))
+        return false;
+    sram->pending = 0;
+
+    if (sram->failed)
+    {
+        sram->failed = false;
+        mark_range(sram, 0, sram->size);
+    }
+
+    if (!sram->dirty_pages)
+        return true;
+
+    if (sram->synced < sram->size)
+        mark_range(sram, sram->synced, sram->size - sram->synced);
+
+    if (sram->flush_cb)
+        sram->flush_cb(sram, sram->flush_arg);
+
+    size_t count = sram->dirty_pages;
+    size_t journal_len = sizeof(journal_header_t) + count * (sizeof(journal_entry_t) + RG_SRAM_PAGE_SIZE);
+    uint8_t *journal = malloc(journal_len);
+    if (!journal)
+    {
+        RG_LOGE("Out of memory, will retry later");
+        return false;
+    }
+
+    journal_header_t *header = (journal_header_t *)journal;
+    journal_entry_t *entries = (journal_entry_t *)(header + 1);
+    uint8_t *payload = (uint8_t *)(entries + count);
+    size_t entry = 0;
+
+    for (size_t page = 0; page < sram->pages && entry < count; page++)
+    {
+        if (!(sram->dirty[page >> 5] & (1u << (page & 31))))
+            continue;
+        size_t offset = page * RG_SRAM_PAGE_SIZE;
+        size_t length = RG_MIN(sram->size - offset, (size_t)RG_SRAM_PAGE_SIZE);
+        copy_range(sram, offset, payload, length);
+        entries[entry++] = (journal_entry_t){offset, length};
+        payload += length;
+    }
+
+    journal_len = payload - journal;
+    *header = (journal_header_t){
+        .magic = JOURNAL_MAGIC,
+        .file_size = sram->size,
+        .count = entry,
+        .checksum = rg_crc32(0, journal + sizeof(journal_header_t), journal_len - sizeof(journal_header_t)),
+    };
+
+    int id = rg_storage_write_file_async(sram->journal, journal, journal_len, RG_FILE_SYNC,
+                                         RG_IO_PRIORITY_LOW, &journal_written_cb, sram);
+    free(journal);
+
+    if (id < 0)
+        return false;
+
+    memset(sram->dirty, 0, (sram->pages + 31) / 32 * sizeof(uint32_t));
+    sram->dirty_pages = 0;
+    sram->first_change = 0;
+    sram->synced = sram->size;
+    sram->pending = id;
+
+    if (wait)
+    {
+        rg_storage_wait(id, -1);
+        return !sram->failed;
+    }
+    return true;
+}
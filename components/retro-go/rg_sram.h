@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Battery-backed cartridge RAM persistence. The core reports writes through rg_sram_mark_dirty (typically
+// from its memory write hook) and rg_sram_tick flushes once the writes have settled for the debounce delay.
+// A flush only copies the dirty pages and hands them to the storage task, which first writes them to a
+// journal next to the save file, then patches the save file in place and removes the journal. A journal
+// left over by a crash or power loss is replayed by rg_sram_load.
+
+#define RG_SRAM_PAGE_SIZE   512 // Matches the sector size of the SD card
+#define RG_SRAM_MAX_REGIONS 4
+
+typedef struct rg_sram_s rg_sram_t;
+
+// Called right before a flush snapshots the pages, lets the core refresh derived data (eg the RTC)
+typedef void (rg_sram_flush_cb_t)(rg_sram_t *sram, void *arg);
+
+rg_sram_t *rg_sram_create(const char *path, int debounceMS);
+void rg_sram_free(rg_sram_t *sram); // Flushes pending changes
+// Regions are laid out back to back in the file, in the order they are added
+bool rg_sram_add_region(rg_sram_t *sram, void *data, size_t size);
+// Returns the number of bytes read from the file, regions beyond that are left untouched
+size_t rg_sram_load(rg_sram_t *sram);
+void rg_sram_mark_dirty(rg_sram_t *sram, const void *ptr, size_t length);
+bool rg_sram_is_dirty(rg_sram_t *sram);
+// A delay <= 0 disables the automatic flush, rg_sram_flush must then be called explicitly
+void rg_sram_set_debounce(rg_sram_t *sram, int debounceMS);
+void rg_sram_set_flush_callback(rg_sram_t *sram, rg_sram_flush_cb_t *callback, void *arg);
+// Should be called once per frame
+void rg_sram_tick(rg_sram_t *sram);
+bool rg_sram_flush(rg_sram_t *sram, bool wait);
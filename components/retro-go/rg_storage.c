@@ -16,9 +16,15 @@
 #endif
 
 #ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <esp_vfs_fat.h>
 #endif
 
+#ifdef RG_TARGET_SDL2
+#include <SDL2/SDL.h>
+#endif
+
 #if defined(_WIN32) || defined(_WIN64)
 #include <io.h>
 #include <windows.h>
@@ -33,6 +39,34 @@
 #endif
 
 static bool disk_mounted = false;
+
+typedef struct io_request_s
+{
+    struct io_request_s *next;
+    rg_io_result_t result;
+    rg_io_callback_t *callback;
+    void *arg;
+    uint32_t flags;
+    int64_t submitted;
+    int priority;
+    bool write;
+    char path[];
+} io_request_t;
+
+static struct
+{
+    rg_task_t *task;
+    rg_mutex_t *lock;
+    io_request_t *head[RG_IO_PRIORITY_COUNT];
+    int running; // Id of the request being carried out
+    int next_id;
+    rg_io_stats_t stats;
+#ifdef ESP_PLATFORM
+    TaskHandle_t waiters[4]; // Tasks blocked in rg_storage_wait, notified when a request completes
+#else
+    SDL_cond *done; // Broadcast when a request completes
+#endif
+} io;
 #if defined(RG_STORAGE_SDSPI_HOST) || defined(RG_STORAGE_SDMMC_HOST)
 static sdmmc_card_t *card_handle = NULL;
 #endif
@@ -68,6 +102,13 @@ void rg_storage_init(void)
     RG_ASSERT(!disk_mounted, "Storage already initialized!");
     int error_code = -1;
 
+    if (!io.lock)
+        io.lock = rg_mutex_create();
+#ifndef ESP_PLATFORM
+    if (!io.done)
+        io.done = SDL_CreateCond();
+#endif
+
 #if defined(RG_STORAGE_SDSPI_HOST)
 
     RG_LOGI("Looking for SD Card using SDSPI...");
@@ -187,6 +228,8 @@ void rg_storage_deinit(void)
     if (!disk_mounted)
         return;
 
+    if (!rg_storage_wait(0, 5000))
+        RG_LOGE("Some asynchronous requests didn't complete!");
     rg_storage_commit();
 
     int error_code = 0;
@@ -310,9 +353,558 @@ bool rg_storage_exists(const char *path)
     return access(path, F_OK) == 0;
 }
 
+/**
+ * Folder listings used by rg_storage_scandir_batch. A listing is an array of entries pointing into a
+ * single names buffer, which is also exactly what we persist in RG_BASE_PATH_CACHE/scandir. A cached
+ * listing is only reused if its validator still matches the folder: its mtime where the filesystem
+ * maintains it, otherwise a hash of the raw readdir() output (which still saves us all the stat()s).
+ * Neither notices a file rewritten in place, so a cached listing's size/mtime can be stale (and
+ * without a folder mtime there's nothing to save unless RG_SCANDIR_STAT is requested).
+ */
+#define SCANDIR_CACHE_MAGIC 0x31445352 // "RSD1"
+#define SCANDIR_CACHE_PATH  RG_BASE_PATH_CACHE "/scandir"
+
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint32_t validator;
+    uint32_t count;
+    uint32_t names_len; // The folder's path is stored first to detect hash collisions
+    uint8_t has_stat;
+    uint8_t reserved[3];
+} scandir_cache_header_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t name;
+    uint32_t size;
+    uint32_t mtime;
+    uint8_t is_file;
+    uint8_t is_dir;
+    uint8_t reserved[2];
+} scandir_cache_entry_t;
+
+typedef struct
+{
+    rg_scandir_batch_t batch;
+    char *names;
+    size_t names_len;
+    uint32_t validator;
+    bool has_stat;
+} scandir_listing_t;
+
+typedef struct
+{
+    rg_scandir_cb_t *callback;
+    void *arg;
+    uint32_t types;
+    rg_scandir_t result;
+} scandir_adapter_t;
+
+static uint32_t scandir_hash(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *ptr = data;
+    while (len--)
+        hash = (hash ^ *ptr++) * 16777619;
+    return hash;
+}
+
+static void listing_free(scandir_listing_t *listing)
+{
+    if (!listing)
+        return;
+    free(listing->batch.entries);
+    free(listing->names);
+    free(listing);
+}
+
+static int listing_compare(const void *a, const void *b)
+{
+    return strcasecmp(((const rg_scandir_entry_t *)a)->name, ((const rg_scandir_entry_t *)b)->name);
+}
+
+static void listing_cache_path(char *buffer, const char *path)
+{
+    snprintf(buffer, RG_PATH_MAX, "%s/%08X.bin", SCANDIR_CACHE_PATH, (unsigned)scandir_hash(2166136261, path, strlen(path)));
+}
+
+static scandir_listing_t *listing_read_dir(const char *path, uint32_t flags)
+{
+    size_t path_len = strlen(path) + 1;
+    size_t capacity = 0, names_capacity = 0;
+    struct dirent *ent;
+
+    if (path_len > RG_PATH_MAX - 5)
+    {
+        RG_LOGE("Folder path too long '%s'", path);
+        return NULL;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir)
+        return NULL;
+
+    scandir_listing_t *listing = calloc(1, sizeof(scandir_listing_t));
+    if (!listing)
+    {
+        closedir(dir);
+        return NULL;
+    }
+    listing->validator = 2166136261;
+
+    while ((ent = readdir(dir)))
+    {
+        if (ent->d_name[0] == '.' && (!ent->d_name[1] || ent->d_name[1] == '.'))
+        {
+            // Skip self and parent
+            continue;
+        }
+
+        size_t name_len = strlen(ent->d_name) + 1;
+        if (path_len + name_len > RG_PATH_MAX)
+        {
+            RG_LOGE("File path too long '%s/%s'", path, ent->d_name);
+            continue;
+        }
+
+        if (listing->batch.count == capacity)
+        {
+            void *entries = realloc(listing->batch.entries, (capacity + 64) * sizeof(rg_scandir_entry_t));
+            if (!entries)
+                break;
+            listing->batch.entries = entries;
+            capacity += 64;
+        }
+
+        if (listing->names_len + name_len > names_capacity)
+        {
+            void *names = realloc(listing->names, names_capacity + 2048);
+            if (!names)
+                break;
+            listing->names = names;
+            names_capacity += 2048;
+        }
+
+        rg_scandir_entry_t *entry = &listing->batch.entries[listing->batch.count++];
+        memset(entry, 0, sizeof(rg_scandir_entry_t));
+        // Names may still move, we store offsets until we're done
+        entry->name = (const char *)(uintptr_t)listing->names_len;
+        memcpy(listing->names + listing->names_len, ent->d_name, name_len);
+        listing->names_len += name_len;
+    #if defined(DT_REG) && defined(DT_DIR)
+        entry->is_file = ent->d_type == DT_REG;
+        entry->is_dir = ent->d_type == DT_DIR;
+        listing->validator = scandir_hash(listing->validator, &ent->d_type, 1);
+    #else
+        // We're forced to stat() if the OS doesn't provide type via dirent
+        flags |= RG_SCANDIR_STAT;
+    #endif
+        listing->validator = scandir_hash(listing->validator, ent->d_name, name_len);
+    }
+
+    closedir(dir);
+
+    if (ent)
+        RG_LOGE("Out of memory, listing of '%s' stopped at %d entries", path, (int)listing->batch.count);
+
+    for (size_t i = 0; i < listing->batch.count; i++)
+        listing->batch.entries[i].name = listing->names + (uintptr_t)listing->batch.entries[i].name;
+
+    if (flags & RG_SCANDIR_STAT)
+    {
+        char *pathbuf = malloc(RG_PATH_MAX + 1);
+        struct stat statbuf;
+        for (size_t i = 0; pathbuf && i < listing->batch.count; i++)
+        {
+            rg_scandir_entry_t *entry = &listing->batch.entries[i];
+            snprintf(pathbuf, RG_PATH_MAX + 1, "%s/%s", path, entry->name);
+            if (stat(pathbuf, &statbuf) == 0)
+            {
+                entry->is_file = S_ISREG(statbuf.st_mode);
+                entry->is_dir = S_ISDIR(statbuf.st_mode);
+                entry->size = statbuf.st_size;
+                entry->mtime = statbuf.st_mtime;
+            }
+        }
+        free(pathbuf);
+        listing->has_stat = true;
+    }
+
+    return listing;
+}
+
+static scandir_listing_t *listing_load_cache(const char *path, uint32_t validator, bool need_stat)
+{
+    char cache_path[RG_PATH_MAX + 1];
+    scandir_cache_header_t header;
+    scandir_cache_entry_t *entries = NULL;
+    scandir_listing_t *listing = NULL;
+    size_t path_len = strlen(path) + 1;
+
+    listing_cache_path(cache_path, path);
+
+    FILE *fp = fopen(cache_path, "rb");
+    if (!fp)
+        return NULL;
+
+    if (!fread(&header, sizeof(header), 1, fp) || header.magic != SCANDIR_CACHE_MAGIC
+        || header.validator != validator || (need_stat && !header.has_stat) || header.names_len < path_len
+        || header.count > 0x10000 || header.names_len > header.count * (RG_PATH_MAX + 1) + path_len)
+        goto _cleanup;
+
+    listing = calloc(1, sizeof(scandir_listing_t));
+    entries = malloc(header.count * sizeof(scandir_cache_entry_t) + 1);
+    if (!listing || !entries || !(listing->names = malloc(header.names_len))
+        || !(listing->batch.entries = calloc(header.count + 1, sizeof(rg_scandir_entry_t))))
+        goto _cleanup;
+
+    if ((header.count && !fread(entries, header.count * sizeof(scandir_cache_entry_t), 1, fp))
+        || !fread(listing->names, header.names_len, 1, fp) || memcmp(listing->names, path, path_len) != 0
+        || listing->names[header.names_len - 1] != 0)
+        goto _cleanup;
+
+    for (size_t i = 0; i < header.count; i++)
+    {
+        if (entries[i].name < path_len || entries[i].name >= header.names_len)
+            goto _cleanup;
+        listing->batch.entries[i] = (rg_scandir_entry_t){
+            .name = listing->names + entries[i].name,
+            .size = entries[i].size,
+            .mtime = entries[i].mtime,
+            .is_file = entries[i].is_file,
+            .is_dir = entries[i].is_dir,
+        };
+    }
+    listing->batch.count = header.count;
+    listing->names_len = header.names_len;
+    listing->validator = validator;
+    listing->has_stat = header.has_stat;
+
+    fclose(fp);
+    free(entries);
+    return listing;
+
+_cleanup:
+    fclose(fp);
+    free(entries);
+    listing_free(listing);
+    return NULL;
+}
+
+static void listing_save_cache(const char *path, const scandir_listing_t *listing)
+{
+    char cache_path[RG_PATH_MAX + 1];
+    size_t path_len = strlen(path) + 1;
+    scandir_cache_header_t header = {
+        .magic = SCANDIR_CACHE_MAGIC,
+        .validator = listing->validator,
+        .count = listing->batch.count,
+        .names_len = path_len + listing->names_len,
+        .has_stat = listing->has_stat,
+    };
+
+    listing_cache_path(cache_path, path);
+
+    FILE *fp = fopen(cache_path, "wb");
+    if (!fp && rg_storage_mkdir(SCANDIR_CACHE_PATH))
+        fp = fopen(cache_path, "wb");
+    if (!fp)
+        return;
+
+    bool success = fwrite(&header, sizeof(header), 1, fp);
+    for (size_t i = 0; i < listing->batch.count && success; i++)
+    {
+        const rg_scandir_entry_t *entry = &listing->batch.entries[i];
+        scandir_cache_entry_t out = {
+            .name = path_len + (entry->name - listing->names),
+            .size = entry->size,
+            .mtime = entry->mtime,
+            .is_file = entry->is_file,
+            .is_dir = entry->is_dir,
+        };
+        success = fwrite(&out, sizeof(out), 1, fp);
+    }
+    success = success && fwrite(path, path_len, 1, fp);
+    success = success && (!listing->names_len || fwrite(listing->names, listing->names_len, 1, fp));
+    fclose(fp);
+
+    if (!success)
+        remove(cache_path);
+}
+
+static scandir_listing_t *listing_get(const char *path, uint32_t flags)
+{
+    scandir_listing_t *listing = NULL;
+
+    if ((flags & RG_SCANDIR_CACHED) && (RG_STORAGE_DIR_MTIME || (flags & RG_SCANDIR_STAT)))
+    {
+    #if RG_STORAGE_DIR_MTIME
+        struct stat statbuf;
+        if (stat(path, &statbuf) != 0)
+            return NULL;
+        uint32_t validator = statbuf.st_mtime;
+        listing = listing_load_cache(path, validator, flags & RG_SCANDIR_STAT);
+        if (!listing && (listing = listing_read_dir(path, flags)))
+        {
+            listing->validator = validator;
+            // A change within the same second wouldn't bump the mtime, don't trust it yet
+            if (validator < time(NULL) - 1)
+                listing_save_cache(path, listing);
+        }
+    #else
+        listing = listing_read_dir(path, flags & ~RG_SCANDIR_STAT);
+        scandir_listing_t *cached = listing ? listing_load_cache(path, listing->validator, flags & RG_SCANDIR_STAT) : NULL;
+        if (cached)
+        {
+            listing_free(listing);
+            listing = cached;
+        }
+        else if (listing)
+        {
+            if (flags & RG_SCANDIR_STAT)
+            {
+                uint32_t validator = listing->validator;
+                listing_free(listing);
+                if ((listing = listing_read_dir(path, flags)))
+                    listing->validator = validator;
+            }
+            if (listing)
+                listing_save_cache(path, listing);
+        }
+    #endif
+    }
+    else
+    {
+        listing = listing_read_dir(path, flags);
+    }
+
+    if (listing && (flags & RG_SCANDIR_SORT))
+        qsort(listing->batch.entries, listing->batch.count, sizeof(rg_scandir_entry_t), listing_compare);
+
+    if (listing)
+        listing->batch.dirname = path;
+
+    return listing;
+}
+
+static int scandir_adapter_cb(const rg_scandir_batch_t *batch, void *arg)
+{
+    scandir_adapter_t *adapter = arg;
+    rg_scandir_t *result = &adapter->result;
+    size_t path_len = strlen(batch->dirname) + 1;
+
+    strcat(strcpy(result->path, batch->dirname), "/");
+    result->basename = result->path + path_len;
+    result->dirname = batch->dirname;
+
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        rg_scandir_entry_t *entry = &batch->entries[i];
+        if (!((entry->is_dir && adapter->types != RG_SCANDIR_FILES) || (entry->is_file && adapter->types != RG_SCANDIR_DIRS)))
+            continue;
+
+        strcpy((char *)result->basename, entry->name);
+        result->is_file = entry->is_file;
+        result->is_dir = entry->is_dir;
+        result->size = entry->size;
+        result->mtime = entry->mtime;
+
+        int ret = (adapter->callback)(result, adapter->arg);
+
+        if (ret == RG_SCANDIR_STOP)
+            return RG_SCANDIR_STOP;
+
+        if (ret == RG_SCANDIR_SKIP)
+            entry->skip = true;
+    }
+
+    return RG_SCANDIR_CONTINUE;
+}
+
+// Returns RG_SCANDIR_STOP if the callback asked to stop, -1 if the folder couldn't be listed
+static int scandir_batch_walk(const char *path, rg_scandir_batch_cb_t *callback, void *arg, uint32_t flags)
+{
+    scandir_listing_t *listing = listing_get(path, flags);
+    if (!listing)
+        return -1;
+
+    int ret = (callback)(&listing->batch, arg);
+
+    if (ret != RG_SCANDIR_STOP && (flags & RG_SCANDIR_RECURSIVE))
+    {
+        char *pathbuf = malloc(RG_PATH_MAX + 1);
+        for (size_t i = 0; pathbuf && i < listing->batch.count && ret != RG_SCANDIR_STOP; i++)
+        {
+            const rg_scandir_entry_t *entry = &listing->batch.entries[i];
+            if (!entry->is_dir || entry->skip)
+                continue;
+            snprintf(pathbuf, RG_PATH_MAX + 1, "%s/%s", path, entry->name);
+            if (scandir_batch_walk(pathbuf, callback, arg, flags) == RG_SCANDIR_STOP)
+                ret = RG_SCANDIR_STOP;
+        }
+        free(pathbuf);
+    }
+
+    listing_free(listing);
+    return ret == RG_SCANDIR_STOP ? RG_SCANDIR_STOP : RG_SCANDIR_CONTINUE;
+}
+
+#ifdef RG_TARGET_SDL2
+typedef struct
+{
+    rg_scandir_batch_cb_t *callback;
+    void *arg;
+    uint32_t flags;
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    char **queue;
+    size_t queue_len;
+    size_t queue_capacity;
+    int busy;
+    bool stop;
+} scandir_walker_t;
+
+// Queues the subfolders of a listing that the callback didn't skip, walker->lock must be held
+static void scandir_walker_push(scandir_walker_t *walker, const char *path, const scandir_listing_t *listing)
+{
+    for (size_t i = 0; i < listing->batch.count; i++)
+    {
+        const rg_scandir_entry_t *entry = &listing->batch.entries[i];
+        if (!entry->is_dir || entry->skip)
+            continue;
+        if (walker->queue_len == walker->queue_capacity)
+        {
+            void *queue = realloc(walker->queue, (walker->queue_capacity + 32) * sizeof(char *));
+            if (!queue)
+                break;
+            walker->queue = queue;
+            walker->queue_capacity += 32;
+        }
+        char *subpath = malloc(strlen(path) + strlen(entry->name) + 2);
+        if (subpath)
+            walker->queue[walker->queue_len++] = strcat(strcat(strcpy(subpath, path), "/"), entry->name);
+    }
+}
+
+// Workers pull folders from a shared queue and push back the subfolders they find. The callback
+// runs with the walker's lock held so that callers don't have to be thread-safe.
+static int scandir_walker_task(void *arg)
+{
+    scandir_walker_t *walker = arg;
+
+    SDL_LockMutex(walker->lock);
+    while (!walker->stop)
+    {
+        if (walker->queue_len == 0)
+        {
+            if (walker->busy == 0)
+                break;
+            SDL_CondWait(walker->cond, walker->lock);
+            continue;
+        }
+
+        char *path = walker->queue[--walker->queue_len];
+        walker->busy++;
+        SDL_UnlockMutex(walker->lock);
+
+        scandir_listing_t *listing = listing_get(path, walker->flags);
+
+        SDL_LockMutex(walker->lock);
+        if (listing && !walker->stop)
+        {
+            if ((walker->callback)(&listing->batch, walker->arg) == RG_SCANDIR_STOP)
+                walker->stop = true;
+
+            if (!walker->stop)
+                scandir_walker_push(walker, path, listing);
+        }
+        listing_free(listing);
+        free(path);
+        walker->busy--;
+        SDL_CondBroadcast(walker->cond);
+    }
+    SDL_CondBroadcast(walker->cond);
+    SDL_UnlockMutex(walker->lock);
+
+    return 0;
+}
+
+static bool scandir_batch_parallel(const char *path, rg_scandir_batch_cb_t *callback, void *arg, uint32_t flags)
+{
+    // The root is listed on the caller's thread so that we can report errors like the sequential walk
+    scandir_listing_t *listing = listing_get(path, flags);
+    if (!listing)
+        return false;
+
+    scandir_walker_t walker = {
+        .callback = callback,
+        .arg = arg,
+        .flags = flags,
+        .lock = SDL_CreateMutex(),
+        .cond = SDL_CreateCond(),
+    };
+    SDL_Thread *threads[RG_SCANDIR_THREADS] = {0};
+
+    walker.stop = (callback)(&listing->batch, arg) == RG_SCANDIR_STOP;
+
+    if (!walker.stop)
+        scandir_walker_push(&walker, path, listing);
+    listing_free(listing);
+
+    // No point in spawning more threads than there are subfolders to start with
+    size_t threads_count = RG_MIN(walker.queue_len, RG_SCANDIR_THREADS);
+    for (size_t i = 1; i < threads_count; i++)
+        threads[i] = SDL_CreateThread(scandir_walker_task, "rg_scandir", &walker);
+
+    scandir_walker_task(&walker);
+
+    for (size_t i = 1; i < RG_SCANDIR_THREADS; i++)
+    {
+        if (threads[i])
+            SDL_WaitThread(threads[i], NULL);
+    }
+
+    // Leftovers if the callback stopped us early
+    while (walker.queue_len > 0)
+        free(walker.queue[--walker.queue_len]);
+    free(walker.queue);
+    SDL_DestroyCond(walker.cond);
+    SDL_DestroyMutex(walker.lock);
+
+    return true;
+}
+#endif
+
+bool rg_storage_scandir_batch(const char *path, rg_scandir_batch_cb_t *callback, void *arg, uint32_t flags)
+{
+    CHECK_PATH(path);
+
+#ifdef RG_TARGET_SDL2
+    if ((flags & RG_SCANDIR_PARALLEL) && (flags & RG_SCANDIR_RECURSIVE) && RG_SCANDIR_THREADS > 1)
+        return scandir_batch_parallel(path, callback, arg, flags);
+#endif
+
+    return scandir_batch_walk(path, callback, arg, flags) != -1;
+}
+
 bool rg_storage_scandir(const char *path, rg_scandir_cb_t *callback, void *arg, uint32_t flags)
 {
     CHECK_PATH(path);
+
+    // Those need the whole folder in memory, the plain walk below streams entries instead
+    if (flags & (RG_SCANDIR_SORT | RG_SCANDIR_CACHED | RG_SCANDIR_PARALLEL))
+    {
+        scandir_adapter_t *adapter = calloc(1, sizeof(scandir_adapter_t));
+        if (!adapter)
+            return false;
+        adapter->callback = callback;
+        adapter->arg = arg;
+        adapter->types = flags & (RG_SCANDIR_FILES | RG_SCANDIR_DIRS);
+        bool ret = rg_storage_scandir_batch(path, scandir_adapter_cb, adapter, flags);
+        free(adapter);
+        return ret;
+    }
+
     uint32_t types = flags & (RG_SCANDIR_FILES | RG_SCANDIR_DIRS);
     size_t path_len = strlen(path) + 1;
     struct stat statbuf;
@@ -487,10 +1079,260 @@ bool rg_storage_write_file(const char *path, const void *data_ptr, size_t data_l
         return false;
     }
 
+    if ((flags & RG_FILE_SYNC) && !rg_storage_sync_file(fp))
+    {
+        RG_LOGE("Fsync failed (%d): '%s'", errno, path);
+        fclose(fp);
+        return false;
+    }
+
     fclose(fp);
     return true;
 }
 
+bool rg_storage_sync_file(FILE *fp)
+{
+    if (!fp || fflush(fp) != 0)
+        return false;
+#if defined(_WIN32) || defined(_WIN64)
+    return _commit(_fileno(fp)) == 0;
+#else
+    return fsync(fileno(fp)) == 0;
+#endif
+}
+
+/**
+ * Asynchronous I/O. Each priority is a FIFO, the storage task always takes the oldest request of the
+ * highest priority available. A write that hasn't started yet is marked as coalesced (and its data is
+ * dropped) when a newer write to the same path comes in, the storage task then only runs its callback.
+ */
+static void io_task(void *arg)
+{
+    rg_task_msg_t msg;
+
+    while (rg_task_receive(&msg, -1))
+    {
+        if (msg.type == RG_TASK_MSG_STOP)
+            break;
+
+        while (true)
+        {
+            io_request_t *req = NULL;
+
+            rg_mutex_take(io.lock, -1);
+            for (int i = 0; i < RG_IO_PRIORITY_COUNT && !req; i++)
+            {
+                if ((req = io.head[i]))
+                    io.head[i] = req->next;
+            }
+            // A read must not overtake a pending write to the same file, do the write first
+            for (int i = req ? req->priority + 1 : RG_IO_PRIORITY_COUNT; i < RG_IO_PRIORITY_COUNT && !req->write; i++)
+            {
+                for (io_request_t **prev = &io.head[i], *w = *prev; w; prev = &w->next, w = w->next)
+                {
+                    if (!w->write || w->result.coalesced || strcmp(w->path, req->path) != 0)
+                        continue;
+                    *prev = w->next;
+                    req->next = io.head[req->priority];
+                    io.head[req->priority] = req;
+                    req = w;
+                    break;
+                }
+            }
+            io.running = req ? req->result.id : 0;
+            rg_mutex_give(io.lock);
+
+            if (!req)
+                break;
+
+            rg_io_result_t *result = &req->result;
+            if (result->coalesced)
+                result->success = true;
+            else if (req->write)
+                result->success = rg_storage_write_file(req->path, result->data, result->data_len, req->flags);
+            else
+                result->success = rg_storage_read_file(req->path, &result->data, &result->data_len, req->flags);
+            result->latency = rg_system_timer() - req->submitted;
+
+            int bucket = 0;
+            for (int64_t ms = result->latency / 1000; ms > 0 && bucket < RG_IO_HISTOGRAM_BUCKETS - 1; ms >>= 1)
+                bucket++;
+
+            if (req->callback)
+                (req->callback)(result, req->arg);
+            else if (!req->write && !(req->flags & RG_FILE_USER_BUFFER))
+                free(result->data);
+
+            // The request only counts as done once its callback has returned, rg_storage_wait relies on it
+            rg_mutex_take(io.lock, -1);
+            io.stats.histogram[req->priority][bucket]++;
+            io.stats.maxLatency = RG_MAX(io.stats.maxLatency, result->latency);
+            io.stats.failed += !result->success;
+            io.stats.pending--;
+            io.running = 0;
+        #ifdef ESP_PLATFORM
+            TaskHandle_t waiters[RG_COUNT(io.waiters)];
+            memcpy(waiters, io.waiters, sizeof(waiters));
+        #else
+            SDL_CondBroadcast(io.done);
+        #endif
+            rg_mutex_give(io.lock);
+
+        #ifdef ESP_PLATFORM
+            for (size_t i = 0; i < RG_COUNT(waiters); i++)
+            {
+                if (waiters[i])
+                    xTaskNotifyGive(waiters[i]);
+            }
+        #endif
+
+            if (req->write)
+                free(result->data);
+            free(req);
+        }
+    }
+}
+
+static int io_submit(const char *path, bool write, void *data, size_t data_len, uint32_t flags,
+                     int priority, rg_io_callback_t *callback, void *arg)
+{
+    RG_ASSERT_ARG(priority >= 0 && priority < RG_IO_PRIORITY_COUNT);
+    CHECK_PATH(path);
+
+    io_request_t *req = calloc(1, sizeof(io_request_t) + strlen(path) + 1);
+    if (!req)
+        return -1;
+
+    strcpy(req->path, path);
+    req->result.path = req->path;
+    req->result.data = data;
+    req->result.data_len = data_len;
+    req->callback = callback;
+    req->arg = arg;
+    req->flags = flags;
+    req->priority = priority;
+    req->write = write;
+    req->submitted = rg_system_timer();
+
+    rg_mutex_take(io.lock, -1);
+    if (!io.task)
+        io.task = rg_task_create("rg_storage", &io_task, NULL, 4 * 1024, RG_TASK_PRIORITY_4, -1);
+    if (write)
+    {
+        for (int i = 0; i < RG_IO_PRIORITY_COUNT; i++)
+        {
+            for (io_request_t *w = io.head[i]; w; w = w->next)
+            {
+                if (!w->write || w->result.coalesced || strcmp(w->path, path) != 0)
+                    continue;
+                free(w->result.data);
+                w->result.data = NULL;
+                w->result.data_len = 0;
+                w->result.coalesced = true;
+                io.stats.coalesced++;
+            }
+        }
+    }
+    req->result.id = ++io.next_id;
+    io_request_t **tail = &io.head[priority];
+    while (*tail)
+        tail = &(*tail)->next;
+    *tail = req;
+    io.stats.requests++;
+    io.stats.pending++;
+    rg_mutex_give(io.lock);
+
+    // The queue holds a single message, if it's full the task is already going to wake up
+    rg_task_send(io.task, &(rg_task_msg_t){.type = 1}, 0);
+
+    return req->result.id;
+}
+
+int rg_storage_read_file_async(const char *path, void *data_out, size_t data_len, uint32_t flags,
+                               int priority, rg_io_callback_t *callback, void *arg)
+{
+    RG_ASSERT_ARG(data_out || !(flags & RG_FILE_USER_BUFFER));
+    return io_submit(path, false, data_out, data_len, flags, priority, callback, arg);
+}
+
+int rg_storage_write_file_async(const char *path, const void *data_ptr, size_t data_len, uint32_t flags,
+                                int priority, rg_io_callback_t *callback, void *arg)
+{
+    RG_ASSERT_ARG(data_ptr || !data_len);
+    void *data = malloc(data_len ?: 1);
+    if (!data)
+        return -1;
+    memcpy(data, data_ptr, data_len);
+    int id = io_submit(path, true, data, data_len, flags, priority, callback, arg);
+    if (id < 0)
+        free(data);
+    return id;
+}
+
+bool rg_storage_wait(int request_id, int timeoutMS)
+{
+    int64_t deadline = rg_system_timer() + timeoutMS * 1000LL;
+    bool done = false;
+
+    if (!io.task || rg_task_current() == io.task)
+        return io.stats.pending == 0;
+
+    rg_mutex_take(io.lock, -1);
+    while (true)
+    {
+        done = true;
+        if (request_id == 0)
+            done = io.stats.pending == 0;
+        else if (io.running == request_id)
+            done = false;
+        for (int i = 0; i < RG_IO_PRIORITY_COUNT && done && request_id; i++)
+        {
+            for (io_request_t *req = io.head[i]; req && done; req = req->next)
+                done = req->result.id != request_id;
+        }
+
+        int64_t remaining = deadline - rg_system_timer();
+        if (done || (timeoutMS >= 0 && remaining <= 0))
+            break;
+
+        // Sleep until the storage task completes a request, then check again
+    #ifdef ESP_PLATFORM
+        size_t slot = 0;
+        while (slot < RG_COUNT(io.waiters) && io.waiters[slot])
+            slot++;
+        TickType_t timeout = timeoutMS < 0 ? portMAX_DELAY : pdMS_TO_TICKS((remaining + 999) / 1000) + 1;
+        if (slot < RG_COUNT(io.waiters))
+            io.waiters[slot] = xTaskGetCurrentTaskHandle();
+        else
+            timeout = 1; // Too many waiters, fall back to checking every tick
+        rg_mutex_give(io.lock);
+        ulTaskNotifyTake(pdTRUE, timeout);
+        rg_mutex_take(io.lock, -1);
+        if (slot < RG_COUNT(io.waiters))
+            io.waiters[slot] = NULL;
+    #else
+        if (timeoutMS < 0)
+            SDL_CondWait(io.done, (SDL_mutex *)io.lock);
+        else
+            SDL_CondWaitTimeout(io.done, (SDL_mutex *)io.lock, (remaining + 999) / 1000);
+    #endif
+    }
+    rg_mutex_give(io.lock);
+
+    return done;
+}
+
+rg_io_stats_t rg_storage_get_io_stats(void)
+{
+    rg_io_stats_t stats = {0};
+    if (io.lock && rg_mutex_take(io.lock, -1))
+    {
+        stats = io.stats;
+        rg_mutex_give(io.lock);
+    }
+    return stats;
+}
+
 /**
  * This is a minimal UNZIP implementation that utilizes only the miniz primitives found in ESP32's ROM.
  * I think that we should use miniz' ZIP API instead and bundle miniz with retro-go. But first I need
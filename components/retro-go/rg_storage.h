@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <time.h>
 
 #define RG_BASE_PATH        RG_STORAGE_ROOT "/retro-go"
@@ -36,12 +37,35 @@ enum
     RG_SCANDIR_STAT  = (1 << 8),
     RG_SCANDIR_SORT  = (1 << 9),
     RG_SCANDIR_RECURSIVE = (1 << 10),
+    RG_SCANDIR_CACHED = (1 << 11),   // Reuse the listing cached in RG_BASE_PATH_CACHE if the folder didn't change
+                                     // (files rewritten in place aren't detected, their size/mtime may be stale)
+    RG_SCANDIR_PARALLEL = (1 << 12), // Walk subfolders from several threads (SDL2 only, callbacks are still serialized)
 
     RG_SCANDIR_CONTINUE = 1,
     RG_SCANDIR_SKIP = 2,
     RG_SCANDIR_STOP = 0,
 };
 
+typedef struct
+{
+    const char *name;
+    size_t size;
+    time_t mtime;
+    bool is_file;
+    bool is_dir;
+    bool skip; // Set by the callback to not recurse into this folder
+} rg_scandir_entry_t;
+
+typedef struct
+{
+    const char *dirname;
+    rg_scandir_entry_t *entries;
+    size_t count;
+} rg_scandir_batch_t;
+
+// Receives a whole folder at once, FILES/DIRS filtering is left to the callback
+typedef int (rg_scandir_batch_cb_t)(const rg_scandir_batch_t *batch, void *arg);
+
 typedef struct
 {
     const char *basename;
@@ -64,6 +88,7 @@ bool rg_storage_exists(const char *path);
 bool rg_storage_mkdir(const char *dir);
 rg_stat_t rg_storage_stat(const char *path);
 bool rg_storage_scandir(const char *path, rg_scandir_cb_t *callback, void *arg, uint32_t flags);
+bool rg_storage_scandir_batch(const char *path, rg_scandir_batch_cb_t *callback, void *arg, uint32_t flags);
 int64_t rg_storage_get_free_space(const char *path);
 
 enum
@@ -74,7 +99,54 @@ enum
     RG_FILE_ALIGN_64KB = (1 << 3),      // Will align/pad data_out to 64KB (not applicable if RG_FILE_USER_BUFFER)
     RG_FILE_USER_BUFFER = (1 << 4),     // Will use *data_out and *data_len provided by the user
     RG_FILE_ATOMIC_WRITE = (1 << 5),    // Will write to a temp file before replacing the target
+    RG_FILE_SYNC = (1 << 6),            // Will flush the data to the storage medium before returning
 };
 bool rg_storage_read_file(const char *path, void **data_out, size_t *data_len, uint32_t flags);
 bool rg_storage_write_file(const char *path, const void *data_ptr, size_t data_len, uint32_t flags);
+// Flushes stdio and OS buffers of an open file to the storage medium
+bool rg_storage_sync_file(FILE *fp);
 bool rg_storage_unzip_file(const char *zip_path, const char *filter, void **data_out, size_t *data_len, uint32_t flags);
+
+// Asynchronous file I/O. Requests are carried out in priority order by a dedicated storage task,
+// which is also where the completion callbacks run. Pending requests are flushed by rg_storage_deinit.
+typedef enum
+{
+    RG_IO_PRIORITY_HIGH,   // The game is waiting on it (bios, rom data, ...)
+    RG_IO_PRIORITY_NORMAL,
+    RG_IO_PRIORITY_LOW,    // Background persistence (sram, screenshots, ...)
+    RG_IO_PRIORITY_COUNT,
+} rg_io_priority_t;
+
+#define RG_IO_HISTOGRAM_BUCKETS 12 // Latency buckets: <1ms, <2ms, <4ms, ..., >=1024ms
+
+typedef struct
+{
+    int id;
+    const char *path;
+    void *data;      // Reads: the file content, the callback must free it unless RG_FILE_USER_BUFFER was used
+    size_t data_len;
+    bool success;
+    bool coalesced;  // The write was superseded by a newer write to the same path before it started
+    int64_t latency; // From submission to completion, in us
+} rg_io_result_t;
+
+typedef void (rg_io_callback_t)(const rg_io_result_t *result, void *arg);
+
+typedef struct
+{
+    uint32_t requests;
+    uint32_t coalesced;
+    uint32_t failed;
+    uint32_t pending;
+    int64_t maxLatency;
+    uint32_t histogram[RG_IO_PRIORITY_COUNT][RG_IO_HISTOGRAM_BUCKETS];
+} rg_io_stats_t;
+
+// Both return a request id (> 0) or -1. Written data is copied, the caller can reuse its buffer right away.
+int rg_storage_read_file_async(const char *path, void *data_out, size_t data_len, uint32_t flags,
+                               int priority, rg_io_callback_t *callback, void *arg);
+int rg_storage_write_file_async(const char *path, const void *data_ptr, size_t data_len, uint32_t flags,
+                                int priority, rg_io_callback_t *callback, void *arg);
+// Waits for a request to complete, request_id 0 waits for every pending request
+bool rg_storage_wait(int request_id, int timeoutMS);
+rg_io_stats_t rg_storage_get_io_stats(void);
@@ -298,9 +298,16 @@ bool rg_surface_save_image_file(const rg_surface_t *source, const char *filename
         source = temp;
     }
 
-    error = lodepng_encode24_file(filename, source->data + source->offset, width, height);
+    // Encoding stays on the caller but the write goes to the storage task, it's rarely needed right away
+    unsigned char *png = NULL;
+    size_t png_len = 0;
+    error = lodepng_encode24(&png, &png_len, source->data + source->offset, width, height);
     rg_surface_free(temp);
 
+    if (error == 0)
+        error = rg_storage_write_file_async(filename, png, png_len, 0, RG_IO_PRIORITY_LOW, NULL, NULL) < 0;
+    free(png);
+
     if (error == 0)
         return true;
 
@@ -25,6 +25,7 @@
 #endif
 
 #define RG_STRUCT_MAGIC 0x12345678
+#define RG_TASK_QUEUE_LENGTH 1 // Same depth on every platform, callers rely on send() blocking
 #define RG_LOGBUF_SIZE 2048
 typedef struct
 {
@@ -50,32 +51,55 @@ struct rg_task_s
     // bool blocked;
 #ifdef ESP_PLATFORM
     QueueHandle_t queue;
+    SemaphoreHandle_t emptied; // Given by the receiver when it takes the last message
+    portMUX_TYPE lock;         // Guards stats
     TaskHandle_t handle;
 #else
-    rg_task_msg_t msg;
-    int msgWaiting;
+    SDL_mutex *lock;
+    SDL_cond *cond; // Broadcast whenever a message is added or removed
+    rg_task_msg_t queue[RG_TASK_QUEUE_LENGTH];
+    size_t queueHead, queueCount;
     SDL_threadID handle;
 #endif
+    rg_task_stats_t stats; // Guarded by lock
     char name[16];
 };
 
 #ifdef RG_ENABLE_PROFILING
+#define PROFILE_RING_LENGTH 8192
 typedef struct
 {
-    void *func_ptr, *caller_ptr;
-    int32_t num_calls, run_time;
-    int64_t enter_time;
-} profile_frame_t;
+    const char *name;
+    uint32_t start; // us since time_started
+    uint32_t duration;
+} profile_event_t;
+
+typedef struct
+{
+    char name[16];
+    uint32_t head; // Total events written, only the owner task writes
+    profile_event_t events[PROFILE_RING_LENGTH];
+} profile_ring_t;
 
 static struct
 {
     int64_t time_started;
-    int32_t total_frames;
+    volatile bool paused;
     rg_mutex_t *lock;
-    profile_frame_t frames[512];
+    profile_ring_t *rings[8]; // Indexed like tasks[]
 } *profile;
+static __thread profile_ring_t *local_ring;
 #endif
 
+static struct
+{
+    int32_t current[RG_STAGE_COUNT]; // Since the last tick, other tasks add to it so it's updated atomically
+    int32_t window[RG_STAGE_COUNT][RG_STAGE_WINDOW];
+    uint32_t frames;
+} stages;
+static __thread rg_stage_zone_t *current_stage;
+static const char *stage_names[RG_STAGE_COUNT] = {"emulate", "render", "audio", "convert", "transfer", "sync"};
+
 // The trace will survive a software reset
 static RTC_NOINIT_ATTR panic_trace_t panicTrace;
 static RTC_NOINIT_ATTR time_t rtcValue;
@@ -136,6 +160,11 @@ static void update_memory_statistics(void)
 #endif
 }
 
+static int compare_int32(const void *a, const void *b)
+{
+    return *(const int32_t *)a - *(const int32_t *)b;
+}
+
 static void update_statistics(void)
 {
     static counters_t counters = {0};
@@ -177,6 +206,20 @@ static void update_statistics(void)
     }
     statistics.uptime = rg_system_timer() / 1000000;
 
+    size_t count = RG_MIN(stages.frames, RG_STAGE_WINDOW);
+    for (size_t i = 0; i < RG_STAGE_COUNT && count > 0; ++i)
+    {
+        int32_t sorted[RG_STAGE_WINDOW];
+        int64_t total = 0;
+        memcpy(sorted, stages.window[i], sizeof(sorted));
+        qsort(sorted, count, sizeof(int32_t), compare_int32);
+        for (size_t j = 0; j < count; ++j)
+            total += sorted[j];
+        statistics.stages[i].min = sorted[0];
+        statistics.stages[i].avg = total / count;
+        statistics.stages[i].p99 = sorted[(count * 99 + 99) / 100 - 1];
+    }
+
     update_memory_statistics();
 }
 
@@ -228,6 +271,13 @@ static void system_monitor_task(void *arg)
             (int)roundf(statistics.partialFPS),
             (int)roundf(statistics.fullFPS),
             (int)roundf((battery.volts * 1000) ?: battery.level));
+        if (statistics.ticks > 0)
+        {
+            const rg_stage_stats_t *s = statistics.stages;
+            rg_system_log(RG_LOG_DEBUG, NULL, "STAGES (us, avg/p99): EMU:%d/%d RND:%d/%d AUD:%d/%d CNV:%d/%d SPI:%d/%d SYN:%d/%d\n",
+                (int)s[0].avg, (int)s[0].p99, (int)s[1].avg, (int)s[1].p99, (int)s[2].avg, (int)s[2].p99,
+                (int)s[3].avg, (int)s[3].p99, (int)s[4].avg, (int)s[4].p99, (int)s[5].avg, (int)s[5].p99);
+        }
 
         // Auto frameskip
         if (statistics.ticks > app.tickRate * 2)
@@ -381,7 +431,7 @@ rg_app_t *rg_system_init(int sampleRate, const rg_handlers_t *handlers, const rg
         app.bootType = RG_RST_PANIC;
     else if (r_reason == ESP_RST_SW)
         app.bootType = RG_RST_RESTART;
-    tasks[0] = (rg_task_t){.handle = xTaskGetCurrentTaskHandle(), .name = "main"};
+    tasks[0] = (rg_task_t){.handle = xTaskGetCurrentTaskHandle(), .lock = portMUX_INITIALIZER_UNLOCKED, .name = "main"};
 #elif defined(RG_TARGET_SDL2)
     tasks[0] = (rg_task_t){.handle = SDL_ThreadID(), .name = "main"};
 #endif
@@ -453,6 +503,7 @@ rg_app_t *rg_system_init(int sampleRate, const rg_handlers_t *handlers, const rg
     RG_LOGI("Profiling has been enabled at compile time!\n");
     profile = rg_alloc(sizeof(*profile), MEM_SLOW);
     profile->lock = rg_mutex_create();
+    profile->time_started = rg_system_timer();
 #endif
 
     update_memory_statistics();
@@ -484,8 +535,8 @@ static void task_wrapper(void *arg)
 {
     rg_task_t *task = arg;
     task->handle = xTaskGetCurrentTaskHandle();
-    task->queue = xQueueCreate(1, sizeof(rg_task_msg_t));
     (task->func)(task->arg);
+    vSemaphoreDelete(task->emptied);
     vQueueDelete(task->queue);
     memset(task, 0, sizeof(rg_task_t));
     vTaskDelete(NULL);
@@ -496,11 +547,31 @@ static int task_wrapper(void *arg)
     rg_task_t *task = arg;
     task->handle = SDL_ThreadID();
     (task->func)(task->arg);
+    SDL_DestroyCond(task->cond);
+    SDL_DestroyMutex(task->lock);
     memset(task, 0, sizeof(rg_task_t));
     return 0;
 }
+
+// Waits for the task's queue to change. Returns false once the deadline (-1 = none) has passed.
+// task->lock must be held.
+static bool task_wait(rg_task_t *task, int64_t deadline)
+{
+    if (deadline < 0)
+        return SDL_CondWait(task->cond, task->lock) == 0;
+    int64_t remaining = deadline - rg_system_timer();
+    if (remaining <= 0)
+        return false;
+    SDL_CondWaitTimeout(task->cond, task->lock, (remaining + 999) / 1000);
+    return true;
+}
 #endif
 
+static int64_t task_deadline(int timeoutMS)
+{
+    return timeoutMS < 0 ? -1 : rg_system_timer() + timeoutMS * 1000LL;
+}
+
 rg_task_t *rg_task_create(const char *name, void (*taskFunc)(void *arg), void *arg, size_t stackSize, int priority, int affinity)
 {
     RG_ASSERT_ARG(name && taskFunc);
@@ -521,16 +592,29 @@ rg_task_t *rg_task_create(const char *name, void (*taskFunc)(void *arg), void *a
     strncpy(task->name, name, 15);
 
 #if defined(ESP_PLATFORM)
+    // The queue must exist before the task runs, callers may send right away
     TaskHandle_t handle = NULL;
+    portMUX_INITIALIZE(&task->lock);
+    task->queue = xQueueCreate(RG_TASK_QUEUE_LENGTH, sizeof(rg_task_msg_t));
+    task->emptied = xSemaphoreCreateBinary();
     if (affinity < 0)
         affinity = tskNO_AFFINITY;
-    if (xTaskCreatePinnedToCore(task_wrapper, name, stackSize, task, priority, &handle, affinity) == pdPASS)
+    if (task->queue && task->emptied && xTaskCreatePinnedToCore(task_wrapper, name, stackSize, task, priority, &handle, affinity) == pdPASS)
         return task;
+    if (task->emptied)
+        vSemaphoreDelete(task->emptied);
+    if (task->queue)
+        vQueueDelete(task->queue);
 #elif defined(RG_TARGET_SDL2)
+    // The queue must exist before the thread runs, callers may send right away
+    task->lock = SDL_CreateMutex();
+    task->cond = SDL_CreateCond();
     SDL_Thread *thread = SDL_CreateThread(task_wrapper, name, task);
     SDL_DetachThread(thread);
     if (thread)
         return task;
+    SDL_DestroyCond(task->cond);
+    SDL_DestroyMutex(task->lock);
 #endif
 
     RG_LOGE("Task creation failed: name='%s', fn='%p', stack=%d\n", name, taskFunc, (int)stackSize);
@@ -565,65 +649,181 @@ rg_task_t *rg_task_current(void)
     return NULL;
 }
 
-bool rg_task_send(rg_task_t *task, const rg_task_msg_t *msg)
+// Stats updates, task->lock must be held
+static inline void task_count_send(rg_task_t *task, bool success, size_t depth)
+{
+    if (success)
+        task->stats.sent++;
+    else
+        task->stats.timeouts++;
+    task->stats.maxDepth = RG_MAX(task->stats.maxDepth, depth);
+}
+
+static inline void task_count_read(rg_task_t *task, bool success, bool remove)
+{
+    if (!success)
+        task->stats.timeouts++;
+    else if (remove)
+        task->stats.received++;
+}
+
+bool rg_task_send(rg_task_t *task, const rg_task_msg_t *msg, int timeoutMS)
 {
     RG_ASSERT_ARG(task && msg);
+    bool success = false;
 #if defined(ESP_PLATFORM)
-    return xQueueSend(task->queue, msg, portMAX_DELAY) == pdTRUE;
+    bool blocked = false;
+    if (!(success = xQueueSend(task->queue, msg, 0) == pdTRUE) && timeoutMS != 0)
+    {
+        blocked = true;
+        success = xQueueSend(task->queue, msg, timeoutMS < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMS)) == pdTRUE;
+    }
+    // The task may have exited and released its queue as soon as it got a stop request
+    if (success && msg->type == RG_TASK_MSG_STOP)
+        return true;
+    size_t depth = uxQueueMessagesWaiting(task->queue);
+    portENTER_CRITICAL(&task->lock);
+    task->stats.blockedSends += blocked;
+    task_count_send(task, success, depth);
+    portEXIT_CRITICAL(&task->lock);
 #elif defined(RG_TARGET_SDL2)
-    while (task->msgWaiting > 0)
-        continue;
-    task->msg = *msg;
-    task->msgWaiting = 1;
-    return true;
+    int64_t deadline = task_deadline(timeoutMS);
+    SDL_LockMutex(task->lock);
+    if (task->queueCount == RG_TASK_QUEUE_LENGTH)
+    {
+        task->stats.blockedSends++;
+        while (task->queueCount == RG_TASK_QUEUE_LENGTH && task_wait(task, deadline))
+            continue;
+    }
+    if (task->queueCount < RG_TASK_QUEUE_LENGTH)
+    {
+        task->queue[(task->queueHead + task->queueCount++) % RG_TASK_QUEUE_LENGTH] = *msg;
+        SDL_CondBroadcast(task->cond);
+        success = true;
+    }
+    task_count_send(task, success, task->queueCount);
+    SDL_UnlockMutex(task->lock);
 #endif
+    return success;
 }
 
-bool rg_task_peek(rg_task_msg_t *out)
+// Common to peek/receive: wait for a message and copy it, optionally removing it from the queue
+static bool task_read(rg_task_msg_t *out, int timeoutMS, bool remove)
 {
     rg_task_t *task = rg_task_current();
     bool success = false;
     if (!task || !out)
         return false;
-    // task->blocked = true;
 #if defined(ESP_PLATFORM)
-    success = xQueuePeek(task->queue, out, portMAX_DELAY) == pdTRUE;
+    if (!task->queue) // The main task doesn't have one
+        return false;
+    TickType_t timeout = timeoutMS < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMS);
+    if (remove)
+        success = xQueueReceive(task->queue, out, timeout) == pdTRUE;
+    else
+        success = xQueuePeek(task->queue, out, timeout) == pdTRUE;
+    if (success && remove && uxQueueMessagesWaiting(task->queue) == 0)
+        xSemaphoreGive(task->emptied);
+    portENTER_CRITICAL(&task->lock);
+    task_count_read(task, success, remove);
+    portEXIT_CRITICAL(&task->lock);
 #elif defined(RG_TARGET_SDL2)
-    while (task->msgWaiting < 1)
+    if (!task->lock) // The main task doesn't have one
+        return false;
+    int64_t deadline = task_deadline(timeoutMS);
+    SDL_LockMutex(task->lock);
+    while (task->queueCount == 0 && task_wait(task, deadline))
         continue;
-    *out = task->msg;
+    if (task->queueCount > 0)
+    {
+        *out = task->queue[task->queueHead];
+        if (remove)
+        {
+            task->queueHead = (task->queueHead + 1) % RG_TASK_QUEUE_LENGTH;
+            task->queueCount--;
+            SDL_CondBroadcast(task->cond);
+        }
+        success = true;
+    }
+    task_count_read(task, success, remove);
+    SDL_UnlockMutex(task->lock);
 #endif
-    // task->blocked = false;
     return success;
 }
 
-bool rg_task_receive(rg_task_msg_t *out)
+bool rg_task_peek(rg_task_msg_t *out, int timeoutMS)
 {
-    rg_task_t *task = rg_task_current();
-    bool success = false;
-    if (!task || !out)
-        return false;
-    // task->blocked = true;
+    return task_read(out, timeoutMS, false);
+}
+
+bool rg_task_receive(rg_task_msg_t *out, int timeoutMS)
+{
+    return task_read(out, timeoutMS, true);
+}
+
+size_t rg_task_messages_waiting(rg_task_t *task)
+{
+    if (!task) task = rg_task_current();
+#if defined(ESP_PLATFORM)
+    return uxQueueMessagesWaiting(task->queue);
+#elif defined(RG_TARGET_SDL2)
+    SDL_LockMutex(task->lock);
+    size_t count = task->queueCount;
+    SDL_UnlockMutex(task->lock);
+    return count;
+#endif
+}
+
+bool rg_task_wait_empty(rg_task_t *task, int timeoutMS)
+{
+    RG_ASSERT_ARG(task);
+    int64_t deadline = task_deadline(timeoutMS);
 #if defined(ESP_PLATFORM)
-    success = xQueueReceive(task->queue, out, portMAX_DELAY) == pdTRUE;
+    // FreeRTOS can't block on a queue becoming empty, the receiver gives task->emptied instead
+    bool waited = false;
+    while (uxQueueMessagesWaiting(task->queue) > 0)
+    {
+        TickType_t timeout = portMAX_DELAY;
+        if (deadline >= 0)
+        {
+            int64_t remaining = deadline - rg_system_timer();
+            if (remaining <= 0)
+                return false;
+            timeout = pdMS_TO_TICKS((remaining + 999) / 1000) + 1;
+        }
+        xSemaphoreTake(task->emptied, timeout);
+        waited = true;
+    }
+    // Only one waiter can take the semaphore, pass it on in case there are others
+    if (waited)
+        xSemaphoreGive(task->emptied);
+    return true;
 #elif defined(RG_TARGET_SDL2)
-    while (task->msgWaiting < 1)
+    SDL_LockMutex(task->lock);
+    while (task->queueCount > 0 && task_wait(task, deadline))
         continue;
-    *out = task->msg;
-    task->msgWaiting = 0;
+    bool empty = task->queueCount == 0;
+    SDL_UnlockMutex(task->lock);
+    return empty;
 #endif
-    // task->blocked = false;
-    return success;
 }
 
-size_t rg_task_messages_waiting(rg_task_t *task)
+rg_task_stats_t rg_task_get_stats(rg_task_t *task)
 {
     if (!task) task = rg_task_current();
+    rg_task_stats_t stats = {0};
+    if (!task)
+        return stats;
 #if defined(ESP_PLATFORM)
-    return uxQueueMessagesWaiting(task->queue);
+    portENTER_CRITICAL(&task->lock);
+    stats = task->stats;
+    portEXIT_CRITICAL(&task->lock);
 #elif defined(RG_TARGET_SDL2)
-    return task->msgWaiting;
+    SDL_LockMutex(task->lock);
+    stats = task->stats;
+    SDL_UnlockMutex(task->lock);
 #endif
+    return stats;
 }
 
 // bool rg_task_is_blocked(rg_task_t *task)
@@ -759,9 +959,40 @@ void rg_system_tick(int busyTime)
     statistics.lastTick = rg_system_timer();
     statistics.busyTime += busyTime;
     statistics.ticks++;
+    for (size_t i = 0; i < RG_STAGE_COUNT; ++i)
+        stages.window[i][stages.frames % RG_STAGE_WINDOW] = __atomic_exchange_n(&stages.current[i], 0, __ATOMIC_RELAXED);
+    stages.frames++;
     // WDT_RELOAD(WDT_TIMEOUT);
 }
 
+void rg_system_stage_begin(rg_stage_zone_t *zone, rg_stage_t stage)
+{
+    zone->stage = stage;
+    zone->nested = 0;
+    zone->parent = current_stage;
+    current_stage = zone;
+    zone->start = rg_system_timer();
+}
+
+void rg_system_stage_end(rg_stage_zone_t *zone)
+{
+    int64_t elapsed = rg_system_timer() - zone->start;
+    current_stage = zone->parent;
+    if (zone->parent)
+        zone->parent->nested += elapsed;
+    __atomic_fetch_add(&stages.current[zone->stage], (int32_t)(elapsed - zone->nested), __ATOMIC_RELAXED);
+}
+
+int rg_system_get_stage_time(rg_stage_t stage)
+{
+    return __atomic_load_n(&stages.current[stage], __ATOMIC_RELAXED);
+}
+
+const char *rg_system_get_stage_name(rg_stage_t stage)
+{
+    return stage < RG_STAGE_COUNT ? stage_names[stage] : "?";
+}
+
 IRAM_ATTR int64_t rg_system_timer(void)
 {
 #if defined(ESP_PLATFORM)
@@ -783,6 +1014,7 @@ static void shutdown_cleanup(void)
     exitCalled = true;
     rg_display_clear(C_BLACK);                // Let the user know that something is happening
     rg_gui_draw_hourglass();                  // ...
+    rg_idle_attach(NULL);                     // Record the idle skip counters, the app might commit them
     rg_system_event(RG_EVENT_SHUTDOWN, NULL); // Allow apps to save their state if they want
     rg_audio_deinit();                        // Disable sound ASAP to avoid audio garbage
     rg_system_save_time();                    // RTC might save to storage, do it before
@@ -841,6 +1073,7 @@ void rg_system_switch_app(const char *partition, const char *name, const char *a
 
     if (app.initialized)
     {
+        rg_idle_attach(NULL);
         rg_settings_set_string(NS_BOOT, SETTING_BOOT_NAME, name);
         rg_settings_set_string(NS_BOOT, SETTING_BOOT_ARGS, args);
         rg_settings_set_number(NS_BOOT, SETTING_BOOT_FLAGS, flags);
@@ -1264,6 +1497,8 @@ bool rg_emu_save_state(uint8_t slot)
         char *filename = rg_emu_get_path(RG_PATH_SCREENSHOT + slot, app.romPath);
         rg_emu_screenshot(filename, rg_display_get_info()->screen.width / 2, 0);
         free(filename);
+        // The screenshot is written by the storage task but the save slot preview reads it right away
+        rg_storage_wait(0, -1);
 
         emu_update_save_slot(slot);
     }
@@ -1375,88 +1610,95 @@ float rg_emu_get_speed(void)
 }
 
 #ifdef RG_ENABLE_PROFILING
-// Note this profiler might be inaccurate because of:
-// https://gcc.gnu.org/bugzilla/show_bug.cgi?id=28205
-
-// We also need to add multi-core support. Currently it's not an issue
-// because all our profiled code runs on the same core.
-
-#define LOCK_PROFILE()   rg_mutex_take(profile->lock, 10000)
-#define UNLOCK_PROFILE() rg_mutex_give(lock)
-
-NO_PROFILE static inline profile_frame_t *find_frame(void *this_fn, void *call_site)
+static profile_ring_t *profile_get_ring(void)
 {
-    for (int i = 0; i < 512; ++i)
-    {
-        profile_frame_t *frame = &profile->frames[i];
-        if (frame->func_ptr == 0)
-        {
-            profile->total_frames = RG_MAX(profile->total_frames, i + 1);
-            frame->func_ptr = this_fn;
-        }
-        if (frame->func_ptr == this_fn) // && frame->caller_ptr == call_site)
-            return frame;
-    }
+    rg_task_t *task = rg_task_current();
+    if (!task)
+        return NULL; // Threads not started by rg_task_create can't be recorded
+
+    size_t slot = task - tasks;
+    rg_mutex_take(profile->lock, -1);
+    profile_ring_t *ring = profile->rings[slot];
+    if (!ring)
+        ring = profile->rings[slot] = rg_alloc(sizeof(profile_ring_t), MEM_SLOW | MEM_NOPANIC);
+    if (ring)
+        memcpy(ring->name, task->name, 16);
+    rg_mutex_give(profile->lock);
 
-    RG_PANIC("Profile memory exhausted!");
+    return (local_ring = ring);
 }
 
-NO_PROFILE void rg_system_dump_profile(void)
+rg_profile_zone_t rg_profile_zone_begin(const char *name)
 {
-    LOCK_PROFILE();
-
-    printf("RGD:PROF:BEGIN %d %d\n", profile->total_frames, (int)(rg_system_timer() - profile->time_started));
-
-    for (int i = 0; i < profile->total_frames; ++i)
-    {
-        profile_frame_t *frame = &profile->frames[i];
-
-        printf(
-            "RGD:PROF:DATA %p\t%p\t%u\t%u\n",
-            frame->caller_ptr,
-            frame->func_ptr,
-            frame->num_calls,
-            frame->run_time
-        );
-    }
-
-    printf("RGD:PROF:END\n");
-
-    memset(profile->frames, 0, sizeof(profile->frames));
-    profile->time_started = rg_system_timer();
-    profile->total_frames = 0;
-
-    UNLOCK_PROFILE();
+    return (rg_profile_zone_t){name, rg_system_timer()};
 }
 
-NO_PROFILE void __cyg_profile_func_enter(void *this_fn, void *call_site)
+void rg_profile_zone_end(rg_profile_zone_t *zone)
 {
-    if (!profile)
+    if (!profile || profile->paused)
         return;
 
     int64_t now = rg_system_timer();
-    LOCK_PROFILE();
-    profile_frame_t *fn = find_frame(this_fn, call_site);
-    // Recursion will need a real stack, this is absurd
-    if (fn->enter_time != 0)
-        fn->run_time += now - fn->enter_time;
-    fn->enter_time = rg_system_timer(); // not now, because we delayed execution
-    fn->num_calls++;
-    UNLOCK_PROFILE();
+    profile_ring_t *ring = local_ring ?: profile_get_ring();
+    if (!ring || zone->start < profile->time_started)
+        return;
+
+    // The ring only has one writer, the exporter pauses recording before reading it
+    profile_event_t *event = &ring->events[ring->head % PROFILE_RING_LENGTH];
+    event->name = zone->name;
+    event->start = zone->start - profile->time_started;
+    event->duration = now - zone->start;
+    __sync_synchronize();
+    ring->head++;
 }
 
-NO_PROFILE void __cyg_profile_func_exit(void *this_fn, void *call_site)
+bool rg_system_save_profile(const char *filename)
 {
+    RG_ASSERT_ARG(filename);
+
     if (!profile)
-        return;
+        return false;
 
-    int64_t now = rg_system_timer();
-    LOCK_PROFILE();
-    profile_frame_t *fn = find_frame(this_fn, call_site);
-    // Ignore if profiler was disabled when function entered
-    if (fn->enter_time != 0)
-        fn->run_time += now - fn->enter_time;
-    fn->enter_time = 0;
-    UNLOCK_PROFILE();
+    FILE *fp = fopen(filename, "w");
+    if (!fp)
+    {
+        RG_LOGE("Failed to open '%s'", filename);
+        return false;
+    }
+
+    // Give the zones being written right now a moment to complete
+    profile->paused = true;
+    rg_task_delay(2);
+
+    size_t count = 0;
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"%s\"}}", app.name);
+    for (size_t tid = 0; tid < RG_COUNT(profile->rings); ++tid)
+    {
+        profile_ring_t *ring = profile->rings[tid];
+        if (!ring)
+            continue;
+        fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            (int)tid, ring->name);
+        uint32_t first = ring->head > PROFILE_RING_LENGTH ? ring->head - PROFILE_RING_LENGTH : 0;
+        for (uint32_t i = first; i < ring->head; ++i)
+        {
+            const profile_event_t *event = &ring->events[i % PROFILE_RING_LENGTH];
+            fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%u,\"dur\":%u}",
+                event->name, (int)tid, (unsigned)event->start, (unsigned)event->duration);
+            count++;
+        }
+        ring->head = 0;
+    }
+    fprintf(fp, "\n]}\n");
+    bool success = !ferror(fp);
+    fclose(fp);
+
+    // Start a new capture, zones that began before now will be ignored
+    profile->time_started = rg_system_timer();
+    profile->paused = false;
+
+    RG_LOGI("Saved %d zones to '%s'", (int)count, filename);
+    return success;
 }
 #endif
@@ -28,6 +28,8 @@ extern "C" {
 #include "rg_display.h"
 #include "rg_input.h"
 #include "rg_storage.h"
+#include "rg_sram.h"
+#include "rg_idle.h"
 #include "rg_settings.h"
 #include "rg_network.h"
 #include "rg_gui.h"
@@ -192,10 +194,36 @@ typedef struct
     int saveSlot;
     const char *romPath;
     const rg_gui_option_t *options;
+    const rg_gui_option_t *debugOptions; // Extra entries shown in the debug menu
     rg_handlers_t handlers;
     bool initialized;
 } rg_app_t;
 
+typedef enum
+{
+    RG_STAGE_EMULATE = 0, // Core emulation (the CPU, and the PPU in cores that interleave it)
+    RG_STAGE_RENDER,      // Core work producing the frame outside of emulation
+    RG_STAGE_AUDIO,       // rg_audio_submit, including waiting on the audio driver
+    RG_STAGE_CONVERT,     // Display task scaling and converting the frame into LCD buffers
+    RG_STAGE_TRANSFER,    // Display task waiting on the LCD to take or finish a buffer
+    RG_STAGE_SYNC,        // Core waiting on the display task to take a frame
+    RG_STAGE_COUNT,
+} rg_stage_t;
+
+typedef struct
+{
+    int32_t min, avg, p99; // us per frame over the last RG_STAGE_WINDOW frames
+} rg_stage_stats_t;
+
+#define RG_STAGE_WINDOW 128
+
+typedef struct rg_stage_zone_s
+{
+    rg_stage_t stage;
+    int64_t start, nested;
+    struct rg_stage_zone_s *parent;
+} rg_stage_zone_t;
+
 typedef struct
 {
     float skippedFPS;
@@ -214,6 +242,7 @@ typedef struct
     int freeBlockInt;
     int freeBlockExt;
     int freeStackMain;
+    rg_stage_stats_t stages[RG_STAGE_COUNT];
 } rg_stats_t;
 
 rg_app_t *rg_system_init(int sampleRate, const rg_handlers_t *handlers, const rg_gui_option_t *options);
@@ -241,6 +270,12 @@ void rg_system_event(int event, void *data);
 int64_t rg_system_timer(void);
 rg_app_t *rg_system_get_app(void);
 rg_stats_t rg_system_get_counters(void);
+// Stage time is accumulated per frame, a frame ends at rg_system_tick. Stages nest: time spent in an
+// inner stage isn't counted in the outer one. Prefer RG_STAGE_ZONE, it also records a profile zone.
+void rg_system_stage_begin(rg_stage_zone_t *zone, rg_stage_t stage);
+void rg_system_stage_end(rg_stage_zone_t *zone);
+int rg_system_get_stage_time(rg_stage_t stage); // us recorded since the last tick
+const char *rg_system_get_stage_name(rg_stage_t stage);
 
 // RTC and time-related functions
 void rg_system_set_timezone(const char *TZ);
@@ -260,14 +295,25 @@ typedef struct
     };
 } rg_task_msg_t;
 #define RG_TASK_MSG_STOP -1
+typedef struct
+{
+    uint32_t sent;
+    uint32_t received;
+    uint32_t maxDepth;     // Most messages ever waiting in the queue
+    uint32_t blockedSends; // Sends that found the queue full and had to wait
+    uint32_t timeouts;     // Sends or reads that gave up
+} rg_task_stats_t;
 rg_task_t *rg_task_create(const char *name, void (*taskFunc)(void *arg), void *arg, size_t stackSize, int priority, int affinity);
 rg_task_t *rg_task_find(const char *name);
 rg_task_t *rg_task_current(void);
-bool rg_task_send(rg_task_t *task, const rg_task_msg_t *msg);
-bool rg_task_peek(rg_task_msg_t *out);
-bool rg_task_receive(rg_task_msg_t *out);
+// Message queue functions block like rg_mutex_take: timeoutMS < 0 waits forever, 0 doesn't wait
+bool rg_task_send(rg_task_t *task, const rg_task_msg_t *msg, int timeoutMS);
+bool rg_task_peek(rg_task_msg_t *out, int timeoutMS);
+bool rg_task_receive(rg_task_msg_t *out, int timeoutMS);
+bool rg_task_wait_empty(rg_task_t *task, int timeoutMS);
 bool rg_task_is_blocked(rg_task_t *task);
 size_t rg_task_messages_waiting(rg_task_t *task);
+rg_task_stats_t rg_task_get_stats(rg_task_t *task);
 // The main difference between rg_task_delay and rg_usleep is that rg_task_delay will yield
 // to other tasks and will not busy wait time smaller than a tick. Meaning rg_usleep
 // is more accurate but rg_task_delay is more multitasking-friendly.
@@ -316,14 +362,39 @@ float rg_emu_get_speed(void);
 #define RG_LOGV(x, ...) rg_system_log(RG_LOG_VERBOSE, RG_LOG_TAG, x, ## __VA_ARGS__)
 #endif
 
+// RG_PROFILE_ZONE("name") records the time spent until the end of the enclosing scope, RG_PROFILE_BEGIN
+// and RG_PROFILE_END do the same for spans that aren't a scope. Zones are kept in a ring buffer per task
+// (created by rg_task_create) and rg_system_save_profile exports them all as a Chrome trace
+// (chrome://tracing or ui.perfetto.dev). The name must be a string literal.
 #ifdef RG_ENABLE_PROFILING
-void __cyg_profile_func_enter(void *this_fn, void *call_site);
-void __cyg_profile_func_exit(void *this_fn, void *call_site);
-#define NO_PROFILE __attribute((no_instrument_function))
+typedef struct
+{
+    const char *name;
+    int64_t start;
+} rg_profile_zone_t;
+rg_profile_zone_t rg_profile_zone_begin(const char *name);
+void rg_profile_zone_end(rg_profile_zone_t *zone);
+bool rg_system_save_profile(const char *filename);
+#define RG_PROFILE_ZONE_VAR_(line) _rg_profile_zone_##line
+#define RG_PROFILE_ZONE_VAR(line) RG_PROFILE_ZONE_VAR_(line)
+#define RG_PROFILE_ZONE(name) \
+    __attribute__((cleanup(rg_profile_zone_end))) rg_profile_zone_t RG_PROFILE_ZONE_VAR(__LINE__) = rg_profile_zone_begin(name)
+#define RG_PROFILE_BEGIN(var, name) rg_profile_zone_t var = rg_profile_zone_begin(name)
+#define RG_PROFILE_END(var) rg_profile_zone_end(&var)
 #else
-#define NO_PROFILE
+#define RG_PROFILE_ZONE(name)
+#define RG_PROFILE_BEGIN(var, name)
+#define RG_PROFILE_END(var)
 #endif
 
+// RG_STAGE_ZONE(RG_STAGE_x) attributes the time until the end of the enclosing scope to a frame stage
+#define RG_STAGE_ZONE_VAR_(line) _rg_stage_zone_##line
+#define RG_STAGE_ZONE_VAR(line) RG_STAGE_ZONE_VAR_(line)
+#define RG_STAGE_ZONE(stage)                                                                      \
+    RG_PROFILE_ZONE(rg_system_get_stage_name(stage));                                              \
+    __attribute__((cleanup(rg_system_stage_end))) rg_stage_zone_t RG_STAGE_ZONE_VAR(__LINE__); \
+    rg_system_stage_begin(&RG_STAGE_ZONE_VAR(__LINE__), stage)
+
 #ifdef __cplusplus
 }
 #endif
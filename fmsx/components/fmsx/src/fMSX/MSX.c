@@ -184,6 +184,17 @@ byte PLatch;                       /* Palette buffer         */
 byte ALatch;                       /* Address buffer         */
 int  Palette[16];                  /* Current palette        */
 
+/** Line cache ***********************************************/
+int  ScreenBuffers = 0;            /* Frame buffers, 0 = OFF */
+unsigned int VDPTime = 1;          /* Scanline counter       */
+unsigned int VRAMTime[0x20000>>VRAMBLOCK]; /* VRAM writes    */
+byte CleanLines[256];              /* 1: Same as last frame  */
+static unsigned int LineKeys[MAXBUFFERS][256]; /* VDP state  */
+static unsigned int LineTimes[MAXBUFFERS][256];/* When drawn */
+static unsigned int LineGen;       /* Changed to invalidate  */
+static unsigned int TopKey;        /* Screen top at line 0   */
+static int LineBuf;                /* Buffer being drawn     */
+
 /** Cheat entries ********************************************/
 int MCFCount     = 0;              /* Size of MCFEntries[]   */
 MCFEntry MCFEntries[MAXCHEATS];    /* Entries from .MCF file */
@@ -307,6 +318,8 @@ void VDPOut(byte R,byte V);       /* Write value into a VDP register */
 void Printer(byte V);             /* Send a character to a printer   */
 void PPIOut(byte New,byte Old);   /* Set PPI bits (key click, etc.)  */
 int  CheckSprites(void);          /* Check for sprite collisions     */
+static int CountSprites(byte Y);  /* Sprite status for line Y        */
+static int LineCached(byte Y);    /* Check if line Y can be skipped  */
 byte RTCIn(byte R);               /* Read RTC registers              */
 byte SetScreen(void);             /* Change screen mode              */
 word SetIRQ(byte IRQ);            /* Set/Reset IRQ                   */
@@ -989,6 +1002,9 @@ int ResetMSX(int NewMode,int NewRAMPages,int NewVRAMPages)
   /* Reset CPU */
   ResetZ80(&CPU);
 
+  /* VRAM and VDP state are all new */
+  InvalidateLines();
+
   /* Done */
   return(Mode);
 }
@@ -1268,6 +1284,7 @@ case 0x87:
 case 0x98: /* VDP Data */
   VKey=1;
   VDPData=VPAGE[VAddr]=Value;
+  TouchVRAM(VPAGE-VRAM+VAddr);
   VAddr=(VAddr+1)&0x3FFF;
   /* If VAddr rolled over, modify VRAM page# */
   if(!VAddr&&(ScrMode>3)) 
@@ -2044,6 +2061,7 @@ word LoopZ80(Z80 *R)
 
     /* New scanline */
     ScanLine=ScanLine<(PALVideo? 312:261)? ScanLine+1:0;
+    VDPTime++;
 
     /* If first scanline of the screen... */
     if(!ScanLine)
@@ -2054,8 +2072,13 @@ word LoopZ80(Z80 *R)
       /* Reset VRefresh bit */
       VDPStatus[2]&=0xBF;
 
-      /* Refresh display */
-      if(UCount>=100) { UCount-=100;RefreshScreen(); }
+      /* Refresh display, cached lines go to the next buffer */
+      if(UCount>=100)
+      {
+        UCount-=100;
+        RefreshScreen();
+        if((++LineBuf>=ScreenBuffers)||(LineBuf>=MAXBUFFERS)) LineBuf=0;
+      }
       UCount+=UPeriod;
 
       /* Blinking for TEXT80 */
@@ -2146,7 +2169,7 @@ word LoopZ80(Z80 *R)
   LoopVDP();
 
   /* Refresh scanline, possibly with the overscan */
-  if((UCount>=100)&&Drawing&&(ScanLine<256))
+  if((UCount>=100)&&Drawing&&(ScanLine<256)&&(!ScreenBuffers||!LineCached(ScanLine)))
   {
     if(!ModeYJK||(ScrMode<7)||(ScrMode>8))
       (RefreshLine[ScrMode])(ScanLine);
@@ -2254,6 +2277,210 @@ word LoopZ80(Z80 *R)
   return(R->IRequest);
 }
 
+/** CountSprites() *******************************************/
+/** Update sprite status bits for line Y the same way as    **/
+/** Sprites()/ColorSprites() do. Returns 1 if any sprite is **/
+/** shown on line Y.                                        **/
+/*************************************************************/
+static int CountSprites(byte Y)
+{
+  static const byte SprHeights[4] = { 8,16,16,32 };
+  register byte OH,IH,*AT;
+  register int L,K,C,N;
+
+  /* No sprites in text modes or when the screen is off */
+  if(!ScreenON||!ScrMode||(ScrMode>=MAXSCREEN+1)) return(0);
+
+  /* ColorSprites() clears status even when sprites are off */
+  if(ScrMode>3) VDPStatus[0]&=~0x5F;
+  if(SpritesOFF) return(0);
+
+  /* RefreshLine1-3() pass Y+VScroll, Sprites() adds it again */
+  if(ScrMode<4) Y+=VScroll<<1;
+
+  VDPStatus[0]&=~0x5F;
+  OH = SprHeights[VDP[1]&0x03];
+  IH = SprHeights[VDP[1]&0x02];
+  C  = (ScrMode>3? MAXSPRITE2:MAXSPRITE1)+1;
+
+  for(L=N=0,AT=SprTab;L<32;++L,AT+=4)
+  {
+    K=AT[0];
+    if(K==(ScrMode>3? 216:208)) break;
+    if(ScrMode>3) K=(byte)(K-VScroll);
+    if(K>256-IH) K-=256;
+
+    if((Y>K)&&(Y<=K+OH))
+    {
+      if(!--C)
+      {
+        VDPStatus[0]|=0x40;
+        if(!OPTION(MSX_ALLSPRITE)) break;
+      }
+      N=1;
+    }
+  }
+
+  VDPStatus[0]|=L<32? L:31;
+  return(N);
+}
+
+/** VRAMChanged() ********************************************/
+/** Check if any of N bytes of VRAM at offset A were written**/
+/** at or after VDPTime T.                                  **/
+/*************************************************************/
+static int VRAMChanged(int A,int N,unsigned int T)
+{
+  register int J;
+
+  for(J=A>>VRAMBLOCK;J<=(A+N-1)>>VRAMBLOCK;++J)
+    if((int)(VRAMTime[J&((0x20000>>VRAMBLOCK)-1)]-T)>=0) return(1);
+
+  return(0);
+}
+
+/** LineChanged() ********************************************/
+/** Check if VRAM shown on line Y was written at or after   **/
+/** VDPTime T. Sprite tables are only checked when S=1.     **/
+/*************************************************************/
+static int LineChanged(byte Y,unsigned int T,int S)
+{
+  register byte V;
+  register int A,I;
+
+  if(!ScreenON) return(0);
+
+  V=Y+VScroll;
+  switch(ScrMode)
+  {
+    case 0:
+      if(VRAMChanged(ChrTab-VRAM+40*(Y>>3),40,T)) return(1);
+      break;
+    case MAXSCREEN+1:
+      if(VRAMChanged(ChrTab-VRAM+((80*(Y>>3))&ChrTabM),80,T)) return(1);
+      if(VRAMChanged(ColTab-VRAM+((10*(Y>>3))&ColTabM),10,T)) return(1);
+      break;
+    case 1:
+      if(VRAMChanged(ChrTab-VRAM+((int)(V&0xF8)<<2),32,T)) return(1);
+      if(VRAMChanged(ColTab-VRAM,32,T)) return(1);
+      break;
+    case 2:
+    case 4:
+      if(VRAMChanged(ChrTab-VRAM+((int)(V&0xF8)<<2),32,T)) return(1);
+      /* Only one third of the tables, unless masked */
+      A=(int)(V&0xC0)<<5;
+      I=(ColTabM&0x1800)==0x1800? A:0;
+      if(VRAMChanged(ColTab-VRAM+I,A+0x800-I,T)) return(1);
+      I=(ChrGenM&0x1800)==0x1800? A:0;
+      if(VRAMChanged(ChrGen-VRAM+I,A+0x800-I,T)) return(1);
+      break;
+    case 3:
+      if(VRAMChanged(ChrTab-VRAM+((int)(V&0xF8)<<2),32,T)) return(1);
+      break;
+    case 5:
+    case 6:
+      A=((int)(Y+VScroll)<<7)&ChrTabM&0x7FFF;
+      if(VRAMChanged(ChrTab-VRAM+A,128,T)) return(1);
+      break;
+    default:
+      /* RefreshLine12() may also scroll into the next row */
+      A=((int)(Y+VScroll)<<8)&ChrTabM&0xFFFF;
+      if(HScroll512&&(HScroll>255)) A+=0x10000;
+      if(VRAMChanged(ChrTab-VRAM+A,512,T)) return(1);
+      break;
+  }
+
+  /* Pattern table of the text modes, unless using fixed font */
+  switch(ScrMode)
+  {
+    case 0:
+    case 1:
+    case MAXSCREEN+1:
+      if(FontBuf&&OPTION(MSX_FIXEDFONT)) break;
+    case 3:
+      if(VRAMChanged(ChrGen-VRAM,0x800,T)) return(1);
+      break;
+  }
+
+  /* Sprite attributes, colors, and patterns */
+  if(S)
+  {
+    A=SprTab-VRAM;
+    if(ScrMode>3? VRAMChanged(A-0x200,0x280,T):VRAMChanged(A,0x80,T)) return(1);
+    if(VRAMChanged(SprGen-VRAM,0x800,T)) return(1);
+  }
+
+  return(0);
+}
+
+/** LineKey() ************************************************/
+/** Hash of the VDP state, other than VRAM, that refreshing **/
+/** a line depends on. Bit 0 is left for sprites.           **/
+/*************************************************************/
+static unsigned int LineKey(void)
+{
+  static const byte Regs[] = { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,18,23,25,26,27 };
+  register unsigned int K;
+  register int J;
+
+  K=2166136261u^LineGen;
+  for(J=0;J<sizeof(Regs);++J) K=(K^VDP[Regs[J]])*16777619u;
+  for(J=0;J<16;++J) K=(K^Palette[J])*16777619u;
+  K=(K^ScrMode^(XFGColor<<4)^(XBGColor<<8))*16777619u;
+  K=(K^TopKey^(FontBuf&&OPTION(MSX_FIXEDFONT)? 0x10000:0))*16777619u;
+  return(K&~1);
+}
+
+/** LineValid() **********************************************/
+/** Check if line Y in frame buffer B was drawn with state  **/
+/** K and its VRAM did not change since.                    **/
+/*************************************************************/
+static int LineValid(int B,byte Y,unsigned int K)
+{
+  return(LineTimes[B][Y]&&(LineKeys[B][Y]==K)&&!LineChanged(Y,LineTimes[B][Y],K&1));
+}
+
+/** LineCached() *********************************************/
+/** Returns 1 if line Y in the current frame buffer already **/
+/** shows what refreshing it would draw, so it can be       **/
+/** skipped. Sets CleanLines[Y] when the previous frame     **/
+/** also showed the same.                                   **/
+/*************************************************************/
+static int LineCached(byte Y)
+{
+  register unsigned int K;
+  register int B;
+
+  CleanLines[Y]=0;
+
+  /* Line 0 also paints the top border and sets FirstLine */
+  if(!Y) TopKey=VDP[9]|((int)VDP[18]<<8);
+
+  K=LineKey()|CountSprites(Y);
+  B=LineBuf;
+
+  if(Y&&LineValid(B,Y,K))
+  {
+    /* Previous frame went into the previous buffer */
+    B=(B? B:(ScreenBuffers<MAXBUFFERS? ScreenBuffers:MAXBUFFERS))-1;
+    CleanLines[Y]=LineValid(B,Y,K);
+    return(1);
+  }
+
+  LineKeys[B][Y]=K;
+  LineTimes[B][Y]=VDPTime;
+  return(0);
+}
+
+/** InvalidateLines() ****************************************/
+/** Make the line cache refresh the whole screen again.     **/
+/*************************************************************/
+void InvalidateLines(void)
+{
+  ++LineGen;
+  memset(CleanLines,0,sizeof(CleanLines));
+}
+
 /** CheckSprites() *******************************************/
 /** Check for sprite collisions.                            **/
 /*************************************************************/
@@ -2896,6 +3123,7 @@ byte LoadFNT(const char *FileName)
   if(!FontBuf) { fclose(F);return(0); }
   /* Read font, ignore short reads */
   fread(FontBuf,1,256*8,F);
+  InvalidateLines();
   /* Done */
   fclose(F);
   return(1);  
@@ -3393,6 +3621,7 @@ int LoadPAL(const char *Name)
   }
 
   fclose(F);
+  InvalidateLines();
   return(J);
 }
 
@@ -106,6 +106,7 @@ extern "C" {
 #define MAXMAPPERS  8       /* Total defined MegaROM mappers */
 #define MAXCHUNKS   256     /* Max number of memory blocks   */
 #define MAXCHEATS   256     /* Max number of cheats          */
+#define MAXBUFFERS  2       /* Frame buffers in line cache   */
 
 #define MAXCHANNELS (AY8910_CHANNELS+YM2413_CHANNELS)
   /* Number of sound channels used by the emulation */
@@ -230,6 +231,16 @@ extern volatile byte KeyState[16];
 #define HAdjust       (-((signed char)(VDP[18]<<4)>>4))
 /*************************************************************/
 
+/** Line cache ***********************************************/
+/** When ScreenBuffers is set, lines are only refreshed if  **/
+/** the VRAM they show or the VDP state changed since they  **/
+/** were drawn into the same frame buffer. VRAM writes are  **/
+/** tracked in 256-byte blocks, stamped with VDPTime.       **/
+/*************************************************************/
+#define VRAMBLOCK     8               /* log2(block size)    */
+#define TouchVRAM(A)  VRAMTime[((A)>>VRAMBLOCK)&((0x20000>>VRAMBLOCK)-1)]=VDPTime
+/*************************************************************/
+
 /** Variables used to control emulator behavior **************/
 extern byte Verbose;                  /* Debug msgs ON/OFF   */
 extern int  Mode;                     /* ORed MSX_* bits     */
@@ -254,6 +265,10 @@ extern byte XFGColor,XBGColor;        /* Alternative colors  */
 extern byte ScrMode;                  /* Current screen mode */
 extern int  ScanLine;                 /* Current scanline    */
 extern byte *FontBuf;                 /* Optional fixed font */
+extern int  ScreenBuffers;            /* Line cache, 0 = OFF */
+extern unsigned int VDPTime;          /* Scanline counter    */
+extern unsigned int VRAMTime[];       /* Last VRAM writes    */
+extern byte CleanLines[256];          /* 1: Same as before   */
 
 extern byte ExitNow;                  /* 1: Exit emulator    */
 
@@ -398,6 +413,12 @@ byte ChangeDisk(byte N,const char *FileName);
 /*************************************************************/
 byte LoadFNT(const char *FileName);
 
+/** InvalidateLines() ****************************************/
+/** Make the line cache refresh the whole screen again.     **/
+/** Call it after drawing over the frame buffers.           **/
+/*************************************************************/
+void InvalidateLines(void);
+
 /** SetScreenDepth() *****************************************/
 /** Set screen depth for the display drivers. Returns 1 on  **/
 /** success, 0 on failure.                                  **/
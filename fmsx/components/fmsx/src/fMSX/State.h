@@ -209,6 +209,7 @@ unsigned int LoadState(unsigned char *Buf,unsigned int MaxSize)
 
   /* Set screen mode and VRAM table addresses */
   SetScreen();
+  InvalidateLines();
 
   /* Set some other variables */
   VPAGE    = VRAM+((int)VDP[14]<<14);
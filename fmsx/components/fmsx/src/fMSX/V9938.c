@@ -145,6 +145,13 @@ static void VDPpset(register byte SM,
 
 static int GetVdpTimingValue(register int *);
 
+static int VDPSpan(register int X, register int TX,
+                   register int MX, register int N);
+static void VDPCopySpan(register byte *D, register byte *S,
+                        register int N, register int TX);
+static void VDPTouch(register byte SM, register int Y0,
+                     register int Y1, register int TY);
+
 static void SrchEngine(void);
 static void LineEngine(void);
 static void LmmvEngine(void);
@@ -339,6 +346,57 @@ static int GetVdpTimingValue(register int *timing_values)
   return(timing_values[((VDP[1]>>6)&1)|(VDP[8]&2)|((VDP[9]<<1)&4)]);
 }
 
+/** VDPSpan() ************************************************/
+/** Number of steps left on the row from X, at most N.      **/
+/** Returns 0 if X is not on the row                        **/
+/*************************************************************/
+INLINE int VDPSpan(int X, int TX, int MX, int N)
+{
+  register int S;
+
+  if (X<0 || X>=MX)
+    return(0);
+  S = TX>0? (MX-1-X)/TX+1 : X/(-TX)+1;
+  return(S<N? S:N);
+}
+
+/** VDPCopySpan() ********************************************/
+/** Copy N bytes starting at S to D in the same order as    **/
+/** the dot loops would, going up or down depending on TX   **/
+/*************************************************************/
+INLINE void VDPCopySpan(byte *D, byte *S, int N, int TX)
+{
+  if (TX>0) {
+    if (D<=S || D>=S+N)
+      memmove(D, S, N);
+    else
+      while (N--) *D++=*S++;
+  }
+  else {
+    if (D>=S || D<=S-N)
+      memmove(D-N+1, S-N+1, N);
+    else
+      while (N--) *D--=*S--;
+  }
+}
+
+/** VDPTouch() ***********************************************/
+/** Mark VRAM rows from Y0 to Y1, going in TY direction, as **/
+/** written for the line cache                              **/
+/*************************************************************/
+static void VDPTouch(byte SM, int Y0, int Y1, int TY)
+{
+  register int J;
+
+  if (SM>3)
+    return;
+  for (J=0; J<1024; J++, Y0+=TY) {
+    TouchVRAM(VDPVRMP(SM, 0, Y0)-VRAM);
+    if (!((Y0-Y1)&1023))
+      break;
+  }
+}
+
 /** SrchEgine()** ********************************************/
 /** Search a dot                                            **/
 /*************************************************************/
@@ -460,6 +518,8 @@ void LineEngine(void)
               break;
     }
 
+  VDPTouch(ScrMode-5, MMC.DY, DY, TY);
+
   if ((VdpOpsCnt=cnt)>0) {
     /* Command execution done */
     VDPStatus[2]&=0xFE;
@@ -507,6 +567,8 @@ void LmmvEngine(void)
             break;
   }
 
+  VDPTouch(ScrMode-5, MMC.DY, DY, TY);
+
   if ((VdpOpsCnt=cnt)>0) {
     /* Command execution done */
     VDPStatus[2]&=0xFE;
@@ -543,12 +605,37 @@ void LmmmEngine(void)
   register int ADX=MMC.ADX;
   register int ANX=MMC.ANX;
   register byte LO=MMC.LO;
+  register byte SM=ScrMode-5;
+  register int A=TX>0? 0:PPB[SM&3]-1;
   register int cnt;
   register int delta;
+  register int N,B,X;
+  register int done=0;
  
   delta = GetVdpTimingValue(lmmm_timing);
   cnt = VdpOpsCnt;
 
+  /* IMP copies of byte aligned rows are plain byte copies, */
+  /* do whole rows at once while they fit in the time slice */
+  if (!LO && SM<4)
+    while (ASX%PPB[SM]==A && ADX%PPB[SM]==A
+        && (N=VDPSpan(ADX, TX, MMC.MX, VDPSpan(ASX, TX, MMC.MX, ANX)))>0
+        && cnt-N*delta>0) {
+      B=N/PPB[SM];
+      VDPCopySpan(VDP_VRMP(SM, ADX, DY), VDP_VRMP(SM, ASX, SY), B, TX);
+      for (X=B*PPB[SM]; X<N; X++)
+        VDP_PSET(SM, ADX+X*TX, DY, VDP_POINT(SM, ASX+X*TX, SY), LO);
+      cnt-=N*delta;
+      if (!(--NY&1023) || (SY+=TY)==-1 || (DY+=TY)==-1) {
+        done=1;
+        break;
+      }
+      ASX=SX;
+      ADX=DX;
+      ANX=NX;
+    }
+
+  if (!done)
   switch (ScrMode) {
     case 5: pre_loop VDPpset5(ADX, DY, VDPpoint5(ASX, SY), LO); post_xxyy(256)
             break;
@@ -560,6 +647,8 @@ void LmmmEngine(void)
             break;
   }
 
+  VDPTouch(ScrMode-5, MMC.DY, DY, TY);
+
   if ((VdpOpsCnt=cnt)>0) {
     /* Command execution done */
     VDPStatus[2]&=0xFE;
@@ -628,6 +717,7 @@ void LmmcEngine(void)
 
     VDPStatus[7]=VDP[44]&=Mask[SM];
     VDP_PSET(SM, MMC.ADX, MMC.DY, VDP[44], MMC.LO);
+    VDPTouch(SM, MMC.DY, MMC.DY, 1);
     VdpOpsCnt-=GetVdpTimingValue(lmmv_timing);
     VDPStatus[2]|=0x80;
 
@@ -664,12 +754,30 @@ void HmmvEngine(void)
   register int ADX=MMC.ADX;
   register int ANX=MMC.ANX;
   register byte CL=MMC.CL;
+  register byte SM=ScrMode-5;
+  register byte *P;
   register int cnt;
   register int delta;
+  register int N;
+  register int done=0;
  
   delta = GetVdpTimingValue(hmmv_timing);
   cnt = VdpOpsCnt;
 
+  /* Fill whole rows at once while they fit in the time slice */
+  while (SM<4 && (N=VDPSpan(ADX, TX, MMC.MX, ANX))>0 && cnt-N*delta>0) {
+    P=VDP_VRMP(SM, ADX, DY);
+    memset(TX>0? P:P-N+1, CL, N);
+    cnt-=N*delta;
+    if (!(--NY&1023) || (DY+=TY)==-1) {
+      done=1;
+      break;
+    }
+    ADX=DX;
+    ANX=NX;
+  }
+
+  if (!done)
   switch (ScrMode) {
     case 5: pre_loop *VDP_VRMP5(ADX, DY) = CL; post__x_y(256)
             break;
@@ -681,6 +789,8 @@ void HmmvEngine(void)
             break;
   }
 
+  VDPTouch(ScrMode-5, MMC.DY, DY, TY);
+
   if ((VdpOpsCnt=cnt)>0) {
     /* Command execution done */
     VDPStatus[2]&=0xFE;
@@ -716,12 +826,31 @@ void HmmmEngine(void)
   register int ASX=MMC.ASX;
   register int ADX=MMC.ADX;
   register int ANX=MMC.ANX;
+  register byte SM=ScrMode-5;
   register int cnt;
   register int delta;
+  register int N;
+  register int done=0;
  
   delta = GetVdpTimingValue(hmmm_timing);
   cnt = VdpOpsCnt;
 
+  /* Copy whole rows at once while they fit in the time slice */
+  while (SM<4
+      && (N=VDPSpan(ADX, TX, MMC.MX, VDPSpan(ASX, TX, MMC.MX, ANX)))>0
+      && cnt-N*delta>0) {
+    VDPCopySpan(VDP_VRMP(SM, ADX, DY), VDP_VRMP(SM, ASX, SY), N, TX);
+    cnt-=N*delta;
+    if (!(--NY&1023) || (SY+=TY)==-1 || (DY+=TY)==-1) {
+      done=1;
+      break;
+    }
+    ASX=SX;
+    ADX=DX;
+    ANX=NX;
+  }
+
+  if (!done)
   switch (ScrMode) {
     case 5: pre_loop *VDP_VRMP5(ADX, DY) = *VDP_VRMP5(ASX, SY); post_xxyy(256)
             break;
@@ -733,6 +862,8 @@ void HmmmEngine(void)
             break;
   }
 
+  VDPTouch(ScrMode-5, MMC.DY, DY, TY);
+
   if ((VdpOpsCnt=cnt)>0) {
     /* Command execution done */
     VDPStatus[2]&=0xFE;
@@ -773,12 +904,27 @@ void YmmmEngine(void)
   register int TY=MMC.TY;
   register int NY=MMC.NY;
   register int ADX=MMC.ADX;
+  register byte SM=ScrMode-5;
   register int cnt;
   register int delta;
+  register int N;
+  register int done=0;
  
   delta = GetVdpTimingValue(ymmm_timing);
   cnt = VdpOpsCnt;
 
+  /* Copy whole rows at once while they fit in the time slice */
+  while (SM<4 && (N=VDPSpan(ADX, TX, MMC.MX, MMC.MX))>0 && cnt-N*delta>0) {
+    VDPCopySpan(VDP_VRMP(SM, ADX, DY), VDP_VRMP(SM, ADX, SY), N, TX);
+    cnt-=N*delta;
+    if (!(--NY&1023) || (SY+=TY)==-1 || (DY+=TY)==-1) {
+      done=1;
+      break;
+    }
+    ADX=DX;
+  }
+
+  if (!done)
   switch (ScrMode) {
     case 5: pre_loop *VDP_VRMP5(ADX, DY) = *VDP_VRMP5(ADX, SY); post__xyy(256)
             break;
@@ -790,6 +936,8 @@ void YmmmEngine(void)
             break;
   }
 
+  VDPTouch(ScrMode-5, MMC.DY, DY, TY);
+
   if ((VdpOpsCnt=cnt)>0) {
     /* Command execution done */
     VDPStatus[2]&=0xFE;
@@ -824,6 +972,7 @@ void HmmcEngine(void)
   if ((VDPStatus[2]&0x80)!=0x80) {
 
     *VDP_VRMP(ScrMode-5, MMC.ADX, MMC.DY)=VDP[44];
+    VDPTouch(ScrMode-5, MMC.DY, MMC.DY, 1);
     VdpOpsCnt-=GetVdpTimingValue(hmmv_timing);
     VDPStatus[2]|=0x80;
 
@@ -944,6 +1093,7 @@ byte VDPDraw(byte Op)
                VDP[38]+((int)VDP[39]<<8),
                VDP[44],
                Op&0x0F);
+      VDPTouch(SM, VDP[38]+((int)VDP[39]<<8), VDP[38]+((int)VDP[39]<<8), 1);
       return 1;
     case CM_SRCH:
       VdpEngine=SrchEngine;
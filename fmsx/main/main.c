@@ -63,12 +63,30 @@ static const char *BiosFiles[] = {
     // "KANJI.ROM",
 };
 
-static inline void SubmitFrame(void)
+static inline void SubmitFrame(bool partial)
 {
     int crop_v = CropPicture ? (ScanLines212 ? 8 : 18) : 0;
     currentUpdate->offset = crop_v * currentUpdate->stride;
     currentUpdate->height = HEIGHT - crop_v * 2;
-    rg_display_submit(currentUpdate, 0);
+
+    if (!partial)
+    {
+        rg_display_submit(currentUpdate, 0);
+        return;
+    }
+
+    // Rows of the buffer that the line cache left untouched since the previous frame. We use the 16bpp
+    // drivers (see InitMachine), FirstLine_16 is where RefreshBorder put line 0. Line 0 paints the top
+    // border and is always drawn, the last line also paints the bottom border.
+    uint32_t dirty_lines[(HEIGHT + 31) / 32] = {0};
+    int last_line = (ScanLines212 ? 212 : 192) - 1;
+    for (int row = crop_v; row < HEIGHT - crop_v; ++row)
+    {
+        int line = RG_MIN(row - FirstLine_16, last_line);
+        if (line <= 0 || !CleanLines[line])
+            dirty_lines[(row - crop_v) >> 5] |= 1u << ((row - crop_v) & 31);
+    }
+    rg_display_submit_lines(currentUpdate, dirty_lines, 0);
 }
 
 int ProcessEvents(int Wait)
@@ -108,6 +126,7 @@ int ProcessEvents(int Wait)
         rg_audio_set_mute(true);
         MenuMSX();
         rg_audio_set_mute(false);
+        InvalidateLines();
         rg_input_wait_for_key(RG_KEY_ANY, false, 500);
         InMenu = 0;
     }
@@ -206,6 +225,9 @@ int InitMachine(void)
     SetScreenDepth(NormScreen.D);
     SetVideo(&NormScreen, 0, 0, WIDTH, HEIGHT);
 
+    // Unchanged lines are not redrawn, the line cache needs to know we alternate between our buffers
+    ScreenBuffers = RG_COUNT(updates);
+
     for (int J = 0; J < 80; J++)
         SetColor(J, 0, 0, 0);
 
@@ -242,9 +264,12 @@ void SetColor(byte N, byte R, byte G, byte B)
 void PutImage(void)
 {
     if (InKeyboard)
+    {
         DrawKeyboard(&NormScreen, KBDKeys[KeyboardRow][KeyboardCol]);
+        InvalidateLines();
+    }
 
-    SubmitFrame();
+    SubmitFrame(!InKeyboard);
     currentUpdate = updates[currentUpdate == updates[0]];
     NormScreen.Data = currentUpdate->data;
     XBuf = NormScreen.Data;
@@ -258,10 +283,24 @@ unsigned int Joystick(void)
 
 void Keyboard(void)
 {
+    // Emulation doesn't map to a scope here, close the previous frame's and open the next.
+    // PutImage's submit will nest in it.
+    static rg_stage_zone_t emulate_stage;
+    if (emulate_stage.start)
+        rg_system_stage_end(&emulate_stage);
+
     // Keyboard() is a convenient place to do our vsync stuff :)
     rg_system_tick(rg_system_timer() - FrameStartTime);
     FrameStartTime = rg_system_timer();
 
+#ifdef RG_ENABLE_PROFILING
+    static rg_profile_zone_t frame_zone;
+    if (frame_zone.name)
+        rg_profile_zone_end(&frame_zone);
+    frame_zone = rg_profile_zone_begin("frame");
+#endif
+    rg_system_stage_begin(&emulate_stage, RG_STAGE_EMULATE);
+
     if (PendingLoadSTA)
     {
         LoadSTA(PendingLoadSTA);
@@ -277,7 +316,7 @@ unsigned int Mouse(byte N)
 
 int ShowVideo(void)
 {
-    SubmitFrame();
+    SubmitFrame(false);
     rg_system_tick(0);
     return 1;
 }
@@ -336,7 +375,7 @@ void PlayAllSound(int uSec)
 {
     int64_t start = rg_system_timer();
     unsigned int samples = 2 * uSec * AUDIO_SAMPLE_RATE / 1000000;
-    rg_task_send(audioQueue, &(rg_task_msg_t){.dataInt = samples});
+    rg_task_send(audioQueue, &(rg_task_msg_t){.dataInt = samples}, -1);
     FrameStartTime += rg_system_timer() - start;
 }
 
@@ -372,7 +411,9 @@ static void event_handler(int event, void *arg)
 {
     if (event == RG_EVENT_REDRAW)
     {
-        SubmitFrame();
+        // The display now shows the frame being drawn, the next one can't be compared to the previous
+        SubmitFrame(false);
+        InvalidateLines();
     }
 }
 
@@ -413,10 +454,10 @@ static void audioTask(void *arg)
 {
     RG_LOGI("task started");
     rg_task_msg_t msg;
-    while (rg_task_peek(&msg))
+    while (rg_task_peek(&msg, -1))
     {
         RenderAndPlayAudio(msg.dataInt);
-        rg_task_receive(&msg);
+        rg_task_receive(&msg, -1);
     }
 }
 
@@ -100,6 +100,11 @@ void load_cartridge()
 
     set_region();
 
+#if M68K_BLOCK_CACHE
+    // Blocks decoded from the previous cartridge are stale
+    m68k_flush_blocks();
+#endif
+
 }
 #else
 
@@ -151,6 +156,11 @@ void load_cartridge(unsigned char *buffer, size_t size)
 
 
     set_region();
+
+#if M68K_BLOCK_CACHE
+    // Blocks decoded from the previous cartridge are stale
+    m68k_flush_blocks();
+#endif
 }
 
 #endif
@@ -508,6 +518,7 @@ static inline void gwenesis_bus_write_memory_8(unsigned int address,
     return;
 
   case RAM_ADDR:
+    m68k_ram_written(address, 1);
     WRITE8RAM(address, value);
     return;
 
@@ -568,6 +579,7 @@ static inline void gwenesis_bus_write_memory_16(unsigned int address,
     return;
 
   case RAM_ADDR:
+    m68k_ram_written(address, 2);
     WRITE16RAM(address, value);
     return;
 
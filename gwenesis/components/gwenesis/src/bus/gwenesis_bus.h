@@ -43,7 +43,8 @@ __license__ = "GPLv3"
 #define GWENESIS_REFRESH_RATE_PAL 50
 #define GWENESIS_AUDIO_FREQ_PAL 52781
 
-#define GWENESIS_AUDIO_ACCURATE 1
+// 0: line accurate, 1: cycle accurate, 2: cycle accurate with the frame rendered at once (see ym2612.c)
+#define GWENESIS_AUDIO_ACCURATE 2
 
 #define Z80_FREQ_DIVISOR 14     // Frequency divisor to Z80 clock
 #define VDP_CYCLES_PER_LINE 3420// VDP Cycles per Line
@@ -42,7 +42,9 @@
 /* ======================================================================== */
 
 #include <setjmp.h>
+#include <rg_idle.h>
 #include "macros.h"
+#include "m68kconf.h"
 #ifdef HOOK_CPU
 #include "cpuhook.h"
 #endif
@@ -187,6 +189,22 @@
 
 #endif
 
+#if M68K_BLOCK_CACHE
+/* One flag per 64 bytes of RAM holding instructions of the block cache */
+extern unsigned char m68k_code_lines[];
+void m68k_flush_ram_blocks(void);
+/* ROM blocks are never checked again, this must be called whenever what the CPU sees below 0x800000 */
+/* changes: new cartridge, and bank switching or SRAM mapping if a mapper is ever emulated. */
+void m68k_flush_blocks(void);
+#define m68k_ram_written(A, SIZE) \
+  do { \
+    if (m68k_code_lines[((A) & 0xFFFF) >> 6] | m68k_code_lines[(((A) + (SIZE) - 1) & 0xFFFF) >> 6]) \
+      m68k_flush_ram_blocks(); \
+  } while (0)
+#else
+#define m68k_ram_written(A, SIZE)
+#endif
+
 #define m68k_read_immediate_16(A) ( ( (A) & 0x800000) ? FETCH16RAM((A)) : FETCH16ROM((A)) )
 #define m68k_read_immediate_32(A) ( ( (A) & 0x800000) ? FETCH32RAM((A)) : FETCH32ROM((A)) )
 
@@ -315,6 +333,7 @@ typedef struct
   cpu_memory_map memory_map[256]; /* memory mapping */
 
   cpu_idle_t poll;      /* polling detection */
+  rg_idle_t idle;       /* idle loop fast-forward, idle.cycles + cycles never goes back */
 
   uint cycles;          /* current master cycle count */ 
   uint cycle_end;       /* aimed master cycle count for current execution frame */
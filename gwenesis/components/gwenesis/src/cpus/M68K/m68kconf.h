@@ -72,6 +72,15 @@
  */
 #define M68K_CHECK_PC_ADDRESS_ERROR OPT_OFF
 
+/* If ON, straight-line blocks of decoded instructions (handler, opcode and
+ * cycles) are cached by address so that loops skip the opcode fetch and the
+ * jump table lookups, which live in flash on the ESP32. Blocks decoded from
+ * RAM are dropped as soon as the RAM they cover is written to.
+ */
+#ifndef M68K_BLOCK_CACHE
+#define M68K_BLOCK_CACHE            OPT_OFF
+#endif
+
 
 /* ----------------------------- COMPATIBILITY ---------------------------- */
 
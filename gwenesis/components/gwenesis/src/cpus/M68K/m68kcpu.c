@@ -19,6 +19,7 @@ extern int vdp_68k_irq_ack(int int_level);
   #endif
 #endif
 
+#include <string.h>
 #include "m68kconf.h"
 #include "m68kcpu.h"
 #include "m68kops.h"
@@ -36,6 +37,31 @@ static int irq_latency;
 
 m68ki_cpu_core m68k;
 
+#if M68K_BLOCK_CACHE
+#define BLOCK_CACHE_SIZE  128  /* Number of blocks, direct mapped by start address */
+#define BLOCK_MAX_LENGTH  16   /* Maximum number of instructions per block */
+
+typedef struct
+{
+  void (*handler)(void);
+  uint pc;
+  uint16 ir;
+  uint16 cycles;
+} m68ki_decoded_t;
+
+typedef struct
+{
+  uint pc;      /* Address of the first instruction, odd when the entry is empty */
+  uint gen;     /* 0 for ROM blocks, value of ram_gen when a RAM block was decoded */
+  uint length;
+  m68ki_decoded_t ops[BLOCK_MAX_LENGTH];
+} m68ki_block_t;
+
+static m68ki_block_t blocks[BLOCK_CACHE_SIZE];
+static uint ram_gen = 1;
+unsigned char m68k_code_lines[0x10000 >> 6];
+#endif
+
 
 /* ======================================================================== */
 /* =============================== CALLBACKS ============================== */
@@ -259,6 +285,96 @@ void m68k_set_irq_delay(unsigned int int_level)
   m68ki_check_interrupts(); /* Level triggered (IRQ) */
 }
 
+/* Short backward branches with unchanged registers and no writes are loops waiting for */
+/* the next line or interrupt, whole iterations are skipped up to the end of the slice */
+static void m68ki_idle_check(uint pc)
+{
+  uint64_t state = m68ki_get_sr();
+  for (int i = 0; i < 16; i++)
+    state = (state ^ REG_DA[i]) * 0x100000001B3ull;
+
+  m68ki_cpu.cycles += rg_idle_branch(&m68ki_cpu.idle, pc, REG_PC, state,
+                                     m68ki_cpu.idle.cycles + m68ki_cpu.cycles,
+                                     m68ki_cpu.cycle_end - m68ki_cpu.cycles);
+}
+
+#if M68K_BLOCK_CACHE
+void m68k_flush_ram_blocks(void)
+{
+  /* Invalidates every RAM block at once, writes to RAM code are rare enough */
+  if (++ram_gen == 0)
+    ram_gen = 1;
+  memset(m68k_code_lines, 0, sizeof(m68k_code_lines));
+}
+
+void m68k_flush_blocks(void)
+{
+  for (int i = 0; i < BLOCK_CACHE_SIZE; i++)
+    blocks[i].pc = 1;
+  m68k_flush_ram_blocks();
+}
+
+/* Executes the block starting at the current PC, decoding it first if it isn't cached. */
+/* Replay stops as soon as the PC leaves the recorded path (branch taken, exception...). */
+static void m68ki_run_block(uint cycles)
+{
+  uint start = REG_PC;
+  uint gen = (start & 0x800000) ? ram_gen : 0;
+  m68ki_block_t *block = &blocks[(start >> 1) % BLOCK_CACHE_SIZE];
+  m68ki_decoded_t *op = block->ops;
+
+  if (block->pc == start && block->gen == gen)
+  {
+    m68ki_decoded_t *end = op + block->length;
+    do
+    {
+      uint pc = op->pc;
+      REG_IR = op->ir;
+      REG_PC = pc + 2;
+      op->handler();
+      USE_CYCLES(op->cycles);
+
+      if (pc - REG_PC <= RG_IDLE_MAX_LENGTH)
+        m68ki_idle_check(pc);
+    }
+    while (++op < end && REG_PC == op->pc && m68k.cycles < cycles && (!gen || gen == ram_gen));
+    return;
+  }
+
+  block->pc = start;
+  block->gen = gen;
+  block->length = 0;
+
+  while (1)
+  {
+    uint pc = REG_PC;
+    REG_IR = m68ki_read_imm_16();
+    op->handler = m68ki_instruction_jump_table[REG_IR];
+    op->pc = pc;
+    op->ir = REG_IR;
+    op->cycles = CYC_INSTRUCTION[REG_IR];
+    block->length++;
+
+    /* Instructions are at most 10 bytes long */
+    if (gen)
+    {
+      m68k_code_lines[(pc & 0xFFFF) >> 6] = 1;
+      m68k_code_lines[((pc + 9) & 0xFFFF) >> 6] = 1;
+    }
+
+    op->handler();
+    USE_CYCLES(op->cycles);
+
+    if (pc - REG_PC <= RG_IDLE_MAX_LENGTH)
+      m68ki_idle_check(pc);
+
+    /* End the block on anything that isn't a fall through to the next instruction */
+    if (++op == block->ops + BLOCK_MAX_LENGTH || REG_PC - pc - 2 > 8 || m68k.cycles >= cycles || (gen && gen != ram_gen))
+      break;
+  }
+}
+#endif
+
 void m68k_run(unsigned int cycles) 
 {
     //  printf("m68K_run current_cycles=%d add=%d STOP=%x\n",m68k.cycles,cycles,CPU_STOPPED);
@@ -303,7 +419,11 @@ void m68k_run(unsigned int cycles)
       cpu_hook(HOOK_M68K_E, 0, REG_PC, 0);
 #endif
 
+#if M68K_BLOCK_CACHE
+    m68ki_run_block(cycles);
+#else
     /* Decode next instruction */
+    uint pc = REG_PC;
     REG_IR = m68ki_read_imm_16();
 
 //    printf("PC=%x IR=%x CYCLES=%d \n",m68k.pc,REG_IR,CYC_INSTRUCTION[REG_IR]);
@@ -312,6 +432,10 @@ void m68k_run(unsigned int cycles)
     m68ki_instruction_jump_table[REG_IR]();
     USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
 
+    if (pc - REG_PC <= RG_IDLE_MAX_LENGTH)
+      m68ki_idle_check(pc);
+#endif
+
     /* Trace m68k_exception, if necessary */
     m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
   }
@@ -349,6 +473,10 @@ void m68k_init(void)
   m68k.cycle_ratio = 1 << M68K_OVERCLOCK_SHIFT;
 #endif
 
+#if M68K_BLOCK_CACHE
+  m68k_flush_blocks();
+#endif
+
 #if M68K_EMULATE_INT_ACK == OPT_ON
   m68k_set_int_ack_callback(NULL);
 #endif
@@ -401,6 +529,10 @@ void m68k_pulse_reset(void)
 #endif
 
   USE_CYCLES(CYC_EXCEPTION[EXCEPTION_RESET]);
+  rg_idle_reset(&m68ki_cpu.idle);
+#if M68K_BLOCK_CACHE
+  m68k_flush_blocks();
+#endif
 }
 
 void m68k_pulse_halt(void)
@@ -448,6 +580,10 @@ void gwenesis_m68k_load_state() {
   m68k.cycles = saveGwenesisStateGet(state, "m68k_cycles");
   m68k.int_level = saveGwenesisStateGet(state, "m68k_int_level");
   m68k.stopped = saveGwenesisStateGet(state, "m68k_stopped");
+  rg_idle_reset(&m68k.idle);
+#if M68K_BLOCK_CACHE
+  m68k_flush_blocks();
+#endif
 
 }
 
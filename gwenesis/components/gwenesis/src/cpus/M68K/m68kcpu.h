@@ -863,6 +863,7 @@ INLINE uint m68ki_read_8(uint address)
 
 	if (ADDRESS_68K(address) <  0x800000) return FETCH8ROM(ADDRESS_68K(address));
 	if (ADDRESS_68K(address) >= 0xFF0000) return FETCH8RAM(ADDRESS_68K(address));
+	rg_idle_reset(&m68ki_cpu.idle); /* VDP status and HV counter change within a line */
 	return m68k_read_memory_8(ADDRESS_68K(address));
 
 }
@@ -874,6 +875,7 @@ INLINE uint m68ki_read_16(uint address)
  
  	if (ADDRESS_68K(address) <  0x800000) return FETCH16ROM(ADDRESS_68K(address));
 	if (ADDRESS_68K(address) >= 0xFF0000) return FETCH16RAM(ADDRESS_68K(address));
+	rg_idle_reset(&m68ki_cpu.idle); /* VDP status and HV counter change within a line */
 	return m68k_read_memory_16(ADDRESS_68K(address));
 
 }
@@ -884,6 +886,7 @@ INLINE uint m68ki_read_32(uint address)
   m68ki_set_fc(FLAG_S | m68ki_get_address_space()) /* auto-disable (see m68kcpu.h) */
 	if (ADDRESS_68K(address) <  0x800000) return FETCH32ROM(ADDRESS_68K(address));
 	if (ADDRESS_68K(address) >= 0xFF0000) return FETCH32RAM(ADDRESS_68K(address));
+	rg_idle_reset(&m68ki_cpu.idle); /* VDP status and HV counter change within a line */
 	return m68k_read_memory_32(ADDRESS_68K(address));
 }
 
@@ -891,7 +894,9 @@ INLINE void m68ki_write_8(uint address, uint value)
 {
 
   m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_DATA) /* auto-disable (see m68kcpu.h) */
+  rg_idle_reset(&m68ki_cpu.idle);
         if (ADDRESS_68K(address) >= 0xFF0000) {
+          m68k_ram_written(address, 1);
           WRITE8RAM(ADDRESS_68K(address), value);
         } else
         m68k_write_memory_8(ADDRESS_68K(address), value);
@@ -901,7 +906,9 @@ INLINE void m68ki_write_16(uint address, uint value)
 {
 
   m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_DATA) /* auto-disable (see m68kcpu.h) */
+  rg_idle_reset(&m68ki_cpu.idle);
         if (ADDRESS_68K(address) >= 0xFF0000) {
+          m68k_ram_written(address, 2);
           WRITE16RAM(ADDRESS_68K(address), value);
         } else
 	m68k_write_memory_16(ADDRESS_68K(address), value);
@@ -911,7 +918,9 @@ INLINE void m68ki_write_32(uint address, uint value)
 {
 
   m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_DATA) /* auto-disable (see m68kcpu.h) */
+  rg_idle_reset(&m68ki_cpu.idle);
         if (ADDRESS_68K(address) >= 0xFF0000) {
+          m68k_ram_written(address, 4);
           WRITE32RAM(ADDRESS_68K(address), value);
         } else
 	m68k_write_memory_32(ADDRESS_68K(address), value);
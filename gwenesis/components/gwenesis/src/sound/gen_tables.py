@@ -0,0 +1,73 @@
+import math, os, re, sys
+
+# This script should be run to update ym2612_tables.h when the table formulas in ym2612.c change.
+# The math is identical to the original init_tables(), build with YM2612_CHECK_TABLES to compare
+# the generated tables against the ones computed at runtime on the target.
+
+os.chdir(sys.path[0])
+
+ENV_STEP = 128.0 / 1024
+SIN_LEN = 1024
+TL_RES_LEN = 256
+TL_TAB_LEN = 13 * 2 * TL_RES_LEN
+
+# Linear Power Table
+tl_tab = [0] * TL_TAB_LEN
+for x in range(TL_RES_LEN):
+    m = math.floor((1 << 16) / math.pow(2, (x + 1) * (ENV_STEP / 4.0) / 8.0))
+    n = int(m) >> 4
+    n = (n >> 1) + 1 if n & 1 else n >> 1
+    n <<= 2
+    tl_tab[x * 2 + 0] = n
+    tl_tab[x * 2 + 1] = -n
+    for i in range(1, 13):
+        tl_tab[x * 2 + 0 + i * 2 * TL_RES_LEN] = n >> i
+        tl_tab[x * 2 + 1 + i * 2 * TL_RES_LEN] = -(n >> i)
+
+# Logarithmic Sinus table
+sin_tab = [0] * SIN_LEN
+for i in range(SIN_LEN):
+    m = math.sin(((i * 2) + 1) * math.pi / SIN_LEN)
+    if m > 0.0:
+        o = 8 * math.log(1.0 / m) / math.log(2)
+    else:
+        o = 8 * math.log(-1.0 / m) / math.log(2)
+    o = o / (ENV_STEP / 4)
+    n = int(2.0 * o)
+    n = (n >> 1) + 1 if n & 1 else n >> 1
+    sin_tab[i] = n * 2 + (0 if m >= 0.0 else 1)
+
+# LFO PM modulation table, built from lfo_pm_output in ym2612.c (GW_TARGET layout)
+with open("ym2612.c", "r") as f:
+    source = f.read()
+body = re.search(r"lfo_pm_output\[7\*8\]\[8\]\s*=\s*\{(.*?)\n\};", source, re.S).group(1)
+body = re.sub(r"/\*.*?\*/", "", body, flags=re.S)
+values = [int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", body)]
+lfo_pm_output = [values[i * 8 : i * 8 + 8] for i in range(7 * 8)]
+
+lfo_pm_table = [0] * (128 * 8 * 16)
+for i in range(8):
+    for fnum in range(128):
+        for step in range(8):
+            value = 0
+            for bit in range(7):
+                if fnum & (1 << bit):
+                    value = (value + lfo_pm_output[bit * 8 + i][step]) & 0xFF
+            lfo_pm_table[(fnum * 16 * 8) + (i * 16) + step + 0] = value
+            lfo_pm_table[(fnum * 16 * 8) + (i * 16) + (step ^ 7) + 8] = value
+
+
+def table(ctype, name, data, per_line):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append("  " + ",".join("%d" % v for v in data[i : i + per_line]) + ",")
+    return "static const %s %s[%d] = {\n%s\n};\n" % (ctype, name, len(data), "\n".join(lines))
+
+
+output = "// Generated by gen_tables.py, do not edit\n\n"
+output += table("INT16", "tl_tab", tl_tab, 16) + "\n"
+output += table("UINT16", "sin_tab", sin_tab, 16) + "\n"
+output += "#if GW_TARGET\n" + table("UINT8", "lfo_pm_table", lfo_pm_table, 32) + "#endif\n"
+
+with open("ym2612_tables.h", "w", newline="") as f:
+    f.write(output)
@@ -71,6 +71,12 @@ static const int PSGVolumeValues[16] = {
 
 static SN76489_Context gwenesis_SN76489;
 
+#if GWENESIS_AUDIO_ACCURATE == 2
+static void gwenesis_SN76489_wait(void);
+#else
+#define gwenesis_SN76489_wait()
+#endif
+
 void gwenesis_SN76489_Init( int PSGClockValue, int SamplingRate,int freq_divisor)
 {
     gwenesis_SN76489.dClock=(float)PSGClockValue/16/SamplingRate;
@@ -83,6 +89,8 @@ void gwenesis_SN76489_Reset()
 {
     int i;
 
+    gwenesis_SN76489_wait();
+
     for(i = 0; i <= 3; i++)
     {
         /* Initialise PSG state */
@@ -205,6 +213,110 @@ static inline void gwenesis_SN76489_Update(INT16 *buffer, int length)
 }
 /* SN76589 execution */
 extern int scan_line;
+#if GWENESIS_AUDIO_ACCURATE == 2
+/* Batched mode: writes are queued with the sample they apply at and the */
+/* frame is rendered at once, see ym2612.c                               */
+/* PSG music is well under a hundred writes per frame, a frame that goes */
+/* over (PSG sample playback) is rendered early on the emulation task.   */
+#define SN76489_QUEUE_LENGTH 256
+
+typedef struct
+{
+    uint32 writes[SN76489_QUEUE_LENGTH];  /* sample << 8 | data */
+    int count;
+    int start;          /* first sample not rendered yet */
+    int length;         /* samples in the frame, once closed */
+    int16 *buffer;
+} SN76489_Frame;
+
+static SN76489_Frame sn76489_frames[2];
+static SN76489_Frame *sn76489_frame = &sn76489_frames[0];      /* frame being recorded */
+static SN76489_Frame *sn76489_pending = NULL;         /* closed frame, not rendered yet */
+static void (*sn76489_render_wait)(void);             /* set when frames are rendered by another task */
+
+static void gwenesis_SN76489_write_data(int data);
+
+/* wait until the chip is no longer used by gwenesis_SN76489_render_frame */
+static void gwenesis_SN76489_wait(void)
+{
+    if (!__atomic_load_n(&sn76489_pending, __ATOMIC_ACQUIRE))
+        return;
+    if (sn76489_render_wait)
+        sn76489_render_wait();
+    /* not handed to the render task yet (or there is none): render it here */
+    gwenesis_SN76489_render_frame();
+}
+
+void gwenesis_SN76489_set_render_wait(void (*wait)(void))
+{
+    sn76489_render_wait = wait;
+}
+
+static void gwenesis_SN76489_sync(int target)
+{
+    if (sn76489_clock >= target)
+        return;
+
+    int sn76489_prev_index = sn76489_index;
+    sn76489_index += (target - sn76489_clock) / gwenesis_SN76489.divisor;
+    if (sn76489_index > sn76489_prev_index)
+        sn76489_clock = sn76489_index * gwenesis_SN76489.divisor;
+    else
+        sn76489_index = sn76489_prev_index;
+}
+
+static void gwenesis_SN76489_render_writes(SN76489_Frame *frame, int end)
+{
+    int pos = frame->start;
+
+    for (int i = 0; i < frame->count; i++)
+    {
+        int index = frame->writes[i] >> 8;
+        if (index > pos) {
+            gwenesis_SN76489_Update(frame->buffer + pos, index - pos);
+            pos = index;
+        }
+        gwenesis_SN76489_write_data(frame->writes[i] & 0xff);
+    }
+    if (end > pos)
+        gwenesis_SN76489_Update(frame->buffer + pos, end - pos);
+
+    frame->count = 0;
+    frame->start = end;
+}
+
+void gwenesis_SN76489_begin_frame(int16 *buffer)
+{
+    sn76489_frame->buffer = buffer;
+    sn76489_frame->count = 0;
+    sn76489_frame->start = 0;
+}
+
+void gwenesis_SN76489_end_frame(int target)
+{
+    gwenesis_SN76489_sync(target);
+    gwenesis_SN76489_wait();
+    sn76489_frame->length = sn76489_index;
+    __atomic_store_n(&sn76489_pending, sn76489_frame, __ATOMIC_RELEASE);
+    sn76489_frame = (sn76489_frame == &sn76489_frames[0]) ? &sn76489_frames[1] : &sn76489_frames[0];
+}
+
+void gwenesis_SN76489_render_frame(void)
+{
+    SN76489_Frame *frame = __atomic_load_n(&sn76489_pending, __ATOMIC_ACQUIRE);
+
+    if (frame) {
+        gwenesis_SN76489_render_writes(frame, frame->length);
+        __atomic_store_n(&sn76489_pending, NULL, __ATOMIC_RELEASE);
+    }
+}
+
+void gwenesis_SN76489_run(int target) {
+    gwenesis_SN76489_end_frame(target);
+    gwenesis_SN76489_render_frame();
+}
+
+#else
 void gwenesis_SN76489_run(int target) {
  
 if ( sn76489_clock >= target) return;
@@ -218,10 +330,26 @@ if ( sn76489_clock >= target) return;
     sn76489_index = sn76489_prev_index;
   }
 }
+#endif
 void gwenesis_SN76489_Write(int data, int target)
 {
+#if GWENESIS_AUDIO_ACCURATE == 2
+  gwenesis_SN76489_sync(target);
+
+  /* queue is full: render what we have so far */
+  if (sn76489_frame->count == SN76489_QUEUE_LENGTH) {
+    gwenesis_SN76489_wait();
+    gwenesis_SN76489_render_writes(sn76489_frame, sn76489_index);
+  }
+  sn76489_frame->writes[sn76489_frame->count++] = (sn76489_index << 8) | (data & 0xff);
+}
+
+static void gwenesis_SN76489_write_data(int data)
+{
+#else
   if (GWENESIS_AUDIO_ACCURATE == 1)
     gwenesis_SN76489_run(target);
+#endif
 
   if (data & 0x80) {
     /* Latch/data byte  %1 cc t dddd */
@@ -255,6 +383,7 @@ void gwenesis_SN76489_Write(int data, int target)
 }
 
 void gwenesis_sn76489_save_state() {
+  gwenesis_SN76489_wait();
   SaveState* state;
   state = saveGwenesisStateOpenForWrite("sn76489");
   saveGwenesisStateSetBuffer(state, "gwenesis_SN76489", &gwenesis_SN76489, sizeof(gwenesis_SN76489));
@@ -262,6 +391,7 @@ void gwenesis_sn76489_save_state() {
 }
 
 void gwenesis_sn76489_load_state() {
+  gwenesis_SN76489_wait();
   SaveState* state = saveGwenesisStateOpenForRead("sn76489");
   saveGwenesisStateGetBuffer(state, "gwenesis_SN76489", &gwenesis_SN76489, sizeof(gwenesis_SN76489));
 
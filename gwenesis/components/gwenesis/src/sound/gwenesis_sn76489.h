@@ -67,6 +67,13 @@ int gwenesis_SN76489_GetContextSize(void);
 void gwenesis_SN76489_Write(int data, int target);
 void gwenesis_SN76489_run(int target);
 
+/* GWENESIS_AUDIO_ACCURATE == 2: the frame's writes are queued and rendered at once */
+void gwenesis_SN76489_begin_frame(int16 *buffer);
+void gwenesis_SN76489_end_frame(int target);
+void gwenesis_SN76489_render_frame(void);
+/* When frames are rendered by another task: blocks until it is done with the frames handed to it */
+void gwenesis_SN76489_set_render_wait(void (*wait)(void));
+
 void gwenesis_sn76489_save_state();
 void gwenesis_sn76489_load_state();
 
@@ -206,12 +206,12 @@ void ym_log(const char *subs, const char *fmt, ...) {
 *   TL_RES_LEN - sinus resolution (X axis)
 */
 #define TL_TAB_LEN (13*2*TL_RES_LEN)
-static signed int tl_tab[TL_TAB_LEN];
 
 #define ENV_QUIET    (TL_TAB_LEN>>3)
 
-/* sin waveform table in 'decibel' scale */
-static unsigned int sin_tab[SIN_LEN] ;
+/* tl_tab (linear power), sin_tab (sin waveform in 'decibel' scale) and lfo_pm_table are */
+/* precomputed by gen_tables.py so that they stay in flash instead of taking up RAM */
+#include "ym2612_tables.h"
 
 /* sustain level table (3dB per step) */
 /* bit0, bit1, bit2, bit3, bit4, bit5, bit6 */
@@ -430,6 +430,7 @@ static const UINT8 lfo_ams_depth_shift[4] = {8, 3, 1, 0};
    samples (32*432=13824; 32 because we store only a quarter of whole
             waveform in the table below)
 */
+#if defined(YM2612_CHECK_TABLES) || !GW_TARGET
 static const UINT8 lfo_pm_output[7*8][8]={
 /* 7 bits meaningful (of F-NUMBER), 8 LFO output levels per one depth (out of 32), 8 LFO depths */
 /* FNUM BIT 4: 000 0001xxxx */
@@ -503,11 +504,10 @@ static const UINT8 lfo_pm_output[7*8][8]={
 /* DEPTH 7 */ {0,   0,0x20,0x30,0x40,0x40,0x50,0x60},
 
 };
+#endif
 
 /* all 128 LFO PM waveforms */
-#if GW_TARGET
-static UINT8 lfo_pm_table[128*8*16];  /* 128 combinations of 7 bits meaningful (of F-NUMBER), 8 LFO depths, 32 LFO output levels per one depth */
-#else
+#if !GW_TARGET
 static INT32 lfo_pm_table[128*8*32] ;  /* 128 combinations of 7 bits meaningful (of F-NUMBER), 8 LFO depths, 32 LFO output levels per one depth */
 #endif
 
@@ -656,6 +656,16 @@ typedef struct
 /* emulated chip */
 static YM2612 ym2612;
 
+#if GWENESIS_AUDIO_ACCURATE == 2
+static void ym2612_wait(void);
+static void ym2612_timers_load(void);
+static void ym2612_timers_store(void);
+#else
+#define ym2612_wait()
+#define ym2612_timers_load()
+#define ym2612_timers_store()
+#endif
+
 /* current chip state */
 static INT32  m2,c1,c2;   /* Phase Modulation input for operators 2,3,4 */
 static INT32  mem;        /* one sample delay memory */
@@ -1837,15 +1847,17 @@ static void reset_channels(FM_CH *CH , int num )
   //printf("YM2612 reset channels\n");
 }
 
-/* initialize generic tables */
-static void init_tables(void)
+#ifdef YM2612_CHECK_TABLES
+/* Rebuilds the precomputed tables with the original double-precision math and reports */
+/* any difference, the target's libm must agree with the one used by gen_tables.py */
+static void check_tables(void)
 {
-  //printf("YM2612 init tables\n");
-  signed int d,i,x;
+  signed int i,x;
   signed int n;
   double o,m;
+  int errors = 0;
 
-  /* build Linear Power Table */
+  /* Linear Power Table */
   for (x=0; x<TL_RES_LEN; x++)
   {
     m = (1<<16) / pow(2,(x+1) * (ENV_STEP/4.0) / 8.0);
@@ -1864,24 +1876,22 @@ static void init_tables(void)
     n <<= 2;    /* 13 bits here (as in real chip) */
 
     /* 14 bits (with sign bit) */
-    tl_tab[ x*2 + 0 ] = n;
-    tl_tab[ x*2 + 1 ] = -tl_tab[ x*2 + 0 ];
 
     /* one entry in the 'Power' table use the following format, xxxxxyyyyyyyys with:            */
     /*        s = sign bit                                                                      */
     /* yyyyyyyy = 8-bits decimal part (0-TL_RES_LEN)                                            */
     /* xxxxx    = 5-bits integer 'shift' value (0-31) but, since Power table output is 13 bits, */
     /*            any value above 13 (included) would be discarded.                             */
-    for (i=1; i<13; i++)
+    for (i=0; i<13; i++)
     {
-      tl_tab[ x*2+0 + i*2*TL_RES_LEN ] =  tl_tab[ x*2+0 ]>>i;
-      tl_tab[ x*2+1 + i*2*TL_RES_LEN ] = -tl_tab[ x*2+0 + i*2*TL_RES_LEN ];
+      if (tl_tab[ x*2+0 + i*2*TL_RES_LEN ] != (n>>i) || tl_tab[ x*2+1 + i*2*TL_RES_LEN ] != -(n>>i))
+        errors++;
     }
   }
 
 # define M_PI		3.14159265358979323846	/* pi */
 
-  /* build Logarithmic Sinus table */
+  /* Logarithmic Sinus table */
   for (i=0; i<SIN_LEN; i++)
   {
     /* non-standard sinus */
@@ -1902,9 +1912,48 @@ static void init_tables(void)
       n = n>>1;
 
     /* 13-bits (8.5) value is formatted for above 'Power' table */
-    sin_tab[ i ] = n*2 + (m>=0.0? 0: 1 );
+    if (sin_tab[ i ] != n*2 + (m>=0.0? 0: 1 ))
+      errors++;
   }
 
+#if GW_TARGET
+  for(i = 0; i < 8; i++)
+  {
+    UINT8 fnum, step, value;
+    UINT32 bit_tmp;
+    for (fnum=0; fnum<128; fnum++)
+    {
+      for (step=0; step<8; step++)
+      {
+        value = 0;
+        for (bit_tmp=0; bit_tmp<7; bit_tmp++)
+        {
+          if (fnum & (1<<bit_tmp))
+            value += lfo_pm_output[bit_tmp * 8 + i][step];
+        }
+        if (lfo_pm_table[(fnum * 16 * 8) + (i * 16) + step + 0] != value ||
+            lfo_pm_table[(fnum * 16 * 8) + (i * 16) + (step ^ 7) + 8] != value)
+          errors++;
+      }
+    }
+  }
+#endif
+
+  printf("YM2612 tables check: %d errors\n", errors);
+}
+#endif
+
+/* initialize generic tables */
+static void init_tables(void)
+{
+  //printf("YM2612 init tables\n");
+  signed int d,i;
+
+#ifdef YM2612_CHECK_TABLES
+  check_tables();
+#endif
+
+#if !GW_TARGET
   /* build LFO PM modulation table */
   for(i = 0; i < 8; i++) /* 8 PM depths */
   {
@@ -1929,20 +1978,14 @@ static void init_tables(void)
           }
         }
         /* 32 steps for LFO PM (sinus) */
-
-#if GW_TARGET
-        lfo_pm_table[(fnum * 16 * 8) + (i * 16) + step + 0] = value;
-        lfo_pm_table[(fnum * 16 * 8) + (i * 16) + (step ^ 7) + 8] = value;
-
-#else
         lfo_pm_table[(fnum * 32 * 8) + (i * 32) + step + 0] = value;
         lfo_pm_table[(fnum * 32 * 8) + (i * 32) + (step ^ 7) + 8] = value;
         lfo_pm_table[(fnum * 32 * 8) + (i * 32) + step + 16] = -value;
         lfo_pm_table[(fnum * 32 * 8) + (i * 32) + (step ^ 7) + 24] = -value;
-#endif
       }
     }
   }
+#endif
 
   /* build DETUNE table */
   for (d = 0;d <= 3;d++)
@@ -1960,6 +2003,7 @@ static void init_tables(void)
 void YM2612Init(void) {
   static unsigned init_table_done = 0;
 
+  ym2612_wait();
   memset(&ym2612, 0, sizeof(YM2612));
   if (init_table_done == 0) {
     init_tables();
@@ -1974,6 +2018,8 @@ void YM2612ResetChip(void)
 
   int i;
 
+  ym2612_wait();
+
   ym2612.OPN.eg_timer     = 0;
   ym2612.OPN.eg_cnt       = 0;
 
@@ -2009,6 +2055,8 @@ void YM2612ResetChip(void)
     OPNWriteReg(i      ,0);
     OPNWriteReg(i|0x100,0);
   }
+
+  ym2612_timers_load();
 }
 
 /* YM2612 execution */
@@ -2148,6 +2196,211 @@ static inline void YM2612Update(int16_t *buffer, int length)
   INTERNAL_TIMER_B(length);
 }
 
+#if GWENESIS_AUDIO_ACCURATE == 2
+/* Batched mode: register writes are queued with the sample they apply at */
+/* and the whole frame is rendered in one pass by ym2612_render_frame,   */
+/* possibly on another core while the next frame is being emulated.      */
+/* The status register only depends on the timers, which are run ahead   */
+/* on a copy of the chip state so that reads see the same values as in   */
+/* cycle accurate mode.                                                  */
+/* A 26 kHz DAC stream selecting register 0x2A before every sample is    */
+/* ~870 writes per frame, FM music a few hundred. A frame that goes over */
+/* is rendered early on the emulation task, which is only slower.        */
+#define YM2612_QUEUE_LENGTH 1024
+
+typedef struct
+{
+  UINT32 writes[YM2612_QUEUE_LENGTH]; /* sample << 10 | port << 8 | value */
+  int count;
+  int start;        /* first sample not rendered yet */
+  int length;       /* samples in the frame, once closed */
+  int16_t *buffer;
+} YM2612_FRAME;
+
+static YM2612_FRAME ym2612_frames[2];
+static YM2612_FRAME *ym2612_frame = &ym2612_frames[0];  /* frame being recorded */
+static YM2612_FRAME *ym2612_pending = NULL;    /* closed frame, not rendered yet */
+static FM_ST ym2612_timers;                             /* timers state seen by the CPUs */
+static void (*ym2612_render_wait)(void);                /* set when frames are rendered by another task */
+
+static void ym2612_write_port(unsigned int a, unsigned int v);
+
+/* wait until the chip is no longer used by ym2612_render_frame */
+static void ym2612_wait(void)
+{
+  if (!__atomic_load_n(&ym2612_pending, __ATOMIC_ACQUIRE))
+    return;
+  if (ym2612_render_wait)
+    ym2612_render_wait();
+  /* not handed to the render task yet (or there is none): render it here */
+  ym2612_render_frame();
+}
+
+void ym2612_set_render_wait(void (*wait)(void))
+{
+  ym2612_render_wait = wait;
+}
+
+/* the chip state was reset or restored, restart the timers from it */
+static void ym2612_timers_load(void)
+{
+  ym2612_timers = ym2612.OPN.ST;
+}
+
+/* the chip only runs the timers for CSM, its status is out of date */
+static void ym2612_timers_store(void)
+{
+  ym2612.OPN.ST.status = ym2612_timers.status;
+  ym2612.OPN.ST.TAC = ym2612_timers.TAC;
+  ym2612.OPN.ST.TBC = ym2612_timers.TBC;
+}
+
+/* same as INTERNAL_TIMER_A/B on the timers copy */
+static void ym2612_timers_run(int length)
+{
+  FM_ST *st = &ym2612_timers;
+
+  if (st->mode & 0x01)
+  {
+    for (int i = 0; i < length; i++)
+    {
+      if (--st->TAC <= 0)
+      {
+        if (st->mode & 0x04)
+          st->status |= 0x01;
+        st->TAC = st->TAL;
+      }
+    }
+  }
+
+  if (st->mode & 0x02)
+  {
+    st->TBC -= length;
+    if (st->TBC <= 0)
+    {
+      if (st->mode & 0x08)
+        st->status |= 0x02;
+      if (st->TBL)
+        st->TBC += st->TBL;
+      else
+        st->TBC = st->TBL;
+    }
+  }
+}
+
+/* timers side of YM2612Write, see OPNWriteMode and set_timers */
+static void ym2612_timers_write(unsigned int a, unsigned int v)
+{
+  FM_ST *st = &ym2612_timers;
+
+  switch (a)
+  {
+    case 0:
+      st->address = v;
+      break;
+    case 2:
+      st->address = v | 0x100;
+      break;
+    default:
+      switch (st->address)
+      {
+        case 0x24:
+          st->TA = (st->TA & 0x03) | (((int)v) << 2);
+          st->TAL = 1024 - st->TA;
+          break;
+        case 0x25:
+          st->TA = (st->TA & 0x3fc) | (v & 3);
+          st->TAL = 1024 - st->TA;
+          break;
+        case 0x26:
+          st->TB = v;
+          st->TBL = (256 - v) << 4;
+          break;
+        case 0x27:
+          if ((v & 1) && !(st->mode & 1))
+            st->TAC = st->TAL;
+          if ((v & 2) && !(st->mode & 2))
+            st->TBC = st->TBL;
+          st->status &= (~v >> 4);
+          st->mode = v;
+          break;
+      }
+  }
+}
+
+/* advance the sample index (and the timers copy) up to target */
+static void ym2612_sync(int target)
+{
+  if (ym2612_clock >= target)
+    return;
+
+  int ym2612_prev_index = ym2612_index;
+  ym2612_index += (target - ym2612_clock) / ym2612.divisor;
+  if (ym2612_index > ym2612_prev_index) {
+    ym2612_timers_run(ym2612_index - ym2612_prev_index);
+    ym2612_clock = ym2612_index * ym2612.divisor;
+  } else {
+    ym2612_index = ym2612_prev_index;
+  }
+}
+
+/* render the queued writes of a frame up to sample end */
+static void ym2612_render_writes(YM2612_FRAME *frame, int end)
+{
+  int pos = frame->start;
+
+  for (int i = 0; i < frame->count; i++)
+  {
+    UINT32 w = frame->writes[i];
+    int index = w >> 10;
+    if (index > pos) {
+      YM2612Update(frame->buffer + pos, index - pos);
+      pos = index;
+    }
+    ym2612_write_port((w >> 8) & 3, w & 0xff);
+  }
+  if (end > pos)
+    YM2612Update(frame->buffer + pos, end - pos);
+
+  frame->count = 0;
+  frame->start = end;
+}
+
+/* start recording a frame, its samples will be rendered to buffer */
+void ym2612_begin_frame(int16_t *buffer)
+{
+  ym2612_frame->buffer = buffer;
+  ym2612_frame->count = 0;
+  ym2612_frame->start = 0;
+}
+
+/* close the frame at target, it must be rendered by ym2612_render_frame */
+/* before the end of the next one                                        */
+void ym2612_end_frame(int target)
+{
+  ym2612_sync(target);
+  ym2612_wait();
+  ym2612_frame->length = ym2612_index;
+  __atomic_store_n(&ym2612_pending, ym2612_frame, __ATOMIC_RELEASE);
+  ym2612_frame = (ym2612_frame == &ym2612_frames[0]) ? &ym2612_frames[1] : &ym2612_frames[0];
+}
+
+void ym2612_render_frame(void)
+{
+  YM2612_FRAME *frame = __atomic_load_n(&ym2612_pending, __ATOMIC_ACQUIRE);
+
+  if (frame) {
+    ym2612_render_writes(frame, frame->length);
+    __atomic_store_n(&ym2612_pending, NULL, __ATOMIC_RELEASE);
+  }
+}
+
+void ym2612_run( int target) {
+  ym2612_end_frame(target);
+  ym2612_render_frame();
+}
+
+#else
 void ym2612_run( int target) {
 
   if ( ym2612_clock >= target) {
@@ -2163,6 +2416,7 @@ void ym2612_run( int target) {
     ym2612_index = ym2612_prev_index;
   }
 }
+#endif
 
 /* ym2612 write */
 /* n = number  */
@@ -2172,11 +2426,27 @@ void YM2612Write(unsigned int a, unsigned int v,  int target)
 {
   ym_log(__FUNCTION__," %06x : %02x",a,v);
 
+  v &= 0xff;  /* adjust to 8 bit bus */
+
+#if GWENESIS_AUDIO_ACCURATE == 2
+  ym2612_sync(target);
+  ym2612_timers_write(a, v);
+
+  /* queue is full: render what we have so far */
+  if (ym2612_frame->count == YM2612_QUEUE_LENGTH) {
+    ym2612_wait();
+    ym2612_render_writes(ym2612_frame, ym2612_index);
+  }
+  ym2612_frame->writes[ym2612_frame->count++] = (ym2612_index << 10) | ((a & 3) << 8) | v;
+}
+
+static void ym2612_write_port(unsigned int a, unsigned int v)
+{
+#else
   //Sync
   if (GWENESIS_AUDIO_ACCURATE == 1)
     ym2612_run(target); 
-
-  v &= 0xff;  /* adjust to 8 bit bus */
+#endif
 
   switch( a )
   {
@@ -2222,11 +2492,17 @@ void YM2612Write(unsigned int a, unsigned int v,  int target)
 
 unsigned int YM2612Read(int target)
 {
+#if GWENESIS_AUDIO_ACCURATE == 2
+  ym2612_sync(target);
+  ym_log(__FUNCTION__, "%02x",ym2612_timers.status & 0xff);
+  return ym2612_timers.status & 0xff;
+#else
   // //Sync
   if (GWENESIS_AUDIO_ACCURATE == 1)
     ym2612_run(target);
   ym_log(__FUNCTION__, "%02x",ym2612.OPN.ST.status & 0xff);
   return ym2612.OPN.ST.status & 0xff;
+#endif
 }
 
 
@@ -2234,6 +2510,8 @@ void YM2612Config(unsigned char dac_bits) //,unsigned int AUDIO_FREQ_DIVISOR)
 {
    int i;
 
+  ym2612_wait();
+
   /* DAC precision (normally 9-bit on real hardware, implemented through simple 14-bit channel output bitmasking) */
   bitmask = ~((1 << (TL_BITS - dac_bits)) - 1);
 
@@ -2332,6 +2610,9 @@ int YM2612SaveContext(unsigned char *state)
 #endif
 
 void gwenesis_ym2612_save_state() {
+  ym2612_wait();
+  ym2612_timers_store();
+
   SaveState* state;
   state = saveGwenesisStateOpenForWrite("ym2612");
   saveGwenesisStateSetBuffer(state, "ym2612", &ym2612, sizeof(ym2612));
@@ -2345,6 +2626,7 @@ void gwenesis_ym2612_save_state() {
 }
 
 void gwenesis_ym2612_load_state() {
+  ym2612_wait();
   SaveState* state = saveGwenesisStateOpenForRead("ym2612");
   saveGwenesisStateGetBuffer(state, "ym2612", &ym2612, sizeof(ym2612));
   m2 = saveGwenesisStateGet(state, "m2");
@@ -2354,4 +2636,6 @@ void gwenesis_ym2612_load_state() {
   saveGwenesisStateGetBuffer(state, "out_fm", out_fm, sizeof(out_fm));
   bitmask = saveGwenesisStateGet(state, "bitmask");
   saveGwenesisStateGetBuffer(state, "OPNREGS", OPNREGS, sizeof(OPNREGS));
+
+  ym2612_timers_load();
 }
@@ -28,6 +28,13 @@ extern void YM2612Write(unsigned int a, unsigned int v, int target);
 extern void ym2612_run(int target);
 extern unsigned int YM2612Read(int target);
 
+/* GWENESIS_AUDIO_ACCURATE == 2: the frame's writes are queued and rendered at once */
+extern void ym2612_begin_frame(int16_t *buffer);
+extern void ym2612_end_frame(int target);
+extern void ym2612_render_frame(void);
+/* When frames are rendered by another task: blocks until it is done with the frames handed to it */
+extern void ym2612_set_render_wait(void (*wait)(void));
+
 #if 0
 extern int YM2612LoadContext(unsigned char *state);
 extern int YM2612SaveContext(unsigned char *state);
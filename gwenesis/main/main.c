@@ -7,6 +7,10 @@
 #define AUDIO_SAMPLE_RATE (53267)
 #define AUDIO_BUFFER_LENGTH (AUDIO_SAMPLE_RATE / 60 + 1)
 
+// With batched audio (GWENESIS_AUDIO_ACCURATE == 2) each frame is rendered on the second core
+// while the next one is emulated
+#define AUDIO_RENDER_TASK (GWENESIS_AUDIO_ACCURATE == 2)
+
 extern unsigned char* VRAM;
 extern int zclk;
 int system_clock;
@@ -19,6 +23,10 @@ int16_t gwenesis_ym2612_buffer[AUDIO_BUFFER_LENGTH];
 int ym2612_index;
 int ym2612_clock;
 
+#if AUDIO_RENDER_TASK
+static rg_task_t *audio_task;
+#endif
+
 static FILE *savestate_fp = NULL;
 static int savestate_errors = 0;
 
@@ -189,6 +197,28 @@ static void event_handler(int event, void *arg)
     }
 }
 
+#if AUDIO_RENDER_TASK
+static void audio_task_func(void *arg)
+{
+    rg_task_msg_t msg;
+    while (rg_task_peek(&msg, -1))
+    {
+        if (msg.type == RG_TASK_MSG_STOP)
+            break;
+        gwenesis_SN76489_render_frame();
+        ym2612_render_frame();
+        if (msg.dataPtr)
+            rg_audio_submit(msg.dataPtr, AUDIO_BUFFER_LENGTH >> 1);
+        rg_task_receive(&msg, -1);
+    }
+}
+
+static void audio_task_wait(void)
+{
+    rg_task_wait_empty(audio_task, -1);
+}
+#endif
+
 void app_main(void)
 {
     const rg_handlers_t handlers = {
@@ -253,6 +283,9 @@ void app_main(void)
         rg_emu_load_state(app->saveSlot);
     }
 
+    // Games polling a RAM flag set by the vblank handler are fast-forwarded to the next line
+    rg_idle_attach(&m68k.idle);
+
     app->tickRate = 60;
     app->frameskip = 3;
 
@@ -267,9 +300,20 @@ void app_main(void)
 
     int skipFrames = 0;
 
+#if AUDIO_RENDER_TASK
+    audio_task = rg_task_create("gen_audio", &audio_task_func, NULL, 2 * 1024, RG_TASK_PRIORITY_2, 1);
+    ym2612_set_render_wait(&audio_task_wait);
+    gwenesis_SN76489_set_render_wait(&audio_task_wait);
+    // The second set of buffers is only written and read once per frame, it can live in PSRAM
+    int16_t *ym2612_buffers[2] = {gwenesis_ym2612_buffer, rg_alloc(AUDIO_BUFFER_LENGTH * 2, MEM_SLOW)};
+    int16_t *sn76489_buffers[2] = {gwenesis_sn76489_buffer, rg_alloc(AUDIO_BUFFER_LENGTH * 2, MEM_SLOW)};
+    int audio_frame = 0;
+#endif
+
     RG_LOGI("emulation loop\n");
     while (true)
     {
+        RG_PROFILE_ZONE("frame");
         joystick_old = joystick;
         joystick = rg_input_read_gamepad();
 
@@ -314,8 +358,20 @@ void app_main(void)
         sn76489_clock = sn76489_enabled ? 0 : 0x1000000;
         sn76489_index = 0;
 
+#if AUDIO_RENDER_TASK
+        audio_frame ^= 1;
+        ym2612_begin_frame(ym2612_buffers[audio_frame]);
+        gwenesis_SN76489_begin_frame(sn76489_buffers[audio_frame]);
+#elif GWENESIS_AUDIO_ACCURATE == 2
+        ym2612_begin_frame(gwenesis_ym2612_buffer);
+        gwenesis_SN76489_begin_frame(gwenesis_sn76489_buffer);
+#endif
+
         scan_line = 0;
 
+        RG_PROFILE_BEGIN(emulate_zone, "emulate");
+        rg_stage_zone_t emulate_stage;
+        rg_system_stage_begin(&emulate_stage, RG_STAGE_EMULATE);
         while (scan_line < lines_per_frame)
         {
             m68k_run(system_clock + VDP_CYCLES_PER_LINE);
@@ -323,6 +379,7 @@ void app_main(void)
 
             /* Audio */
             /*  GWENESIS_AUDIO_ACCURATE:
+            *    =2 : batched mode. R/W accesses are queued and audio is rendered at the end of the frame
             *    =1 : cycle accurate mode. audio is refreshed when CPUs are performing a R/W access
             *    =0 : line  accurate mode. audio is refreshed every lines.
             */
@@ -379,9 +436,21 @@ void app_main(void)
             gwenesis_SN76489_run(system_clock);
             ym2612_run(system_clock);
         }
+#if AUDIO_RENDER_TASK
+        // The previous frame must be fully rendered before its queue is reused
+        rg_task_wait_empty(audio_task, -1);
+        gwenesis_SN76489_end_frame(system_clock);
+        ym2612_end_frame(system_clock);
+#elif GWENESIS_AUDIO_ACCURATE == 2
+        gwenesis_SN76489_run(system_clock);
+        ym2612_run(system_clock);
+#endif
 
         // reset m68k cycles to the begin of next frame cycle
         m68k.cycles -= system_clock;
+        m68k.idle.cycles += system_clock;
+        rg_system_stage_end(&emulate_stage);
+        RG_PROFILE_END(emulate_zone);
 
         if (drawFrame)
         {
@@ -395,10 +464,16 @@ void app_main(void)
 
         rg_system_tick(rg_system_timer() - startTime);
 
+#if AUDIO_RENDER_TASK
+        // TODO: Mix in gwenesis_sn76489_buffer
+        int16_t *audio_buffer = (yfm_enabled || z80_enabled) ? ym2612_buffers[audio_frame] : NULL;
+        rg_task_send(audio_task, &(rg_task_msg_t){.dataPtr = audio_buffer}, -1);
+#else
         if (yfm_enabled || z80_enabled) {
             // TODO: Mix in gwenesis_sn76489_buffer
             rg_audio_submit((void *)gwenesis_ym2612_buffer, AUDIO_BUFFER_LENGTH >> 1);
         }
+#endif
 
         if (skipFrames == 0)
         {
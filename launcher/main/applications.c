@@ -25,32 +25,15 @@ static bool crc_cache_dirty = true;
 static retro_app_t *apps[24];
 static int apps_count = 0;
 
-static int scan_folder_cb(const rg_scandir_t *entry, void *arg)
+static int scan_folder_cb(const rg_scandir_batch_t *batch, void *arg)
 {
     retro_app_t *app = (retro_app_t *)arg;
-    uint8_t type = RETRO_TYPE_INVALID;
+    const char *folder = rg_unique_string(batch->dirname);
 
-    // Skip hidden files
-    if (entry->basename[0] == '.')
-        return RG_SCANDIR_SKIP;
-
-    if (entry->is_file)
-    {
-        if (rg_extension_match(entry->basename, app->extensions))
-            type = RETRO_TYPE_FILE;
-    }
-    else if (entry->is_dir)
+    // Reserve room for the whole folder at once, we might end up with a bit of slack
+    if (app->files_count + batch->count > app->files_capacity)
     {
-        RG_LOGI("Found subdirectory '%s'", entry->path);
-        type = RETRO_TYPE_FOLDER;
-    }
-
-    if (type == RETRO_TYPE_INVALID)
-        return RG_SCANDIR_CONTINUE;
-
-    if (app->files_count + 1 > app->files_capacity)
-    {
-        size_t new_capacity = app->files_capacity * 1.5;
+        size_t new_capacity = RG_MAX((size_t)(app->files_capacity * 1.5), app->files_count + batch->count);
         retro_file_t *new_buf = realloc(app->files, new_capacity * sizeof(retro_file_t));
         if (!new_buf)
         {
@@ -61,15 +44,42 @@ static int scan_folder_cb(const rg_scandir_t *entry, void *arg)
         app->files_capacity = new_capacity;
     }
 
-    app->files[app->files_count++] = (retro_file_t) {
-        .name = strdup(entry->basename),
-        .folder = rg_unique_string(entry->dirname),
-        .checksum = 0,
-        .missing_cover = 0,
-        .saves = 0,
-        .type = type,
-        .app = (void*)app,
-    };
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        rg_scandir_entry_t *entry = &batch->entries[i];
+        uint8_t type = RETRO_TYPE_INVALID;
+
+        // Skip hidden files
+        if (entry->name[0] == '.')
+        {
+            entry->skip = true;
+            continue;
+        }
+
+        if (entry->is_file)
+        {
+            if (rg_extension_match(entry->name, app->extensions))
+                type = RETRO_TYPE_FILE;
+        }
+        else if (entry->is_dir)
+        {
+            RG_LOGI("Found subdirectory '%s/%s'", batch->dirname, entry->name);
+            type = RETRO_TYPE_FOLDER;
+        }
+
+        if (type == RETRO_TYPE_INVALID)
+            continue;
+
+        app->files[app->files_count++] = (retro_file_t) {
+            .name = strdup(entry->name),
+            .folder = folder,
+            .checksum = 0,
+            .missing_cover = 0,
+            .saves = 0,
+            .type = type,
+            .app = (void*)app,
+        };
+    }
 
     return RG_SCANDIR_CONTINUE;
 }
@@ -105,7 +115,7 @@ static void application_init(retro_app_t *app)
     rg_storage_mkdir(app->paths.saves);
     rg_storage_mkdir(app->paths.roms);
 
-    rg_storage_scandir(app->paths.roms, scan_folder_cb, app, RG_SCANDIR_RECURSIVE);
+    rg_storage_scandir_batch(app->paths.roms, scan_folder_cb, app, RG_SCANDIR_RECURSIVE | RG_SCANDIR_PARALLEL);
     rg_storage_scandir(app->paths.saves, scan_saves_cb, app, RG_SCANDIR_RECURSIVE);
     // rg_storage_scandir(app->paths.covers, scan_folder_cb3, app, RG_SCANDIR_RECURSIVE);
 
@@ -50,3 +50,25 @@
 
 /* Define to bundle prboom.wad (minus the trig tables, which we always include) */
 #define PRBOOMWAD
+
+/* Define to memory map WAD files on hosts that support it (lumps are then never cached) */
+#if !defined(ESP_PLATFORM) && (defined(__linux__) || defined(__APPLE__))
+#define HAVE_MMAP
+#endif
+
+/* Data partition that may hold a copy of the IWAD, it is mapped instead of reading the file */
+/* (rg_tool.py --wad writes it, followed by a trailer with the magic, the size and the CRC32) */
+#define WAD_PARTITION_LABEL "wad"
+#define WAD_PARTITION_MAGIC "WADP"
+
+/* Extension of the file caching the CRC32 of a WAD, to compare it with the partition's */
+#define WAD_CHECKSUM_EXT ".crc"
+
+/* Extension of the lump directory cache written next to the last loaded WAD */
+#define WAD_DIRECTORY_EXT ".dir"
+
+/* Contiguous region for blocks that have an owner (lumps, patches), purged in LRU order (max 4MB) */
+#define ZONE_REGION_SIZE (1024 * 1024)
+
+/* Size of the pages the small blocks size-classes are carved from */
+#define ZONE_SLAB_PAGE_SIZE 8192
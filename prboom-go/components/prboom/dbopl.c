@@ -45,6 +45,7 @@
 /* $Id: dbopl.cpp,v 1.10 2009-06-10 19:54:51 harekiet Exp $ */
 
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 //#include "dosbox.h"
@@ -191,7 +192,12 @@ static Bit16u SinTable[ 512 ];
 
 //6 is just 0 shifted and masked
 
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+//WaveTable and MulTable are precomputed by gen_dbopl_tables.py and stay in flash
+#include "dbopl_tables.h"
+#else
 static Bit16s WaveTable[ 8 * 512 ];
+#endif
 //Distance into WaveTable the wave starts
 static const Bit16u WaveBaseTable[8] = {
   0x000, 0x200, 0x200, 0x800,
@@ -211,10 +217,6 @@ static const Bit16u WaveStartTable[8] = {
 };
 #endif
 
-#if ( DBOPL_WAVE == WAVE_TABLEMUL )
-static Bit16u MulTable[ 384 ];
-#endif
-
 static Bit8u KslTable[ 8 * 16 ];
 static Bit8u TremoloTable[ TREMOLO_TABLE ];
 //Start of a channel behind the chip struct start
@@ -1458,24 +1460,25 @@ void DBOPL_InitTables( void ) {
     SinTable[i] = (Bit16s)( 0.5 - log10( sin( (i + 0.5) * (PI / 512.0) ) ) / log10(2.0)*256 );
   }
 #endif
-#if ( DBOPL_WAVE == WAVE_TABLEMUL )
-  //Multiplication based tables
-  for ( i = 0; i < 384; i++ ) {
-    int s = i * 8;
-    //TODO maybe keep some of the precision errors of the original table?
-    double val = ( 0.5 + ( pow(2.0, -1.0 + ( 255 - s) * ( 1.0 /256 ) )) * ( 1 << MUL_SH ));
-    MulTable[i] = (Bit16u)(val);
-  }
-
-  //Sine Wave Base
-  for ( i = 0; i < 512; i++ ) {
-    WaveTable[ 0x0200 + i ] = (Bit16s)(sin( (i + 0.5) * (PI / 512.0) ) * 4084);
-    WaveTable[ 0x0000 + i ] = -WaveTable[ 0x200 + i ];
-  }
-  //Exponential wave
-  for ( i = 0; i < 256; i++ ) {
-    WaveTable[ 0x700 + i ] = (Bit16s)( 0.5 + ( pow(2.0, -1.0 + ( 255 - i * 8) * ( 1.0 /256 ) ) ) * 4085 );
-    WaveTable[ 0x6ff - i ] = -WaveTable[ 0x700 + i ];
+#if ( DBOPL_WAVE == WAVE_TABLEMUL ) && defined( DBOPL_CHECK_TABLES )
+  //Compare the precomputed tables with the original math, the target's libm
+  //must agree with the one used by gen_dbopl_tables.py
+  {
+    int errors = 0;
+    for ( i = 0; i < 384; i++ ) {
+      int s = i * 8;
+      double val = ( 0.5 + ( pow(2.0, -1.0 + ( 255 - s) * ( 1.0 /256 ) )) * ( 1 << MUL_SH ));
+      errors += MulTable[i] != (Bit16u)(val);
+    }
+    for ( i = 0; i < 512; i++ ) {
+      Bit16s val = (Bit16s)(sin( (i + 0.5) * (PI / 512.0) ) * 4084);
+      errors += WaveTable[ 0x0200 + i ] != val || WaveTable[ 0x0000 + i ] != -val;
+    }
+    for ( i = 0; i < 256; i++ ) {
+      Bit16s val = (Bit16s)( 0.5 + ( pow(2.0, -1.0 + ( 255 - i * 8) * ( 1.0 /256 ) ) ) * 4085 );
+      errors += WaveTable[ 0x700 + i ] != val || WaveTable[ 0x6ff - i ] != -val;
+    }
+    printf("DBOPL tables check: %d errors\n", errors);
   }
 #endif
 #if ( DBOPL_WAVE == WAVE_TABLELOG )
@@ -1495,7 +1498,7 @@ void DBOPL_InitTables( void ) {
   //  |\\//|    |    |WAV7|    |  \/|    |    |
   //  |06  |0126|27  |7   |3   |4   |4 5 |5   |
 
-#if (( DBOPL_WAVE == WAVE_TABLELOG ) || ( DBOPL_WAVE == WAVE_TABLEMUL ))
+#if ( DBOPL_WAVE == WAVE_TABLELOG )
   for ( i = 0; i < 256; i++ ) {
     //Fill silence gaps
     WaveTable[ 0x400 + i ] = WaveTable[0];
@@ -103,7 +103,7 @@ struct _Operator {
 #if (DBOPL_WAVE == WAVE_HANDLER)
   WaveHandler waveHandler;  //Routine that generate a wave
 #else
-  Bit16s* waveBase;
+  const Bit16s* waveBase;
   Bit32u waveMask;
   Bit32u waveStart;
 #endif
@@ -0,0 +1,287 @@
+// Generated by gen_dbopl_tables.py, do not edit
+
+static const Bit16s WaveTable[ 4096 ] = {
+  -12,-37,-62,-87,-112,-137,-162,-187,-212,-237,-262,-287,-312,-337,-362,-387,
+  -412,-437,-462,-487,-512,-537,-562,-586,-611,-636,-661,-685,-710,-735,-759,-784,
+  -809,-833,-858,-882,-907,-931,-955,-980,-1004,-1028,-1052,-1077,-1101,-1125,-1149,-1173,
+  -1197,-1221,-1245,-1269,-1292,-1316,-1340,-1364,-1387,-1411,-1434,-1458,-1481,-1504,-1528,-1551,
+  -1574,-1597,-1620,-1643,-1666,-1689,-1712,-1734,-1757,-1780,-1802,-1825,-1847,-1869,-1891,-1914,
+  -1936,-1958,-1980,-2002,-2023,-2045,-2067,-2088,-2110,-2131,-2153,-2174,-2195,-2216,-2237,-2258,
+  -2279,-2300,-2320,-2341,-2361,-2382,-2402,-2422,-2442,-2462,-2482,-2502,-2522,-2542,-2561,-2581,
+  -2600,-2619,-2638,-2658,-2677,-2695,-2714,-2733,-2751,-2770,-2788,-2806,-2825,-2843,-2861,-2878,
+  -2896,-2914,-2931,-2949,-2966,-2983,-3000,-3017,-3034,-3051,-3067,-3084,-3100,-3116,-3132,-3149,
+  -3164,-3180,-3196,-3211,-3227,-3242,-3257,-3272,-3287,-3302,-3317,-3331,-3346,-3360,-3374,-3388,
+  -3402,-3416,-3430,-3443,-3457,-3470,-3483,-3496,-3509,-3522,-3534,-3547,-3559,-3571,-3583,-3595,
+  -3607,-3619,-3630,-3642,-3653,-3664,-3675,-3686,-3697,-3707,-3718,-3728,-3738,-3748,-3758,-3768,
+  -3777,-3787,-3796,-3805,-3814,-3823,-3832,-3841,-3849,-3857,-3865,-3873,-3881,-3889,-3897,-3904,
+  -3911,-3918,-3925,-3932,-3939,-3945,-3952,-3958,-3964,-3970,-3976,-3982,-3987,-3992,-3998,-4003,
+  -4007,-4012,-4017,-4021,-4025,-4030,-4034,-4037,-4041,-4045,-4048,-4051,-4054,-4057,-4060,-4063,
+  -4065,-4067,-4069,-4071,-4073,-4075,-4077,-4078,-4079,-4080,-4081,-4082,-4083,-4083,-4083,-4083,
+  -4083,-4083,-4083,-4083,-4082,-4081,-4080,-4079,-4078,-4077,-4075,-4073,-4071,-4069,-4067,-4065,
+  -4063,-4060,-4057,-4054,-4051,-4048,-4045,-4041,-4037,-4034,-4030,-4025,-4021,-4017,-4012,-4007,
+  -4003,-3998,-3992,-3987,-3982,-3976,-3970,-3964,-3958,-3952,-3945,-3939,-3932,-3925,-3918,-3911,
+  -3904,-3897,-3889,-3881,-3873,-3865,-3857,-3849,-3841,-3832,-3823,-3814,-3805,-3796,-3787,-3777,
+  -3768,-3758,-3748,-3738,-3728,-3718,-3707,-3697,-3686,-3675,-3664,-3653,-3642,-3630,-3619,-3607,
+  -3595,-3583,-3571,-3559,-3547,-3534,-3522,-3509,-3496,-3483,-3470,-3457,-3443,-3430,-3416,-3402,
+  -3388,-3374,-3360,-3346,-3331,-3317,-3302,-3287,-3272,-3257,-3242,-3227,-3211,-3196,-3180,-3164,
+  -3149,-3132,-3116,-3100,-3084,-3067,-3051,-3034,-3017,-3000,-2983,-2966,-2949,-2931,-2914,-2896,
+  -2878,-2861,-2843,-2825,-2806,-2788,-2770,-2751,-2733,-2714,-2695,-2677,-2658,-2638,-2619,-2600,
+  -2581,-2561,-2542,-2522,-2502,-2482,-2462,-2442,-2422,-2402,-2382,-2361,-2341,-2320,-2300,-2279,
+  -2258,-2237,-2216,-2195,-2174,-2153,-2131,-2110,-2088,-2067,-2045,-2023,-2002,-1980,-1958,-1936,
+  -1914,-1891,-1869,-1847,-1825,-1802,-1780,-1757,-1734,-1712,-1689,-1666,-1643,-1620,-1597,-1574,
+  -1551,-1528,-1504,-1481,-1458,-1434,-1411,-1387,-1364,-1340,-1316,-1292,-1269,-1245,-1221,-1197,
+  -1173,-1149,-1125,-1101,-1077,-1052,-1028,-1004,-980,-955,-931,-907,-882,-858,-833,-809,
+  -784,-759,-735,-710,-685,-661,-636,-611,-586,-562,-537,-512,-487,-462,-437,-412,
+  -387,-362,-337,-312,-287,-262,-237,-212,-187,-162,-137,-112,-87,-62,-37,-12,
+  12,37,62,87,112,137,162,187,212,237,262,287,312,337,362,387,
+  412,437,462,487,512,537,562,586,611,636,661,685,710,735,759,784,
+  809,833,858,882,907,931,955,980,1004,1028,1052,1077,1101,1125,1149,1173,
+  1197,1221,1245,1269,1292,1316,1340,1364,1387,1411,1434,1458,1481,1504,1528,1551,
+  1574,1597,1620,1643,1666,1689,1712,1734,1757,1780,1802,1825,1847,1869,1891,1914,
+  1936,1958,1980,2002,2023,2045,2067,2088,2110,2131,2153,2174,2195,2216,2237,2258,
+  2279,2300,2320,2341,2361,2382,2402,2422,2442,2462,2482,2502,2522,2542,2561,2581,
+  2600,2619,2638,2658,2677,2695,2714,2733,2751,2770,2788,2806,2825,2843,2861,2878,
+  2896,2914,2931,2949,2966,2983,3000,3017,3034,3051,3067,3084,3100,3116,3132,3149,
+  3164,3180,3196,3211,3227,3242,3257,3272,3287,3302,3317,3331,3346,3360,3374,3388,
+  3402,3416,3430,3443,3457,3470,3483,3496,3509,3522,3534,3547,3559,3571,3583,3595,
+  3607,3619,3630,3642,3653,3664,3675,3686,3697,3707,3718,3728,3738,3748,3758,3768,
+  3777,3787,3796,3805,3814,3823,3832,3841,3849,3857,3865,3873,3881,3889,3897,3904,
+  3911,3918,3925,3932,3939,3945,3952,3958,3964,3970,3976,3982,3987,3992,3998,4003,
+  4007,4012,4017,4021,4025,4030,4034,4037,4041,4045,4048,4051,4054,4057,4060,4063,
+  4065,4067,4069,4071,4073,4075,4077,4078,4079,4080,4081,4082,4083,4083,4083,4083,
+  4083,4083,4083,4083,4082,4081,4080,4079,4078,4077,4075,4073,4071,4069,4067,4065,
+  4063,4060,4057,4054,4051,4048,4045,4041,4037,4034,4030,4025,4021,4017,4012,4007,
+  4003,3998,3992,3987,3982,3976,3970,3964,3958,3952,3945,3939,3932,3925,3918,3911,
+  3904,3897,3889,3881,3873,3865,3857,3849,3841,3832,3823,3814,3805,3796,3787,3777,
+  3768,3758,3748,3738,3728,3718,3707,3697,3686,3675,3664,3653,3642,3630,3619,3607,
+  3595,3583,3571,3559,3547,3534,3522,3509,3496,3483,3470,3457,3443,3430,3416,3402,
+  3388,3374,3360,3346,3331,3317,3302,3287,3272,3257,3242,3227,3211,3196,3180,3164,
+  3149,3132,3116,3100,3084,3067,3051,3034,3017,3000,2983,2966,2949,2931,2914,2896,
+  2878,2861,2843,2825,2806,2788,2770,2751,2733,2714,2695,2677,2658,2638,2619,2600,
+  2581,2561,2542,2522,2502,2482,2462,2442,2422,2402,2382,2361,2341,2320,2300,2279,
+  2258,2237,2216,2195,2174,2153,2131,2110,2088,2067,2045,2023,2002,1980,1958,1936,
+  1914,1891,1869,1847,1825,1802,1780,1757,1734,1712,1689,1666,1643,1620,1597,1574,
+  1551,1528,1504,1481,1458,1434,1411,1387,1364,1340,1316,1292,1269,1245,1221,1197,
+  1173,1149,1125,1101,1077,1052,1028,1004,980,955,931,907,882,858,833,809,
+  784,759,735,710,685,661,636,611,586,562,537,512,487,462,437,412,
+  387,362,337,312,287,262,237,212,187,162,137,112,87,62,37,12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -16,-17,-17,-17,-18,-18,-19,-19,-19,-20,-20,-21,-21,-22,-22,-23,
+  -23,-24,-24,-25,-25,-26,-26,-27,-27,-28,-29,-29,-30,-30,-31,-32,
+  -33,-33,-34,-35,-35,-36,-37,-38,-39,-40,-40,-41,-42,-43,-44,-45,
+  -46,-47,-48,-49,-50,-51,-52,-54,-55,-56,-57,-58,-60,-61,-62,-64,
+  -65,-66,-68,-69,-71,-72,-74,-76,-77,-79,-81,-83,-84,-86,-88,-90,
+  -92,-94,-96,-98,-100,-103,-105,-107,-109,-112,-114,-117,-119,-122,-125,-127,
+  -130,-133,-136,-139,-142,-145,-148,-151,-155,-158,-162,-165,-169,-172,-176,-180,
+  -184,-188,-192,-196,-201,-205,-210,-214,-219,-224,-228,-233,-239,-244,-249,-255,
+  -260,-266,-272,-278,-284,-290,-296,-303,-309,-316,-323,-330,-337,-345,-352,-360,
+  -368,-376,-384,-393,-401,-410,-419,-428,-438,-447,-457,-467,-477,-488,-498,-509,
+  -520,-532,-543,-555,-567,-580,-593,-606,-619,-632,-646,-660,-675,-690,-705,-720,
+  -736,-752,-769,-785,-803,-820,-838,-856,-875,-894,-914,-934,-954,-975,-997,-1018,
+  -1041,-1064,-1087,-1111,-1135,-1160,-1185,-1211,-1238,-1265,-1293,-1321,-1350,-1379,-1409,-1440,
+  -1472,-1504,-1537,-1571,-1605,-1640,-1676,-1713,-1750,-1789,-1828,-1868,-1909,-1951,-1993,-2037,
+  -2082,-2127,-2174,-2221,-2270,-2320,-2370,-2422,-2475,-2530,-2585,-2642,-2699,-2759,-2819,-2881,
+  -2944,-3008,-3074,-3141,-3210,-3281,-3352,-3426,-3501,-3577,-3656,-3736,-3818,-3901,-3987,-4074,
+  4074,3987,3901,3818,3736,3656,3577,3501,3426,3352,3281,3210,3141,3074,3008,2944,
+  2881,2819,2759,2699,2642,2585,2530,2475,2422,2370,2320,2270,2221,2174,2127,2082,
+  2037,1993,1951,1909,1868,1828,1789,1750,1713,1676,1640,1605,1571,1537,1504,1472,
+  1440,1409,1379,1350,1321,1293,1265,1238,1211,1185,1160,1135,1111,1087,1064,1041,
+  1018,997,975,954,934,914,894,875,856,838,820,803,785,769,752,736,
+  720,705,690,675,660,646,632,619,606,593,580,567,555,543,532,520,
+  509,498,488,477,467,457,447,438,428,419,410,401,393,384,376,368,
+  360,352,345,337,330,323,316,309,303,296,290,284,278,272,266,260,
+  255,249,244,239,233,228,224,219,214,210,205,201,196,192,188,184,
+  180,176,172,169,165,162,158,155,151,148,145,142,139,136,133,130,
+  127,125,122,119,117,114,112,109,107,105,103,100,98,96,94,92,
+  90,88,86,84,83,81,79,77,76,74,72,71,69,68,66,65,
+  64,62,61,60,58,57,56,55,54,52,51,50,49,48,47,46,
+  45,44,43,42,41,40,40,39,38,37,36,35,35,34,33,33,
+  32,31,30,30,29,29,28,27,27,26,26,25,25,24,24,23,
+  23,22,22,21,21,20,20,19,19,19,18,18,17,17,17,16,
+  12,37,62,87,112,137,162,187,212,237,262,287,312,337,362,387,
+  412,437,462,487,512,537,562,586,611,636,661,685,710,735,759,784,
+  809,833,858,882,907,931,955,980,1004,1028,1052,1077,1101,1125,1149,1173,
+  1197,1221,1245,1269,1292,1316,1340,1364,1387,1411,1434,1458,1481,1504,1528,1551,
+  1574,1597,1620,1643,1666,1689,1712,1734,1757,1780,1802,1825,1847,1869,1891,1914,
+  1936,1958,1980,2002,2023,2045,2067,2088,2110,2131,2153,2174,2195,2216,2237,2258,
+  2279,2300,2320,2341,2361,2382,2402,2422,2442,2462,2482,2502,2522,2542,2561,2581,
+  2600,2619,2638,2658,2677,2695,2714,2733,2751,2770,2788,2806,2825,2843,2861,2878,
+  2896,2914,2931,2949,2966,2983,3000,3017,3034,3051,3067,3084,3100,3116,3132,3149,
+  3164,3180,3196,3211,3227,3242,3257,3272,3287,3302,3317,3331,3346,3360,3374,3388,
+  3402,3416,3430,3443,3457,3470,3483,3496,3509,3522,3534,3547,3559,3571,3583,3595,
+  3607,3619,3630,3642,3653,3664,3675,3686,3697,3707,3718,3728,3738,3748,3758,3768,
+  3777,3787,3796,3805,3814,3823,3832,3841,3849,3857,3865,3873,3881,3889,3897,3904,
+  3911,3918,3925,3932,3939,3945,3952,3958,3964,3970,3976,3982,3987,3992,3998,4003,
+  4007,4012,4017,4021,4025,4030,4034,4037,4041,4045,4048,4051,4054,4057,4060,4063,
+  4065,4067,4069,4071,4073,4075,4077,4078,4079,4080,4081,4082,4083,4083,4083,4083,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  12,62,112,162,212,262,312,362,412,462,512,562,611,661,710,759,
+  809,858,907,955,1004,1052,1101,1149,1197,1245,1292,1340,1387,1434,1481,1528,
+  1574,1620,1666,1712,1757,1802,1847,1891,1936,1980,2023,2067,2110,2153,2195,2237,
+  2279,2320,2361,2402,2442,2482,2522,2561,2600,2638,2677,2714,2751,2788,2825,2861,
+  2896,2931,2966,3000,3034,3067,3100,3132,3164,3196,3227,3257,3287,3317,3346,3374,
+  3402,3430,3457,3483,3509,3534,3559,3583,3607,3630,3653,3675,3697,3718,3738,3758,
+  3777,3796,3814,3832,3849,3865,3881,3897,3911,3925,3939,3952,3964,3976,3987,3998,
+  4007,4017,4025,4034,4041,4048,4054,4060,4065,4069,4073,4077,4079,4081,4083,4083,
+  4083,4083,4082,4080,4078,4075,4071,4067,4063,4057,4051,4045,4037,4030,4021,4012,
+  4003,3992,3982,3970,3958,3945,3932,3918,3904,3889,3873,3857,3841,3823,3805,3787,
+  3768,3748,3728,3707,3686,3664,3642,3619,3595,3571,3547,3522,3496,3470,3443,3416,
+  3388,3360,3331,3302,3272,3242,3211,3180,3149,3116,3084,3051,3017,2983,2949,2914,
+  2878,2843,2806,2770,2733,2695,2658,2619,2581,2542,2502,2462,2422,2382,2341,2300,
+  2258,2216,2174,2131,2088,2045,2002,1958,1914,1869,1825,1780,1734,1689,1643,1597,
+  1551,1504,1458,1411,1364,1316,1269,1221,1173,1125,1077,1028,980,931,882,833,
+  784,735,685,636,586,537,487,437,387,337,287,237,187,137,87,37,
+  -12,-62,-112,-162,-212,-262,-312,-362,-412,-462,-512,-562,-611,-661,-710,-759,
+  -809,-858,-907,-955,-1004,-1052,-1101,-1149,-1197,-1245,-1292,-1340,-1387,-1434,-1481,-1528,
+  -1574,-1620,-1666,-1712,-1757,-1802,-1847,-1891,-1936,-1980,-2023,-2067,-2110,-2153,-2195,-2237,
+  -2279,-2320,-2361,-2402,-2442,-2482,-2522,-2561,-2600,-2638,-2677,-2714,-2751,-2788,-2825,-2861,
+  -2896,-2931,-2966,-3000,-3034,-3067,-3100,-3132,-3164,-3196,-3227,-3257,-3287,-3317,-3346,-3374,
+  -3402,-3430,-3457,-3483,-3509,-3534,-3559,-3583,-3607,-3630,-3653,-3675,-3697,-3718,-3738,-3758,
+  -3777,-3796,-3814,-3832,-3849,-3865,-3881,-3897,-3911,-3925,-3939,-3952,-3964,-3976,-3987,-3998,
+  -4007,-4017,-4025,-4034,-4041,-4048,-4054,-4060,-4065,-4069,-4073,-4077,-4079,-4081,-4083,-4083,
+  -4083,-4083,-4082,-4080,-4078,-4075,-4071,-4067,-4063,-4057,-4051,-4045,-4037,-4030,-4021,-4012,
+  -4003,-3992,-3982,-3970,-3958,-3945,-3932,-3918,-3904,-3889,-3873,-3857,-3841,-3823,-3805,-3787,
+  -3768,-3748,-3728,-3707,-3686,-3664,-3642,-3619,-3595,-3571,-3547,-3522,-3496,-3470,-3443,-3416,
+  -3388,-3360,-3331,-3302,-3272,-3242,-3211,-3180,-3149,-3116,-3084,-3051,-3017,-2983,-2949,-2914,
+  -2878,-2843,-2806,-2770,-2733,-2695,-2658,-2619,-2581,-2542,-2502,-2462,-2422,-2382,-2341,-2300,
+  -2258,-2216,-2174,-2131,-2088,-2045,-2002,-1958,-1914,-1869,-1825,-1780,-1734,-1689,-1643,-1597,
+  -1551,-1504,-1458,-1411,-1364,-1316,-1269,-1221,-1173,-1125,-1077,-1028,-980,-931,-882,-833,
+  -784,-735,-685,-636,-586,-537,-487,-437,-387,-337,-287,-237,-187,-137,-87,-37,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  -12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,-12,
+  12,62,112,162,212,262,312,362,412,462,512,562,611,661,710,759,
+  809,858,907,955,1004,1052,1101,1149,1197,1245,1292,1340,1387,1434,1481,1528,
+  1574,1620,1666,1712,1757,1802,1847,1891,1936,1980,2023,2067,2110,2153,2195,2237,
+  2279,2320,2361,2402,2442,2482,2522,2561,2600,2638,2677,2714,2751,2788,2825,2861,
+  2896,2931,2966,3000,3034,3067,3100,3132,3164,3196,3227,3257,3287,3317,3346,3374,
+  3402,3430,3457,3483,3509,3534,3559,3583,3607,3630,3653,3675,3697,3718,3738,3758,
+  3777,3796,3814,3832,3849,3865,3881,3897,3911,3925,3939,3952,3964,3976,3987,3998,
+  4007,4017,4025,4034,4041,4048,4054,4060,4065,4069,4073,4077,4079,4081,4083,4083,
+  4083,4083,4082,4080,4078,4075,4071,4067,4063,4057,4051,4045,4037,4030,4021,4012,
+  4003,3992,3982,3970,3958,3945,3932,3918,3904,3889,3873,3857,3841,3823,3805,3787,
+  3768,3748,3728,3707,3686,3664,3642,3619,3595,3571,3547,3522,3496,3470,3443,3416,
+  3388,3360,3331,3302,3272,3242,3211,3180,3149,3116,3084,3051,3017,2983,2949,2914,
+  2878,2843,2806,2770,2733,2695,2658,2619,2581,2542,2502,2462,2422,2382,2341,2300,
+  2258,2216,2174,2131,2088,2045,2002,1958,1914,1869,1825,1780,1734,1689,1643,1597,
+  1551,1504,1458,1411,1364,1316,1269,1221,1173,1125,1077,1028,980,931,882,833,
+  784,735,685,636,586,537,487,437,387,337,287,237,187,137,87,37,
+  12,62,112,162,212,262,312,362,412,462,512,562,611,661,710,759,
+  809,858,907,955,1004,1052,1101,1149,1197,1245,1292,1340,1387,1434,1481,1528,
+  1574,1620,1666,1712,1757,1802,1847,1891,1936,1980,2023,2067,2110,2153,2195,2237,
+  2279,2320,2361,2402,2442,2482,2522,2561,2600,2638,2677,2714,2751,2788,2825,2861,
+  2896,2931,2966,3000,3034,3067,3100,3132,3164,3196,3227,3257,3287,3317,3346,3374,
+  3402,3430,3457,3483,3509,3534,3559,3583,3607,3630,3653,3675,3697,3718,3738,3758,
+  3777,3796,3814,3832,3849,3865,3881,3897,3911,3925,3939,3952,3964,3976,3987,3998,
+  4007,4017,4025,4034,4041,4048,4054,4060,4065,4069,4073,4077,4079,4081,4083,4083,
+  4083,4083,4082,4080,4078,4075,4071,4067,4063,4057,4051,4045,4037,4030,4021,4012,
+  4003,3992,3982,3970,3958,3945,3932,3918,3904,3889,3873,3857,3841,3823,3805,3787,
+  3768,3748,3728,3707,3686,3664,3642,3619,3595,3571,3547,3522,3496,3470,3443,3416,
+  3388,3360,3331,3302,3272,3242,3211,3180,3149,3116,3084,3051,3017,2983,2949,2914,
+  2878,2843,2806,2770,2733,2695,2658,2619,2581,2542,2502,2462,2422,2382,2341,2300,
+  2258,2216,2174,2131,2088,2045,2002,1958,1914,1869,1825,1780,1734,1689,1643,1597,
+  1551,1504,1458,1411,1364,1316,1269,1221,1173,1125,1077,1028,980,931,882,833,
+  784,735,685,636,586,537,487,437,387,337,287,237,187,137,87,37,
+};
+
+static const Bit16u MulTable[ 384 ] = {
+  65359,63958,62588,61247,59934,58650,57393,56163,54960,53782,52630,51502,50399,49319,48262,47228,
+  46216,45225,44256,43308,42380,41472,40583,39714,38863,38030,37215,36417,35637,34874,34126,33395,
+  32679,31979,31294,30623,29967,29325,28697,28082,27480,26891,26315,25751,25199,24659,24131,23614,
+  23108,22613,22128,21654,21190,20736,20292,19857,19431,19015,18607,18209,17819,17437,17063,16697,
+  16340,15990,15647,15312,14984,14663,14348,14041,13740,13446,13157,12876,12600,12330,12065,11807,
+  11554,11306,11064,10827,10595,10368,10146,9928,9716,9507,9304,9104,8909,8718,8532,8349,
+  8170,7995,7823,7656,7492,7331,7174,7020,6870,6723,6579,6438,6300,6165,6033,5903,
+  5777,5653,5532,5413,5297,5184,5073,4964,4858,4754,4652,4552,4455,4359,4266,4174,
+  4085,3997,3912,3828,3746,3666,3587,3510,3435,3361,3289,3219,3150,3082,3016,2952,
+  2888,2827,2766,2707,2649,2592,2536,2482,2429,2377,2326,2276,2227,2180,2133,2087,
+  2042,1999,1956,1914,1873,1833,1794,1755,1717,1681,1645,1609,1575,1541,1508,1476,
+  1444,1413,1383,1353,1324,1296,1268,1241,1214,1188,1163,1138,1114,1090,1066,1044,
+  1021,999,978,957,936,916,897,878,859,840,822,805,787,771,754,738,
+  722,707,692,677,662,648,634,621,607,594,581,569,557,545,533,522,
+  511,500,489,478,468,458,448,439,429,420,411,402,394,385,377,369,
+  361,353,346,338,331,324,317,310,304,297,291,285,278,272,267,261,
+  255,250,244,239,234,229,224,219,215,210,206,201,197,193,189,184,
+  181,177,173,169,166,162,159,155,152,149,145,142,139,136,133,130,
+  128,125,122,120,117,115,112,110,107,105,103,101,98,96,94,92,
+  90,88,86,85,83,81,79,78,76,74,73,71,70,68,67,65,
+  64,62,61,60,59,57,56,55,54,53,51,50,49,48,47,46,
+  45,44,43,42,41,40,40,39,38,37,36,36,35,34,33,33,
+  32,31,31,30,29,29,28,27,27,26,26,25,25,24,24,23,
+  23,22,22,21,21,20,20,19,19,19,18,18,17,17,17,16,
+};
@@ -0,0 +1,54 @@
+import math, os, sys
+
+# This script should be run to update dbopl_tables.h when the WAVE_TABLEMUL formulas in dbopl.c change.
+# The math is identical to the original DBOPL_InitTables(), build with DBOPL_CHECK_TABLES to compare
+# the generated tables against the ones computed at runtime on the target.
+
+os.chdir(sys.path[0])
+
+MUL_SH = 16
+
+# Multiplication based tables
+MulTable = [0] * 384
+for i in range(384):
+    s = i * 8
+    MulTable[i] = int(0.5 + (math.pow(2.0, -1.0 + (255 - s) * (1.0 / 256))) * (1 << MUL_SH))
+
+WaveTable = [0] * (8 * 512)
+# Sine Wave Base
+for i in range(512):
+    WaveTable[0x0200 + i] = int(math.sin((i + 0.5) * (math.pi / 512.0)) * 4084)
+    WaveTable[0x0000 + i] = -WaveTable[0x200 + i]
+# Exponential wave
+for i in range(256):
+    WaveTable[0x700 + i] = int(0.5 + (math.pow(2.0, -1.0 + (255 - i * 8) * (1.0 / 256))) * 4085)
+    WaveTable[0x6FF - i] = -WaveTable[0x700 + i]
+for i in range(256):
+    # Fill silence gaps
+    WaveTable[0x400 + i] = WaveTable[0]
+    WaveTable[0x500 + i] = WaveTable[0]
+    WaveTable[0x900 + i] = WaveTable[0]
+    WaveTable[0xC00 + i] = WaveTable[0]
+    WaveTable[0xD00 + i] = WaveTable[0]
+    # Replicate sines in other pieces
+    WaveTable[0x800 + i] = WaveTable[0x200 + i]
+    # double speed sines
+    WaveTable[0xA00 + i] = WaveTable[0x200 + i * 2]
+    WaveTable[0xB00 + i] = WaveTable[0x000 + i * 2]
+    WaveTable[0xE00 + i] = WaveTable[0x200 + i * 2]
+    WaveTable[0xF00 + i] = WaveTable[0x200 + i * 2]
+
+
+def table(ctype, name, data, per_line):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append("  " + ",".join("%d" % v for v in data[i : i + per_line]) + ",")
+    return "static const %s %s[ %d ] = {\n%s\n};\n" % (ctype, name, len(data), "\n".join(lines))
+
+
+output = "// Generated by gen_dbopl_tables.py, do not edit\n\n"
+output += table("Bit16s", "WaveTable", WaveTable, 16) + "\n"
+output += table("Bit16u", "MulTable", MulTable, 16)
+
+with open("dbopl_tables.h", "w", newline="") as f:
+    f.write(output)
@@ -44,6 +44,23 @@
 #include "w_wad.h"
 #include "lprintf.h"
 
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef ESP_PLATFORM
+#include <rg_system.h>
+#include <esp_idf_version.h>
+#include <esp_partition.h>
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+#define esp_partition_mmap_handle_t spi_flash_mmap_handle_t
+#define esp_partition_munmap spi_flash_munmap
+#define ESP_PARTITION_MMAP_DATA SPI_FLASH_MMAP_DATA
+#endif
+#endif
+
 //
 // GLOBALS
 //
@@ -56,6 +73,11 @@ size_t numwadfiles = 0;
 lumpinfo_t *lumpinfo;
 size_t      numlumps;
 
+// Lump cache statistics
+unsigned int lumpcachehits;
+unsigned int lumpcachemisses;
+size_t       lumpbytesread;
+
 void ExtractFileBase (const char *path, char *dest)
 {
   const char *src = path + strlen(path) - 1;
@@ -104,24 +126,137 @@ char *AddDefaultExtension(char *path, const char *ext)
 // LUMP BASED ROUTINES.
 //
 
+#ifdef ESP_PLATFORM
+typedef struct
+{
+  char magic[4];
+  uint32_t size;
+  uint32_t checksum;
+} wadtrailer_t;
+
+typedef struct
+{
+  uint32_t size;
+  uint32_t mtime;
+  uint32_t checksum;
+} wadchecksum_t;
+
 //
-// W_AddFile
-// All files are optional, but at least one file must be
-//  found (PWAD, if all required lumps are present).
-// Files with a .wad extension are wadlink files
-//  with multiple lumps.
-// Other files are single lumps with the base filename
-//  for the lump name.
+// W_FileChecksum
+// CRC32 of the whole file, cached next to it as long as its size and mtime don't change
 //
-// Reload hack removed by Lee Killough
-// CPhipps - source is an enum
+static boolean W_FileChecksum(wadfile_info_t *wadfile, uint32_t *checksum)
+{
+  char path[PATH_MAX + 1];
+  wadchecksum_t cached;
+  uint32_t crc = 0;
+  byte *buffer;
+  FILE *fp;
+
+  snprintf(path, PATH_MAX, "%s%s", wadfile->name, WAD_CHECKSUM_EXT);
+
+  if ((fp = fopen(path, "rb")))
+  {
+    boolean valid = fread(&cached, sizeof(cached), 1, fp) == 1 && cached.size == wadfile->size &&
+                    cached.mtime == (uint32_t)wadfile->mtime;
+    fclose(fp);
+    if (valid)
+    {
+      *checksum = cached.checksum;
+      return true;
+    }
+  }
+
+  if (!(buffer = malloc(32 * 1024)))
+    return false;
+
+  for (size_t pos = 0; pos < wadfile->size; pos += 32 * 1024)
+  {
+    size_t len = MIN(wadfile->size - pos, 32 * 1024);
+    if (W_Read(buffer, len, pos, wadfile) != len)
+    {
+      free(buffer);
+      return false;
+    }
+    crc = rg_crc32(crc, buffer, len);
+  }
+  free(buffer);
+
+  cached = (wadchecksum_t){wadfile->size, wadfile->mtime, crc};
+  if ((fp = fopen(path, "wb")))
+  {
+    fwrite(&cached, sizeof(cached), 1, fp);
+    fclose(fp);
+  }
+
+  *checksum = crc;
+  return true;
+}
+#endif
+
 //
-// proff - changed using pointer to wadfile_info_t
-static void W_AddFile(wadfile_info_t *wadfile)
+// W_MapFile
+// Try to get the whole file addressable without reading it in RAM: either
+// memory mapped from the filesystem or from a flash partition holding a copy.
+//
+static boolean W_MapFile(wadfile_info_t *wadfile)
 {
-  size_t startlump = numlumps;
-  filelump_t *lumpindex, *fileinfo;
-  wadinfo_t header;
+#if defined(HAVE_MMAP)
+  int fd = open(wadfile->name, O_RDONLY);
+  void *data = MAP_FAILED;
+
+  if (fd < 0)
+    return false;
+  if (wadfile->size > 0)
+    data = mmap(NULL, wadfile->size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (data == MAP_FAILED)
+    return false;
+
+  wadfile->data = data;
+  return true;
+#elif defined(ESP_PLATFORM)
+  const esp_partition_t *partition;
+  esp_partition_mmap_handle_t handle;
+  const void *data;
+  wadtrailer_t trailer;
+  uint32_t checksum;
+
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, WAD_PARTITION_LABEL);
+  if (!partition || partition->size < wadfile->size + sizeof(trailer))
+    return false;
+
+  // The partition must hold the same WAD, the trailer after it gives its size and its CRC32
+  if (esp_partition_read(partition, wadfile->size, &trailer, sizeof(trailer)) != ESP_OK ||
+      memcmp(trailer.magic, WAD_PARTITION_MAGIC, 4) || trailer.size != wadfile->size)
+    return false;
+
+  if (!W_FileChecksum(wadfile, &checksum) || checksum != trailer.checksum)
+  {
+    lprintf(LO_WARN, "W_MapFile: %s differs from the copy in flash\n", wadfile->name);
+    return false;
+  }
+
+  if (esp_partition_mmap(partition, 0, wadfile->size, ESP_PARTITION_MMAP_DATA, &data, &handle) != ESP_OK)
+    return false;
+
+  wadfile->data = data;
+  return true;
+#else
+  return false;
+#endif
+}
+
+//
+// W_OpenFile
+// Get the file ready for W_Read, mapping it in memory when possible
+//
+static void W_OpenFile(wadfile_info_t *wadfile)
+{
+  struct stat st;
+
+  wadfile->mtime = stat(wadfile->name, &st) == 0 ? st.st_mtime : 0;
 
   // If we do not have the whole thing in memory then we open it from disk
   if (!wadfile->data)
@@ -136,13 +271,37 @@ static void W_AddFile(wadfile_info_t *wadfile)
       fseek(wadfile->handle, 0, SEEK_END);
       wadfile->size = ftell(wadfile->handle);
     }
+    if (wadfile->handle && W_MapFile(wadfile))
+    {
+      fclose(wadfile->handle);
+      wadfile->handle = NULL;
+    }
   }
 
   if (!wadfile->handle && !wadfile->data)
-    I_Error("W_AddFile: couldn't open %s", wadfile->name);
+    I_Error("W_OpenFile: couldn't open %s", wadfile->name);
+}
 
-  W_Read(&header, sizeof(header), 0, wadfile);
+//
+// W_AddFile
+// All files are optional, but at least one file must be
+//  found (PWAD, if all required lumps are present).
+// Files with a .wad extension are wadlink files
+//  with multiple lumps.
+// Other files are single lumps with the base filename
+//  for the lump name.
+//
+// Reload hack removed by Lee Killough
+// CPhipps - source is an enum
+//
+// proff - changed using pointer to wadfile_info_t
+static void W_AddFile(wadfile_info_t *wadfile)
+{
+  size_t startlump = numlumps;
+  filelump_t *lumpindex, *fileinfo;
+  wadinfo_t header;
 
+  W_Read(&header, sizeof(header), 0, wadfile);
   if (strncmp(header.identification, "IWAD", 4) && strncmp(header.identification, "PWAD", 4))
   {
     // Assume it's a single lump file
@@ -343,6 +502,158 @@ void W_HashLumps(void)
 
 // End of lump hashing -- killough 1/31/98
 
+//
+// Lump directory cache
+// The coalesced and hashed directory of all the loaded files is saved next to
+// the last WAD so the next startup doesn't have to parse and sort it again.
+//
+
+#define DIRCACHE_MAGIC "LDIR"
+#define DIRCACHE_VERSION 1
+
+typedef struct
+{
+  char magic[4];
+  int  version;
+  unsigned int key;
+  int  numlumps;
+} dircache_header_t;
+
+typedef struct
+{
+  char  name[8];
+  short li_namespace;
+  short wadfile;          // index in wadfiles[], -1 for markers
+  short index, next;
+  int   size;
+  int   position;
+} dircache_lump_t;
+
+// Identifies the exact set of files (and order) the directory was built from
+static unsigned int W_DirectoryCacheKey(void)
+{
+  unsigned int key = 2166136261u;
+
+  for (size_t i = 0; i < numwadfiles; i++)
+  {
+    for (const char *c = wadfiles[i].name; *c; c++)
+      key = (key ^ (byte)*c) * 16777619u;
+    key = (key ^ (unsigned int)wadfiles[i].size) * 16777619u;
+    key = (key ^ (unsigned int)wadfiles[i].mtime) * 16777619u;
+  }
+
+  return key;
+}
+
+static const char *W_DirectoryCachePath(void)
+{
+  static char path[PATH_MAX + 1];
+
+  // Use the last file that lives on the filesystem, built-in prboom.wad is always first
+  for (size_t i = numwadfiles; i-- > 0;)
+  {
+    if (wadfiles[i].mtime)
+    {
+      snprintf(path, PATH_MAX, "%s%s", wadfiles[i].name, WAD_DIRECTORY_EXT);
+      return path;
+    }
+  }
+
+  return NULL;
+}
+
+static boolean W_LoadDirectoryCache(const char *path)
+{
+  dircache_header_t header;
+  dircache_lump_t *lumps = NULL;
+  boolean success = false;
+  FILE *fp;
+
+  if (!path || !(fp = fopen(path, "rb")))
+    return false;
+
+  if (fread(&header, sizeof(header), 1, fp) != 1 ||
+      memcmp(header.magic, DIRCACHE_MAGIC, 4) ||
+      header.version != DIRCACHE_VERSION ||
+      header.key != W_DirectoryCacheKey() ||
+      header.numlumps <= 0 || header.numlumps > SHRT_MAX)
+    goto done;
+
+  lumps = malloc(header.numlumps * sizeof(dircache_lump_t));
+  lumpinfo = malloc(header.numlumps * sizeof(lumpinfo_t));
+  if (!lumps || !lumpinfo || fread(lumps, sizeof(dircache_lump_t), header.numlumps, fp) != header.numlumps)
+    goto done;
+
+  for (int i = 0; i < header.numlumps; i++)
+  {
+    lumpinfo_t *lump_p = &lumpinfo[i];
+    // Nothing in there is trusted: chains must stay in the table and only point to earlier lumps
+    // (as W_HashLumps builds them, which also rules out loops), lumps must lie within their file
+    if (lumps[i].wadfile < -1 || lumps[i].wadfile >= (int)numwadfiles ||
+        lumps[i].index < -1 || lumps[i].index >= header.numlumps ||
+        lumps[i].next < -1 || lumps[i].next >= i ||
+        lumps[i].size < 0 || lumps[i].position < 0)
+      goto done;
+    if (lumps[i].wadfile >= 0 &&
+        (size_t)lumps[i].position + lumps[i].size > wadfiles[lumps[i].wadfile].size)
+      goto done;
+    memcpy(lump_p->name, lumps[i].name, 8);
+    lump_p->li_namespace = lumps[i].li_namespace;
+    lump_p->wadfile = lumps[i].wadfile < 0 ? NULL : &wadfiles[lumps[i].wadfile];
+    lump_p->index = lumps[i].index;
+    lump_p->next = lumps[i].next;
+    lump_p->size = lumps[i].size;
+    lump_p->position = lumps[i].position;
+    lump_p->locks = 0;
+    lump_p->ptr = NULL;
+  }
+
+  numlumps = header.numlumps;
+  success = true;
+
+done:
+  if (!success)
+  {
+    lprintf(LO_WARN, "W_LoadDirectoryCache: %s is stale or invalid\n", path);
+    free(lumpinfo);
+    lumpinfo = NULL;
+  }
+  free(lumps);
+  fclose(fp);
+  return success;
+}
+
+static void W_SaveDirectoryCache(const char *path)
+{
+  dircache_header_t header = {DIRCACHE_MAGIC, DIRCACHE_VERSION, W_DirectoryCacheKey(), numlumps};
+  dircache_lump_t *lumps;
+  FILE *fp;
+
+  if (!path || numlumps > SHRT_MAX || !(lumps = calloc(numlumps, sizeof(dircache_lump_t))))
+    return;
+
+  for (size_t i = 0; i < numlumps; i++)
+  {
+    memcpy(lumps[i].name, lumpinfo[i].name, 8);
+    lumps[i].li_namespace = lumpinfo[i].li_namespace;
+    lumps[i].wadfile = lumpinfo[i].wadfile ? lumpinfo[i].wadfile - wadfiles : -1;
+    lumps[i].index = lumpinfo[i].index;
+    lumps[i].next = lumpinfo[i].next;
+    lumps[i].size = lumpinfo[i].size;
+    lumps[i].position = lumpinfo[i].position;
+  }
+
+  if ((fp = fopen(path, "wb")))
+  {
+    if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+        fwrite(lumps, sizeof(dircache_lump_t), numlumps, fp) != numlumps)
+      lprintf(LO_WARN, "W_SaveDirectoryCache: failed to write %s\n", path);
+    fclose(fp);
+  }
+
+  free(lumps);
+}
+
 
 // W_GetNumForName
 // Calls W_CheckNumForName, but bombs out if not found.
@@ -374,6 +685,17 @@ void W_Init(void)
   lumpinfo = NULL;
   numlumps = 0;
 
+  for (size_t i = 0; i < numwadfiles; i++)
+    W_OpenFile(&wadfiles[i]);
+
+  const char *cache_path = W_DirectoryCachePath();
+
+  if (W_LoadDirectoryCache(cache_path))
+  {
+    lprintf(LO_INFO, " loaded lump directory from %s (%d lumps)\n", cache_path, (int)numlumps);
+    return;
+  }
+
   for (size_t i = 0; i < numwadfiles; i++)
     W_AddFile(&wadfiles[i]);
 
@@ -385,6 +707,8 @@ void W_Init(void)
   W_CoalesceMarkedResource("C_START", "C_END", ns_colormaps);
 
   W_HashLumps();
+
+  W_SaveDirectoryCache(cache_path);
 }
 
 //
@@ -454,9 +778,18 @@ const void *W_CacheLumpNum(int lump)
   {
     // Bypass caching if we have the WAD mapped in memory
     if (l->wadfile && l->wadfile->data)
+    {
+      lumpcachehits++;
       return l->wadfile->data + l->position;
+    }
     W_ReadLump(Z_Malloc(W_LumpLength(lump), PU_STATIC, &l->ptr), lump);
     l->locks = 0;
+    lumpcachemisses++;
+    lumpbytesread += l->size;
+  }
+  else
+  {
+    lumpcachehits++;
   }
 
   if (++l->locks == 1)
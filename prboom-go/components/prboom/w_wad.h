@@ -35,6 +35,8 @@
 #ifndef __W_WAD__
 #define __W_WAD__
 
+#include <time.h>
+
 //
 // WADFILE I/O related stuff.
 //
@@ -67,6 +69,7 @@ typedef struct
   const void *data;
   size_t size;
   void *handle;
+  time_t mtime;           // used to validate the lump directory cache
 } wadfile_info_t;
 
 typedef struct
@@ -88,6 +91,11 @@ extern size_t numwadfiles;
 extern lumpinfo_t *lumpinfo;
 extern size_t      numlumps;
 
+// Lump cache statistics (mapped lumps count as hits)
+extern unsigned int lumpcachehits;
+extern unsigned int lumpcachemisses;
+extern size_t       lumpbytesread;
+
 void    W_Init(void);
 int     W_CheckNumForNameNs(const char* name, int);
 int     W_GetNumForName(const char* name);
@@ -56,11 +56,19 @@
 #define CHUNK_SIZE 4        // Minimum chunk size at which blocks are allocated
 #define ZONEID  0x931d4a11  // signature for block header
 
+// Where a block's memory comes from
+enum {
+  POOL_SYSTEM = 0,          // system malloc, one call per block
+  POOL_REGION,              // purgeable region, see Z_RegionAlloc
+  POOL_SLAB,                // POOL_SLAB + n is the n-th slab size class
+};
+
 typedef struct memblock
 {
   uint32_t zoneid;
-  uint32_t tag: 10;
-  uint32_t size:22;
+  uint32_t tag: 5;
+  uint32_t pool: 5;
+  uint32_t size:22;         // slab blocks store their page index instead
 
   struct memblock *next,*prev;
   void **user;
@@ -79,6 +87,252 @@ static const size_t HEADER_SIZE = (sizeof(memblock_t)+CHUNK_SIZE-1) & ~(CHUNK_SI
 
 static memblock_t *blockbytag[PU_MAX];
 
+//
+// Size-class slabs
+// Small blocks (thinkers, mobjs, msecnodes, ...) are carved out of fixed size
+// pages so that the level churn doesn't fragment the system heap.
+//
+
+static const unsigned short slab_sizes[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+#define NUM_SLAB_CLASSES (sizeof(slab_sizes) / sizeof(*slab_sizes))
+#define SLAB_MAX_SIZE 512
+
+typedef struct slabpage
+{
+  struct slabpage *next, *prev; // pages of this class that have free slots
+  memblock_t *free;             // free slots, linked through memblock_t.next
+  unsigned short sclass;
+  unsigned short used;
+  unsigned short slots;
+  unsigned int index;           // in slabpages[]
+} slabpage_t;
+
+static slabpage_t *slabpartial[NUM_SLAB_CLASSES];
+static slabpage_t **slabpages;
+static unsigned int numslabpages, maxslabpages;
+
+//
+// Purgeable region
+// Blocks that have an owner (lumps, patches, composites) are likely to become
+// PU_CACHE and be purged later. They're kept in one contiguous region, where
+// purged lumps make room for new lumps instead of leaving holes in the heap.
+//
+
+static byte *region, *region_end;
+static memblock_t *region_rover;
+
+#define REGION_MIN_FRAGMENT 64
+#define REGION_NEXT(b) ((memblock_t *)((byte *)(b) + HEADER_SIZE + (b)->size))
+
+// Bytes obtained from each pool, for Z_GetStats
+static size_t system_used, slab_used, region_used;
+
+static inline size_t Z_BlockSize(const memblock_t *block)
+{
+  return block->pool >= POOL_SLAB ? slab_sizes[block->pool - POOL_SLAB] : block->size;
+}
+
+static memblock_t *Z_SlabAlloc(size_t size)
+{
+  unsigned int sclass = 0;
+
+  while (slab_sizes[sclass] < size)
+    sclass++;
+
+  slabpage_t *page = slabpartial[sclass];
+
+  if (!page)
+  {
+    size_t slot_size = HEADER_SIZE + slab_sizes[sclass];
+    size_t header_size = (sizeof(slabpage_t) + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1);
+    unsigned int index = 0;
+
+    // Reuse the index of a released page if any
+    while (index < numslabpages && slabpages[index])
+      index++;
+
+    if (index == maxslabpages)
+    {
+      slabpage_t **pages = (realloc)(slabpages, (maxslabpages + 64) * sizeof(*pages));
+      if (!pages)
+        return NULL;
+      slabpages = pages;
+      maxslabpages += 64;
+    }
+
+    if (!(page = (malloc)(ZONE_SLAB_PAGE_SIZE)))
+      return NULL;
+
+    page->next = page->prev = NULL;
+    page->free = NULL;
+    page->sclass = sclass;
+    page->used = 0;
+    page->slots = (ZONE_SLAB_PAGE_SIZE - header_size) / slot_size;
+    page->index = index;
+
+    if (index == numslabpages)
+      numslabpages++;
+    slabpages[index] = page;
+
+    for (int i = page->slots - 1; i >= 0; i--)
+    {
+      memblock_t *slot = (memblock_t *)((byte *)page + header_size + i * slot_size);
+      slot->zoneid = 0;
+      slot->next = page->free;
+      page->free = slot;
+    }
+
+    slabpartial[sclass] = page;
+  }
+
+  memblock_t *block = page->free;
+  page->free = block->next;
+
+  if (++page->used == page->slots)
+  {
+    // The page is full, take it out of the partial list
+    slabpartial[sclass] = page->next;
+    if (page->next)
+      page->next->prev = NULL;
+    page->next = page->prev = NULL;
+  }
+
+  block->pool = POOL_SLAB + sclass;
+  block->size = page->index;
+  slab_used += slab_sizes[sclass];
+
+  return block;
+}
+
+static void Z_SlabFree(memblock_t *block)
+{
+  unsigned int sclass = block->pool - POOL_SLAB;
+  slabpage_t *page = slabpages[block->size];
+
+  slab_used -= slab_sizes[sclass];
+
+  if (page->used-- == page->slots)
+  {
+    // The page was full, make it available again
+    page->prev = NULL;
+    page->next = slabpartial[sclass];
+    if (page->next)
+      page->next->prev = page;
+    slabpartial[sclass] = page;
+  }
+
+  // Release empty pages unless it's the only one left for this class
+  if (page->used == 0 && (page->next || page->prev))
+  {
+    if (page->prev)
+      page->prev->next = page->next;
+    else
+      slabpartial[sclass] = page->next;
+    if (page->next)
+      page->next->prev = page->prev;
+    slabpages[page->index] = NULL;
+    (free)(page);
+    return;
+  }
+
+  block->next = page->free;
+  page->free = block;
+}
+
+// Merge the free blocks that follow a free block in the region
+static void Z_RegionMerge(memblock_t *block)
+{
+  memblock_t *next;
+
+  while ((byte *)(next = REGION_NEXT(block)) < region_end && next->tag == PU_FREE)
+  {
+    if (next == region_rover)
+      region_rover = block;
+    block->size += HEADER_SIZE + next->size;
+  }
+}
+
+// Take size bytes at the start of a free (and merged) region block
+static memblock_t *Z_RegionTake(memblock_t *block, size_t size)
+{
+  size_t extra = block->size - size;
+
+  if (extra >= HEADER_SIZE + REGION_MIN_FRAGMENT)
+  {
+    block->size = size;
+    memblock_t *rest = REGION_NEXT(block);
+    rest->zoneid = 0;
+    rest->tag = PU_FREE;
+    rest->pool = POOL_REGION;
+    rest->size = extra - HEADER_SIZE;
+    region_rover = rest;
+  }
+  else
+  {
+    region_rover = (byte *)REGION_NEXT(block) < region_end ? REGION_NEXT(block) : (memblock_t *)region;
+  }
+
+  region_used += HEADER_SIZE + block->size;
+  return block;
+}
+
+// First fit, starting at the rover and merging free blocks along the way
+static memblock_t *Z_RegionFind(size_t size)
+{
+  memblock_t *block = region_rover;
+
+  do
+  {
+    if (block->tag == PU_FREE)
+    {
+      Z_RegionMerge(block);
+      if (block->size >= size)
+        return Z_RegionTake(block, size);
+    }
+    block = REGION_NEXT(block);
+    if ((byte *)block >= region_end)
+      block = (memblock_t *)region;
+  } while (block != region_rover);
+
+  return NULL;
+}
+
+static memblock_t *Z_RegionAlloc(size_t size, boolean purge)
+{
+  memblock_t *block;
+
+  if (!region || size > (size_t)(region_end - region))
+    return NULL;
+
+  if ((block = Z_RegionFind(size)) || !purge)
+    return block;
+
+  // Evict the least recently released cached blocks living in the region
+  // until one of the holes they leave is large enough
+  memblock_t *cached = blockbytag[PU_CACHE];
+  memblock_t *end = cached ? cached->prev : NULL;
+
+  while (cached)
+  {
+    memblock_t *next = cached->next;
+    boolean last = (cached == end);
+
+    if (cached->pool == POOL_REGION)
+    {
+      (Z_Free)((byte *)cached + HEADER_SIZE DA(__FILE__, __LINE__));
+      Z_RegionMerge(cached);
+      if (cached->size >= size)
+        return Z_RegionTake(cached, size);
+    }
+
+    if (last)
+      break;
+    cached = next;
+  }
+
+  return Z_RegionFind(size);
+}
+
 #ifdef INSTRUMENTED
 
 // statistics for evaluating performance
@@ -133,20 +387,20 @@ void Z_DumpMemory(void)
     {
       switch (block->tag) {
       case PU_FREE:
-        fprintf(fp, "free %d\n", block->size);
-        total_free += block->size;
+        fprintf(fp, "free %d\n", (int)Z_BlockSize(block));
+        total_free += Z_BlockSize(block);
         break;
       case PU_CACHE:
-        fprintf(fp, "cache %s:%d:%d\n", block->file, block->line, block->size);
-        total_cache += block->size;
+        fprintf(fp, "cache %s:%d:%d\n", block->file, block->line, (int)Z_BlockSize(block));
+        total_cache += Z_BlockSize(block);
         break;
       case PU_LEVEL:
-        fprintf(fp, "level %s:%d:%d\n", block->file, block->line, block->size);
-        total_malloc += block->size;
+        fprintf(fp, "level %s:%d:%d\n", block->file, block->line, (int)Z_BlockSize(block));
+        total_malloc += Z_BlockSize(block);
         break;
       default:
-        fprintf(fp, "malloc %s:%d:%d", block->file, block->line, block->size);
-        total_malloc += block->size;
+        fprintf(fp, "malloc %s:%d:%d", block->file, block->line, (int)Z_BlockSize(block));
+        total_malloc += Z_BlockSize(block);
         if (block->file)
           if (strstr(block->file,"w_memcache.c"))
             W_PrintLump(fp, (char*)block + HEADER_SIZE);
@@ -177,7 +431,63 @@ void Z_Close(void)
 
 void Z_Init(void)
 {
-  // Nothing to do
+  // The block size field is 22 bits wide
+  size_t size = MIN(ZONE_REGION_SIZE, (1 << 22) - 1) & ~(CHUNK_SIZE-1);
+
+  // Best effort, everything still works from the system heap without a region
+  if (size > HEADER_SIZE && (region = (malloc)(size)))
+  {
+    region_end = region + size;
+    region_rover = (memblock_t *)region;
+    region_rover->zoneid = 0;
+    region_rover->tag = PU_FREE;
+    region_rover->pool = POOL_REGION;
+    region_rover->size = size - HEADER_SIZE;
+  }
+  else
+  {
+    lprintf(LO_WARN, "Z_Init: purgeable region unavailable\n");
+  }
+}
+
+void Z_GetStats(zone_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  stats->system_used = system_used;
+  stats->slab_used = slab_used;
+
+  for (unsigned int i = 0; i < numslabpages; i++)
+    if (slabpages[i])
+      stats->slab_size += ZONE_SLAB_PAGE_SIZE;
+
+  for (memblock_t *block = blockbytag[PU_CACHE]; block; block = block->next)
+  {
+    stats->cache_used += Z_BlockSize(block);
+    if (block->next == blockbytag[PU_CACHE])
+      break;
+  }
+
+  if (region)
+  {
+    stats->region_size = region_end - region;
+    stats->region_used = region_used;
+
+    // Adjacent free blocks may not be merged yet, count them as one
+    size_t run = 0;
+    for (memblock_t *block = (memblock_t *)region; (byte *)block < region_end; block = REGION_NEXT(block))
+    {
+      if (block->tag == PU_FREE)
+      {
+        if (run == 0)
+          stats->region_fragments++;
+        run += HEADER_SIZE + block->size;
+        stats->region_largest = MAX(stats->region_largest, run - HEADER_SIZE);
+      }
+      else
+        run = 0;
+    }
+  }
 }
 
 void *(Z_Malloc)(size_t size, int tag, void **user DA(const char *file, int line))
@@ -202,7 +512,21 @@ void *(Z_Malloc)(size_t size, int tag, void **user DA(const char *file, int line
 
   size = (size+CHUNK_SIZE-1) & ~(CHUNK_SIZE-1);  // round to chunk size
 
-  while (!(block = (malloc)(size + HEADER_SIZE))) {
+  if (size <= SLAB_MAX_SIZE)
+    block = Z_SlabAlloc(size);
+  else if (user)
+    block = Z_RegionAlloc(size, true);
+
+  while (!block) {
+    if ((block = (malloc)(size + HEADER_SIZE))) {
+      block->pool = POOL_SYSTEM;
+      block->size = size;
+      system_used += size + HEADER_SIZE;
+      break;
+    }
+    // The region is the last resort for any kind of block
+    if ((block = Z_RegionAlloc(size, false)))
+      break;
     if (!blockbytag[PU_CACHE])
       I_Error ("Z_Malloc: Failure trying to allocate %lu bytes"
 #ifdef INSTRUMENTED
@@ -230,13 +554,11 @@ void *(Z_Malloc)(size_t size, int tag, void **user DA(const char *file, int line
     blockbytag[tag]->prev = block;
   }
 
-  block->size = size;
-
 #ifdef INSTRUMENTED
   if (tag >= PU_PURGELEVEL)
-    purgable_memory += block->size;
+    purgable_memory += Z_BlockSize(block);
   else
-    active_memory += block->size;
+    active_memory += Z_BlockSize(block);
 #endif
 
 #ifdef INSTRUMENTED
@@ -259,7 +581,6 @@ void *(Z_Malloc)(size_t size, int tag, void **user DA(const char *file, int line
 
   return block;
 }
-
 void (Z_Free)(void *p DA(const char *file, int line))
 {
   memblock_t *block = (memblock_t *)((char *) p - HEADER_SIZE);
@@ -296,15 +617,26 @@ void (Z_Free)(void *p DA(const char *file, int line))
 
 #ifdef INSTRUMENTED
   if (block->tag >= PU_PURGELEVEL)
-    purgable_memory -= block->size;
+    purgable_memory -= Z_BlockSize(block);
   else
-    active_memory -= block->size;
+    active_memory -= Z_BlockSize(block);
 
   /* scramble memory -- weed out any bugs */
-  memset(block, gametic & 0xff, block->size + HEADER_SIZE);
+  memset(p, gametic & 0xff, Z_BlockSize(block));
 #endif
 
-  (free)(block);
+  if (block->pool >= POOL_SLAB)
+    Z_SlabFree(block);
+  else if (block->pool == POOL_REGION)
+  {
+    block->tag = PU_FREE;       // merged lazily by the next allocations
+    region_used -= HEADER_SIZE + block->size;
+  }
+  else
+  {
+    system_used -= HEADER_SIZE + block->size;
+    (free)(block);
+  }
 
 #ifdef INSTRUMENTED
       Z_DrawStats();           // print memory allocation stats
@@ -396,14 +728,14 @@ void (Z_ChangeTag)(void *ptr, int tag DA(const char *file, int line))
 #ifdef INSTRUMENTED
   if (block->tag < PU_PURGELEVEL && tag >= PU_PURGELEVEL)
   {
-    active_memory -= block->size;
-    purgable_memory += block->size;
+    active_memory -= Z_BlockSize(block);
+    purgable_memory += Z_BlockSize(block);
   }
   else
     if (block->tag >= PU_PURGELEVEL && tag < PU_PURGELEVEL)
     {
-      active_memory += block->size;
-      purgable_memory -= block->size;
+      active_memory += Z_BlockSize(block);
+      purgable_memory -= Z_BlockSize(block);
     }
 #endif
 
@@ -416,7 +748,8 @@ void *(Z_Realloc)(void *ptr, size_t n, int tag, void **user DA(const char *file,
   if (ptr)
     {
       memblock_t *block = (memblock_t *)((char *) ptr - HEADER_SIZE);
-      memcpy(p, ptr, n <= block->size ? n : block->size);
+      size_t size = Z_BlockSize(block);
+      memcpy(p, ptr, n <= size ? n : size);
       (Z_Free)(ptr DA(file, line));
       if (user) // in case Z_Free nullified same user
         *user=p;
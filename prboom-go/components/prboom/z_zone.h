@@ -76,7 +76,20 @@ enum {
 #define DAC(x,y)
 #endif
 
+typedef struct
+{
+  size_t system_used;     // blocks allocated directly from the system heap
+  size_t slab_size;       // pages held by the size-class slabs
+  size_t slab_used;       // slots in use in those pages
+  size_t region_size;     // purgeable region
+  size_t region_used;
+  size_t region_largest;  // largest free block in the region
+  size_t region_fragments;// number of free holes in the region
+  size_t cache_used;      // purgeable blocks (PU_CACHE), any pool
+} zone_stats_t;
+
 void (Z_Init)(void);
+void (Z_GetStats)(zone_stats_t *stats);
 void (Z_Close)(void);
 void (Z_CheckHeap)(DAC(const char *,int));   // killough 3/22/98: add file/line info
 void (Z_ChangeTag)(void *ptr, int tag DA(const char *, int));
@@ -37,6 +37,7 @@
 #include <r_fps.h>
 #include <s_sound.h>
 #include <st_stuff.h>
+#include <w_wad.h>
 #include <mus2mid.h>
 #include <midifile.h>
 #include <oplplayer.h>
@@ -70,14 +71,16 @@ typedef struct {
 
 typedef struct {
     const doom_sfx_t *sfx;
-    size_t pos;
-    float factor;
+    uint32_t pos;  // 16.16 position in the sfx
+    uint32_t step; // 16.16 increment per output sample
+    int left, right;
     int starttic;
 } channel_t;
 
 static channel_t channels[NUM_MIX_CHANNELS];
 static const doom_sfx_t *sfx[NUMSFX];
 static rg_audio_sample_t mixbuffer[AUDIO_BUFFER_LENGTH];
+static int32_t mixaccum[AUDIO_BUFFER_LENGTH * 2];
 static const music_player_t *music_player = &opl_synth_player;
 static bool musicPlaying = false;
 
@@ -128,6 +131,45 @@ static rg_gui_event_t gamma_update_cb(rg_gui_option_t *option, rg_gui_event_t ev
     return RG_DIALOG_VOID;
 }
 
+static rg_gui_event_t lump_cache_cb(rg_gui_option_t *option, rg_gui_event_t event)
+{
+    sprintf(option->value, "%u hit %u miss", lumpcachehits, lumpcachemisses);
+    return RG_DIALOG_VOID;
+}
+
+static rg_gui_event_t lump_read_cb(rg_gui_option_t *option, rg_gui_event_t event)
+{
+    sprintf(option->value, "%dKB", (int)(lumpbytesread / 1024));
+    return RG_DIALOG_VOID;
+}
+
+static rg_gui_event_t zone_slabs_cb(rg_gui_option_t *option, rg_gui_event_t event)
+{
+    zone_stats_t stats;
+    Z_GetStats(&stats);
+    sprintf(option->value, "%dKB/%dKB", (int)(stats.slab_used / 1024), (int)(stats.slab_size / 1024));
+    return RG_DIALOG_VOID;
+}
+
+static rg_gui_event_t zone_region_cb(rg_gui_option_t *option, rg_gui_event_t event)
+{
+    zone_stats_t stats;
+    Z_GetStats(&stats);
+    sprintf(option->value, "%dKB/%dKB", (int)(stats.region_used / 1024), (int)(stats.region_size / 1024));
+    return RG_DIALOG_VOID;
+}
+
+static rg_gui_event_t zone_frag_cb(rg_gui_option_t *option, rg_gui_event_t event)
+{
+    zone_stats_t stats;
+    Z_GetStats(&stats);
+    size_t available = stats.region_size - stats.region_used;
+    int frag = available ? 100 - (int)(stats.region_largest * 100 / available) : 0;
+    sprintf(option->value, "%d%% (%d holes, max %dKB)", frag, (int)stats.region_fragments,
+            (int)(stats.region_largest / 1024));
+    return RG_DIALOG_VOID;
+}
+
 
 void I_StartFrame(void)
 {
@@ -209,8 +251,18 @@ const char *I_DoomExeDir(void)
     return RG_BASE_PATH_ROMS "/doom";
 }
 
+static void set_channel_params(channel_t *chan, int volume, int seperation)
+{
+    // seperation goes from 0 (left) to 255 (right), volume from 0 to 127
+    seperation = MIN(MAX(seperation, 1), 254);
+    chan->left = (254 - seperation) * volume / 127;
+    chan->right = seperation * volume / 127;
+}
+
 void I_UpdateSoundParams(int handle, int volume, int seperation, int pitch)
 {
+    if (handle >= 0 && handle < NUM_MIX_CHANNELS)
+        set_channel_params(&channels[handle], volume, seperation);
 }
 
 int I_StartSound(int sfxid, int channel, int vol, int sep, int pitch, int priority)
@@ -249,9 +301,10 @@ int I_StartSound(int sfxid, int channel, int vol, int sep, int pitch, int priori
     }
 
     channel_t *chan = &channels[slot];
-    chan->sfx = sfx[sfxid];
-    chan->factor = (float)chan->sfx->samplerate / snd_samplerate;
+    chan->step = MAX(((uint32_t)sfx[sfxid]->samplerate << 16) / snd_samplerate, 1);
     chan->pos = 0;
+    set_channel_params(chan, vol, sep);
+    chan->sfx = sfx[sfxid];
 
     return slot;
 }
@@ -276,10 +329,46 @@ bool I_AnySoundStillPlaying(void)
     return false;
 }
 
+// Resamples the channel and adds it to the interleaved stereo accumulator, returns false once it has ended
+static bool mix_channel(channel_t *chan, int32_t *restrict accum, int count)
+{
+    const doom_sfx_t *sfx = chan->sfx;
+    if (!sfx)
+        return false;
+
+    const byte *samples = sfx->samples;
+    uint32_t pos = chan->pos, step = chan->step;
+    uint32_t end = (uint32_t)sfx->length << 16;
+    int left = chan->left, right = chan->right;
+
+    // Stop at the last sample instead of checking the position every time
+    uint32_t remaining = pos < end ? (end - pos + step - 1) / step : 0;
+    bool ended = remaining <= (uint32_t)count;
+    if (ended)
+        count = remaining;
+
+    for (int i = 0; i < count; i++)
+    {
+        int sample = samples[pos >> 16] - 128;
+        accum[i * 2 + 0] += sample * left;
+        accum[i * 2 + 1] += sample * right;
+        pos += step;
+    }
+
+    chan->pos = pos;
+    if (ended)
+        chan->sfx = NULL;
+    return true;
+}
+
 static void soundTask(void *arg)
 {
+    int16_t *audioBuffer = (int16_t *)mixbuffer;
+    int32_t *accum = mixaccum;
+
     while (1)
     {
+        RG_PROFILE_BEGIN(mix_zone, "mixer");
         bool haveMusic = snd_MusicVolume > 0 && musicPlaying;
         bool haveSFX = snd_SfxVolume > 0 && I_AnySoundStillPlaying();
 
@@ -290,52 +379,27 @@ static void soundTask(void *arg)
 
         if (haveSFX)
         {
-            int16_t *audioBuffer = (int16_t *)mixbuffer;
-            int16_t *audioBufferEnd = audioBuffer + AUDIO_BUFFER_LENGTH * 2;
-            while (audioBuffer < audioBufferEnd)
+            int totalSources = 0;
+
+            if (haveMusic)
+            {
+                for (int i = 0; i < AUDIO_BUFFER_LENGTH * 2; i++)
+                    accum[i] = audioBuffer[i];
+            }
+            else
             {
-                int totalSample = 0;
-                int totalSources = 0;
-                int sample;
-
-                for (int i = 0; i < NUM_MIX_CHANNELS; i++)
-                {
-                    channel_t *chan = &channels[i];
-                    if (!chan->sfx)
-                        continue;
-
-                    size_t pos = (size_t)(chan->pos++ * chan->factor);
-
-                    if (pos >= chan->sfx->length)
-                    {
-                        chan->sfx = NULL;
-                    }
-                    else if ((sample = chan->sfx->samples[pos]))
-                    {
-                        totalSample += sample - 127;
-                        totalSources++;
-                    }
-                }
-
-                totalSample <<= 7;
-                totalSample /= (16 - snd_SfxVolume);
-
-                if (haveMusic)
-                {
-                    totalSample += *audioBuffer;
-                    totalSources += (totalSources == 0);
-                }
-
-                if (totalSources > 0)
-                    totalSample /= totalSources;
-
-                if (totalSample > 32767)
-                    totalSample = 32767;
-                else if (totalSample < -32768)
-                    totalSample = -32768;
-
-                *audioBuffer++ = totalSample;
-                *audioBuffer++ = totalSample;
+                memset(mixaccum, 0, sizeof(mixaccum));
+            }
+
+            for (int i = 0; i < NUM_MIX_CHANNELS; i++)
+                totalSources += mix_channel(&channels[i], accum, AUDIO_BUFFER_LENGTH);
+
+            // Normalize once for the whole block, 8.8 fixed point
+            int gain = 256 / MAX(totalSources, 1);
+            for (int i = 0; i < AUDIO_BUFFER_LENGTH * 2; i++)
+            {
+                int sample = (accum[i] * gain) >> 8;
+                audioBuffer[i] = MIN(MAX(sample, -32768), 32767);
             }
         }
 
@@ -343,6 +407,7 @@ static void soundTask(void *arg)
         {
             memset(mixbuffer, 0, sizeof(mixbuffer));
         }
+        RG_PROFILE_END(mix_zone);
 
         rg_audio_submit(mixbuffer, AUDIO_BUFFER_LENGTH);
     }
@@ -540,7 +605,17 @@ void app_main()
         RG_DIALOG_END
     };
 
+    static const rg_gui_option_t debug_options[] = {
+        {0, "Lump cache", "-", RG_DIALOG_FLAG_NORMAL, &lump_cache_cb},
+        {0, "Lump reads", "-", RG_DIALOG_FLAG_NORMAL, &lump_read_cb},
+        {0, "Zone slabs", "-", RG_DIALOG_FLAG_NORMAL, &zone_slabs_cb},
+        {0, "Zone cache", "-", RG_DIALOG_FLAG_NORMAL, &zone_region_cb},
+        {0, "Zone frag", "-", RG_DIALOG_FLAG_NORMAL, &zone_frag_cb},
+        RG_DIALOG_END
+    };
+
     app = rg_system_init(AUDIO_SAMPLE_RATE, &handlers, options);
+    app->debugOptions = debug_options;
     app->tickRate = TICRATE;
 
     const rg_display_t *display = rg_display_get_info();
@@ -4,11 +4,14 @@
 #include "cpu.h"
 #include "sound.h"
 
-// For cycle accurate emulation this needs to be 1
-// Anything above 10 have diminishing returns
-#define COUNTERS_TICK_PERIOD 8
 #define CPU_DISASSEMBLER 0
 
+/* Threaded dispatch: each opcode jumps straight to the next one through a label table instead
+   of going back to the switch. Cycle accounting is identical, only the dispatch differs. */
+#ifndef CPU_THREADED_DISPATCH
+#define CPU_THREADED_DISPATCH 0
+#endif
+
 static const byte cycles_table[256] =
 {
 	1, 3, 2, 2, 1, 1, 2, 1, 5, 2, 2, 2, 1, 1, 2, 1,
@@ -131,21 +134,51 @@ A = LB(acc); }
 
 #define COND_EXEC_INT(i, n) if (temp & i) { DI; PUSH(PC); R_IF &= ~i; PC = 0x40+((n)<<3); clen = 5; goto _skip; }
 
+#if CPU_THREADED_DISPATCH && !CPU_DISASSEMBLER
+/* Ops that may raise an interrupt, halt, or reach an event go through the common path */
+#define CASE_L(n, l) case n: l
+#define NEXT do { \
+	remaining -= clen; \
+	sched.pending += clen; \
+	if (remaining <= 0 || sched.pending >= sched.deadline || (IME && (R_IF & R_IE))) \
+		goto _sync; \
+	IME = IMA; \
+	op = FETCH; \
+	clen = cycles_table[op]; \
+	goto *dispatch_table[op]; \
+} while (0)
+#else
+#undef CPU_THREADED_DISPATCH
+#define CPU_THREADED_DISPATCH 0
+#define CASE_L(n, l) case n
+#define NEXT break
+#endif
+#define CASE(n) CASE_L(n, op_##n)
+
 #define ALU_CASES(base, imm, op, label) \
-case (imm): b = FETCH; goto label; \
-case (base): b = B; goto label; \
-case (base)+1: b = C; goto label; \
-case (base)+2: b = D; goto label; \
-case (base)+3: b = E; goto label; \
-case (base)+4: b = H; goto label; \
-case (base)+5: b = L; goto label; \
-case (base)+6: b = readb(HL); goto label; \
-case (base)+7: b = A; \
-label: op(b); break;
+CASE_L(imm, label##_N): b = FETCH; goto label; \
+CASE_L(base, label##_B): b = B; goto label; \
+CASE_L((base)+1, label##_C): b = C; goto label; \
+CASE_L((base)+2, label##_D): b = D; goto label; \
+CASE_L((base)+3, label##_E): b = E; goto label; \
+CASE_L((base)+4, label##_H): b = H; goto label; \
+CASE_L((base)+5, label##_L): b = L; goto label; \
+CASE_L((base)+6, label##_M): b = readb(HL); goto label; \
+CASE_L((base)+7, label##_A): b = A; \
+label: op(b); NEXT;
 
 
 static gb_cpu_t cpu;
 
+/* The clock-bound counters (timer, serial, LCD, sound) are only advanced when the next event
+   they can raise is due, or when the CPU accesses one of their registers. In between, the CPU
+   runs straight through. Both fields are in CPU cycles. */
+static struct
+{
+	int pending;  // Cycles executed since the counters were last advanced
+	int deadline; // Cycles from the last advance to the next LCD mode change, timer overflow or serial transfer
+} sched;
+
 
 gb_cpu_t *gb_cpu_init(void)
 {
@@ -160,6 +193,9 @@ void gb_cpu_reset(bool hard)
 	cpu.div = 0;
 	cpu.timer = 0;
 
+	sched.pending = 0;
+	sched.deadline = 0;
+
 	IME = 0;
 	IMA = 0;
 
@@ -207,6 +243,8 @@ static inline void serial_advance(int cycles)
 		GB.serial -= cycles << 1;
 		if (GB.serial <= 0)
 		{
+			if (GB.trace.callback)
+				(GB.trace.callback)(GB_TRACE_SERIAL, R_SB);
 			R_SB = 0xFF;
 			R_SC &= 0x7f;
 			GB.serial = 0;
@@ -216,6 +254,55 @@ static inline void serial_advance(int cycles)
 	}
 }
 
+/* returns the number of CPU cycles until the next event that can change the state seen by the CPU */
+static inline int next_event(void)
+{
+	if (GB.trace.lockstep)
+		return 1;
+
+	// LCD mode changes (GB.cycles is in double-speed cycles)
+	int next = cpu.double_speed ? GB.cycles : (GB.cycles + 1) >> 1;
+
+	// Timer overflow
+	if (R_TAC & 0x04)
+	{
+		int shift = (((-R_TAC) & 3) << 1) + 1;
+		int left = ((256 - R_TIMA) << 9) - cpu.timer;
+		left = (left + (1 << shift) - 1) >> shift;
+		if (left < next)
+			next = left;
+	}
+
+	// Serial transfer completion (GB.serial is in double-speed cycles)
+	if (GB.serial > 0 && ((GB.serial + 1) >> 1) < next)
+		next = (GB.serial + 1) >> 1;
+
+	return next > 0 ? next : 1;
+}
+
+/* Advance the counters by the cycles executed so far and schedule the next event */
+void gb_cpu_sync(void)
+{
+	int count = sched.pending;
+	sched.pending = 0;
+
+	if (count > 0)
+	{
+		/* Advance clock-bound counters */
+		timer_advance(count);
+		serial_advance(count);
+
+		if (!cpu.double_speed)
+			count <<= 1;
+
+		/* Advance fixed-speed counters */
+		gb_lcd_emulate(count);
+		gb_sound_advance(count);
+	}
+
+	sched.deadline = next_event();
+}
+
 static inline int exec_cb(void)
 {
 	// All instructions use 2 cycles + 1 additional cycle per HL read or write
@@ -297,17 +384,56 @@ IRAM_ATTR int gb_cpu_emulate(int cycles)
 {
 	int clen, temp;
 	int remaining = cycles;
-	int count = 0;
 	byte op, b;
 	gb_cpu_reg_t acc;
 
+#if CPU_THREADED_DISPATCH
+	static const void *const dispatch_table[256] =
+	{
+		&&op_0x00, &&op_0x01, &&op_0x02, &&op_0x03, &&op_0x04, &&op_0x05, &&op_0x06, &&op_0x07,
+		&&op_0x08, &&op_0x09, &&op_0x0A, &&op_0x0B, &&op_0x0C, &&op_0x0D, &&op_0x0E, &&op_0x0F,
+		&&op_0x10, &&op_0x11, &&op_0x12, &&op_0x13, &&op_0x14, &&op_0x15, &&op_0x16, &&op_0x17,
+		&&op_0x18, &&op_0x19, &&op_0x1A, &&op_0x1B, &&op_0x1C, &&op_0x1D, &&op_0x1E, &&op_0x1F,
+		&&op_0x20, &&op_0x21, &&op_0x22, &&op_0x23, &&op_0x24, &&op_0x25, &&op_0x26, &&op_0x27,
+		&&op_0x28, &&op_0x29, &&op_0x2A, &&op_0x2B, &&op_0x2C, &&op_0x2D, &&op_0x2E, &&op_0x2F,
+		&&op_0x30, &&op_0x31, &&op_0x32, &&op_0x33, &&op_0x34, &&op_0x35, &&op_0x36, &&op_0x37,
+		&&op_0x38, &&op_0x39, &&op_0x3A, &&op_0x3B, &&op_0x3C, &&op_0x3D, &&op_0x3E, &&op_0x3F,
+		&&op_0x40, &&op_0x41, &&op_0x42, &&op_0x43, &&op_0x44, &&op_0x45, &&op_0x46, &&op_0x47,
+		&&op_0x48, &&op_0x49, &&op_0x4A, &&op_0x4B, &&op_0x4C, &&op_0x4D, &&op_0x4E, &&op_0x4F,
+		&&op_0x50, &&op_0x51, &&op_0x52, &&op_0x53, &&op_0x54, &&op_0x55, &&op_0x56, &&op_0x57,
+		&&op_0x58, &&op_0x59, &&op_0x5A, &&op_0x5B, &&op_0x5C, &&op_0x5D, &&op_0x5E, &&op_0x5F,
+		&&op_0x60, &&op_0x61, &&op_0x62, &&op_0x63, &&op_0x64, &&op_0x65, &&op_0x66, &&op_0x67,
+		&&op_0x68, &&op_0x69, &&op_0x6A, &&op_0x6B, &&op_0x6C, &&op_0x6D, &&op_0x6E, &&op_0x6F,
+		&&op_0x70, &&op_0x71, &&op_0x72, &&op_0x73, &&op_0x74, &&op_0x75, &&op_0x76, &&op_0x77,
+		&&op_0x78, &&op_0x79, &&op_0x7A, &&op_0x7B, &&op_0x7C, &&op_0x7D, &&op_0x7E, &&op_0x7F,
+		&&__ADD_B, &&__ADD_C, &&__ADD_D, &&__ADD_E, &&__ADD_H, &&__ADD_L, &&__ADD_M, &&__ADD_A,
+		&&__ADC_B, &&__ADC_C, &&__ADC_D, &&__ADC_E, &&__ADC_H, &&__ADC_L, &&__ADC_M, &&__ADC_A,
+		&&__SUB_B, &&__SUB_C, &&__SUB_D, &&__SUB_E, &&__SUB_H, &&__SUB_L, &&__SUB_M, &&__SUB_A,
+		&&__SBC_B, &&__SBC_C, &&__SBC_D, &&__SBC_E, &&__SBC_H, &&__SBC_L, &&__SBC_M, &&__SBC_A,
+		&&__AND_B, &&__AND_C, &&__AND_D, &&__AND_E, &&__AND_H, &&__AND_L, &&__AND_M, &&__AND_A,
+		&&__XOR_B, &&__XOR_C, &&__XOR_D, &&__XOR_E, &&__XOR_H, &&__XOR_L, &&__XOR_M, &&__XOR_A,
+		&&__OR_B, &&__OR_C, &&__OR_D, &&__OR_E, &&__OR_H, &&__OR_L, &&__OR_M, &&__OR_A,
+		&&__CP_B, &&__CP_C, &&__CP_D, &&__CP_E, &&__CP_H, &&__CP_L, &&__CP_M, &&__CP_A,
+		&&op_0xC0, &&op_0xC1, &&op_0xC2, &&op_0xC3, &&op_0xC4, &&op_0xC5, &&__ADD_N, &&op_0xC7,
+		&&op_0xC8, &&op_0xC9, &&op_0xCA, &&op_0xCB, &&op_0xCC, &&op_0xCD, &&__ADC_N, &&op_0xCF,
+		&&op_0xD0, &&op_0xD1, &&op_0xD2, &&op_0xD3, &&op_0xD4, &&op_0xD5, &&__SUB_N, &&op_0xD7,
+		&&op_0xD8, &&op_0xD9, &&op_0xDA, &&op_0xDB, &&op_0xDC, &&op_0xDD, &&__SBC_N, &&op_0xDF,
+		&&op_0xE0, &&op_0xE1, &&op_0xE2, &&op_0xE3, &&op_0xE4, &&op_0xE5, &&__AND_N, &&op_0xE7,
+		&&op_0xE8, &&op_0xE9, &&op_0xEA, &&op_0xEB, &&op_0xEC, &&op_0xED, &&__XOR_N, &&op_0xEF,
+		&&op_0xF0, &&op_0xF1, &&op_0xF2, &&op_0xF3, &&op_0xF4, &&op_0xF5, &&__OR_N, &&op_0xF7,
+		&&op_0xF8, &&op_0xF9, &&op_0xFA, &&op_0xFB, &&op_0xFC, &&op_0xFD, &&__CP_N, &&op_0xFF
+	};
+#endif
+
 	if (!cpu.double_speed)
 		remaining >>= 1;
 
 next:
-	/* Skip idle cycles */
+	/* Skip idle cycles, only an event can wake us up */
 	if (cpu.halted) {
-		clen = 1;
+		clen = sched.deadline - sched.pending;
+		if (clen > remaining) clen = remaining;
+		if (clen < 1) clen = 1;
 		goto _skip;
 	}
 
@@ -333,195 +459,195 @@ next:
 
 	switch(op)
 	{
-	case 0x00: /* NOP */
-	case 0x40: /* LD B,B */
-	case 0x49: /* LD C,C */
-	case 0x52: /* LD D,D */
-	case 0x5B: /* LD E,E */
-	case 0x64: /* LD H,H */
-	case 0x6D: /* LD L,L */
-	case 0x7F: /* LD A,A */
-		break;
-
-	case 0x41: /* LD B,C */
-		B = C; break;
-	case 0x42: /* LD B,D */
-		B = D; break;
-	case 0x43: /* LD B,E */
-		B = E; break;
-	case 0x44: /* LD B,H */
-		B = H; break;
-	case 0x45: /* LD B,L */
-		B = L; break;
-	case 0x46: /* LD B,(HL) */
-		B = readb(HL); break;
-	case 0x47: /* LD B,A */
-		B = A; break;
-
-	case 0x48: /* LD C,B */
-		C = B; break;
-	case 0x4A: /* LD C,D */
-		C = D; break;
-	case 0x4B: /* LD C,E */
-		C = E; break;
-	case 0x4C: /* LD C,H */
-		C = H; break;
-	case 0x4D: /* LD C,L */
-		C = L; break;
-	case 0x4E: /* LD C,(HL) */
-		C = readb(HL); break;
-	case 0x4F: /* LD C,A */
-		C = A; break;
-
-	case 0x50: /* LD D,B */
-		D = B; break;
-	case 0x51: /* LD D,C */
-		D = C; break;
-	case 0x53: /* LD D,E */
-		D = E; break;
-	case 0x54: /* LD D,H */
-		D = H; break;
-	case 0x55: /* LD D,L */
-		D = L; break;
-	case 0x56: /* LD D,(HL) */
-		D = readb(HL); break;
-	case 0x57: /* LD D,A */
-		D = A; break;
-
-	case 0x58: /* LD E,B */
-		E = B; break;
-	case 0x59: /* LD E,C */
-		E = C; break;
-	case 0x5A: /* LD E,D */
-		E = D; break;
-	case 0x5C: /* LD E,H */
-		E = H; break;
-	case 0x5D: /* LD E,L */
-		E = L; break;
-	case 0x5E: /* LD E,(HL) */
-		E = readb(HL); break;
-	case 0x5F: /* LD E,A */
-		E = A; break;
-
-	case 0x60: /* LD H,B */
-		H = B; break;
-	case 0x61: /* LD H,C */
-		H = C; break;
-	case 0x62: /* LD H,D */
-		H = D; break;
-	case 0x63: /* LD H,E */
-		H = E; break;
-	case 0x65: /* LD H,L */
-		H = L; break;
-	case 0x66: /* LD H,(HL) */
-		H = readb(HL); break;
-	case 0x67: /* LD H,A */
-		H = A; break;
-
-	case 0x68: /* LD L,B */
-		L = B; break;
-	case 0x69: /* LD L,C */
-		L = C; break;
-	case 0x6A: /* LD L,D */
-		L = D; break;
-	case 0x6B: /* LD L,E */
-		L = E; break;
-	case 0x6C: /* LD L,H */
-		L = H; break;
-	case 0x6E: /* LD L,(HL) */
-		L = readb(HL); break;
-	case 0x6F: /* LD L,A */
-		L = A; break;
-
-	case 0x70: /* LD (HL),B */
-		writeb(HL, B); break;
-	case 0x71: /* LD (HL),C */
-		writeb(HL, C); break;
-	case 0x72: /* LD (HL),D */
-		writeb(HL, D); break;
-	case 0x73: /* LD (HL),E */
-		writeb(HL, E); break;
-	case 0x74: /* LD (HL),H */
-		writeb(HL, H); break;
-	case 0x75: /* LD (HL),L */
-		writeb(HL, L); break;
-	case 0x77: /* LD (HL),A */
-		writeb(HL, A); break;
-
-	case 0x78: /* LD A,B */
-		A = B; break;
-	case 0x79: /* LD A,C */
-		A = C; break;
-	case 0x7A: /* LD A,D */
-		A = D; break;
-	case 0x7B: /* LD A,E */
-		A = E; break;
-	case 0x7C: /* LD A,H */
-		A = H; break;
-	case 0x7D: /* LD A,L */
-		A = L; break;
-	case 0x7E: /* LD A,(HL) */
-		A = readb(HL); break;
-
-	case 0x01: /* LD BC,imm */
-		BC = readw(PC); PC += 2; break;
-	case 0x11: /* LD DE,imm */
-		DE = readw(PC); PC += 2; break;
-	case 0x21: /* LD HL,imm */
-		HL = readw(PC); PC += 2; break;
-	case 0x31: /* LD SP,imm */
-		SP = readw(PC); PC += 2; break;
-
-	case 0x02: /* LD (BC),A */
-		writeb(BC, A); break;
-	case 0x0A: /* LD A,(BC) */
-		A = readb(BC); break;
-	case 0x12: /* LD (DE),A */
-		writeb(DE, A); break;
-	case 0x1A: /* LD A,(DE) */
-		A = readb(DE); break;
-
-	case 0x22: /* LDI (HL),A */
-		writeb(HL, A); HL++; break;
-	case 0x2A: /* LDI A,(HL) */
-		A = readb(HL); HL++; break;
-	case 0x32: /* LDD (HL),A */
-		writeb(HL, A); HL--; break;
-	case 0x3A: /* LDD A,(HL) */
-		A = readb(HL); HL--; break;
-
-	case 0x06: /* LD B,imm */
-		B = FETCH; break;
-	case 0x0E: /* LD C,imm */
-		C = FETCH; break;
-	case 0x16: /* LD D,imm */
-		D = FETCH; break;
-	case 0x1E: /* LD E,imm */
-		E = FETCH; break;
-	case 0x26: /* LD H,imm */
-		H = FETCH; break;
-	case 0x2E: /* LD L,imm */
-		L = FETCH; break;
-	case 0x36: /* LD (HL),imm */
-		writeb(HL, FETCH); break;
-	case 0x3E: /* LD A,imm */
-		A = FETCH; break;
-
-	case 0x08: /* LD (imm),SP */
-		writew(readw(PC), SP); PC += 2; break;
-	case 0xEA: /* LD (imm),A */
-		writeb(readw(PC), A); PC += 2; break;
-
-	case 0xE0: /* LDH (imm),A */
-		writeb(0xff00 + FETCH, A); break;
-	case 0xE2: /* LDH (C),A */
-		writeb(0xff00 + C, A); break;
-	case 0xF0: /* LDH A,(imm) */
-		A = readb(0xff00 + FETCH); break;
-	case 0xF2: /* LDH A,(C) (undocumented) */
-		A = readb(0xff00 + C); break;
-
-	case 0xF8: /* LD HL,SP+imm */
+	CASE(0x00): /* NOP */
+	CASE(0x40): /* LD B,B */
+	CASE(0x49): /* LD C,C */
+	CASE(0x52): /* LD D,D */
+	CASE(0x5B): /* LD E,E */
+	CASE(0x64): /* LD H,H */
+	CASE(0x6D): /* LD L,L */
+	CASE(0x7F): /* LD A,A */
+		NEXT;
+
+	CASE(0x41): /* LD B,C */
+		B = C; NEXT;
+	CASE(0x42): /* LD B,D */
+		B = D; NEXT;
+	CASE(0x43): /* LD B,E */
+		B = E; NEXT;
+	CASE(0x44): /* LD B,H */
+		B = H; NEXT;
+	CASE(0x45): /* LD B,L */
+		B = L; NEXT;
+	CASE(0x46): /* LD B,(HL) */
+		B = readb(HL); NEXT;
+	CASE(0x47): /* LD B,A */
+		B = A; NEXT;
+
+	CASE(0x48): /* LD C,B */
+		C = B; NEXT;
+	CASE(0x4A): /* LD C,D */
+		C = D; NEXT;
+	CASE(0x4B): /* LD C,E */
+		C = E; NEXT;
+	CASE(0x4C): /* LD C,H */
+		C = H; NEXT;
+	CASE(0x4D): /* LD C,L */
+		C = L; NEXT;
+	CASE(0x4E): /* LD C,(HL) */
+		C = readb(HL); NEXT;
+	CASE(0x4F): /* LD C,A */
+		C = A; NEXT;
+
+	CASE(0x50): /* LD D,B */
+		D = B; NEXT;
+	CASE(0x51): /* LD D,C */
+		D = C; NEXT;
+	CASE(0x53): /* LD D,E */
+		D = E; NEXT;
+	CASE(0x54): /* LD D,H */
+		D = H; NEXT;
+	CASE(0x55): /* LD D,L */
+		D = L; NEXT;
+	CASE(0x56): /* LD D,(HL) */
+		D = readb(HL); NEXT;
+	CASE(0x57): /* LD D,A */
+		D = A; NEXT;
+
+	CASE(0x58): /* LD E,B */
+		E = B; NEXT;
+	CASE(0x59): /* LD E,C */
+		E = C; NEXT;
+	CASE(0x5A): /* LD E,D */
+		E = D; NEXT;
+	CASE(0x5C): /* LD E,H */
+		E = H; NEXT;
+	CASE(0x5D): /* LD E,L */
+		E = L; NEXT;
+	CASE(0x5E): /* LD E,(HL) */
+		E = readb(HL); NEXT;
+	CASE(0x5F): /* LD E,A */
+		E = A; NEXT;
+
+	CASE(0x60): /* LD H,B */
+		H = B; NEXT;
+	CASE(0x61): /* LD H,C */
+		H = C; NEXT;
+	CASE(0x62): /* LD H,D */
+		H = D; NEXT;
+	CASE(0x63): /* LD H,E */
+		H = E; NEXT;
+	CASE(0x65): /* LD H,L */
+		H = L; NEXT;
+	CASE(0x66): /* LD H,(HL) */
+		H = readb(HL); NEXT;
+	CASE(0x67): /* LD H,A */
+		H = A; NEXT;
+
+	CASE(0x68): /* LD L,B */
+		L = B; NEXT;
+	CASE(0x69): /* LD L,C */
+		L = C; NEXT;
+	CASE(0x6A): /* LD L,D */
+		L = D; NEXT;
+	CASE(0x6B): /* LD L,E */
+		L = E; NEXT;
+	CASE(0x6C): /* LD L,H */
+		L = H; NEXT;
+	CASE(0x6E): /* LD L,(HL) */
+		L = readb(HL); NEXT;
+	CASE(0x6F): /* LD L,A */
+		L = A; NEXT;
+
+	CASE(0x70): /* LD (HL),B */
+		writeb(HL, B); NEXT;
+	CASE(0x71): /* LD (HL),C */
+		writeb(HL, C); NEXT;
+	CASE(0x72): /* LD (HL),D */
+		writeb(HL, D); NEXT;
+	CASE(0x73): /* LD (HL),E */
+		writeb(HL, E); NEXT;
+	CASE(0x74): /* LD (HL),H */
+		writeb(HL, H); NEXT;
+	CASE(0x75): /* LD (HL),L */
+		writeb(HL, L); NEXT;
+	CASE(0x77): /* LD (HL),A */
+		writeb(HL, A); NEXT;
+
+	CASE(0x78): /* LD A,B */
+		A = B; NEXT;
+	CASE(0x79): /* LD A,C */
+		A = C; NEXT;
+	CASE(0x7A): /* LD A,D */
+		A = D; NEXT;
+	CASE(0x7B): /* LD A,E */
+		A = E; NEXT;
+	CASE(0x7C): /* LD A,H */
+		A = H; NEXT;
+	CASE(0x7D): /* LD A,L */
+		A = L; NEXT;
+	CASE(0x7E): /* LD A,(HL) */
+		A = readb(HL); NEXT;
+
+	CASE(0x01): /* LD BC,imm */
+		BC = readw(PC); PC += 2; NEXT;
+	CASE(0x11): /* LD DE,imm */
+		DE = readw(PC); PC += 2; NEXT;
+	CASE(0x21): /* LD HL,imm */
+		HL = readw(PC); PC += 2; NEXT;
+	CASE(0x31): /* LD SP,imm */
+		SP = readw(PC); PC += 2; NEXT;
+
+	CASE(0x02): /* LD (BC),A */
+		writeb(BC, A); NEXT;
+	CASE(0x0A): /* LD A,(BC) */
+		A = readb(BC); NEXT;
+	CASE(0x12): /* LD (DE),A */
+		writeb(DE, A); NEXT;
+	CASE(0x1A): /* LD A,(DE) */
+		A = readb(DE); NEXT;
+
+	CASE(0x22): /* LDI (HL),A */
+		writeb(HL, A); HL++; NEXT;
+	CASE(0x2A): /* LDI A,(HL) */
+		A = readb(HL); HL++; NEXT;
+	CASE(0x32): /* LDD (HL),A */
+		writeb(HL, A); HL--; NEXT;
+	CASE(0x3A): /* LDD A,(HL) */
+		A = readb(HL); HL--; NEXT;
+
+	CASE(0x06): /* LD B,imm */
+		B = FETCH; NEXT;
+	CASE(0x0E): /* LD C,imm */
+		C = FETCH; NEXT;
+	CASE(0x16): /* LD D,imm */
+		D = FETCH; NEXT;
+	CASE(0x1E): /* LD E,imm */
+		E = FETCH; NEXT;
+	CASE(0x26): /* LD H,imm */
+		H = FETCH; NEXT;
+	CASE(0x2E): /* LD L,imm */
+		L = FETCH; NEXT;
+	CASE(0x36): /* LD (HL),imm */
+		writeb(HL, FETCH); NEXT;
+	CASE(0x3E): /* LD A,imm */
+		A = FETCH; NEXT;
+
+	CASE(0x08): /* LD (imm),SP */
+		writew(readw(PC), SP); PC += 2; NEXT;
+	CASE(0xEA): /* LD (imm),A */
+		writeb(readw(PC), A); PC += 2; NEXT;
+
+	CASE(0xE0): /* LDH (imm),A */
+		writeb(0xff00 + FETCH, A); NEXT;
+	CASE(0xE2): /* LDH (C),A */
+		writeb(0xff00 + C, A); NEXT;
+	CASE(0xF0): /* LDH A,(imm) */
+		A = readb(0xff00 + FETCH); NEXT;
+	CASE(0xF2): /* LDH A,(C) (undocumented) */
+		A = readb(0xff00 + C); NEXT;
+
+	CASE(0xF8): /* LD HL,SP+imm */
 		// https://gammpei.github.io/blog/posts/2018-03-04/how-to-write-a-game-boy-emulator-part-8-blarggs-cpu-test-roms-1-3-4-5-7-8-9-10-11.html
 		b = FETCH;
 		temp = (int)(SP) + (signed char)b;
@@ -532,11 +658,11 @@ next:
 		if ((SP & 0xff) + b > 0xff) F |= FC;
 
 		HL = temp;
-		break;
-	case 0xF9: /* LD SP,HL */
-		SP = HL; break;
-	case 0xFA: /* LD A,(imm) */
-		A = readb(readw(PC)); PC += 2; break;
+		NEXT;
+	CASE(0xF9): /* LD SP,HL */
+		SP = HL; NEXT;
+	CASE(0xFA): /* LD A,(imm) */
+		A = readb(readw(PC)); PC += 2; NEXT;
 
 		ALU_CASES(0x80, 0xC6, ADD, __ADD)
 		ALU_CASES(0x88, 0xCE, ADC, __ADC)
@@ -547,83 +673,83 @@ next:
 		ALU_CASES(0xB0, 0xF6, OR, __OR)
 		ALU_CASES(0xB8, 0xFE, CP, __CP)
 
-	case 0x09: /* ADD HL,BC */
-		ADDW(BC); break;
-	case 0x19: /* ADD HL,DE */
-		ADDW(DE); break;
-	case 0x39: /* ADD HL,SP */
-		ADDW(SP); break;
-	case 0x29: /* ADD HL,HL */
-		ADDW(HL); break;
-
-	case 0x04: /* INC B */
-		INC(B); break;
-	case 0x0C: /* INC C */
-		INC(C); break;
-	case 0x14: /* INC D */
-		INC(D); break;
-	case 0x1C: /* INC E */
-		INC(E); break;
-	case 0x24: /* INC H */
-		INC(H); break;
-	case 0x2C: /* INC L */
-		INC(L); break;
-	case 0x34: /* INC (HL) */
+	CASE(0x09): /* ADD HL,BC */
+		ADDW(BC); NEXT;
+	CASE(0x19): /* ADD HL,DE */
+		ADDW(DE); NEXT;
+	CASE(0x39): /* ADD HL,SP */
+		ADDW(SP); NEXT;
+	CASE(0x29): /* ADD HL,HL */
+		ADDW(HL); NEXT;
+
+	CASE(0x04): /* INC B */
+		INC(B); NEXT;
+	CASE(0x0C): /* INC C */
+		INC(C); NEXT;
+	CASE(0x14): /* INC D */
+		INC(D); NEXT;
+	CASE(0x1C): /* INC E */
+		INC(E); NEXT;
+	CASE(0x24): /* INC H */
+		INC(H); NEXT;
+	CASE(0x2C): /* INC L */
+		INC(L); NEXT;
+	CASE(0x34): /* INC (HL) */
 		b = readb(HL);
 		INC(b);
 		writeb(HL, b);
-		break;
-	case 0x3C: /* INC A */
-		INC(A); break;
-
-	case 0x03: /* INC BC */
-		INCW(BC); break;
-	case 0x13: /* INC DE */
-		INCW(DE); break;
-	case 0x23: /* INC HL */
-		INCW(HL); break;
-	case 0x33: /* INC SP */
-		INCW(SP); break;
-
-	case 0x05: /* DEC B */
-		DEC(B); break;
-	case 0x0D: /* DEC C */
-		DEC(C); break;
-	case 0x15: /* DEC D */
-		DEC(D); break;
-	case 0x1D: /* DEC E */
-		DEC(E); break;
-	case 0x25: /* DEC H */
-		DEC(H); break;
-	case 0x2D: /* DEC L */
-		DEC(L); break;
-	case 0x35: /* DEC (HL) */
+		NEXT;
+	CASE(0x3C): /* INC A */
+		INC(A); NEXT;
+
+	CASE(0x03): /* INC BC */
+		INCW(BC); NEXT;
+	CASE(0x13): /* INC DE */
+		INCW(DE); NEXT;
+	CASE(0x23): /* INC HL */
+		INCW(HL); NEXT;
+	CASE(0x33): /* INC SP */
+		INCW(SP); NEXT;
+
+	CASE(0x05): /* DEC B */
+		DEC(B); NEXT;
+	CASE(0x0D): /* DEC C */
+		DEC(C); NEXT;
+	CASE(0x15): /* DEC D */
+		DEC(D); NEXT;
+	CASE(0x1D): /* DEC E */
+		DEC(E); NEXT;
+	CASE(0x25): /* DEC H */
+		DEC(H); NEXT;
+	CASE(0x2D): /* DEC L */
+		DEC(L); NEXT;
+	CASE(0x35): /* DEC (HL) */
 		b = readb(HL);
 		DEC(b);
 		writeb(HL, b);
-		break;
-	case 0x3D: /* DEC A */
-		DEC(A); break;
-
-	case 0x0B: /* DEC BC */
-		DECW(BC); break;
-	case 0x1B: /* DEC DE */
-		DECW(DE); break;
-	case 0x2B: /* DEC HL */
-		DECW(HL); break;
-	case 0x3B: /* DEC SP */
-		DECW(SP); break;
-
-	case 0x07: /* RLCA */
-		RLCA(A); break;
-	case 0x0F: /* RRCA */
-		RRCA(A); break;
-	case 0x17: /* RLA */
-		RLA(A); break;
-	case 0x1F: /* RRA */
-		RRA(A); break;
-
-	case 0x27: /* DAA */
+		NEXT;
+	CASE(0x3D): /* DEC A */
+		DEC(A); NEXT;
+
+	CASE(0x0B): /* DEC BC */
+		DECW(BC); NEXT;
+	CASE(0x1B): /* DEC DE */
+		DECW(DE); NEXT;
+	CASE(0x2B): /* DEC HL */
+		DECW(HL); NEXT;
+	CASE(0x3B): /* DEC SP */
+		DECW(SP); NEXT;
+
+	CASE(0x07): /* RLCA */
+		RLCA(A); NEXT;
+	CASE(0x0F): /* RRCA */
+		RRCA(A); NEXT;
+	CASE(0x17): /* RLA */
+		RLA(A); NEXT;
+	CASE(0x1F): /* RRA */
+		RRA(A); NEXT;
+
+	CASE(0x27): /* DAA */
 		//http://forums.nesdev.com/viewtopic.php?t=9088
 		temp = A;
 
@@ -643,89 +769,89 @@ next:
 
 		if (temp & 0x100)   F |= FC;
 		if (!(temp & 0xff)) F |= FZ;
-		break;
-
-	case 0x2F: /* CPL */
-		CPL(A); break;
-
-	case 0x18: /* JR */
-		JR; break;
-	case 0x20: /* JR NZ */
-		if (!(F&FZ)) JR; else NOJR; break;
-	case 0x28: /* JR Z */
-		if (F&FZ) JR; else NOJR; break;
-	case 0x30: /* JR NC */
-		if (!(F&FC)) JR; else NOJR; break;
-	case 0x38: /* JR C */
-		if (F&FC) JR; else NOJR; break;
-
-	case 0xC3: /* JP */
-		JP; break;
-	case 0xC2: /* JP NZ */
-		if (!(F&FZ)) JP; else NOJP; break;
-	case 0xCA: /* JP Z */
-		if (F&FZ) JP; else NOJP; break;
-	case 0xD2: /* JP NC */
-		if (!(F&FC)) JP; else NOJP; break;
-	case 0xDA: /* JP C */
-		if (F&FC) JP; else NOJP; break;
-	case 0xE9: /* JP HL */
-		PC = HL; break;
-
-	case 0xC9: /* RET */
-		RET; break;
-	case 0xC0: /* RET NZ */
-		if (!(F&FZ)) RET; else NORET; break;
-	case 0xC8: /* RET Z */
-		if (F&FZ) RET; else NORET; break;
-	case 0xD0: /* RET NC */
-		if (!(F&FC)) RET; else NORET; break;
-	case 0xD8: /* RET C */
-		if (F&FC) RET; else NORET; break;
-	case 0xD9: /* RETI */
-		IME = IMA = 1; RET; break;
-
-	case 0xCD: /* CALL */
-		CALL; break;
-	case 0xC4: /* CALL NZ */
-		if (!(F&FZ)) CALL; else NOCALL; break;
-	case 0xCC: /* CALL Z */
-		if (F&FZ) CALL; else NOCALL; break;
-	case 0xD4: /* CALL NC */
-		if (!(F&FC)) CALL; else NOCALL; break;
-	case 0xDC: /* CALL C */
-		if (F&FC) CALL; else NOCALL; break;
-
-	case 0xC7: /* RST 0 */
-	case 0xCF: /* RST 8 */
-	case 0xD7: /* RST 10 */
-	case 0xDF: /* RST 18 */
-	case 0xE7: /* RST 20 */
-	case 0xEF: /* RST 28 */
-	case 0xF7: /* RST 30 */
-	case 0xFF: /* RST 38 */
-		RST(op & 0x38); break;
-
-	case 0xC1: /* POP BC */
-		POP(BC); break;
-	case 0xC5: /* PUSH BC */
-		PUSH(BC); break;
-	case 0xD1: /* POP DE */
-		POP(DE); break;
-	case 0xD5: /* PUSH DE */
-		PUSH(DE); break;
-	case 0xE1: /* POP HL */
-		POP(HL); break;
-	case 0xE5: /* PUSH HL */
-		PUSH(HL); break;
-	case 0xF1: /* POP AF */
-		POP(AF); AF &= 0xfff0; break;
-	case 0xF5: /* PUSH AF */
-		PUSH(AF); break;
-
-	case 0xE8: /* ADD SP,imm */
+		NEXT;
+
+	CASE(0x2F): /* CPL */
+		CPL(A); NEXT;
+
+	CASE(0x18): /* JR */
+		JR; NEXT;
+	CASE(0x20): /* JR NZ */
+		if (!(F&FZ)) JR; else NOJR; NEXT;
+	CASE(0x28): /* JR Z */
+		if (F&FZ) JR; else NOJR; NEXT;
+	CASE(0x30): /* JR NC */
+		if (!(F&FC)) JR; else NOJR; NEXT;
+	CASE(0x38): /* JR C */
+		if (F&FC) JR; else NOJR; NEXT;
+
+	CASE(0xC3): /* JP */
+		JP; NEXT;
+	CASE(0xC2): /* JP NZ */
+		if (!(F&FZ)) JP; else NOJP; NEXT;
+	CASE(0xCA): /* JP Z */
+		if (F&FZ) JP; else NOJP; NEXT;
+	CASE(0xD2): /* JP NC */
+		if (!(F&FC)) JP; else NOJP; NEXT;
+	CASE(0xDA): /* JP C */
+		if (F&FC) JP; else NOJP; NEXT;
+	CASE(0xE9): /* JP HL */
+		PC = HL; NEXT;
+
+	CASE(0xC9): /* RET */
+		RET; NEXT;
+	CASE(0xC0): /* RET NZ */
+		if (!(F&FZ)) RET; else NORET; NEXT;
+	CASE(0xC8): /* RET Z */
+		if (F&FZ) RET; else NORET; NEXT;
+	CASE(0xD0): /* RET NC */
+		if (!(F&FC)) RET; else NORET; NEXT;
+	CASE(0xD8): /* RET C */
+		if (F&FC) RET; else NORET; NEXT;
+	CASE(0xD9): /* RETI */
+		IME = IMA = 1; RET; NEXT;
+
+	CASE(0xCD): /* CALL */
+		CALL; NEXT;
+	CASE(0xC4): /* CALL NZ */
+		if (!(F&FZ)) CALL; else NOCALL; NEXT;
+	CASE(0xCC): /* CALL Z */
+		if (F&FZ) CALL; else NOCALL; NEXT;
+	CASE(0xD4): /* CALL NC */
+		if (!(F&FC)) CALL; else NOCALL; NEXT;
+	CASE(0xDC): /* CALL C */
+		if (F&FC) CALL; else NOCALL; NEXT;
+
+	CASE(0xC7): /* RST 0 */
+	CASE(0xCF): /* RST 8 */
+	CASE(0xD7): /* RST 10 */
+	CASE(0xDF): /* RST 18 */
+	CASE(0xE7): /* RST 20 */
+	CASE(0xEF): /* RST 28 */
+	CASE(0xF7): /* RST 30 */
+	CASE(0xFF): /* RST 38 */
+		RST(op & 0x38); NEXT;
+
+	CASE(0xC1): /* POP BC */
+		POP(BC); NEXT;
+	CASE(0xC5): /* PUSH BC */
+		PUSH(BC); NEXT;
+	CASE(0xD1): /* POP DE */
+		POP(DE); NEXT;
+	CASE(0xD5): /* PUSH DE */
+		PUSH(DE); NEXT;
+	CASE(0xE1): /* POP HL */
+		POP(HL); NEXT;
+	CASE(0xE5): /* PUSH HL */
+		PUSH(HL); NEXT;
+	CASE(0xF1): /* POP AF */
+		POP(AF); AF &= 0xfff0; NEXT;
+	CASE(0xF5): /* PUSH AF */
+		PUSH(AF); NEXT;
+
+	CASE(0xE8): /* ADD SP,imm */
 		// https://gammpei.github.io/blog/posts/2018-03-04/how-to-write-a-game-boy-emulator-part-8-blarggs-cpu-test-roms-1-3-4-5-7-8-9-10-11.html
-		b = FETCH; // ADDSP(b); break;
+		b = FETCH; // ADDSP(b); NEXT;
 		temp = SP + (signed char)b;
 
 		F &= ~(FZ | FN | FH | FC);
@@ -734,30 +860,33 @@ next:
 		if ((SP & 0xff) + b > 0xff) F |= FC;
 
 		SP = temp;
-		break;
+		NEXT;
 
-	case 0xF3: /* DI */
-		DI; break;
-	case 0xFB: /* EI */
-		EI; break;
+	CASE(0xF3): /* DI */
+		DI; NEXT;
+	CASE(0xFB): /* EI */
+		EI; NEXT;
 
-	case 0x37: /* SCF */
-		SCF; break;
-	case 0x3F: /* CCF */
-		CCF; break;
+	CASE(0x37): /* SCF */
+		SCF; NEXT;
+	CASE(0x3F): /* CCF */
+		CCF; NEXT;
 
-	case 0x10: /* STOP */
+	CASE(0x10): /* STOP */
 		PC++;
 		if (R_KEY1 & 1)
 		{
+			// Pending cycles were counted at the old speed, and the next event moves with the switch
+			gb_cpu_sync();
 			cpu.double_speed ^= 1;
 			R_KEY1 = (R_KEY1 & 0x7E) | ((cpu.double_speed & 1) << 7);
+			gb_cpu_sync();
 			break;
 		}
 		/* NOTE - we do not implement dmg STOP whatsoever */
 		break;
 
-	case 0x76: /* HALT */
+	CASE(0x76): /* HALT */
 		cpu.halted = 1;
 		if (!IME)
 		{
@@ -765,10 +894,12 @@ next:
 		}
 		break;
 
-	case 0xCB: /* CB prefix */
+	CASE(0xCB): /* CB prefix */
 		clen = exec_cb();
-		break;
+		NEXT;
 
+	CASE(0xD3): CASE(0xDB): CASE(0xDD): CASE(0xE3): CASE(0xE4): CASE(0xEB):
+	CASE(0xEC): CASE(0xED): CASE(0xF4): CASE(0xFC): CASE(0xFD):
 	default:
 		MESSAGE_ERROR("invalid opcode 0x%02X at address 0x%04X, rombank = %d\n",
 			op, (PC-1) & 0xffff, GB.cart->rombank);
@@ -778,28 +909,14 @@ next:
 _skip:
 
 	remaining -= clen;
-	count += clen;
+	sched.pending += clen;
 
-#if COUNTERS_TICK_PERIOD > 1
-	if (count >= COUNTERS_TICK_PERIOD || remaining <= 0)
+#if CPU_THREADED_DISPATCH
+_sync:
 #endif
+	if (sched.pending >= sched.deadline || remaining <= 0)
 	{
-		/* Advance clock-bound counters */
-		timer_advance(count);
-		serial_advance(count);
-
-		if (!cpu.double_speed)
-			count <<= 1;
-
-		/* Advance fixed-speed counters */
-		gb_lcd_emulate(count);
-		gb_sound_advance(count);
-		// gb_sound_emulate(count);
-
-		// Here we could calculate when the next event is going to happen
-		// So that we can skip even more cycles, but it doesn't seem to save
-		// much more CPU and adds lots of complexity...
-		count = 0;
+		gb_cpu_sync();
 	}
 
 	if (remaining > 0)
@@ -57,5 +57,6 @@ typedef struct
 gb_cpu_t *gb_cpu_init(void);
 void gb_cpu_reset(bool hard);
 int  gb_cpu_emulate(int cycles);
+void gb_cpu_sync(void);
 void gb_cpu_burn(int cycles);
 void gb_cpu_disassemble(unsigned a, int c);
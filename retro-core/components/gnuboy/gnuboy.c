@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include "gnuboy.h"
@@ -59,6 +60,14 @@ void gnuboy_set_soundbuffer(void *buffer, size_t length)
 }
 
 
+static uint32_t trace_hash(uint32_t hash, const void *data, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		hash = (hash ^ ((const byte *)data)[i]) * 16777619;
+	return hash;
+}
+
+
 /*
 	Time intervals throughout the code, unless otherwise noted, are
 	specified in double-speed machine cycles (2MHz), each unit
@@ -114,6 +123,21 @@ void gnuboy_run(bool draw)
 	if (GB.audio.callback && GB.audio.pos > 0) {
 		(GB.audio.callback)(GB.audio.buffer, GB.audio.pos);
 	}
+
+	if (GB.trace.callback) {
+		gb_cpu_t *cpu = GB.cpu;
+		uint32_t hash = 2166136261;
+		hash = trace_hash(hash, cpu, offsetof(gb_cpu_t, disassemble));
+		hash = trace_hash(hash, hw.ioregs, sizeof(hw.ioregs));
+		hash = trace_hash(hash, hw.oam, sizeof(hw.oam));
+		hash = trace_hash(hash, hw.pal, sizeof(hw.pal));
+		hash = trace_hash(hash, hw.rambanks, 8 * 4096);
+		hash = trace_hash(hash, hw.vbanks, 2 * 8192);
+		hash = trace_hash(hash, &hw.cycles, sizeof(hw.cycles));
+		hash = trace_hash(hash, &hw.serial, sizeof(hw.serial));
+		hash = trace_hash(hash, &hw.ilines, sizeof(hw.ilines));
+		(GB.trace.callback)(GB_TRACE_FRAME, hash);
+	}
 }
 
 
@@ -564,17 +588,7 @@ int gnuboy_load_sram(const char *file)
 		uint32_t rtc_buf[12];
 
 		if (fseek(f, cart.ramsize * 8192, SEEK_SET) == 0 && fread(&rtc_buf, 48, 1, f) == 1)
-		{
-			cart.rtc = (gb_rtc_t){
-				.s = rtc_buf[0],
-				.m = rtc_buf[1],
-				.h = rtc_buf[2],
-				.d = rtc_buf[3],
-				.flags = rtc_buf[4],
-				.regs = {rtc_buf[5], rtc_buf[6], rtc_buf[7], rtc_buf[8], rtc_buf[9]},
-			};
-			MESSAGE_INFO("Loaded RTC section %03d %02d:%02d:%02d.\n", cart.rtc.d, cart.rtc.h, cart.rtc.m, cart.rtc.s);
-		}
+			gnuboy_set_rtc_data(rtc_buf);
 	}
 
 	fclose(f);
@@ -583,6 +597,44 @@ int gnuboy_load_sram(const char *file)
 }
 
 
+bool gnuboy_get_rtc_data(uint32_t data[12])
+{
+	if (!cart.has_rtc)
+		return false;
+
+	uint64_t rt = RTC_BASE + cart.rtc.s + (cart.rtc.m * 60) + (cart.rtc.h * 3600) + (cart.rtc.d * 86400);
+	uint32_t *rtp = (uint32_t*)&rt;
+	data[0] = cart.rtc.s;
+	data[1] = cart.rtc.m;
+	data[2] = cart.rtc.h;
+	data[3] = cart.rtc.d;
+	data[4] = cart.rtc.flags;
+	for (int i = 0; i < 5; i++)
+		data[5 + i] = cart.rtc.regs[i];
+	data[10] = rtp[0];
+	data[11] = rtp[1];
+	return true;
+}
+
+
+bool gnuboy_set_rtc_data(const uint32_t data[12])
+{
+	if (!cart.has_rtc)
+		return false;
+
+	cart.rtc = (gb_rtc_t){
+		.s = data[0],
+		.m = data[1],
+		.h = data[2],
+		.d = data[3],
+		.flags = data[4],
+		.regs = {data[5], data[6], data[7], data[8], data[9]},
+	};
+	MESSAGE_INFO("Loaded RTC section %03d %02d:%02d:%02d.\n", cart.rtc.d, cart.rtc.h, cart.rtc.m, cart.rtc.s);
+	return true;
+}
+
+
 /**
  * If quick_save is set to true, sram_save will only save the sectors that
  * changed + the rtc. If set to false then a full sram file is created.
@@ -620,22 +672,8 @@ int gnuboy_save_sram(const char *file, bool quick_save)
 
 	if (cart.has_rtc)
 	{
-		uint64_t rt = RTC_BASE + cart.rtc.s + (cart.rtc.m * 60) + (cart.rtc.h * 3600) + (cart.rtc.d * 86400);
-		uint32_t *rtp = (uint32_t*)&rt;
-		uint32_t rtc_buf[12] = {
-			cart.rtc.s,
-			cart.rtc.m,
-			cart.rtc.h,
-			cart.rtc.d,
-			cart.rtc.flags,
-			cart.rtc.regs[0],
-			cart.rtc.regs[1],
-			cart.rtc.regs[2],
-			cart.rtc.regs[3],
-			cart.rtc.regs[4],
-			rtp[0],
-			rtp[1],
-		};
+		uint32_t rtc_buf[12];
+		gnuboy_get_rtc_data(rtc_buf);
 		if (fseek(f, cart.ramsize * 8192, SEEK_SET) == 0 && fwrite(&rtc_buf, 48, 1, f) == 1)
 		{
 			MESSAGE_INFO("Saved RTC section.\n");
@@ -648,6 +686,35 @@ int gnuboy_save_sram(const char *file, bool quick_save)
 }
 
 
+byte *gnuboy_get_sram(size_t *size)
+{
+	if (!cart.has_battery || !cart.ramsize)
+		return NULL;
+	if (size)
+		*size = cart.ramsize * 8192;
+	return (byte *)cart.rambanks;
+}
+
+
+void gnuboy_set_sram_callback(gb_sram_cb_t *callback)
+{
+	GB.sram.callback = callback;
+}
+
+
+void gnuboy_set_input_callback(gb_input_cb_t *callback)
+{
+	GB.input.callback = callback;
+}
+
+
+void gnuboy_set_trace(gb_trace_cb_t *callback, bool lockstep)
+{
+	GB.trace.callback = callback;
+	GB.trace.lockstep = lockstep;
+	gb_cpu_sync();
+}
+
 
 /**
  * Save state file format is:
@@ -99,6 +99,16 @@ typedef enum
 
 typedef void (gb_video_cb_t)(void *buffer);
 typedef void (gb_audio_cb_t)(void *buffer, size_t length);
+typedef void (gb_sram_cb_t)(void *ptr, size_t length);
+typedef void (gb_input_cb_t)(void);
+
+typedef enum
+{
+	GB_TRACE_FRAME,  // value: hash of the machine state at the end of the frame
+	GB_TRACE_SERIAL, // value: byte sent over the link port
+} gb_trace_event_t;
+
+typedef void (gb_trace_cb_t)(gb_trace_event_t event, uint32_t value);
 
 int  gnuboy_init(int samplerate, gb_audio_fmt_t audio_fmt, gb_video_fmt_t video_fmt, gb_video_cb_t *video_callback, gb_audio_cb_t *audio_callback);
 int  gnuboy_load_bios(const byte *data, size_t size);
@@ -125,5 +135,17 @@ void gnuboy_set_palette(gb_palette_t pal);
 
 int gnuboy_load_sram(const char *file);
 int gnuboy_save_sram(const char *file, bool quick_save);
+// Battery-backed cart RAM (banks are contiguous), NULL if the cart has none
+byte *gnuboy_get_sram(size_t *size);
+// Called whenever the game changes a byte of battery-backed RAM
+void gnuboy_set_sram_callback(gb_sram_cb_t *callback);
+// Called whenever the game selects a row of the joypad, the host can update the pad right before it's read
+void gnuboy_set_input_callback(gb_input_cb_t *callback);
+// Deterministic trace of frames and serial output. In lockstep mode the counters are advanced after
+// every instruction instead of when their next event is due, both modes must produce the same trace.
+void gnuboy_set_trace(gb_trace_cb_t *callback, bool lockstep);
+// RTC section of the sram file, both return false if the cart has no RTC
+bool gnuboy_get_rtc_data(uint32_t data[12]);
+bool gnuboy_set_rtc_data(const uint32_t data[12]);
 int gnuboy_load_state(const char *file);
 int gnuboy_save_state(const char *file);
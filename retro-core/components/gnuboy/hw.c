@@ -494,6 +494,8 @@ void gb_hw_write(unsigned a, byte b)
 			{
 				cart.rambanks[cart.rambank][a & 0x1FFF] = b;
 				cart.sram_dirty |= (1 << cart.rambank);
+				if (host.sram.callback)
+					(host.sram.callback)(&cart.rambanks[cart.rambank][a & 0x1FFF], 1);
 			}
 		}
 		break;
@@ -519,6 +521,7 @@ void gb_hw_write(unsigned a, byte b)
 		// Sound: 0xFF10 - 0xFF3F
 		else if (a >= 0xFF10 && a <= 0xFF3F)
 		{
+			gb_cpu_sync();
 			gb_sound_write(a & 0xFF, b);
 		}
 		// High RAM: 0xFF80 - 0xFFFE
@@ -531,10 +534,15 @@ void gb_hw_write(unsigned a, byte b)
 		{
 			int r = a & 0xFF;
 
+			// Counters must be caught up before the write, and the write may move the next event
+			gb_cpu_sync();
+
 			switch (r)
 			{
 			case RI_P1:
 				REG(r) = b;
+				if (GB.input.callback)
+					(GB.input.callback)();
 				pad_refresh();
 				break;
 			case RI_SB:
@@ -645,6 +653,8 @@ void gb_hw_write(unsigned a, byte b)
 					break;
 				}
 			}
+
+			gb_cpu_sync();
 		}
 	}
 }
@@ -708,8 +718,15 @@ byte gb_hw_read(unsigned a)
 		else if (a >= 0xFF10 && a <= 0xFF3F)
 		{
 			// Make sure sound emulation is all caught up
+			gb_cpu_sync();
 			gb_sound_emulate();
 		}
+		// Timer: 0xFF04 - 0xFF05
+		else if (a == 0xFF04 || a == 0xFF05)
+		{
+			// DIV and TIMA count continuously, everything else only changes on scheduled events
+			gb_cpu_sync();
+		}
 		// High RAM: 0xFF80 - 0xFFFE
 		// else if ((a & 0xFF80) == 0xFF80)
 		// {
@@ -254,6 +254,19 @@ typedef struct
 		size_t pos, len;
 	} audio;
 
+	struct {
+		gb_sram_cb_t *callback;
+	} sram;
+
+	struct {
+		gb_input_cb_t *callback;
+	} input;
+
+	struct {
+		gb_trace_cb_t *callback;
+		bool lockstep;
+	} trace;
+
 	struct {
 		// Fix for Fushigi no Dungeon - Fuurai no Shiren GB2 and Donkey Kong
 		// This hack simply constrains the window top position
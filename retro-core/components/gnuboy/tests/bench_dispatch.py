@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+# Host benchmark of the CPU dispatch modes of cpu.c: builds the blargg runner with the switch and with
+# CPU_THREADED_DISPATCH, checks that both give the exact same trace, and reports the best user time
+# (rendering is skipped, the time is CPU, scheduler and sound).
+#
+# Usage: bench_dispatch.py [--rom cpu_instrs/cpu_instrs.gb] [--frames N] [--runs N] [--cc gcc]
+import argparse
+import os
+import resource
+import shutil
+import subprocess
+import sys
+import tempfile
+import zipfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+GNUBOY = os.path.dirname(HERE)
+RETRO_GO = os.path.join(GNUBOY, "..", "..", "..", "components", "retro-go")
+MODES = {"switch": "-DCPU_THREADED_DISPATCH=0", "threaded": "-DCPU_THREADED_DISPATCH=1"}
+
+parser = argparse.ArgumentParser(description="gnuboy dispatch benchmark")
+parser.add_argument("--rom", default="cpu_instrs/cpu_instrs.gb", help="ROM path inside blargg.zip")
+parser.add_argument("--frames", type=int, default=8000, help="Frames to run, the ROM keeps running after its result")
+parser.add_argument("--runs", type=int, default=10, help="Runs per mode, the best one is kept")
+parser.add_argument("--cc", default=os.getenv("CC", "gcc"), help="Host C compiler")
+args = parser.parse_args()
+
+workdir = tempfile.mkdtemp(prefix="gnuboy_bench_")
+try:
+    sources = [os.path.join(HERE, "blargg_trace.c")]
+    sources += [os.path.join(GNUBOY, f) for f in sorted(os.listdir(GNUBOY)) if f.endswith(".c")]
+    for mode, flag in MODES.items():
+        cmd = [args.cc, "-O3", flag, "-DRG_TARGET_SDL2", "-I" + GNUBOY, "-I" + RETRO_GO, *sources]
+        subprocess.run([*cmd, "-o", os.path.join(workdir, mode)], check=True)
+
+    with zipfile.ZipFile(os.path.join(HERE, "blargg.zip")) as z:
+        rom = z.extract(args.rom, workdir)
+
+    traces = {}
+    for mode in MODES:
+        for lockstep in ("0", "1"):
+            cmd = [os.path.join(workdir, mode), rom, str(args.frames), lockstep, "1"]
+            traces[mode, lockstep] = subprocess.run(cmd, capture_output=True, text=True, errors="replace").stdout.strip()
+    if len(set(traces.values())) != 1:
+        for key, trace in traces.items():
+            print(f"{key[0]:8} lockstep={key[1]}: {trace}")
+        sys.exit("Trace mismatch between the dispatch modes")
+
+    best = {}
+    for _ in range(args.runs):
+        for mode in MODES:
+            before = resource.getrusage(resource.RUSAGE_CHILDREN).ru_utime
+            subprocess.run([os.path.join(workdir, mode), rom, str(args.frames), "0", "1"], stdout=subprocess.DEVNULL)
+            elapsed = resource.getrusage(resource.RUSAGE_CHILDREN).ru_utime - before
+            best[mode] = min(best.get(mode, elapsed), elapsed)
+
+    print(f"{args.rom}, {args.frames} frames, best of {args.runs} (user time), traces identical")
+    for mode, elapsed in best.items():
+        print(f"  {mode:8} {elapsed:.3f}s  {args.frames / elapsed:.0f} fps  {elapsed / best['switch'] * 100:.0f}%")
+finally:
+    shutil.rmtree(workdir, ignore_errors=True)
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# Runs every ROM from blargg.zip on the host, with the next-event scheduler and in lockstep mode (the
+# counters advanced after every instruction), and checks that both give the exact same trace.
+#
+# Usage: run_blargg.py [--frames N] [--cc gcc] [--cflags "-DCPU_THREADED_DISPATCH=1"]
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import zipfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+GNUBOY = os.path.dirname(HERE)
+RETRO_GO = os.path.join(GNUBOY, "..", "..", "..", "components", "retro-go")
+
+parser = argparse.ArgumentParser(description="gnuboy blargg test runner")
+parser.add_argument("--frames", type=int, default=3600, help="Give up on a ROM after that many frames")
+parser.add_argument("--cc", default=os.getenv("CC", "gcc"), help="Host C compiler")
+parser.add_argument("--cflags", default="", help="Extra compiler flags, to test a build option")
+args = parser.parse_args()
+
+workdir = tempfile.mkdtemp(prefix="gnuboy_blargg_")
+try:
+    runner = os.path.join(workdir, "blargg_trace")
+    sources = [os.path.join(HERE, "blargg_trace.c")]
+    sources += [os.path.join(GNUBOY, f) for f in sorted(os.listdir(GNUBOY)) if f.endswith(".c")]
+    subprocess.run([args.cc, "-O2", *args.cflags.split(), "-DRG_TARGET_SDL2", "-I" + GNUBOY, "-I" + RETRO_GO, *sources, "-o", runner], check=True)
+
+    with zipfile.ZipFile(os.path.join(HERE, "blargg.zip")) as z:
+        z.extractall(workdir)
+
+    roms = []
+    for root, dirs, files in os.walk(workdir):
+        roms += [os.path.join(root, f) for f in files if f.endswith(".gb")]
+
+    mismatches = 0
+    for rom in sorted(roms):
+        name = os.path.relpath(rom, workdir)
+        results = []
+        for lockstep in ("0", "1"):
+            out = subprocess.run([runner, rom, str(args.frames), lockstep], capture_output=True, text=True, errors="replace")
+            results.append(out.stdout.strip())
+        text, trace = results[0].rsplit("\t", 1)
+        status = "passed" if "Passed" in text else "FAILED" if "Failed" in text else "no result"
+        if results[0] != results[1]:
+            mismatches += 1
+            print(f"MISMATCH  {name}\n  scheduler: {results[0]}\n  lockstep:  {results[1]}")
+        else:
+            print(f"same      {name}: {status} ({trace})")
+
+    print(f"\n{len(roms)} ROMs, {mismatches} trace mismatches")
+    sys.exit(1 if mismatches else 0)
+finally:
+    shutil.rmtree(workdir, ignore_errors=True)
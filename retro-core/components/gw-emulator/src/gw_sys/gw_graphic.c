@@ -19,6 +19,7 @@ __license__ = "GPLv3"
 
 */
 #include <string.h>
+#include <stdint.h>
 
 #include "gw_type_defs.h"
 #include "gw_graphic.h"
@@ -43,9 +44,6 @@ __license__ = "GPLv3"
 
 static uint16 *gw_graphic_framebuffer = 0;
 
-static uint16 *source_mixer = 0;
-
-static uint8 SEG_TRANSPARENT_COLOR = 0;
 #define SEG_WHITE_COLOR 0xff
 #define SEG_BLACK_COLOR 0x0
 
@@ -73,150 +71,249 @@ static inline uint16 rgb_multiply_8bits(uint32 bg, uint32 sg)
 	return (uint16)(bg_r << 11) | (bg_g << 5) | bg_b;
 }
 
-/************************ Generic function to display a segment *****************/
-void (*update_segment)(uint8 segment_nb, bool segment_state);
-
-/* Segment to framebuffer graphic function */
-/* segments are stored from 0 to 255 in memory*/
-
-/* Deviation 2bits segment resolution function */
-__attribute__((optimize("unroll-loops"))) static inline void update_segment_2bits(uint8 segment_nb, bool segment_state)
+/************************ Pre-rasterized segments *****************/
+/*
+  At ROM load each segment is converted into horizontal runs of visible pixels.
+  Rendering then never decodes packed pixels nor visits transparent ones, and
+  only the lines covered by segments that changed state are composited again.
+*/
+typedef struct
 {
+	uint16 line;
+	uint16 x;
+	uint16 length;
+	uint32 pixels; /* index of the first pixel intensity in segment_pixels */
+} gw_span_t;
 
-	/* segment first pixel corner (up/left) */
-	uint32 segment = gw_segments_offset[segment_nb];
+static gw_span_t *segment_spans = NULL;
+static uint8 *segment_pixels = NULL;
+static uint32 segment_first_span[GW_MAX_SEGMENTS + 1];
 
-	uint8 cur_pixel,cur_pixelr;
-	int idx = 0;
+/* segments state as requested by the LCD controller and as found in the framebuffer */
+static bool segment_lit[GW_MAX_SEGMENTS];
+static bool segment_drawn[GW_MAX_SEGMENTS];
 
-	/* nothing to do for this segment */
-	if (segment_state == 0)
-		return;
+/* segments in the order they are scanned by the LCD controller */
+static uint8 segment_order[GW_MAX_SEGMENTS];
+static int segment_scanned = 0;
 
-	/* 4bits data size access */
-	idx = segment & 0x3;
-	segment = segment >> 2;
+static uint32_t dirty_lines[(GW_SCREEN_HEIGHT + 31) / 32];
+static bool frame_changed = false;
 
-	uint8 *pixel;
-	pixel = &gw_segments[segment];
+#define LINE_IS_DIRTY(line) (dirty_lines[(line) >> 5] & (1u << ((line) & 31)))
+#define LINE_SET_DIRTY(line) (dirty_lines[(line) >> 5] |= (1u << ((line) & 31)))
 
-	/* get segment coordinates */
-	uint16 segments_x = gw_segments_x[segment_nb];
-	uint16 segments_y = gw_segments_y[segment_nb];
-	uint16 segments_width = gw_segments_width[segment_nb];
-	uint16 segments_height = gw_segments_height[segment_nb];
+/* Decode the pixel intensity of a segment, as 8bits, from 2bits, 4bits or 8bits data */
+static inline uint8 segment_pixel(uint32 offset, uint32 idx)
+{
+	uint8 cur_pixel;
 
-	for (int line = segments_y; line < segments_height + segments_y; line++)
+	if (gw_head.flags & FLAG_SEGMENTS_2BITS)
 	{
-		for (int x = segments_x; x < segments_width + segments_x; x++)
-		{
+		idx += offset;
+		cur_pixel = (gw_segments[idx >> 2] >> 2 * (idx & 0x3)) & 0x3;
+		cur_pixel |= cur_pixel << 2 | cur_pixel << 4 | cur_pixel << 6;
+	}
+	else if (gw_head.flags & FLAG_SEGMENTS_4BITS)
+	{
+		idx += offset;
+		cur_pixel = (idx & 0x1) ? gw_segments[idx >> 1] << 4 : gw_segments[idx >> 1] & 0xF0;
+		cur_pixel |= cur_pixel >> 4;
+	}
+	else
+		cur_pixel = gw_segments[offset + idx];
+
+	return cur_pixel;
+}
 
-			cur_pixelr = (pixel[idx >> 2] >> 2*(idx & 0x3)) &0x3;
+/* Convert all segments to spans. Buffers can be NULL to only count spans and pixels */
+static uint32 rasterize_segments(int nb_segments, gw_span_t *spans, uint8 *pixels, uint32 *nb_pixels)
+{
+	uint8 transparent = (gw_head.flags & FLAG_RENDERING_LCD_INVERTED) ? SEG_BLACK_COLOR : SEG_WHITE_COLOR;
+	uint32 nb_spans = 0;
 
-			idx++;
+	*nb_pixels = 0;
 
-			cur_pixel = cur_pixelr | cur_pixelr << 2 | cur_pixelr << 4 | cur_pixelr << 6;
+	for (int segment_nb = 0; segment_nb < GW_MAX_SEGMENTS; segment_nb++)
+	{
+		segment_first_span[segment_nb] = nb_spans;
 
+		if (segment_nb >= nb_segments)
+			continue;
 
-			/* Check if there something to mix
-			if the segment pixel is transparent nothing to do. */
-			if (cur_pixel != SEG_TRANSPARENT_COLOR) {
-			
-			// change black color to get transparency effect
-			if ( cur_pixel == 0 ) cur_pixel = 39;
-			gw_graphic_framebuffer[line * GW_SCREEN_WIDTH + x] = rgb_multiply_8bits(source_mixer[line * GW_SCREEN_WIDTH + x], cur_pixel);
-			}
+		uint32 offset = gw_segments_offset[segment_nb];
+		uint16 segments_x = gw_segments_x[segment_nb];
+		uint16 segments_y = gw_segments_y[segment_nb];
+		uint16 segments_width = gw_segments_width[segment_nb];
+		uint16 segments_height = gw_segments_height[segment_nb];
+		uint32 idx = 0;
 
+		for (int line = segments_y; line < segments_height + segments_y; line++)
+		{
+			gw_span_t *span = NULL;
+
+			for (int x = segments_x; x < segments_width + segments_x; x++)
+			{
+				uint8 cur_pixel = segment_pixel(offset, idx++);
+
+				if (cur_pixel == transparent || line >= GW_SCREEN_HEIGHT || x >= GW_SCREEN_WIDTH)
+				{
+					span = NULL;
+					continue;
+				}
+
+				// 2bits deviation: change black color to get transparency effect
+				if ((gw_head.flags & FLAG_SEGMENTS_2BITS) && cur_pixel == 0)
+					cur_pixel = 39;
+
+				if (span == NULL)
+				{
+					static gw_span_t counting;
+					span = spans ? &spans[nb_spans] : &counting;
+					span->line = line;
+					span->x = x;
+					span->length = 0;
+					span->pixels = *nb_pixels;
+					nb_spans++;
+				}
+
+				if (pixels)
+					pixels[*nb_pixels] = cur_pixel;
+				(*nb_pixels)++;
+				span->length++;
+			}
 		}
 	}
+	segment_first_span[GW_MAX_SEGMENTS] = nb_spans;
+
+	return nb_spans;
 }
-/* Deviation 4bits segment resolution function */
-__attribute__((optimize("unroll-loops"))) static inline void update_segment_4bits(uint8 segment_nb, bool segment_state)
+
+bool gw_gfx_load_segments()
 {
+	int nb_segments = gw_head.segments_x_size / sizeof(uint16);
+	uint32 nb_spans, nb_pixels;
 
-	/* segment first pixel corner (up/left) */
-	uint32 segment = gw_segments_offset[segment_nb];
+	if (nb_segments > GW_MAX_SEGMENTS)
+		nb_segments = GW_MAX_SEGMENTS;
 
-	uint8 cur_pixel;
-	int idx = 0;
+	free(segment_spans);
+	free(segment_pixels);
 
-	/* nothing to do for this segment */
-	if (segment_state == 0)
-		return;
+	nb_spans = rasterize_segments(nb_segments, NULL, NULL, &nb_pixels);
 
-	/* 4bits data size access */
-	idx = segment & 0x1;
-	segment = segment >> 1;
+	segment_spans = malloc(nb_spans * sizeof(gw_span_t) + 1);
+	segment_pixels = malloc(nb_pixels + 1);
 
-	uint8 *pixel;
-	pixel = &gw_segments[segment];
+	if (!segment_spans || !segment_pixels)
+	{
+		printf("Segments: out of memory (%u spans, %u pixels)\n", nb_spans, nb_pixels);
+		return false;
+	}
 
-	/* get segment coordinates */
-	uint16 segments_x = gw_segments_x[segment_nb];
-	uint16 segments_y = gw_segments_y[segment_nb];
-	uint16 segments_width = gw_segments_width[segment_nb];
-	uint16 segments_height = gw_segments_height[segment_nb];
+	rasterize_segments(nb_segments, segment_spans, segment_pixels, &nb_pixels);
 
-	for (int line = segments_y; line < segments_height + segments_y; line++)
-	{
-		for (int x = segments_x; x < segments_width + segments_x; x++)
-		{
+	printf("Segments: %d segments, %u spans, %u pixels\n", nb_segments, nb_spans, nb_pixels);
 
-			if ((idx & 0x1) == 0)
-				cur_pixel = pixel[idx >> 1] & 0xF0;
-			else
-				cur_pixel = pixel[idx >> 1] << 4;
+	/* the next frame must be composited from scratch */
+	gw_graphic_framebuffer = NULL;
 
-			cur_pixel |= cur_pixel >> 4;
-			idx++;
+	return true;
+}
 
-			/* Check if there something to mix
-			if the segment pixel is transparent nothing to do. */
-			if (cur_pixel != SEG_TRANSPARENT_COLOR)
-				gw_graphic_framebuffer[line * GW_SCREEN_WIDTH + x] = rgb_multiply_8bits(source_mixer[line * GW_SCREEN_WIDTH + x], cur_pixel);
-		}
+/* Record the state of a segment, it will be composited once all segments are scanned */
+static inline void update_segment(uint8 segment_nb, bool segment_state)
+{
+	segment_order[segment_scanned++] = segment_nb;
+	segment_lit[segment_nb] = segment_state;
+}
+
+static inline void draw_segment(uint8 segment_nb, bool inverted)
+{
+	const gw_span_t *span = &segment_spans[segment_first_span[segment_nb]];
+	const gw_span_t *last = &segment_spans[segment_first_span[segment_nb + 1]];
+
+	for (; span < last; span++)
+	{
+		if (!LINE_IS_DIRTY(span->line))
+			continue;
+
+		uint32 offset = span->line * GW_SCREEN_WIDTH + span->x;
+		uint16 *dst = &gw_graphic_framebuffer[offset];
+		const uint16 *src = inverted ? &gw_background[offset] : dst;
+		const uint8 *pixel = &segment_pixels[span->pixels];
+
+		for (int x = 0; x < span->length; x++)
+			dst[x] = rgb_multiply_8bits(src[x], pixel[x]);
 	}
 }
 
-/* Deviation 8bits segment resolution function */
-__attribute__((optimize("unroll-loops"))) static inline void update_segment_8bits(uint8 segment_nb, bool segment_state)
+/* Composite again the lines covered by segments that changed since the last frame */
+static void compose_segments(uint16 *framebuffer)
 {
+	bool inverted = (gw_head.flags & FLAG_RENDERING_LCD_INVERTED) != 0;
+	bool redraw_all = (framebuffer != gw_graphic_framebuffer);
 
-	/* segment first pixel corner (up/left) */
-	uint32 segment = gw_segments_offset[segment_nb];
+	gw_graphic_framebuffer = framebuffer;
+	frame_changed = false;
 
-	uint8 cur_pixel;
-	int idx = 0;
+	if (redraw_all)
+	{
+		memset(dirty_lines, 0xff, sizeof(dirty_lines));
+		frame_changed = true;
+	}
+	else
+	{
+		memset(dirty_lines, 0, sizeof(dirty_lines));
 
-	/* nothing to do for this segment */
-	if (segment_state == 0)
-		return;
+		for (int segment_nb = 0; segment_nb < GW_MAX_SEGMENTS; segment_nb++)
+		{
+			if (segment_lit[segment_nb] == segment_drawn[segment_nb])
+				continue;
 
-	uint8 *pixel;
-	pixel = &gw_segments[segment];
+			const gw_span_t *span = &segment_spans[segment_first_span[segment_nb]];
+			const gw_span_t *last = &segment_spans[segment_first_span[segment_nb + 1]];
 
-	/* get segment coordinates */
-	uint16 segments_x = gw_segments_x[segment_nb];
-	uint16 segments_y = gw_segments_y[segment_nb];
-	uint16 segments_width = gw_segments_width[segment_nb];
-	uint16 segments_height = gw_segments_height[segment_nb];
+			for (; span < last; span++)
+				LINE_SET_DIRTY(span->line);
 
-	for (int line = segments_y; line < segments_height + segments_y; line++)
+			frame_changed = true;
+		}
+	}
+
+	if (frame_changed)
 	{
-		for (int x = segments_x; x < segments_width + segments_x; x++)
+		/* restore dirty lines to the blank LCD */
+		for (int line = 0; line < GW_SCREEN_HEIGHT; line++)
 		{
+			if (!LINE_IS_DIRTY(line))
+				continue;
 
-			cur_pixel = pixel[idx];
-			idx++;
+			if (inverted)
+				memset(&framebuffer[line * GW_SCREEN_WIDTH], 0, GW_SCREEN_WIDTH * 2);
+			else
+				memcpy(&framebuffer[line * GW_SCREEN_WIDTH], &gw_background[line * GW_SCREEN_WIDTH], GW_SCREEN_WIDTH * 2);
+		}
+
+		/* draw lit segments in the same order as the LCD controller scan */
+		for (int i = 0; i < segment_scanned; i++)
+		{
+			uint8 segment_nb = segment_order[i];
 
-			/* Check if there something to mix
-				if the segment pixel is black, it's considered transparent.
-				it prevents from mixing 2 overlapping segments
-				'gw_background' is the colour sheet. segment colour is white. */
-			if (cur_pixel != SEG_TRANSPARENT_COLOR)
-				gw_graphic_framebuffer[line * GW_SCREEN_WIDTH + x] = rgb_multiply_8bits(source_mixer[line * GW_SCREEN_WIDTH + x], cur_pixel);
+			if (segment_lit[segment_nb])
+				draw_segment(segment_nb, inverted);
 		}
 	}
+
+	/* segments not scanned by the next frame are considered off */
+	memcpy(segment_drawn, segment_lit, sizeof(segment_drawn));
+	memset(segment_lit, 0, sizeof(segment_lit));
+	segment_scanned = 0;
+}
+
+const uint32_t *gw_gfx_dirty_lines()
+{
+	return frame_changed ? dirty_lines : NULL;
 }
 
 /* Specific functions to pool segments status */
@@ -246,21 +343,7 @@ __attribute__((optimize("unroll-loops"))) inline void gw_gfx_sm510_rendering(uin
 	uint8 segment_position;
 	uint8 segment_state;
 
-	gw_graphic_framebuffer = framebuffer;
-
-	if (gw_head.flags & FLAG_RENDERING_LCD_INVERTED)
-	{
-
-		memset(framebuffer, 0, GW_SCREEN_WIDTH * GW_SCREEN_HEIGHT * 2);
-		SEG_TRANSPARENT_COLOR = SEG_BLACK_COLOR;
-		source_mixer = gw_background;
-	}
-	else
-	{
-		memcpy(framebuffer, gw_background, GW_SCREEN_WIDTH * GW_SCREEN_HEIGHT * 2);
-		SEG_TRANSPARENT_COLOR = SEG_WHITE_COLOR;
-		source_mixer = framebuffer;
-	}
+	segment_scanned = 0;
 
 	//scan group a1..a16,b1..b16,c11..c16
 	for (int seg_y = 0; seg_y < NB_SEGS_ROW; seg_y++)
@@ -320,6 +403,8 @@ __attribute__((optimize("unroll-loops"))) inline void gw_gfx_sm510_rendering(uin
 
 		update_segment(132 + seg_z, ((segment_state & (1 << seg_z)) != 0));
 	}
+
+	compose_segments(framebuffer);
 }
 
 /* SM500 I/O based LCD controller */
@@ -338,21 +423,7 @@ __attribute__((optimize("unroll-loops"))) inline void gw_gfx_sm500_rendering(uin
 */
 	uint8 seg;
 
-	gw_graphic_framebuffer = framebuffer;
-
-	if (gw_head.flags & FLAG_RENDERING_LCD_INVERTED)
-	{
-
-		memset(framebuffer, 0, GW_SCREEN_WIDTH * GW_SCREEN_HEIGHT * 2);
-		SEG_TRANSPARENT_COLOR = SEG_BLACK_COLOR;
-		source_mixer = gw_background;
-	}
-	else
-	{
-		memcpy(framebuffer, gw_background, GW_SCREEN_WIDTH * GW_SCREEN_HEIGHT * 2);
-		SEG_TRANSPARENT_COLOR = SEG_WHITE_COLOR;
-		source_mixer = framebuffer;
-	}
+	segment_scanned = 0;
 
 	// 2 columns z
 	for (int h = 0; h < 2; h++)
@@ -374,6 +445,8 @@ __attribute__((optimize("unroll-loops"))) inline void gw_gfx_sm500_rendering(uin
 			update_segment(8 * o + 6 + h, m_bp ? ((seg & 0x8) != 0) : 0); // 6,7
 		}
 	}
+
+	compose_segments(framebuffer);
 }
 void gw_gfx_init()
 {
@@ -385,12 +458,6 @@ void gw_gfx_init()
 	// for segments rendering side
 	deflicker_enabled = (flag_lcd_deflicker_level != 0);
 
-	/* determine which API to use for segments rendering */
-	update_segment = update_segment_8bits;
-
-	if (gw_head.flags & FLAG_SEGMENTS_4BITS)
-		update_segment = update_segment_4bits;
-	if (gw_head.flags & FLAG_SEGMENTS_2BITS)
-		update_segment = update_segment_2bits;
-
+	/* the next frame must be composited from scratch */
+	gw_graphic_framebuffer = NULL;
 }
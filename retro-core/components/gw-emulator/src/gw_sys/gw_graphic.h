@@ -22,6 +22,8 @@ __license__ = "GPLv3"
 #ifndef _GW_GRAPHIC_H_
 #define _GW_GRAPHIC_H_
 
+#include <stdint.h>
+
 /****************************/
 // H1..4
 #define NB_SEGS_COL   4
@@ -32,14 +34,21 @@ __license__ = "GPLv3"
 //a,b,c
 #define NB_SEGS_BUS   3
 
+//segments addressable by the LCD controllers
+#define GW_MAX_SEGMENTS 256
+
 //a,b,c base address
 #define ADD_SEGA_BASE    0x60
 #define ADD_SEGB_BASE    0x70
 #define ADD_SEGC_BASE    0x50
 
 /* Function prototypes */
+bool gw_gfx_load_segments();
 void gw_gfx_init();
 void gw_gfx_sm500_rendering(uint16 *framebuffer);
 void gw_gfx_sm510_rendering(uint16 *framebuffer);
 
+/* Lines changed by the last rendering (one bit per line), NULL if the framebuffer is unchanged */
+const uint32_t *gw_gfx_dirty_lines();
+
 #endif /* _GW_GRAPHIC_H_ */
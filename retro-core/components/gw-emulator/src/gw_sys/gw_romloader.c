@@ -46,6 +46,7 @@ __license__ = "GPLv3"
 #include "gw_type_defs.h"
 #include "gw_system.h"
 #include "gw_romloader.h"
+#include "gw_graphic.h"
 #ifdef GW_JPEG_SUPPORT
 #include "hw_jpeg_decoder.h"
 
@@ -325,7 +326,8 @@ bool gw_romloader_rom2ram()
 
    gw_keyboard = (unsigned int *)&GW_ROM[gw_head.keyboard];
 
-   return true;
+   /* Pre-rasterize segments to spans, the packed data isn't used for rendering anymore */
+   return gw_gfx_load_segments();
 }
 
 /* Load a ROM image into memory */
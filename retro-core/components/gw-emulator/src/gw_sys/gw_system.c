@@ -183,6 +183,7 @@ bool gw_system_config()
 void gw_system_reset() { device_reset(); }
 void gw_system_start() { device_start(); }
 void gw_system_blit(unsigned short *active_framebuffer) { device_blit(active_framebuffer); }
+const uint32_t *gw_system_dirty_lines() { return gw_gfx_dirty_lines(); }
 bool gw_system_romload() { return gw_romloader(); }
 
 /******** Audio functions *******************/
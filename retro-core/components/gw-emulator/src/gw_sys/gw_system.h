@@ -22,6 +22,7 @@ __license__ = "GPLv3"
 #define _GW_SYSTEM_H_
 
 #include "gw_type_defs.h"
+#include <stdint.h>
 
 #define GW_SCREEN_WIDTH 320
 #define GW_SCREEN_HEIGHT 240
@@ -48,6 +49,8 @@ void gw_system_reset();
 // Run some clock cycles and refresh the display
 int gw_system_run(int clock_cycles);
 void gw_system_blit(unsigned short *active_framebuffer);
+// Lines changed by the last blit (one bit per line), NULL if nothing changed
+const uint32_t *gw_system_dirty_lines();
 
 // Audio init
 void gw_system_sound_init();
@@ -106,7 +106,9 @@ CMikie::CMikie(CSystem& parent, ULONG displayformat, ULONG samplerate)
    mpRamPointer=NULL;
    mDisplayFormat=displayformat;
    mAudioSampleRate=samplerate;
-   mDisplayPitch=HANDY_SCREEN_WIDTH * 2;
+   mDisplayPitch=HANDY_SCREEN_WIDTH * (mDisplayFormat == MIKIE_PIXEL_FORMAT_8BPP_PAL565_BE ? 1 : 2);
+   mPaletteBank=0;
+   mPaletteDirty=TRUE;
 
    mUART_CABLE_PRESENT=FALSE;
    mpUART_TX_CALLBACK=NULL;
@@ -568,6 +570,7 @@ bool CMikie::ContextLoad(LSS_FILE *fp)
    if(!lss_read(&mTimerInterruptMask,sizeof(ULONG),1,fp)) return 0;
 
    if(!lss_read(mPalette,sizeof(TPALETTE),16,fp)) return 0;
+   mPaletteDirty=TRUE;
 
    if(!lss_read(&mIODAT,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mIODAT_REST_SIGNAL,sizeof(ULONG),1,fp)) return 0;
@@ -846,7 +849,7 @@ void CMikie::BuildPalette()
       mColourMap[Spot.Index]|=((Spot.Colours.Blue<<1)&0x001e) | ((Spot.Colours.Blue>>3)&0x0001);
    }
 
-   if (mDisplayFormat == MIKIE_PIXEL_FORMAT_16BPP_565_BE) {
+   if (mDisplayFormat == MIKIE_PIXEL_FORMAT_16BPP_565_BE || mDisplayFormat == MIKIE_PIXEL_FORMAT_8BPP_PAL565_BE) {
       for(int i=0;i<4096;i++) {
          mColourMap[i] = mColourMap[i] << 8 | mColourMap[i] >> 8;
       }
@@ -871,6 +874,15 @@ inline void CMikie::ResetDisplayPtr()
       mDisplayRotate = mDisplayRotate_Pending;
    }
 
+   // The display rotates indexed frames itself
+   if (mDisplayFormat == MIKIE_PIXEL_FORMAT_8BPP_PAL565_BE)
+   {
+      mpDisplayCurrent=gPrimaryFrameBuffer;
+      mPaletteBank=0;
+      mPaletteDirty=TRUE;
+      return;
+   }
+
    switch(mDisplayRotate)
    {
       case MIKIE_ROTATE_L:
@@ -885,6 +897,20 @@ inline void CMikie::ResetDisplayPtr()
    }
 }
 
+inline void CMikie::UpdatePaletteBank(void)
+{
+   // Bank 0 is set up by the first line, when all 16 banks are used the last one gets overwritten
+   if (mpDisplayCurrent != gPrimaryFrameBuffer && mPaletteBank < 15)
+      mPaletteBank++;
+
+   if (gPrimaryPalette) {
+      UWORD *bank=gPrimaryPalette+(mPaletteBank<<4);
+      for(int loop=0;loop<16;loop++)
+         bank[loop]=mColourMap[mPalette[loop].Index];
+   }
+   mPaletteDirty=FALSE;
+}
+
 inline ULONG CMikie::DisplayRenderLine(void)
 {
    UWORD *bitmap_tmp=NULL;
@@ -942,6 +968,35 @@ inline ULONG CMikie::DisplayRenderLine(void)
       // Mikie screen DMA can only see the system RAM....
       // (Step through bitmap, line at a time)
 
+      if (mDisplayFormat == MIKIE_PIXEL_FORMAT_8BPP_PAL565_BE)
+      {
+         if (mPaletteDirty) UpdatePaletteBank();
+
+         UBYTE *line_tmp=mpDisplayCurrent;
+         UBYTE bank=mPaletteBank<<4;
+
+         if(mDISPCTL_Flip)
+         {
+            for(loop=0;loop<HANDY_SCREEN_WIDTH/2;loop++)
+            {
+               source=mpRamPointer[mLynxAddr--];
+               *(line_tmp++)=bank|(source&0x0f);
+               *(line_tmp++)=bank|(source>>4);
+            }
+         }
+         else
+         {
+            for(loop=0;loop<HANDY_SCREEN_WIDTH/2;loop++)
+            {
+               source=mpRamPointer[mLynxAddr++];
+               *(line_tmp++)=bank|(source>>4);
+               *(line_tmp++)=bank|(source&0x0f);
+            }
+         }
+         mpDisplayCurrent+=mDisplayPitch;
+         return work_done;
+      }
+
       // Assign the temporary pointer;
       bitmap_tmp=(UWORD*)mpDisplayCurrent;
 
@@ -1713,6 +1768,7 @@ void CMikie::Poke(ULONG addr,UBYTE data)
       case (GREENF&0xff):
          TRACE_MIKIE2("Poke(GREENPAL0-F,%02x) at PC=%04x",data,mSystem.mCpu->GetPC());
          mPalette[addr&0x0f].Colours.Green=data&0x0f;
+         mPaletteDirty=TRUE;
          break;
 
       case (BLUERED0&0xff):
@@ -1734,6 +1790,7 @@ void CMikie::Poke(ULONG addr,UBYTE data)
          TRACE_MIKIE2("Poke(BLUEREDPAL0-F,%02x) at PC=%04x",data,mSystem.mCpu->GetPC());
          mPalette[addr&0x0f].Colours.Blue=(data&0xf0)>>4;
          mPalette[addr&0x0f].Colours.Red=data&0x0f;
+         mPaletteDirty=TRUE;
          break;
 
          // Errors on read only register accesses
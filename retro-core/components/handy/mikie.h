@@ -141,7 +141,10 @@ enum
 enum
 {
    MIKIE_PIXEL_FORMAT_16BPP_565=0,
-   MIKIE_PIXEL_FORMAT_16BPP_565_BE
+   MIKIE_PIXEL_FORMAT_16BPP_565_BE,
+   // Unrotated lines of bank<<4|pen indices into gPrimaryPalette (565 BE), a new bank of 16 colours
+   // is started on the first line drawn after a palette change. Rotation is left to the display.
+   MIKIE_PIXEL_FORMAT_8BPP_PAL565_BE
 };
 
 class CMikie : public CLynxBase
@@ -175,6 +178,7 @@ class CMikie : public CLynxBase
       inline void UpdateSound(void);
       inline void UpdateCalcSound(void);
       inline void ResetDisplayPtr();
+      inline void UpdatePaletteBank(void);
       ULONG	DisplayRenderLine(void);
       void	BlowOut(void);
 
@@ -192,6 +196,8 @@ class CMikie : public CLynxBase
 
       TPALETTE	mPalette[16];
       UWORD		mColourMap[4096];
+      UBYTE		mPaletteBank;
+      bool		mPaletteDirty;
 
       ULONG		mIODAT;
       ULONG		mIODIR;
@@ -82,6 +82,7 @@ SWORD   *gAudioBuffer;//[HANDY_AUDIO_BUFFER_SIZE];
 ULONG   gAudioBufferPointer=0;
 ULONG   gAudioLastUpdateCycle=0;
 UBYTE   *gPrimaryFrameBuffer=NULL;
+UWORD   *gPrimaryPalette=NULL;
 
 
 extern void lynx_decrypt(unsigned char * result, const unsigned char * encrypted, const int length);
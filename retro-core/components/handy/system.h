@@ -120,6 +120,7 @@ extern SWORD    *gAudioBuffer;
 extern ULONG    gAudioBufferPointer;
 extern ULONG    gAudioLastUpdateCycle;
 extern UBYTE    *gPrimaryFrameBuffer;
+extern UWORD    *gPrimaryPalette;
 
 // typedef struct lssfile
 // {
@@ -325,6 +325,7 @@ static uint8 map_read(uint32 address)
     case 0x5204:
         /* Scanline IRQ Status */
         {
+            nes6502_idle_reset();
             uint8 x = irq.status;
             irq.status &= ~IRQ_PENDING;
             return x;
@@ -208,6 +208,9 @@ static uint8 map_read(uint32 address)
 {
     uint8 reg = address >> 11;
 
+    if (reg == 0xA || reg == 0xB)
+        nes6502_idle_reset();
+
     switch (reg)
     {
     case 0xA: // IRQ Counter (low) ($5000-$57FF)
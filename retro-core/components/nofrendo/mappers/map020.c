@@ -120,6 +120,9 @@ static uint8 fds_read(uint32 address)
     MESSAGE_INFO("FDS read at %04X\n", address);
     uint8 ret = 0;
 
+    // The disk status changes as the transfer runs, loops polling it must not be fast-forwarded
+    nes6502_idle_reset();
+
     switch (address)
     {
         case 0x4030:                    // Disk Status Register 0
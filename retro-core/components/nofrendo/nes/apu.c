@@ -642,6 +642,7 @@ uint8 apu_read(uint32 address)
    switch (address)
    {
    case APU_SMASK:
+      nes6502_idle_reset();
       value = 0;
       /* Return 1 in 0-5 bit pos if a channel is playing */
       if (apu.rectangle[0].enabled && apu.rectangle[0].vbl_length)
@@ -223,7 +223,7 @@ static nes6502_t cpu;
 
 
 /* Stack push/pull */
-#define PUSH(value)             cpu.stack[S--] = (uint8) (value)
+#define PUSH(value)             rg_idle_reset(&cpu.idle), cpu.stack[S--] = (uint8) (value)
 #define PULL()                  cpu.stack[++S]
 
 
@@ -277,6 +277,8 @@ static nes6502_t cpu;
          ADD_CYCLES(1); \
       ADD_CYCLES(3); \
       PC += (int8) btemp; \
+      if ((int8) btemp < 0) \
+         IDLE_CHECK(PC - (int8) btemp - 2); \
    } \
    else \
    { \
@@ -285,6 +287,17 @@ static nes6502_t cpu;
    } \
 }
 
+/* Fast-forward loops that are only waiting for the next scanline, NMI or IRQ */
+#define IDLE_STATE() \
+   ((uint64_t) A | X << 8 | Y << 16 | S << 24 | (uint64_t) COMBINE_FLAGS() << 32)
+
+#define IDLE_CHECK(from) \
+{ \
+   int skip = rg_idle_branch(&cpu.idle, (from), PC, IDLE_STATE(), \
+                             cpu.total_cycles + cycles - remaining_cycles, remaining_cycles); \
+   ADD_CYCLES(skip); \
+}
+
 #define JUMP(address) \
 { \
    PC = readword(address); \
@@ -625,8 +638,11 @@ static nes6502_t cpu;
 
 #define JMP_ABSOLUTE() \
 { \
+   addr = PC - 1; \
    JUMP(PC); \
    ADD_CYCLES(3); \
+   if (PC <= addr) \
+      IDLE_CHECK(addr); \
 }
 
 #define JSR() \
@@ -1037,7 +1053,7 @@ static nes6502_t cpu;
 */
 
 #define ZP_READBYTE(addr)          (cpu.zp[(addr)])
-#define ZP_WRITEBYTE(addr, value)  (cpu.zp[(addr)] = (uint8) (value))
+#define ZP_WRITEBYTE(addr, value)  (rg_idle_reset(&cpu.idle), cpu.zp[(addr)] = (uint8) (value))
 #define ZP_READWORD(addr)          (PAGE_READWORD(cpu.zp, addr))
 
 /*
@@ -1062,13 +1078,13 @@ static nes6502_t cpu;
 
 #define fast_readbyte(a) ({uint16 _a = (a); cpu.pages[_a >> MEM_PAGESHIFT][_a];})
 #define fast_readword(a) ({uint16 _a = (a); ((_a & MEM_PAGEMASK) != MEM_PAGEMASK) ? PAGE_READWORD(cpu.pages[_a >> MEM_PAGESHIFT], _a) : mem_getword(_a);})
-#define writebyte(a, v)  {uint16 _a = (a), _v = (v); if (_a < 0x2000) cpu.pages[0][_a & 0x7FF] = _v; else mem_putbyte(_a, _v);}
+#define writebyte(a, v)  {uint16 _a = (a), _v = (v); rg_idle_reset(&cpu.idle); if (_a < 0x2000) cpu.pages[0][_a & 0x7FF] = _v; else mem_putbyte(_a, _v);}
 
 #else /* !NES6502_FASTMEM */
 
 #define fast_readbyte(a) mem_getbyte(a)
 #define fast_readword(a) mem_getword(a)
-#define writebyte(a, v) mem_putbyte(a, v)
+#define writebyte(a, v) {rg_idle_reset(&cpu.idle); mem_putbyte(a, v);}
 
 #endif /* !NES6502_FASTMEM */
 
@@ -1470,6 +1486,7 @@ IRAM_ATTR int nes6502_execute(int cycles)
    /* Return our actual amount of executed cycles */
    cycles -= remaining_cycles; // remaining_cycles can be negative, which is fine
    cpu.total_cycles += cycles;
+   cpu.idle.cycles += cycles;
 
    return cycles;
 }
@@ -1518,6 +1535,14 @@ void nes6502_burn(int cycles)
    cpu.burn_cycles += cycles;
 }
 
+/* Stop fast-forwarding the current loop, for reads of registers that
+** may change before the next scanline
+*/
+void nes6502_idle_reset(void)
+{
+   rg_idle_reset(&cpu.idle);
+}
+
 /* Issue a CPU Reset */
 void nes6502_reset(void)
 {
@@ -1528,6 +1553,7 @@ void nes6502_reset(void)
    cpu.int_pending = false;               /* No pending interrupts */
    cpu.jammed = false;
    cpu.burn_cycles = RESET_CYCLES;
+   rg_idle_reset(&cpu.idle);
 }
 
 /* Create a nes6502 object */
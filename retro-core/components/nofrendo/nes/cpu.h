@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <rg_idle.h>
+
 /* NOTE: 16-bit addresses avoided like the plague: use 32-bit values
 **       wherever humanly possible
 */
@@ -64,6 +66,8 @@ typedef struct
 
    long total_cycles;
    long burn_cycles;
+
+   rg_idle_t idle;
 } nes6502_t;
 
 /* Functions which govern the 6502's execution */
@@ -73,6 +77,7 @@ void nes6502_irq(void);
 void nes6502_irq_clear(void);
 uint32 nes6502_getcycles(void);
 void nes6502_burn(int cycles);
+void nes6502_idle_reset(void);
 
 nes6502_t *nes6502_init(uint8 **memmap);
 void nes6502_reset(void);
@@ -25,6 +25,7 @@
 
 static input_t ports[2];
 static int strobe = 0;
+static void (*strobe_hook)(void);
 
 
 void input_write(uint32 address, uint8 value)
@@ -33,6 +34,9 @@ void input_write(uint32 address, uint8 value)
 
     if (!value && strobe)
     {
+        /* Let the host update the pads right when the game latches them */
+        if (strobe_hook)
+            strobe_hook();
         ports[0].reads = 0;
         ports[1].reads = 0;
     }
@@ -82,6 +86,11 @@ void input_update(int port, int state)
     ports[port & 1].state = state;
 }
 
+void input_setstrobehook(void (*hook)(void))
+{
+    strobe_hook = hook;
+}
+
 input_t *input_init(void)
 {
     input_connect(0, NES_JOYPAD);
@@ -55,5 +55,6 @@ input_t *input_init(void);
 void input_reset(void);
 void input_connect(int port, nes_dev_t type);
 void input_update(int port, int state);
+void input_setstrobehook(void (*hook)(void));
 uint8 input_read(uint32 address);
 void input_write(uint32 address, uint8 value);
@@ -132,13 +132,28 @@ void mem_putbyte(uint32 address, uint8 value)
 
    if (flags & MEM_PAGE_HAS_MEMORY)
    {
-      mem.pages[address >> MEM_PAGESHIFT][address] = value;
+      uint8 *ptr = &mem.pages[address >> MEM_PAGESHIFT][address];
+      if ((uintptr_t)ptr - (uintptr_t)mem.sram < mem.sram_size && *ptr != value)
+      {
+         *ptr = value;
+         mem.sram_hook(ptr, 1);
+         return;
+      }
+      *ptr = value;
       return;
    }
 
    MESSAGE_DEBUG("Write to unmapped region: $%2X to $%4X\n", address, value);
 }
 
+/* Report writes that change battery-backed RAM to hook (so it can be saved) */
+void mem_setsramhook(uint8 *sram, size_t size, void (*hook)(void *ptr, size_t length))
+{
+   mem.sram = hook ? sram : NULL;
+   mem.sram_size = hook ? size : 0;
+   mem.sram_hook = hook;
+}
+
 uint32 mem_getword(uint32 address)
 {
    return mem_getbyte(address + 1) << 8 | mem_getbyte(address);
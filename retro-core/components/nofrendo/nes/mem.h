@@ -68,6 +68,11 @@ typedef struct
 
    /* Dummy memory to trap access to unmapped regions */
    uint8 *dummy; // [MEM_PAGESIZE]
+
+   /* Battery-backed RAM, the hook is told about every byte that changes */
+   uint8 *sram;
+   size_t sram_size;
+   void (*sram_hook)(void *ptr, size_t length);
 } mem_t;
 
 mem_t *mem_init_(void);
@@ -78,3 +83,4 @@ uint8 *mem_getpage(uint32 page);
 uint8 mem_getbyte(uint32 address);
 uint32 mem_getword(uint32 address);
 void mem_putbyte(uint32 address, uint8 value);
+void mem_setsramhook(uint8 *sram, size_t size, void (*hook)(void *ptr, size_t length));
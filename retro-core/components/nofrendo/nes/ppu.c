@@ -161,6 +161,8 @@ uint8 ppu_read(uint32 address)
       {
          if (nes6502_getcycles() >= ppu.strike_cycle)
             value |= PPU_STATF_STRIKE;
+         else
+            nes6502_idle_reset(); /* sprite 0 hit is still to come */
       }
 
       /* clear both vblank flag and vram address flipflop */
@@ -23,5 +23,10 @@
 
 #pragma once
 
+#include <stdio.h>
+
+// The _file variants work on any stream (eg fmemopen) and leave it open
+int state_load_file(FILE *file);
+int state_save_file(FILE *file);
 int state_load(const char *fn);
 int state_save(const char *fn);
@@ -9,3 +9,8 @@
 #define ENABLE_IO_TRACING      0
 
 #define USE_MEM_MACROS         0
+
+// Dispatch opcodes with computed gotos instead of a switch (faster, but the CPU loop is bigger)
+#ifndef USE_THREADED_DISPATCH
+#define USE_THREADED_DISPATCH  0
+#endif
@@ -5,8 +5,6 @@
 #include "pce.h"
 #include "gfx.h"
 
-#define PAL(nibble) (PAL[(L >> ((nibble) * 4)) & 15])
-
 #define V_FLIP  0x8000
 #define H_FLIP  0x0800
 
@@ -22,6 +20,93 @@ static struct {
 
 static uint8_t *framebuffer_top, *framebuffer_bottom;
 
+// Decoded patterns: one uint32_t per 8 pixels, pixel N in nibble N (0 = transparent)
+static uint32_t *tile_cache;   // [0x800 tiles][8 rows]
+static uint32_t *sprite_cache; // [0x200 patterns][16 rows][2 halves]
+static uint32_t pattern_scratch[16 * 2];
+static uint32_t planar_lut[256];
+
+uint8_t gfx_tile_dirty[0x800];
+uint8_t gfx_sprite_dirty[0x200];
+
+// Bitmask of the sprites covering each line, per priority. Rebuilt when SPRAM changes.
+static uint64_t sprite_lines[2][XBUF_HEIGHT];
+static bool sprite_lines_dirty;
+
+
+/*
+	Expand one bitplane byte (MSB = leftmost pixel) to one bit per nibble
+*/
+static inline uint32_t
+planar_row(uint8_t p0, uint8_t p1, uint8_t p2, uint8_t p3)
+{
+	return planar_lut[p0] | (planar_lut[p1] << 1) | (planar_lut[p2] << 2) | (planar_lut[p3] << 3);
+}
+
+
+/*
+	Return the decoded rows of background tile `no`, decoding it if VRAM changed
+*/
+static inline const uint32_t *
+get_tile(int no)
+{
+	uint32_t *T = tile_cache ? tile_cache + no * 8 : pattern_scratch;
+
+	if (gfx_tile_dirty[no] || !tile_cache) {
+		const uint16_t *C = PCE.VRAM + no * 16;
+		for (int i = 0; i < 8; i++) {
+			T[i] = planar_row(C[i], C[i] >> 8, C[i + 8], C[i + 8] >> 8);
+		}
+		gfx_tile_dirty[no] = 0;
+	}
+
+	return T;
+}
+
+
+/*
+	Return the decoded rows of sprite pattern `no`, decoding it if VRAM changed
+*/
+static inline const uint32_t *
+get_sprite(int no)
+{
+	uint32_t *T = sprite_cache ? sprite_cache + no * 32 : pattern_scratch;
+
+	if (gfx_sprite_dirty[no] || !sprite_cache) {
+		const uint16_t *C = PCE.VRAM + no * 64;
+		for (int i = 0; i < 16; i++) {
+			T[i * 2 + 0] = planar_row(C[i] >> 8, C[i + 16] >> 8, C[i + 32] >> 8, C[i + 48] >> 8);
+			T[i * 2 + 1] = planar_row(C[i], C[i + 16], C[i + 32], C[i + 48]);
+		}
+		gfx_sprite_dirty[no] = 0;
+	}
+
+	return T;
+}
+
+
+/*
+	Draw 8 decoded pixels, color 0 is transparent
+*/
+static inline void
+draw_pixels(uint8_t *P, uint32_t L, const uint8_t *PAL)
+{
+	for (; L; L >>= 4, P++) {
+		if (L & 15)
+			*P = PAL[L & 15];
+	}
+}
+
+static inline void
+draw_pixels_flipped(uint8_t *P, uint32_t L, const uint8_t *PAL)
+{
+	for (P += 7; L; L >>= 4, P--) {
+		if (L & 15)
+			*P = PAL[L & 15];
+	}
+}
+
+
 /*
 	Draw background tiles between two lines
 */
@@ -54,16 +139,12 @@ draw_tiles(uint8_t *screen_buffer, int Y1, int Y2, int scroll_x, int scroll_y)
 
 			int no = PCE.VRAM[x + y * bg_w];
 
-			uint8_t *PAL = &PCE.Palette[(no >> 8) & 0x1F0];
-			uint8_t *C = (uint8_t*)(PCE.VRAM + (no & 0x7FF) * 16 + offset);
+			const uint8_t *PAL = &PCE.Palette[(no >> 8) & 0x1F0];
+			const uint32_t *C = get_tile(no & 0x7FF) + offset;
 			uint8_t *P = PP;
 
-			for (int i = 0; i < h; i++, P += XBUF_WIDTH, C += 2) {
-				uint32_t J, L, M;
-
-				J = C[0] | C[1] | C[16] | C[17];
-
-				if (!J)
+			for (int i = 0; i < h; i++, P += XBUF_WIDTH) {
+				if (!C[i])
 					continue;
 
 				if (P + 8 >= framebuffer_bottom) {
@@ -74,23 +155,7 @@ draw_tiles(uint8_t *screen_buffer, int Y1, int Y2, int scroll_x, int scroll_y)
 					continue;
 				}
 
-				M = C[0];
-				L = ((M & 0x88) >> 3) | ((M & 0x44) << 6) | ((M & 0x22) << 15) | ((M & 0x11) << 24);
-				M = C[1];
-				L |= ((M & 0x88) >> 2) | ((M & 0x44) << 7) | ((M & 0x22) << 16) | ((M & 0x11) << 25);
-				M = C[16];
-				L |= ((M & 0x88) >> 1) | ((M & 0x44) << 8) | ((M & 0x22) << 17) | ((M & 0x11) << 26);
-				M = C[17];
-				L |= ((M & 0x88) >> 0) | ((M & 0x44) << 9) | ((M & 0x22) << 18) | ((M & 0x11) << 27);
-
-				if (J & 0x80) P[0] = PAL(1);
-				if (J & 0x40) P[1] = PAL(3);
-				if (J & 0x20) P[2] = PAL(5);
-				if (J & 0x10) P[3] = PAL(7);
-				if (J & 0x08) P[4] = PAL(0);
-				if (J & 0x04) P[5] = PAL(2);
-				if (J & 0x02) P[6] = PAL(4);
-				if (J & 0x01) P[7] = PAL(6);
+				draw_pixels(P, C[i], PAL);
 			}
 		}
 		line += h;
@@ -105,24 +170,20 @@ draw_tiles(uint8_t *screen_buffer, int Y1, int Y2, int scroll_x, int scroll_y)
 	Draw sprite C to framebuffer P
 */
 static void
-draw_sprite(uint8_t *P, const uint16_t *C, int height, uint32_t attr)
+draw_sprite(uint8_t *P, const uint32_t *C, int height, uint32_t attr)
 {
-	uint8_t *PAL = &PCE.Palette[256 + ((attr & 0xF) << 4)];
+	const uint8_t *PAL = &PCE.Palette[256 + ((attr & 0xF) << 4)];
 
-	bool hflip = attr & H_FLIP;
-	int inc = 1; //(attr & V_FLIP) ? -1 : 1;
+	int inc = 2; //(attr & V_FLIP) ? -2 : 2;
 
 	if (attr & V_FLIP) {
-		inc = -1;
-		C = C + height - 1;
+		inc = -2;
+		C = C + (height - 1) * 2;
 	}
 
 	for (int i = 0; i < height; i++, C += inc, P += XBUF_WIDTH) {
 
-		uint32_t J = C[0] | C[16] | C[32] | C[48];
-		uint32_t L1, L2, L, M;
-
-		if (!J)
+		if (!(C[0] | C[1]))
 			continue;
 
 		// This will also need to be handled in draw_sprites... (it could adjust simply constrain the height)
@@ -134,64 +195,41 @@ draw_sprite(uint8_t *P, const uint16_t *C, int height, uint32_t attr)
 			continue;
 		}
 
-		M = C[0];
-		L1 = ((M & 0x88) >> 3) | ((M & 0x44) << 6) | ((M & 0x22) << 15) | ((M & 0x11) << 24);
-		L2 = ((M & 0x8800) >> 11) | ((M & 0x4400) >> 2) | ((M & 0x2200) << 7) | ((M & 0x1100) << 16);
-		M = C[16];
-		L1 |= ((M & 0x88) >> 2) | ((M & 0x44) << 7) | ((M & 0x22) << 16) | ((M & 0x11) << 25);
-		L2 |= ((M & 0x8800) >> 10) | ((M & 0x4400) >> 1) | ((M & 0x2200) << 8) | ((M & 0x1100) << 17);
-		M = C[32];
-		L1 |= ((M & 0x88) >> 1) | ((M & 0x44) << 8) | ((M & 0x22) << 17) | ((M & 0x11) << 26);
-		L2 |= ((M & 0x8800) >> 9) | ((M & 0x4400) >> 0) | ((M & 0x2200) << 9) | ((M & 0x1100) << 18);
-		M = C[48];
-		L1 |= ((M & 0x88) >> 0) | ((M & 0x44) << 9) | ((M & 0x22) << 18) | ((M & 0x11) << 27);
-		L2 |= ((M & 0x8800) >> 8) | ((M & 0x4400) << 1) | ((M & 0x2200) << 10) | ((M & 0x1100) << 19);
-
-		if (hflip) {
-			L = L2;
-			if ((J & 0x8000)) P[15] = PAL(1);
-			if ((J & 0x4000)) P[14] = PAL(3);
-			if ((J & 0x2000)) P[13] = PAL(5);
-			if ((J & 0x1000)) P[12] = PAL(7);
-			if ((J & 0x0800)) P[11] = PAL(0);
-			if ((J & 0x0400)) P[10] = PAL(2);
-			if ((J & 0x0200)) P[9]  = PAL(4);
-			if ((J & 0x0100)) P[8]  = PAL(6);
-
-			L = L1;
-			if ((J & 0x80)) P[7] = PAL(1);
-			if ((J & 0x40)) P[6] = PAL(3);
-			if ((J & 0x20)) P[5] = PAL(5);
-			if ((J & 0x10)) P[4] = PAL(7);
-			if ((J & 0x08)) P[3] = PAL(0);
-			if ((J & 0x04)) P[2] = PAL(2);
-			if ((J & 0x02)) P[1] = PAL(4);
-			if ((J & 0x01)) P[0] = PAL(6);
+		if (attr & H_FLIP) {
+			draw_pixels_flipped(P + 8, C[0], PAL);
+			draw_pixels_flipped(P, C[1], PAL);
 		} else {
-			L = L2;
-			if ((J & 0x8000)) P[0] = PAL(1);
-			if ((J & 0x4000)) P[1] = PAL(3);
-			if ((J & 0x2000)) P[2] = PAL(5);
-			if ((J & 0x1000)) P[3] = PAL(7);
-			if ((J & 0x0800)) P[4] = PAL(0);
-			if ((J & 0x0400)) P[5] = PAL(2);
-			if ((J & 0x0200)) P[6] = PAL(4);
-			if ((J & 0x0100)) P[7] = PAL(6);
-
-			L = L1;
-			if ((J & 0x80)) P[8]  = PAL(1);
-			if ((J & 0x40)) P[9]  = PAL(3);
-			if ((J & 0x20)) P[10] = PAL(5);
-			if ((J & 0x10)) P[11] = PAL(7);
-			if ((J & 0x08)) P[12] = PAL(0);
-			if ((J & 0x04)) P[13] = PAL(2);
-			if ((J & 0x02)) P[14] = PAL(4);
-			if ((J & 0x01)) P[15] = PAL(6);
+			draw_pixels(P, C[0], PAL);
+			draw_pixels(P + 8, C[1], PAL);
 		}
 	}
 }
 
 
+/*
+	Bucket the SAT by scanline so that each band only visits the sprites it contains
+*/
+static void
+build_sprite_lines(void)
+{
+	memset(sprite_lines, 0, sizeof(sprite_lines));
+
+	for (int n = 0; n < 64; n++) {
+		const sprite_t *spr = &PCE.SPRAM[n];
+		int cgy = (spr->attr >> 12) & 3;
+		int y = (spr->y & 0x3FF) - 64;
+		int y_end = y + ((cgy | cgy >> 1) + 1) * 16;
+		int priority = (spr->attr >> 7) & 1;
+
+		for (y = MAX(y, 0); y < MIN(y_end, XBUF_HEIGHT); y++) {
+			sprite_lines[priority][y] |= 1ULL << n;
+		}
+	}
+
+	sprite_lines_dirty = false;
+}
+
+
 /*
 	Draw sprites between two lines
 */
@@ -204,17 +242,25 @@ draw_sprites(uint8_t *screen_buffer, int Y1, int Y2, int priority)
 	// Example: Assume that sprite #2 is priority=0 and sprite #5 is priority=1. If they
 	// overlap then sprite #5 shouldn't be drawn because #2 > #5. But currently it will.
 
+	if (sprite_lines_dirty) {
+		build_sprite_lines();
+	}
+
+	uint64_t sprites = 0;
+	for (int line = MAX(Y1, 0); line <= MIN(Y2, XBUF_HEIGHT - 1); line++) {
+		sprites |= sprite_lines[priority][line];
+	}
+
 	// We iterate sprites in reverse order because earlier sprites have
 	// higher priority and therefore must overwrite later sprites.
 
-	for (int n = 63; n >= 0; n--) {
+	while (sprites) {
+		int n = 63 - __builtin_clzll(sprites);
+		sprites &= ~(1ULL << n);
+
 		const sprite_t *spr = &PCE.SPRAM[n];
 		uint32_t attr = spr->attr;
 
-		if (((attr >> 7) & 1) != priority) {
-			continue;
-		}
-
 		int y = (spr->y & 0x3FF) - 64;
 		int x = (spr->x & 0x3FF) - 32;
 		int cgx = (attr >> 8) & 1;
@@ -236,17 +282,17 @@ draw_sprites(uint8_t *screen_buffer, int Y1, int Y2, int priority)
 		cgy *= 16;
 
 		uint8_t *P = screen_buffer + ((attr & V_FLIP ? cgy + y : y) * XBUF_WIDTH) + x;
-		uint16_t *C = PCE.VRAM + (no * 64);
 
-		for (int yy = 0; yy <= cgy; yy += 16) {
+		for (int yy = 0; yy <= cgy; yy += 16, no += 2) {
 			int height = 16;
+			int row = 0;
 			if (attr & V_FLIP) {
 				height = MIN(16, Y2 - y - (cgy - yy));
 			} else {
 				int t = Y1 - y - yy;
 				if (t > 0) {
 					P += t * XBUF_WIDTH;
-					C += t;
+					row = t;
 					height -= t;
 				}
 				height = MIN(height, Y2 - y - yy);
@@ -254,14 +300,14 @@ draw_sprites(uint8_t *screen_buffer, int Y1, int Y2, int priority)
 
 			if (height > 0) {
 				for (int j = 0; j <= cgx; j++) {
-					draw_sprite(P + (attr & H_FLIP ? cgx - j : j) * 16, C + j * 64, height, attr);
+					const uint32_t *C = get_sprite((no + j) & 0x1FF) + row * 2;
+					draw_sprite(P + (attr & H_FLIP ? cgx - j : j) * 16, C, height, attr);
 				}
 			} else {
 				MESSAGE_DEBUG("negative sprite height!\n");
 			}
 
 			P += ((attr & V_FLIP) ? -height : height) * XBUF_WIDTH;
-			C += height + 16 * 7;
 		}
 	}
 }
@@ -348,6 +394,22 @@ render_lines(int min_line, int max_line)
 int
 gfx_init(void)
 {
+	for (int i = 0; i < 256; i++) {
+		uint32_t L = 0;
+		for (int x = 0; x < 8; x++) {
+			L |= ((i >> (7 - x)) & 1) << (x * 4);
+		}
+		planar_lut[i] = L;
+	}
+
+	// The caches are an optimization only, we can still decode patterns on the fly without them
+	if (!tile_cache)
+		tile_cache = malloc(0x800 * 8 * sizeof(uint32_t));
+	if (!sprite_cache)
+		sprite_cache = malloc(0x200 * 32 * sizeof(uint32_t));
+	if (!tile_cache || !sprite_cache)
+		MESSAGE_WARN("Failed to allocate pattern caches, rendering will be slower\n");
+
 	gfx_reset(true);
 	return 0;
 }
@@ -358,13 +420,20 @@ gfx_reset(bool hard)
 {
 	last_line_counter = 0;
 	line_counter = 0;
+
+	memset(gfx_tile_dirty, 1, sizeof(gfx_tile_dirty));
+	memset(gfx_sprite_dirty, 1, sizeof(gfx_sprite_dirty));
+	sprite_lines_dirty = true;
 }
 
 
 void
 gfx_term(void)
 {
-	//
+	free(tile_cache);
+	tile_cache = NULL;
+	free(sprite_cache);
+	sprite_cache = NULL;
 }
 
 
@@ -455,6 +524,7 @@ gfx_run(void)
 		/* VRAM to SATB DMA */
 		if (PCE.VDC.satb == DMA_TRANSFER_PENDING || AutoSATBON) {
 			memcpy(PCE.SPRAM, PCE.VRAM + IO_VDC_REG[SATB].W, 512);
+			sprite_lines_dirty = true;
 			PCE.VDC.satb = DMA_TRANSFER_COUNTER + 4;
 		}
 	}
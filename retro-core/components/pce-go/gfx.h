@@ -1,6 +1,18 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
+
+// Decoded pattern caches are invalidated by VRAM writes (one flag per 8x8 tile / 16x16 sprite)
+extern uint8_t gfx_tile_dirty[0x800];
+extern uint8_t gfx_sprite_dirty[0x200];
+
+static inline void
+gfx_vram_changed(uint16_t addr)
+{
+	gfx_tile_dirty[(addr >> 4) & 0x7FF] = 1;
+	gfx_sprite_dirty[(addr >> 6) & 0x1FF] = 1;
+}
 
 int gfx_init(void);
 void gfx_run(void);
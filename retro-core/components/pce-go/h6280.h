@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <rg_idle.h>
 
 void h6280_reset(void);
 void h6280_run(int cycles);
@@ -26,6 +27,9 @@ typedef struct
 	/* Misc */
 	uint32_t cycles;
 	uint32_t halted;
+
+	/* Idle loop detection */
+	rg_idle_t idle;
 } h6280_t;
 
 // CPU Flags:
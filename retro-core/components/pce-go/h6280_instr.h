@@ -61,10 +61,10 @@ static const UBYTE bcd2bin[0x100] = {
 // Zero page access
 #define get_8bit_zp(zp_addr) ZP_BASE[(zp_addr) & 0xFF]
 #define get_16bit_zp(zp_addr) ({UBYTE x = zp_addr; get_8bit_zp(x) | get_8bit_zp(x + 1) << 8;})
-#define put_8bit_zp(zp_addr, byte) ZP_BASE[(zp_addr) & 0xFF] = (byte)
+#define put_8bit_zp(zp_addr, byte) (rg_idle_reset(&CPU.idle), ZP_BASE[(zp_addr) & 0xFF] = (byte))
 
 // Stack access
-#define push_8bit(byte) ({*(SP_BASE + CPU.S) = (byte); CPU.S--;})
+#define push_8bit(byte) ({rg_idle_reset(&CPU.idle); *(SP_BASE + CPU.S) = (byte); CPU.S--;})
 #define push_16bit(addr) ({UWORD x = addr; push_8bit(x >> 8); push_8bit(x & 0xFF);})
 //#define pull_8bit() (*(SP_BASE + ++CPU.S))
 #define pull_8bit(x) ({ ++CPU.S; x = *(SP_BASE + CPU.S);})
@@ -326,7 +326,7 @@ RunPCE(void)
 
 	while (running)
 	{
-		osd_input_read(PCE.Joypad.regs);
+		PCE.Joypad.latched = 0;
 		pce_run();
 		osd_vsync();
 	}
@@ -385,6 +385,7 @@ LoadState(const char *name)
 		pce_bank_set(i, PCE.MMR[i]);
 
 	gfx_reset(true);
+	rg_idle_reset(&CPU.idle);
 	PCE.VDC.mode_chg = 1;
 	ret = 0;
 
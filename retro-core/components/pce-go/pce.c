@@ -136,6 +136,7 @@ pce_run(void)
 		/*while (PCE.MaxCycles > 0) */ {
 			h6280_run(PCE.MaxCycles);
 			timer_run(PCE.Cycles);
+			CPU.idle.cycles += PCE.Cycles;
 			PCE.MaxCycles -= PCE.Cycles;
 			PCE.Cycles = 0;
 		}
@@ -262,6 +263,8 @@ pce_readIO(uint16_t A)
 		break;
 
 	case 0x0C00:                /* Timer */
+		// The value depends on the exact cycle, a loop polling it can't be fast-forwarded
+		rg_idle_reset(&CPU.idle);
 		ret = (PCE.io_buffer & 0x80);
 		if (PCE.Timer.cycles_counter == PCE.Cycles)
 			ret |= (PCE.Timer.counter - 1) & 0x7F;
@@ -317,6 +320,9 @@ pce_writeIO(uint16_t A, uint8_t V)
 {
 	TRACE_IO("IO Write %02x at %04x\n", V, A);
 
+	// ST0/ST1/ST2 write here directly
+	rg_idle_reset(&CPU.idle);
+
 	// The last write value in 0800-017FF is saved in the io buffer
 	if (A >= 0x800 && A < 0x1800)
 		PCE.io_buffer = V;
@@ -423,6 +429,7 @@ pce_writeIO(uint16_t A, uint8_t V)
 				// I am not 100% sure if MAWR should wrap instead, eg IO_VDC_REG[MAWR].W & 0x7FFF
 				if (IO_VDC_REG[MAWR].W < 0x8000) {
 					PCE.VRAM[IO_VDC_REG[MAWR].W] = (V << 8) | IO_VDC_REG_ACTIVE.B.l;
+					gfx_vram_changed(IO_VDC_REG[MAWR].W);
 				}
 				IO_VDC_REG_INC(MAWR);
 				break;
@@ -502,6 +509,7 @@ pce_writeIO(uint16_t A, uint8_t V)
 				while (IO_VDC_REG[LENR].W != 0xFFFF) {
 					if (IO_VDC_REG[DISTR].W < 0x8000) {
 						PCE.VRAM[IO_VDC_REG[DISTR].W] = PCE.VRAM[IO_VDC_REG[SOUR].W];
+						gfx_vram_changed(IO_VDC_REG[DISTR].W);
 					}
 					IO_VDC_REG[SOUR].W += src_inc;
 					IO_VDC_REG[DISTR].W += dst_inc;
@@ -652,8 +660,14 @@ pce_writeIO(uint16_t A, uint8_t V)
 
 	case 0x1000:                /* Joypad */
 		PCE.Joypad.nibble = V & 1;
-		if (V & 2)
+		if (V & 2) {
 			PCE.Joypad.counter = 0;
+			/* Let the host update the pads right when the game starts reading them */
+			if (!PCE.Joypad.latched) {
+				PCE.Joypad.latched = 1;
+				osd_input_read(PCE.Joypad.regs);
+			}
+		}
 		return;
 
 	case 0x1400:                /* IRQ */
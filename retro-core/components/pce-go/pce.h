@@ -190,6 +190,7 @@ typedef struct {
 		uint8_t regs[8];		/* value of pressed button/direct for each pad */
 		uint8_t nibble;			/* used to know what nibble we must return */
 		uint8_t counter;		/* current addressed joypad */
+		uint8_t latched;		/* osd_input_read() was called this frame */
 	} Joypad;
 
 	// Video Color Encoder
@@ -287,6 +288,7 @@ uint8_t pce_readIO(uint16_t A);
 #define pce_write8(addr, byte) {					\
 	uint16_t a = (addr), b = (byte); 				\
 	uint8_t *page = PageW[a >> 13]; 				\
+	rg_idle_reset(&CPU.idle);						\
 	if (page == PCE.IOAREA) pce_writeIO(a, b); 		\
 	else page[a] = b;								\
 }
@@ -298,6 +300,7 @@ uint8_t pce_readIO(uint16_t A);
 
 #define pce_write16(addr, word) {					\
 	uint16_t a = (addr), w = (word); 				\
+	rg_idle_reset(&CPU.idle);						\
 	*((uint16_t*)(PageW[a >> 13] + a)) = w;			\
 }
 
@@ -319,6 +322,8 @@ pce_write8(uint16_t addr, uint8_t byte)
 {
 	uint8_t *page = PageW[addr >> 13];
 
+	rg_idle_reset(&CPU.idle);
+
 	if (page == PCE.IOAREA)
 		pce_writeIO(addr, byte);
 	else
@@ -334,6 +339,7 @@ pce_read16(uint16_t addr)
 static inline void
 pce_write16(uint16_t addr, uint16_t word)
 {
+	rg_idle_reset(&CPU.idle);
 	*((uint16_t*)(PageW[addr >> 13] + (addr))) = word;
 }
 
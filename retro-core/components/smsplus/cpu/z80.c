@@ -139,6 +139,9 @@ unsigned char *cpu_readmap[64];
 unsigned char *cpu_writemap[64];
 
 int z80_cycle_count = 0;        /* running total of cycles executed */
+rg_idle_t z80_idle;             /* idle loop detection */
+static UINT8 idle_r;            /* R and cycle counter at the last idle check */
+static UINT32 idle_now;
 
 #define CF  0x01
 #define NF  0x02
@@ -363,7 +366,7 @@ static const UINT8 cc[6][0x100] = {
 /***************************************************************
  * Output a byte to given I/O port
  ***************************************************************/
-#define OUT(port,value) Z80.port_write(port, value)
+#define OUT(port,value) (rg_idle_reset(&z80_idle), Z80.port_write(port, value))
 
 /***************************************************************
  * Read a byte from given memory location
@@ -382,7 +385,7 @@ static const UINT8 cc[6][0x100] = {
 /***************************************************************
  * Write a byte to given memory location
  ***************************************************************/
-#define WM(addr,value) Z80.mem_write(addr, value)
+#define WM(addr,value) (rg_idle_reset(&z80_idle), Z80.mem_write(addr, value))
 
 /***************************************************************
  * Write a word to given memory location
@@ -2144,6 +2147,7 @@ void z80_reset(void)
   HALT = 0;
   WZ = PCD;
   Z80.after_ei = false;
+  rg_idle_reset(&z80_idle);
 }
 
 void z80_exit(void)
@@ -2188,12 +2192,32 @@ IRAM_ATTR int z80_execute(int cycles)
 
     if (z80_ICount > 0)
     {
+      UINT16 pc = PCD;
       R++;
       EXEC_OP(ROP());
+
+      /* a backward jump (or HALT) might be a loop waiting for the next line or interrupt */
+      if (PCD <= pc)
+      {
+        UINT64 state = AF | BC << 16 | (UINT64)DE << 32 | (UINT64)HL << 48;
+        state ^= (IX | IY << 16 | (UINT64)SP << 32 | (UINT64)IFF1 << 48) * 0x9E3779B97F4A7C15ull;
+        UINT32 now = z80_idle.cycles + (cycles - z80_ICount);
+        int skip = rg_idle_branch(&z80_idle, pc, PCD, state, now, z80_ICount);
+        if (skip > 0)
+        {
+          /* the previous check was the same loop head: advance R by the opcodes fetched per iteration */
+          z80_ICount -= skip;
+          R += (UINT8)(R - idle_r) * (skip / (int)(now - idle_now));
+          now += skip;
+        }
+        idle_r = R;
+        idle_now = now;
+      }
     }
   }
 
   z80_exec = 0;
+  z80_idle.cycles += (cycles - z80_ICount);
   z80_cycle_count += (cycles - z80_ICount);
 
   return cycles - z80_ICount;
@@ -2,6 +2,7 @@
 #define Z80_H_
 
 #include "cpuintrf.h"
+#include <rg_idle.h>
 
 
 enum
@@ -60,6 +61,7 @@ typedef struct
 
 
 extern int z80_cycle_count;
+extern rg_idle_t z80_idle;
 extern Z80_Regs Z80;
 
 extern unsigned char *cpu_readmap[64];
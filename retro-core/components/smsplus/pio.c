@@ -154,10 +154,22 @@ void pio_ctrl_w(uint8 data)
 static uint8 paddle_toggle[2] = {0,0};
 static uint8 lightgun_latch =0;
 
+/* Give the host a chance to update the controllers right before the game reads them */
+static inline void input_latch(void)
+{
+  if(input.latch && !input.latched)
+  {
+    input.latched = 1;
+    input.latch();
+  }
+}
+
 static uint8 device_r(int port)
 {
   uint8 temp = 0x7F;
 
+  input_latch();
+
   switch(sms.device[port])
   {
     case DEVICE_NONE:
@@ -225,6 +237,7 @@ static uint8 device_r(int port)
       if (io_current->th_dir[port] == PIN_DIR_IN)
       {
         int hc = hc_256[z80_get_elapsed_cycles() % CYCLES_PER_LINE];
+        rg_idle_reset(&z80_idle);
         int dx = input.analog[port][0] - (hc*2);
         int dy = input.analog[port][1] - vdp.line;
 
@@ -377,6 +390,7 @@ uint8 sio_r(int offset)
   switch(offset & 0xFF)
   {
     case 0: /* Input port #2 */
+      input_latch();
       temp = 0xE0;
       if(input.system & INPUT_START)          temp &= ~0x80;
       if(sms.territory == TERRITORY_DOMESTIC) temp &= ~0x40;
@@ -468,6 +482,8 @@ uint8 coleco_pio_r(int port)
 {
   uint8 temp = 0x7f;
 
+  input_latch();
+
   if (coleco.pio_mode)
   {
     /* Joystick  */
@@ -24,6 +24,7 @@
 
 #include "shared.h"
 #include "hvc.h"
+#include <stdint.h>
 
 struct
 {
@@ -34,8 +35,8 @@ struct
 } object_info[64];
 
 /* Background drawing function */
-void (*render_bg)(int line) = NULL;
-void (*render_obj)(int line) = NULL;
+render_func_t render_bg = NULL;
+render_func_t render_obj = NULL;
 
 /* Pointer to output buffer */
 uint8 *linebuf;
@@ -58,6 +59,10 @@ const uint8 *vc_table[3];
 
 static uint8 object_index_count;
 
+/* Sprites found on each line counter value, rebuilt when the SAT changes */
+static uint64_t sat_lines[256];
+int sat_dirty = 1;
+
 /* CRAM palette in TMS compatibility mode */
 static const uint8 tms_crom[] =
 {
@@ -166,7 +171,7 @@ static inline uint32 read_dword(void *address)
 #endif
   }
   else
-    return *(uint32 *)address;
+    return *(uint32_t *)address;
 }
 
 static inline void write_dword(void *address, uint32 data)
@@ -187,11 +192,11 @@ static inline void write_dword(void *address, uint32 data)
     return;
   }
   else
-    *(uint32 *)address = data;
+    *(uint32_t *)address = data;
 }
 #else
-#define read_dword(address) *(uint32 *)address
-#define write_dword(address,data) *(uint32 *)address=data
+#define read_dword(address) *(uint32_t *)address
+#define write_dword(address,data) *(uint32_t *)address=data
 #endif
 
 
@@ -329,16 +334,7 @@ void render_reset(void)
   }
 
   /* Pick default render routine */
-  if (vdp.reg[0] & 4)
-  {
-    render_bg = render_bg_sms;
-    render_obj = render_obj_sms;
-  }
-  else
-  {
-    render_bg = render_bg_tms;
-    render_obj = render_obj_tms;
-  }
+  render_mode();
 
   if (sms.display == 0) // NTSC
   {
@@ -365,11 +361,32 @@ void render_reset(void)
 static int prev_line = -1;
 static int skip_render = 0;
 
-void render_mode(int skip)
+void render_skip(int skip)
 {
     skip_render = skip;
 }
 
+/* Select the line renderers matching the current VDP mode and console */
+void render_mode(void)
+{
+  if (vdp.mode & 8)
+  {
+    if ((sms.console == CONSOLE_GG) && !option.extra_gg)
+      render_bg = render_bg_gg;
+    else
+      render_bg = render_bg_sms;
+    render_obj = render_obj_sms;
+  }
+  else
+  {
+    render_bg = render_bg_tms_select(vdp.mode);
+    render_obj = render_obj_tms;
+  }
+
+  /* Sprite height or end marker handling may have changed */
+  sat_dirty = 1;
+}
+
 /* Draw a line of the display */
 void render_line(int line)
 {
@@ -491,43 +508,61 @@ void render_line(int line)
   }
 }
 
-static uint8 data[8];
+static uint32_t data[2];
+
+/* Spread 4 packed 4-bit pixels into one byte each */
+static inline uint32_t nibbles_to_bytes(uint32_t x)
+{
+  x = (x | (x << 8)) & 0x00FF00FF;
+  x = (x | (x << 4)) & 0x0F0F0F0F;
+#ifdef IS_BIG_ENDIAN
+  x = __builtin_bswap32(x);
+#endif
+  return x;
+}
 
-__attribute__((optimize("unroll-loops")))
 static inline void* tile_get(int attr, int line)
 {
     // ---p cvhn nnnn nnnn
     const uint16 name = attr & 0x1ff;
     const uint16 y = (attr & 0x400) ? (line ^ 7) : line;
     const uint16* ptr = (uint16*)&vdp.vram[(name << 5) | (y << 2) | (0)];
-    const uint32 temp = (bp_lut[*ptr] >> 2) | (bp_lut[*(ptr+1)]);
+    const uint32_t temp = (bp_lut[*ptr] >> 2) | (bp_lut[*(ptr+1)]);
 
-    for (size_t x = 0; x < 8; x++)
-        data[(attr & 0x200) ? (x ^ 7) : x] = (temp >> (x << 2)) & 0x0F;
+    if (attr & 0x200)
+    {
+      data[0] = __builtin_bswap32(nibbles_to_bytes(temp >> 16));
+      data[1] = __builtin_bswap32(nibbles_to_bytes(temp & 0xFFFF));
+    }
+    else
+    {
+      data[0] = nibbles_to_bytes(temp & 0xFFFF);
+      data[1] = nibbles_to_bytes(temp >> 16);
+    }
 
     return data;
 }
 
-/* Draw the Master System background */
-void render_bg_sms(int line)
+/* Draw the Master System background (columns first to last-1) */
+static inline void render_bg_m4(int line, int first, int last, int gg)
 {
   int locked = 0;
   int yscroll_mask = (vdp.extended) ? 256 : 224;
   int v_line = (line + vdp.vscroll) % yscroll_mask;
   int v_row  = (v_line & 7) << 3;
-  int hscroll = ((vdp.reg[0] & 0x40) && (line < 0x10) && (sms.console != CONSOLE_GG)) ? 0 : (0x100 - vdp.reg[8]);
-  int column = 0;
+  int hscroll = ((vdp.reg[0] & 0x40) && (line < 0x10) && !gg) ? 0 : (0x100 - vdp.reg[8]);
+  int column = first;
   uint16 attr;
   uint16 nt_addr = (vdp.ntab + ((v_line >> 3) << 6)) & (((sms.console == CONSOLE_SMS) && !(vdp.reg[2] & 1)) ? ~0x400 :0xFFFF);
   uint16 *nt = (uint16 *)&vdp.vram[nt_addr];
   int nt_scroll = (hscroll >> 3);
   int shift = (hscroll & 7);
-  uint32 atex_mask;
-  uint32 *cache_ptr;
-  uint32 *linebuf_ptr = (uint32 *)&linebuf[0 - shift];
+  uint32_t atex_mask;
+  uint32_t *cache_ptr;
+  uint32_t *linebuf_ptr = (uint32_t *)&linebuf[0 - shift];
 
   /* Draw first column (clipped) */
-  if(shift)
+  if(shift && first == 0)
   {
     int x;
 
@@ -538,7 +573,7 @@ void render_bg_sms(int line)
   }
 
   /* Draw a line of the background */
-  for(; column < 32; column++)
+  for(; column < last; column++)
   {
     /* Stop vertical scrolling for leftmost eight columns */
     if((vdp.reg[0] & 0x80) && (!locked) && (column >= 24))
@@ -568,7 +603,7 @@ void render_bg_sms(int line)
   }
 
   /* Draw last column (clipped) */
-  if(shift)
+  if(shift && last == 32)
   {
     int x, c, a;
 
@@ -591,6 +626,17 @@ void render_bg_sms(int line)
   }
 }
 
+void render_bg_sms(int line)
+{
+  render_bg_m4(line, 0, 32, sms.console == CONSOLE_GG);
+}
+
+/* The Game Gear LCD only shows pixels 48-207, skip the columns that can't be seen */
+void render_bg_gg(int line)
+{
+  render_bg_m4(line, 6, 27, 1);
+}
+
 
 /* Draw sprites */
 void render_obj_sms(int line)
@@ -776,19 +822,13 @@ void palette_sync(int index)
 }
 
 
-static inline void parse_satb(int line)
+static void build_sat_lines(void)
 {
   /* Pointer to sprite attribute table */
   uint8 *st = (uint8 *)&vdp.vram[vdp.satb];
 
-  /* Sprite counter (64 max.) */
-  int i = 0;
-
-  /* Line counter value */
-  int vc = vc_table[vdp.extended][line];
-
   /* Sprite height (8x8 by default) */
-  int yp;
+  int i, y, yp;
   int height = 8;
 
   /* Adjust height for 8x16 sprites */
@@ -799,8 +839,8 @@ static inline void parse_satb(int line)
   if(vdp.reg[1] & 0x01)
     height <<= 1;
 
-  /* Sprite count for current line (8 max.) */
-  object_index_count = 0;
+  memset(sat_lines, 0, sizeof(sat_lines));
+  sat_dirty = 0;
 
   for(i = 0; i < 64; i++)
   {
@@ -814,32 +854,69 @@ static inline void parse_satb(int line)
     /* Wrap Y coordinate for sprites > 240 */
     if(yp > 240) yp -= 256;
 
+    /* Mark every line counter value covered by the sprite */
+    for(y = (yp < 0) ? 0 : yp; y < yp + height && y < 256; y++)
+      sat_lines[y] |= (uint64_t)1 << i;
+  }
+}
+
+static inline void parse_satb(int line)
+{
+  /* Pointer to sprite attribute table */
+  uint8 *st = (uint8 *)&vdp.vram[vdp.satb];
+
+  /* Sprite index */
+  int i;
+
+  /* Line counter value */
+  int vc = vc_table[vdp.extended][line];
+
+  /* Sprite Y range */
+  int yp;
+
+  /* Rebuild the line buckets if the SAT changed */
+  if (sat_dirty)
+    build_sat_lines();
+
+  /* Sprites within vertical range, in SAT order */
+  uint64_t found = sat_lines[vc];
+
+  /* Sprite count for current line (8 max.) */
+  object_index_count = 0;
+
+  while (found)
+  {
+    i = __builtin_ctzll(found);
+    found &= found - 1;
+
+    /* Sprite Y position */
+    yp = st[i];
+
+    /* Wrap Y coordinate for sprites > 240 */
+    if(yp > 240) yp -= 256;
+
     /* Compare sprite position with current line counter */
     yp = vc - yp;
 
-    /* Sprite is within vertical range? */
-    if((yp >= 0) && (yp < height))
+    /* Sprite limit reached? */
+    if (object_index_count == 8)
     {
-      /* Sprite limit reached? */
-      if (object_index_count == 8)
-      {
-        /* Flag is set only during active area */
-        if (line < vdp.height)
-          vdp.spr_ovr = 1;
+      /* Flag is set only during active area */
+      if (line < vdp.height)
+        vdp.spr_ovr = 1;
 
-        /* End of sprite parsing */
-        if (option.spritelimit)
-          return;
-      }
+      /* End of sprite parsing */
+      if (option.spritelimit)
+        return;
+    }
 
-      /* Store sprite attributes for later processing */
-      object_info[object_index_count].yrange = yp;
-      object_info[object_index_count].xpos = st[0x80 + (i << 1)];
-      object_info[object_index_count].attr = st[0x81 + (i << 1)];
+    /* Store sprite attributes for later processing */
+    object_info[object_index_count].yrange = yp;
+    object_info[object_index_count].xpos = st[0x80 + (i << 1)];
+    object_info[object_index_count].attr = st[0x81 + (i << 1)];
 
-      /* Increment Sprite count for current line */
-      ++object_index_count;
-    }
+    /* Increment Sprite count for current line */
+    ++object_index_count;
   }
 }
 
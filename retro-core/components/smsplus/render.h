@@ -33,17 +33,25 @@
 /* Used for blanking a line in whole or in part */
 #define BACKDROP_COLOR      (0x10 | (vdp.reg[7] & 0x0F))
 
-extern void (*render_bg)(int line);
-extern void (*render_obj)(int line);
+/* Invalidate the sprite line buckets when the SAT Y table is written */
+#define RENDER_VRAM_WRITE(addr) do { if ((((addr) - vdp.satb) & 0x3FFF) < 64) sat_dirty = 1; } while (0)
+
+typedef void (*render_func_t)(int line);
+
+extern render_func_t render_bg;
+extern render_func_t render_obj;
 extern const uint8 *vc_table[3];
 extern uint8 *linebuf;
+extern int sat_dirty;
 
 extern void render_shutdown(void);
 extern void render_init(void);
 extern void render_reset(void);
-extern void render_mode(int skip);
+extern void render_mode(void);
+extern void render_skip(int skip);
 extern void render_line(int line);
 extern void render_bg_sms(int line);
+extern void render_bg_gg(int line);
 extern void render_obj_sms(int line);
 extern void palette_sync(int index);
 extern bool render_copy_palette(uint16* palette);
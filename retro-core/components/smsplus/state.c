@@ -253,6 +253,7 @@ void system_load_state(void *mem)
   fread(&Z80.irq_state, 1, 1, mem);
   fread(&Z80.after_ei, 1, 1, mem);
   fread(&padding, 9, 1, mem);
+  rg_idle_reset(&z80_idle);
 
 #if 0
   /*** Set YM2413 ***/
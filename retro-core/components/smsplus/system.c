@@ -31,7 +31,10 @@ void system_frame(int skip)
 {
   int iline, line_z80 = 0;
 
-  render_mode(skip);
+  render_skip(skip);
+
+  /* Let the host update the controllers again on the next read */
+  input.latched = 0;
 
   /* Debounce pause key */
   if(input.system & INPUT_PAUSE)
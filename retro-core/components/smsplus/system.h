@@ -58,6 +58,8 @@ typedef struct
   uint8 pad[2];
   int analog[2][2];
   uint8 system;
+  void (*latch)(void); /* Called on the first controller read of a frame, if set */
+  uint8 latched;
 } input_t;
 
 /* Game image structure */
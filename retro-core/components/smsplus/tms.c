@@ -399,41 +399,30 @@ void make_tms_tables(void)
 }
 
 
-void render_bg_tms(int line)
+render_func_t render_bg_tms_select(int mode)
 {
-    switch(vdp.mode & 7)
+    switch(mode & 7)
     {
         case 0: /* Graphics I */
-            render_bg_m0(line);
-            break;
+            return render_bg_m0;
 
         case 1: /* Text */
-            render_bg_m1(line);
-            break;
+            return render_bg_m1;
 
         case 2: /* Graphics II */
-            render_bg_m2(line);
-            break;
+            return render_bg_m2;
 
         case 3: /* Text (Extended PG) */
-            render_bg_m1x(line);
-            break;
+            return render_bg_m1x;
 
         case 4: /* Multicolor */
-            render_bg_m3(line);
-            break;
-
-        case 5: /* Invalid (1+3) */
-            render_bg_inv(line);
-            break;
+            return render_bg_m3;
 
         case 6: /* Multicolor (Extended PG) */
-            render_bg_m3x(line);
-            break;
+            return render_bg_m3x;
 
-        case 7: /* Invalid (1+2+3) */
-            render_bg_inv(line);
-            break;
+        default: /* Invalid (1+3), (1+2+3) */
+            return render_bg_inv;
     }
 }
 
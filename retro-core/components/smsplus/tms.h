@@ -28,7 +28,7 @@ extern int text_counter;
 
 /* Function prototypes */
 extern void make_tms_tables(void);
-extern void render_bg_tms(int line);
+extern render_func_t render_bg_tms_select(int mode);
 extern void render_obj_tms(int line);
 extern void parse_line(int line);
 
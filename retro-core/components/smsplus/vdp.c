@@ -111,16 +111,8 @@ static void viewport_check(void)
 
   vdp.pn = (vdp.reg[2] << 10) & 0x3C00;
 
-  if (vdp.mode & 8)
-  {
-    render_bg  = render_bg_sms;
-    render_obj = render_obj_sms;
-  }
-  else
-  {
-    render_bg  = render_bg_tms;
-    render_obj = render_obj_tms;
-  }
+  /* pick the line renderers for this mode */
+  render_mode();
 }
 
 /* Initialize VDP emulation */
@@ -259,6 +251,7 @@ void vdp_reg_w(uint8 r, uint8 d)
     case 0x5: /* Sprite Attribute Table Base Address */
       vdp.satb = (d << 7) & 0x3F00;
       vdp.sa = (d <<  7) & 0x3F80;
+      sat_dirty = 1;
       break;
 
     case 0x6:
@@ -315,6 +308,7 @@ void vdp_write(int offset, uint8 data)
       case 0: /* VRAM write */
       case 1: /* VRAM write */
       case 2: /* VRAM write */
+        RENDER_VRAM_WRITE(vdp.addr);
         vdp.vram[(vdp.addr & 0x3FFF)] = data;
         vdp.buffer = data;
         break;
@@ -337,6 +331,9 @@ uint8 vdp_read(int offset)
 {
   uint8 temp;
 
+  /* status flags depend on the exact cycle and the data port has side effects */
+  rg_idle_reset(&z80_idle);
+
   if (offset & 1) /* Status flags */
   {
     /* cycle-accurate SPR_OVR and INT flags */
@@ -426,6 +423,7 @@ void gg_vdp_write(int offset, uint8 data)
       case 0: /* VRAM write */
       case 1: /* VRAM write */
       case 2: /* VRAM write */
+        RENDER_VRAM_WRITE(vdp.addr);
         vdp.vram[(vdp.addr & 0x3FFF)] = data;
         vdp.buffer = data;
         break;
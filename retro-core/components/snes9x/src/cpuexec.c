@@ -104,6 +104,7 @@ void S9xDoHBlankProcessing()
          IPPU.HDMA = S9xDoHDMA(IPPU.HDMA);
       break;
    case HBLANK_END_EVENT:
+      CPUIdle.cycles += Settings.H_Max;
 #ifndef USE_BLARGG_APU
       CPU.Cycles -= Settings.H_Max;
       if (IAPU.APUExecuting)
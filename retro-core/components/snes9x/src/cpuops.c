@@ -2375,7 +2375,7 @@ static void Op0CM0(void)
 #ifndef SA1_OPCODES
 static INLINE void CPUShutdown(void)
 {
-   if (Settings.Shutdown && CPU.PC == CPU.WaitAddress)
+   if (Settings.Shutdown && CPUIdle.enabled && CPU.PC == CPU.WaitAddress)
    {
       /* Don't skip cycles with a pending NMI or IRQ - could cause delayed
        * interrupt. Interrupts are delayed for a few cycles already, but
@@ -2385,6 +2385,8 @@ static INLINE void CPUShutdown(void)
       {
          CPU.WaitAddress = NULL;
 #ifndef USE_BLARGG_APU
+         CPUIdle.skipped += CPU.NextEvent - CPU.Cycles;
+         CPUIdle.loops++;
          CPU.Cycles = CPU.NextEvent;
          if (IAPU.APUExecuting)
          {
@@ -2425,6 +2427,8 @@ static INLINE void ForceShutdown(void)
 #ifndef SA1_OPCODES
    CPU.WaitAddress = NULL;
 #ifndef USE_BLARGG_APU
+   CPUIdle.skipped += CPU.NextEvent - CPU.Cycles;
+   CPUIdle.loops++;
    CPU.Cycles = CPU.NextEvent;
    if (IAPU.APUExecuting)
    {
@@ -12,6 +12,7 @@
 
 SICPU ICPU;
 SCPUState CPU;
+rg_idle_t CPUIdle;
 
 #ifndef USE_BLARGG_APU
 SAPU APU;
@@ -8,6 +8,7 @@
 
 #include "port.h"
 #include "65c816.h"
+#include <rg_idle.h>
 
 #define ROM_NAME_LEN 22
 
@@ -222,6 +223,7 @@ typedef struct
 
 extern SSettings Settings;
 extern SCPUState CPU;
+extern rg_idle_t CPUIdle; /* Opt-out and statistics of the shutdown speed hack */
 extern char String [513];
 
 void S9xSetPause(uint32_t mask);
@@ -6,12 +6,10 @@
 static int skipFrames = 20; // The 20 is to hide startup flicker in some games
 static bool slowFrame = false;
 
-static int video_time;
-static int audio_time;
-
 static const char *sramFile;
+static rg_sram_t *sram;
+static uint32_t sramRTC[12];
 static int autoSaveSRAM = 0;
-static int autoSaveSRAM_Timer = 0;
 static bool useSystemTime = true;
 static bool loadBIOSFile = false;
 
@@ -25,6 +23,26 @@ static const char *SETTING_LOADBIOS = "LoadBIOS";
 // --- MAIN
 
 
+static void sram_write_cb(void *ptr, size_t length)
+{
+    rg_sram_mark_dirty(sram, ptr, length);
+}
+
+static void sram_flush_cb(rg_sram_t *sram, void *arg)
+{
+    // The RTC section is only refreshed along with the game's own data, it changes every second
+    if (gnuboy_get_rtc_data(sramRTC))
+        rg_sram_mark_dirty(sram, sramRTC, sizeof(sramRTC));
+}
+
+static void load_sram(void)
+{
+    size_t size = 0;
+    gnuboy_get_sram(&size);
+    if (sram && rg_sram_load(sram) >= size + sizeof(sramRTC))
+        gnuboy_set_rtc_data(sramRTC);
+}
+
 static void update_rtc_time(void)
 {
     if (!useSystemTime)
@@ -40,6 +58,10 @@ static void event_handler(int event, void *arg)
     {
         rg_display_submit(currentUpdate, 0);
     }
+    else if (event == RG_EVENT_SHUTDOWN)
+    {
+        rg_sram_flush(sram, true);
+    }
 }
 
 static bool screenshot_handler(const char *filename, int width, int height)
@@ -59,16 +81,21 @@ static bool load_state_handler(const char *filename)
         // If a state fails to load then we should behave as we do on boot
         // which is a hard reset and load sram if present
         gnuboy_reset(true);
-        gnuboy_load_sram(sramFile);
+        load_sram();
         update_rtc_time();
 
         return false;
     }
 
+    // The state carries its own copy of the SRAM, the file must follow
+    size_t size = 0;
+    void *data = gnuboy_get_sram(&size);
+    if (sram && data)
+        rg_sram_mark_dirty(sram, data, size);
+
     update_rtc_time();
 
     skipFrames = 0;
-    autoSaveSRAM_Timer = 0;
 
     // TO DO: Call rtc_sync() if a physical RTC is present
     return true;
@@ -77,10 +104,12 @@ static bool load_state_handler(const char *filename)
 static bool reset_handler(bool hard)
 {
     gnuboy_reset(hard);
+    // A hard reset clears the cart RAM, but the battery would have kept it
+    if (hard)
+        load_sram();
     update_rtc_time();
 
     skipFrames = 20;
-    autoSaveSRAM_Timer = 0;
 
     return true;
 }
@@ -136,6 +165,8 @@ static rg_gui_event_t sram_autosave_cb(rg_gui_option_t *option, rg_gui_event_t e
     if (event == RG_DIALOG_PREV || event == RG_DIALOG_NEXT)
     {
         rg_settings_set_number(NS_APP, SETTING_SAVESRAM, autoSaveSRAM);
+        if (sram)
+            rg_sram_set_debounce(sram, autoSaveSRAM * 1000);
     }
 
     if (autoSaveSRAM == 0) strcpy(option->value, "Off ");
@@ -217,18 +248,37 @@ static rg_gui_event_t rtc_update_cb(rg_gui_option_t *option, rg_gui_event_t even
 
 static void video_callback(void *buffer)
 {
-    int64_t startTime = rg_system_timer();
     slowFrame = !rg_display_sync(false);
     rg_display_submit(currentUpdate, 0);
-    video_time += rg_system_timer() - startTime;
 }
 
 
 static void audio_callback(void *buffer, size_t length)
 {
-    int64_t startTime = rg_system_timer();
     rg_audio_submit(buffer, length >> 1);
-    audio_time += rg_system_timer() - startTime;
+}
+
+// The gamepad is latched when the game first selects a row of the joypad in a frame, that is
+// usually in its vblank handler, much closer to the end of the frame than its start.
+static bool inputLatched = false;
+
+static void input_callback(void)
+{
+    if (inputLatched)
+        return;
+
+    uint32_t joystick = rg_input_latch();
+    int pad = 0;
+    if (joystick & RG_KEY_UP) pad |= GB_PAD_UP;
+    if (joystick & RG_KEY_RIGHT) pad |= GB_PAD_RIGHT;
+    if (joystick & RG_KEY_DOWN) pad |= GB_PAD_DOWN;
+    if (joystick & RG_KEY_LEFT) pad |= GB_PAD_LEFT;
+    if (joystick & RG_KEY_SELECT) pad |= GB_PAD_SELECT;
+    if (joystick & RG_KEY_START) pad |= GB_PAD_START;
+    if (joystick & RG_KEY_A) pad |= GB_PAD_A;
+    if (joystick & RG_KEY_B) pad |= GB_PAD_B;
+    gnuboy_set_pad(pad);
+    inputLatched = true;
 }
 
 void gbc_main(void)
@@ -268,6 +318,7 @@ void gbc_main(void)
 
     gnuboy_set_framebuffer(currentUpdate->data);
     gnuboy_set_soundbuffer((void *)audioBuffer, sizeof(audioBuffer) / 2);
+    gnuboy_set_input_callback(&input_callback);
 
     // Load ROM
     if (rg_extension_match(app->romPath, "zip"))
@@ -295,6 +346,18 @@ void gbc_main(void)
 
     gnuboy_set_palette(rg_settings_get_number(NS_APP, SETTING_PALETTE, GB_PALETTE_DMG));
 
+    // Battery-backed RAM is saved incrementally as the game writes to it
+    size_t sramSize = 0;
+    void *sramData = gnuboy_get_sram(&sramSize);
+    if (sramData && (sram = rg_sram_create(sramFile, autoSaveSRAM * 1000)))
+    {
+        rg_sram_add_region(sram, sramData, sramSize);
+        if (gnuboy_get_rtc_data(sramRTC))
+            rg_sram_add_region(sram, sramRTC, sizeof(sramRTC));
+        rg_sram_set_flush_callback(sram, &sram_flush_cb, NULL);
+        gnuboy_set_sram_callback(&sram_write_cb);
+    }
+
     // Hard reset to have a clean slate
     gnuboy_reset(true);
 
@@ -302,74 +365,50 @@ void gbc_main(void)
     if (app->bootFlags & RG_BOOT_RESUME)
         rg_emu_load_state(app->saveSlot);
     else
-        gnuboy_load_sram(sramFile);
+        load_sram();
 
     update_rtc_time();
 
     // Ready!
 
-    uint32_t joystick_old = -1;
-    uint32_t joystick = 0;
-
     while (true)
     {
-        joystick = rg_input_read_gamepad();
+        RG_PROFILE_ZONE("frame");
+        uint32_t joystick = rg_input_read_gamepad();
 
         if (joystick & (RG_KEY_MENU|RG_KEY_OPTION))
         {
             if (joystick & RG_KEY_MENU)
             {
-                if (gnuboy_sram_dirty()) // save in case the user quits
-                    gnuboy_save_sram(sramFile, false);
+                rg_sram_flush(sram, true); // save in case the user quits
                 rg_gui_game_menu();
             }
             else
                 rg_gui_options_menu();
         }
-        else if (joystick != joystick_old)
-        {
-            int pad = 0;
-            if (joystick & RG_KEY_UP) pad |= GB_PAD_UP;
-            if (joystick & RG_KEY_RIGHT) pad |= GB_PAD_RIGHT;
-            if (joystick & RG_KEY_DOWN) pad |= GB_PAD_DOWN;
-            if (joystick & RG_KEY_LEFT) pad |= GB_PAD_LEFT;
-            if (joystick & RG_KEY_SELECT) pad |= GB_PAD_SELECT;
-            if (joystick & RG_KEY_START) pad |= GB_PAD_START;
-            if (joystick & RG_KEY_A) pad |= GB_PAD_A;
-            if (joystick & RG_KEY_B) pad |= GB_PAD_B;
-            gnuboy_set_pad(pad); // That call is somewhat costly, that's why we try to avoid it
-            joystick_old = joystick;
-        }
 
         int64_t startTime = rg_system_timer();
         bool drawFrame = !skipFrames;
-
-        video_time = audio_time = 0;
+        inputLatched = false;
 
         if (drawFrame)
         {
             currentUpdate = updates[currentUpdate == updates[0]];
             gnuboy_set_framebuffer(currentUpdate->data);
         }
-        gnuboy_run(drawFrame);
-
-        if (autoSaveSRAM > 0)
         {
-            if (autoSaveSRAM_Timer <= 0)
-            {
-                if (gnuboy_sram_dirty())
-                {
-                    autoSaveSRAM_Timer = autoSaveSRAM * 60;
-                }
-            }
-            else if (--autoSaveSRAM_Timer == 0)
-            {
-                gnuboy_save_sram(sramFile, true);
-            }
+            RG_STAGE_ZONE(RG_STAGE_EMULATE);
+            gnuboy_run(drawFrame);
         }
 
+        // Games waiting for the joypad interrupt don't select rows, the pad must still change
+        input_callback();
+
+        // Flushes once the game stops writing for autoSaveSRAM seconds (if enabled)
+        rg_sram_tick(sram);
+
         // Tick before submitting audio/syncing
-        rg_system_tick(rg_system_timer() - startTime - audio_time);
+        rg_system_tick(rg_system_timer() - startTime - rg_system_get_stage_time(RG_STAGE_AUDIO));
 
         if (skipFrames == 0)
         {
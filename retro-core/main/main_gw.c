@@ -230,6 +230,8 @@ void gw_main(void)
 
     while (true)
     {
+        RG_PROFILE_ZONE("frame");
+
         /* refresh internal G&W timer on emulated CPU state transition */
         if (previous_m_halt != m_halt)
             gw_check_time();
@@ -260,14 +262,23 @@ void gw_main(void)
         /* Emulate and Blit */
         // Call the emulator function with number of clock cycles
         // to execute on the emulated device
-        gw_system_run(GW_SYSTEM_CYCLES);
+        {
+            RG_STAGE_ZONE(RG_STAGE_EMULATE);
+            gw_system_run(GW_SYSTEM_CYCLES);
+        }
 
         // Our refresh rate is 128Hz, which is way too fast for our display
         // so make sure the previous frame is done sending before queuing a new one
         if (rg_display_sync(false) && drawFrame)
         {
-            gw_system_blit(currentUpdate->data);
-            rg_display_submit(currentUpdate, 0);
+            // Only the segments that changed are composited, nothing to send if none did
+            {
+                RG_STAGE_ZONE(RG_STAGE_RENDER);
+                gw_system_blit(currentUpdate->data);
+            }
+            const uint32_t *dirty_lines = gw_system_dirty_lines();
+            if (dirty_lines)
+                rg_display_submit_lines(currentUpdate, dirty_lines, 0);
         }
         /****************************************************************************/
 
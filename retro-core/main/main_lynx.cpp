@@ -16,13 +16,13 @@ static int dpad_mapped_right;
 
 static rg_surface_t *updates[2];
 static rg_surface_t *currentUpdate;
+static uint32_t display_flags;
 // static bool netplay = false;
 // --- MAIN
 
 static void set_display_mode(void)
 {
     display_rotation_t rotation = rg_display_get_rotation();
-    int width, height;
 
     if (rotation == RG_DISPLAY_ROTATION_AUTO)
     {
@@ -52,38 +52,27 @@ static void set_display_mode(void)
     switch(rotation)
     {
         case RG_DISPLAY_ROTATION_LEFT:
-            width = HANDY_SCREEN_HEIGHT;
-            height = HANDY_SCREEN_WIDTH;
-            lynx->mMikie->SetRotation(MIKIE_ROTATE_L);
+            display_flags = RG_DISPLAY_ROTATE_LEFT;
             dpad_mapped_up    = BUTTON_RIGHT;
             dpad_mapped_down  = BUTTON_LEFT;
             dpad_mapped_left  = BUTTON_UP;
             dpad_mapped_right = BUTTON_DOWN;
             break;
         case RG_DISPLAY_ROTATION_RIGHT:
-            width = HANDY_SCREEN_HEIGHT;
-            height = HANDY_SCREEN_WIDTH;
-            lynx->mMikie->SetRotation(MIKIE_ROTATE_R);
+            display_flags = RG_DISPLAY_ROTATE_RIGHT;
             dpad_mapped_up    = BUTTON_LEFT;
             dpad_mapped_down  = BUTTON_RIGHT;
             dpad_mapped_left  = BUTTON_DOWN;
             dpad_mapped_right = BUTTON_UP;
             break;
         default:
-            width = HANDY_SCREEN_WIDTH;
-            height = HANDY_SCREEN_HEIGHT;
-            lynx->mMikie->SetRotation(MIKIE_NO_ROTATE);
+            display_flags = 0;
             dpad_mapped_up    = BUTTON_UP;
             dpad_mapped_down  = BUTTON_DOWN;
             dpad_mapped_left  = BUTTON_LEFT;
             dpad_mapped_right = BUTTON_RIGHT;
             break;
     }
-
-    updates[0]->width = width;
-    updates[0]->height = height;
-    updates[1]->width = width;
-    updates[1]->height = height;
 }
 
 static CSystem *new_lynx(void)
@@ -94,11 +83,11 @@ static CSystem *new_lynx(void)
         size_t size;
         if (!rg_storage_unzip_file(app->romPath, NULL, &data, &size, 0))
             RG_PANIC("ROM file unzipping failed!");
-        CSystem *lynx = new CSystem((UBYTE*)data, size, MIKIE_PIXEL_FORMAT_16BPP_565_BE, app->sampleRate);
+        CSystem *lynx = new CSystem((UBYTE*)data, size, MIKIE_PIXEL_FORMAT_8BPP_PAL565_BE, app->sampleRate);
         free(data);
         return lynx;
     }
-    return new CSystem(app->romPath, MIKIE_PIXEL_FORMAT_16BPP_565_BE, app->sampleRate);
+    return new CSystem(app->romPath, MIKIE_PIXEL_FORMAT_8BPP_PAL565_BE, app->sampleRate);
 }
 
 
@@ -131,7 +120,7 @@ static void event_handler(int event, void *arg)
 {
     if (event == RG_EVENT_REDRAW)
     {
-        rg_display_submit(currentUpdate, 0);
+        rg_display_submit(currentUpdate, display_flags);
     }
 }
 
@@ -196,9 +185,9 @@ extern "C" void lynx_main(void)
 
     app = rg_system_reinit(AUDIO_SAMPLE_RATE, &handlers, options);
 
-    // the HANDY_SCREEN_WIDTH * HANDY_SCREEN_WIDTH is deliberate because of rotation
-    updates[0] = rg_surface_create(HANDY_SCREEN_WIDTH, HANDY_SCREEN_WIDTH, RG_PIXEL_565_BE, MEM_FAST);
-    updates[1] = rg_surface_create(HANDY_SCREEN_WIDTH, HANDY_SCREEN_WIDTH, RG_PIXEL_565_BE, MEM_FAST);
+    // Mikie draws unrotated palette indexes, rg_display takes care of the rotation
+    updates[0] = rg_surface_create(HANDY_SCREEN_WIDTH, HANDY_SCREEN_HEIGHT, RG_PIXEL_PAL565_BE, MEM_FAST);
+    updates[1] = rg_surface_create(HANDY_SCREEN_WIDTH, HANDY_SCREEN_HEIGHT, RG_PIXEL_PAL565_BE, MEM_FAST);
     currentUpdate = updates[0];
 
     // The Lynx has a variable framerate but 60 is typical
@@ -213,6 +202,7 @@ extern "C" void lynx_main(void)
     }
 
     gPrimaryFrameBuffer = (UBYTE*)currentUpdate->data;
+    gPrimaryPalette = currentUpdate->palette;
     gAudioBuffer = (SWORD*)&audioBuffer;
     gAudioEnabled = 1;
 
@@ -230,6 +220,7 @@ extern "C" void lynx_main(void)
     // Start emulation
     while (1)
     {
+        RG_PROFILE_ZONE("frame");
         uint32_t joystick = rg_input_read_gamepad();
 
         if (joystick & (RG_KEY_MENU|RG_KEY_OPTION))
@@ -255,14 +246,18 @@ extern "C" void lynx_main(void)
     	if (joystick & RG_KEY_SELECT) buttons |= BUTTON_OPT1;
 
         lynx->SetButtonData(buttons);
-        lynx->UpdateFrame(drawFrame);
+        {
+            RG_STAGE_ZONE(RG_STAGE_EMULATE);
+            lynx->UpdateFrame(drawFrame);
+        }
 
         if (drawFrame)
         {
             slowFrame = !rg_display_sync(false);
-            rg_display_submit(currentUpdate, 0);
+            rg_display_submit(currentUpdate, display_flags);
             currentUpdate = updates[currentUpdate == updates[0]];
             gPrimaryFrameBuffer = (UBYTE*)currentUpdate->data;
+            gPrimaryPalette = currentUpdate->palette;
         }
 
         app->tickRate = AUDIO_SAMPLE_RATE / (gAudioBufferPointer / 2);
@@ -8,8 +8,8 @@ static int palette = 0;
 static bool slowFrame = false;
 static bool nsfPlayer = false;
 static nes_t *nes;
+static rg_sram_t *sram;
 
-static rg_surface_t *updates[2];
 static rg_surface_t *currentUpdate;
 
 static const char *SETTING_AUTOCROP = "autocrop";
@@ -19,6 +19,11 @@ static const char *SETTING_SPRITELIMIT = "spritelimit";
 // --- MAIN
 
 
+static void sram_write_cb(void *ptr, size_t length)
+{
+    rg_sram_mark_dirty(sram, ptr, length);
+}
+
 static void event_handler(int event, void *arg)
 {
     if (event == RG_EVENT_REDRAW)
@@ -28,6 +33,10 @@ static void event_handler(int event, void *arg)
         else if (nes)
             (nes->blit_func)(NULL);
     }
+    else if (event == RG_EVENT_SHUTDOWN)
+    {
+        rg_sram_flush(sram, true);
+    }
 }
 
 static bool screenshot_handler(const char *filename, int width, int height)
@@ -45,25 +54,97 @@ static bool load_state_handler(const char *filename)
     if (state_load(filename) != 0)
     {
         nes_reset(true);
+        if (sram)
+            rg_sram_load(sram);
         return false;
     }
+    // The state carries its own copy of the PRG-RAM, the file must follow
+    if (sram)
+        rg_sram_mark_dirty(sram, nes->cart->prg_ram, nes->cart->prg_ram_banks * ROM_PRG_BANK_SIZE);
     return true;
 }
 
 static bool reset_handler(bool hard)
 {
     nes_reset(hard);
+    // A hard reset clears the PRG-RAM, but the battery would have kept it
+    if (hard && sram)
+        rg_sram_load(sram);
     return true;
 }
 
+#ifdef RG_ENABLE_NETPLAY
+static bool netplay = false;
+
+static size_t netplay_save_state(void *buffer, size_t size)
+{
+    FILE *fp = fmemopen(buffer, size, "wb");
+    size_t len = 0;
+    if (fp && state_save_file(fp) == 0)
+        len = ftell(fp);
+    if (fp)
+        fclose(fp);
+    return len;
+}
+
+static bool netplay_load_state(const void *buffer, size_t size)
+{
+    FILE *fp = fmemopen((void *)buffer, size, "rb");
+    bool ret = fp && state_load_file(fp) == 0;
+    if (fp)
+        fclose(fp);
+    return ret;
+}
+
+static void netplay_input(const uint8_t *local, const uint8_t *remote)
+{
+    // The host is always player 1
+    int port = rg_netplay_mode() == NETPLAY_MODE_HOST ? 0 : 1;
+    input_update(port, *local);
+    input_update(port ^ 1, *remote);
+}
+
+static void netplay_run_frame(const void *data_in, const void *data_out)
+{
+    netplay_input(data_in, data_out);
+    nes_emulate(false);
+}
+#endif
+
+static int read_buttons(uint32_t joystick)
+{
+    int buttons = 0;
+    if (joystick & RG_KEY_START)  buttons |= NES_PAD_START;
+    if (joystick & RG_KEY_SELECT) buttons |= NES_PAD_SELECT;
+    if (joystick & RG_KEY_UP)     buttons |= NES_PAD_UP;
+    if (joystick & RG_KEY_RIGHT)  buttons |= NES_PAD_RIGHT;
+    if (joystick & RG_KEY_DOWN)   buttons |= NES_PAD_DOWN;
+    if (joystick & RG_KEY_LEFT)   buttons |= NES_PAD_LEFT;
+    if (joystick & RG_KEY_A)      buttons |= NES_PAD_A;
+    if (joystick & RG_KEY_B)      buttons |= NES_PAD_B;
+    return buttons;
+}
+
+// The gamepad is latched when the game strobes the pad for the first time in a frame,
+// that is usually in the NMI handler, much closer to the end of the frame than its start.
+static bool inputLatched = false;
+
+static void input_strobe_cb(void)
+{
+    if (!inputLatched)
+    {
+        input_update(0, read_buttons(rg_input_latch()));
+        inputLatched = true;
+    }
+}
+
 static void build_palette(int n)
 {
     uint16_t *pal = nofrendo_buildpalette(n, 16);
     for (int i = 0; i < 256; i++)
     {
         uint16_t color = (pal[i] >> 8) | ((pal[i]) << 8);
-        updates[0]->palette[i] = color;
-        updates[1]->palette[i] = color;
+        currentUpdate->palette[i] = color;
     }
     free(pal);
 }
@@ -158,7 +239,7 @@ static void blit_screen(uint8 *bmp)
     currentUpdate->width = NES_SCREEN_WIDTH - crop_h * 2;
     currentUpdate->height = NES_SCREEN_HEIGHT - crop_v * 2;
     currentUpdate->offset = crop_v * currentUpdate->stride + crop_h + 8;
-    rg_display_submit(currentUpdate, 0);
+    rg_display_present(currentUpdate);
 }
 
 static void nsf_draw_overlay(void)
@@ -201,9 +282,9 @@ void nes_main(void)
     autocrop = rg_settings_get_number(NS_APP, SETTING_AUTOCROP, 0);
     palette = rg_settings_get_number(NS_APP, SETTING_PALETTE, 0);
 
-    updates[0] = rg_surface_create(NES_SCREEN_PITCH, NES_SCREEN_HEIGHT, RG_PIXEL_PAL565_BE, MEM_FAST);
-    updates[1] = rg_surface_create(NES_SCREEN_PITCH, NES_SCREEN_HEIGHT, RG_PIXEL_PAL565_BE, MEM_FAST);
-    currentUpdate = updates[0];
+    if (!rg_display_create_frames(NES_SCREEN_PITCH, NES_SCREEN_HEIGHT, RG_PIXEL_PAL565_BE, 3))
+        RG_PANIC("Frames allocation failed.");
+    currentUpdate = rg_display_acquire();
 
     nes = nes_init(SYS_DETECT, app->sampleRate, true, RG_BASE_PATH_BIOS "/fds_bios.bin");
     if (!nes)
@@ -237,6 +318,36 @@ void nes_main(void)
     nes->blit_func = blit_screen;
 
     nsfPlayer = nes->cart->type == ROM_TYPE_NSF;
+    input_setstrobehook(&input_strobe_cb);
+
+    // Battery-backed PRG-RAM is saved incrementally as the game writes to it
+    if (nes->cart->battery && nes->cart->type == ROM_TYPE_INES && nes->cart->prg_ram_banks > 0)
+    {
+        char *sramFile = rg_emu_get_path(RG_PATH_SAVE_SRAM, app->romPath);
+        size_t sramSize = nes->cart->prg_ram_banks * ROM_PRG_BANK_SIZE;
+        if (!rg_storage_mkdir(rg_dirname(sramFile)))
+            RG_LOGE("Unable to create SRAM folder...");
+        if ((sram = rg_sram_create(sramFile, 2000)) && rg_sram_add_region(sram, nes->cart->prg_ram, sramSize))
+        {
+            mem_setsramhook(nes->cart->prg_ram, sramSize, &sram_write_cb);
+            rg_sram_load(sram);
+        }
+        free(sramFile);
+    }
+
+    // Games polling the PPU or a RAM flag are fast-forwarded to the next scanline
+    rg_idle_attach(&nes->cpu->idle);
+
+#ifdef RG_ENABLE_NETPLAY
+    const netplay_rollback_t rollback = {
+        .saveState = &netplay_save_state,
+        .loadState = &netplay_load_state,
+        .runFrame = &netplay_run_frame,
+    };
+    // Fixed blocks are ~7KB, the rest is cartridge RAM
+    rg_netplay_set_rollback(&rollback, 0x2000 + ROM_CHR_BANK_SIZE * nes->cart->chr_ram_banks
+                                              + ROM_PRG_BANK_SIZE * nes->cart->prg_ram_banks);
+#endif
 
     ppu_setopt(PPU_LIMIT_SPRITES, rg_settings_get_number(NS_APP, SETTING_SPRITELIMIT, 1));
 
@@ -256,37 +367,63 @@ void nes_main(void)
 
     while (true)
     {
+        RG_PROFILE_ZONE("frame");
         uint32_t joystick = rg_input_read_gamepad();
 
         if (joystick & (RG_KEY_MENU|RG_KEY_OPTION))
         {
             if (joystick & RG_KEY_MENU)
+            {
+                rg_sram_flush(sram, true); // save in case the user quits
                 rg_gui_game_menu();
+            }
             else
                 rg_gui_options_menu();
         }
 
         int64_t startTime = rg_system_timer();
         bool drawFrame = !skipFrames && !nsfPlayer;
-        int buttons = 0;
-
-        if (joystick & RG_KEY_START)  buttons |= NES_PAD_START;
-        if (joystick & RG_KEY_SELECT) buttons |= NES_PAD_SELECT;
-        if (joystick & RG_KEY_UP)     buttons |= NES_PAD_UP;
-        if (joystick & RG_KEY_RIGHT)  buttons |= NES_PAD_RIGHT;
-        if (joystick & RG_KEY_DOWN)   buttons |= NES_PAD_DOWN;
-        if (joystick & RG_KEY_LEFT)   buttons |= NES_PAD_LEFT;
-        if (joystick & RG_KEY_A)      buttons |= NES_PAD_A;
-        if (joystick & RG_KEY_B)      buttons |= NES_PAD_B;
+        inputLatched = false;
 
         if (drawFrame)
         {
-            currentUpdate = updates[currentUpdate == updates[0]];
+            currentUpdate = rg_display_acquire();
             nes_setvidbuf(currentUpdate->data);
         }
 
-        input_update(0, buttons);
-        nes_emulate(drawFrame);
+    #ifdef RG_ENABLE_NETPLAY
+        if (rg_netplay_status() == NETPLAY_STATUS_CONNECTED)
+        {
+            // Both sides must agree on the input of the whole frame, it can't wait for the strobe
+            uint8_t local = read_buttons(rg_input_latch()), remote = 0;
+            inputLatched = true;
+            // Both sides start from the same power-on state
+            if (!netplay)
+            {
+                // Nothing played over netplay should end up in the local save
+                mem_setsramhook(NULL, 0, NULL);
+                rg_sram_free(sram);
+                sram = NULL;
+                nes_reset(true);
+                netplay = true;
+            }
+            rg_netplay_sync(&local, &remote, 1);
+            netplay_input(&local, &remote);
+        }
+        else
+        {
+            netplay = false;
+        }
+    #endif
+        // The NSF player reads the pad directly
+        if (nsfPlayer)
+            input_strobe_cb();
+        {
+            RG_STAGE_ZONE(RG_STAGE_EMULATE);
+            nes_emulate(drawFrame);
+        }
+
+        rg_sram_tick(sram);
 
         // Tick before submitting audio/syncing
         rg_system_tick(rg_system_timer() - startTime);
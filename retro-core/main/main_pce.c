@@ -8,6 +8,7 @@
 
 #include <pce-go.h>
 #include <psg.h>
+#include <pce.h>
 
 #undef AUDIO_SAMPLE_RATE
 #define AUDIO_SAMPLE_RATE 22050
@@ -52,6 +53,11 @@ uint8_t *osd_gfx_framebuffer(int width, int height)
 void osd_vsync(void)
 {
     static int64_t lasttime, prevtime;
+    static rg_stage_zone_t emulate_stage;
+
+    // pce_run() doesn't return to us, emulation is whatever happens between two vsyncs
+    if (emulate_stage.start)
+        rg_system_stage_end(&emulate_stage);
 
     if (drawFrame)
     {
@@ -99,13 +105,8 @@ void osd_vsync(void)
         lasttime = prevtime;
 
     drawFrame = (skipFrames == 0);
-}
 
-void osd_input_read(uint8_t joypads[8])
-{
     uint32_t joystick = rg_input_read_gamepad();
-    uint32_t buttons = 0;
-
     if (joystick & (RG_KEY_MENU|RG_KEY_OPTION))
     {
         emulationPaused = true;
@@ -116,6 +117,16 @@ void osd_input_read(uint8_t joypads[8])
         emulationPaused = false;
     }
 
+    rg_system_stage_begin(&emulate_stage, RG_STAGE_EMULATE);
+}
+
+// Called when the game resets the joypad multiplexer for the first time in a frame, that is usually
+// in its vblank handler, much closer to the end of the frame than its start.
+void osd_input_read(uint8_t joypads[8])
+{
+    uint32_t joystick = rg_input_latch();
+    uint32_t buttons = 0;
+
     if (joystick & RG_KEY_LEFT)   buttons |= JOY_LEFT;
     if (joystick & RG_KEY_RIGHT)  buttons |= JOY_RIGHT;
     if (joystick & RG_KEY_UP)     buttons |= JOY_UP;
@@ -138,7 +149,10 @@ static void audioTask(void *arg)
         // TODO: Clearly we need to add a better way to remain in sync with the main task...
         while (emulationPaused)
             rg_task_yield();
-        psg_update((int16_t *)audioBuffer, numSamples, 0xFF);
+        {
+            RG_PROFILE_ZONE("apu");
+            psg_update((int16_t *)audioBuffer, numSamples, 0xFF);
+        }
         rg_audio_submit(audioBuffer, numSamples);
     }
 }
@@ -238,6 +252,9 @@ void pce_main(void)
         rg_emu_load_state(app->saveSlot);
     }
 
+    // Games polling the VDC status or a RAM flag are fast-forwarded to the next scanline
+    rg_idle_attach(&CPU.idle);
+
     app->tickRate = 60;
     app->frameskip = 1;
 
@@ -92,6 +92,35 @@ static rg_gui_event_t palette_update_cb(rg_gui_option_t *opt, rg_gui_event_t eve
     return RG_DIALOG_VOID;
 }
 
+// The gamepad is latched when the game first reads a controller port in a frame, that is
+// usually in its vblank handler, much closer to the end of the frame than its start.
+static void input_latch_cb(void)
+{
+    uint32_t joystick = rg_input_latch();
+
+    input.pad[0] = 0x00;
+    input.pad[1] = 0x00;
+    input.system = 0x00;
+
+    if (joystick & RG_KEY_UP)    input.pad[0] |= INPUT_UP;
+    if (joystick & RG_KEY_DOWN)  input.pad[0] |= INPUT_DOWN;
+    if (joystick & RG_KEY_LEFT)  input.pad[0] |= INPUT_LEFT;
+    if (joystick & RG_KEY_RIGHT) input.pad[0] |= INPUT_RIGHT;
+    if (joystick & RG_KEY_A)     input.pad[0] |= INPUT_BUTTON2;
+    if (joystick & RG_KEY_B)     input.pad[0] |= INPUT_BUTTON1;
+
+    if (IS_SMS)
+    {
+        if (joystick & RG_KEY_START)  input.system |= INPUT_PAUSE;
+        if (joystick & RG_KEY_SELECT) input.system |= INPUT_START;
+    }
+    else if (IS_GG)
+    {
+        if (joystick & RG_KEY_START)  input.system |= INPUT_START;
+        if (joystick & RG_KEY_SELECT) input.system |= INPUT_PAUSE;
+    }
+}
+
 void sms_main(void)
 {
     const rg_handlers_t handlers = {
@@ -145,6 +174,7 @@ void sms_main(void)
     bitmap.data = currentUpdate->data;
 
     system_poweron();
+    input.latch = &input_latch_cb;
 
     app->tickRate = (sms.display == DISPLAY_NTSC) ? FPS_NTSC : FPS_PAL;
 
@@ -160,12 +190,16 @@ void sms_main(void)
         rg_emu_load_state(app->saveSlot);
     }
 
+    // Games waiting for an interrupt or polling a RAM flag are fast-forwarded to the next line
+    rg_idle_attach(&z80_idle);
+
     int skipFrames = 0;
     int colecoKey = 0;
     int colecoKeyDecay = 0;
 
     while (true)
     {
+        RG_PROFILE_ZONE("frame");
         uint32_t joystick = rg_input_read_gamepad();
 
         if (joystick & (RG_KEY_MENU|RG_KEY_OPTION))
@@ -180,28 +214,7 @@ void sms_main(void)
         bool drawFrame = !skipFrames;
         bool slowFrame = false;
 
-        input.pad[0] = 0x00;
-        input.pad[1] = 0x00;
-        input.system = 0x00;
-
-        if (joystick & RG_KEY_UP)    input.pad[0] |= INPUT_UP;
-        if (joystick & RG_KEY_DOWN)  input.pad[0] |= INPUT_DOWN;
-        if (joystick & RG_KEY_LEFT)  input.pad[0] |= INPUT_LEFT;
-        if (joystick & RG_KEY_RIGHT) input.pad[0] |= INPUT_RIGHT;
-        if (joystick & RG_KEY_A)     input.pad[0] |= INPUT_BUTTON2;
-        if (joystick & RG_KEY_B)     input.pad[0] |= INPUT_BUTTON1;
-
-        if (IS_SMS)
-        {
-            if (joystick & RG_KEY_START)  input.system |= INPUT_PAUSE;
-            if (joystick & RG_KEY_SELECT) input.system |= INPUT_START;
-        }
-        else if (IS_GG)
-        {
-            if (joystick & RG_KEY_START)  input.system |= INPUT_START;
-            if (joystick & RG_KEY_SELECT) input.system |= INPUT_PAUSE;
-        }
-        else // Coleco
+        if (!IS_SMS && !IS_GG) // Coleco
         {
             coleco.keypad[0] = 0xff;
             coleco.keypad[1] = 0xff;
@@ -236,7 +249,14 @@ void sms_main(void)
             }
         }
 
-        system_frame(!drawFrame);
+        {
+            RG_STAGE_ZONE(RG_STAGE_EMULATE);
+            system_frame(!drawFrame);
+        }
+
+        // The pause button and games that don't poll the pads must still see changes
+        if (!input.latched)
+            input_latch_cb();
 
         if (drawFrame)
         {
@@ -173,12 +173,13 @@ void S9xDeinitDisplay(void)
 {
 }
 
+// Called by S9xUpdateJoypads() once per frame, at the start of vblank when the auto-joypad read happens
 uint32_t S9xReadJoypad(int32_t port)
 {
     if (port != 0)
         return 0;
 
-    uint32_t joystick = rg_input_read_gamepad();
+    uint32_t joystick = rg_input_latch();
     uint32_t joypad = 0;
 
     for (int i = 0; i < RG_COUNT(keymap.keys); ++i)
@@ -299,6 +300,9 @@ void snes_main(void)
         rg_emu_load_state(app->saveSlot);
     }
 
+    // Snes9x has its own idle loop detection (Settings.Shutdown), it shares the opt-out and statistics
+    rg_idle_attach(&CPUIdle);
+
     app->tickRate = Memory.ROMFramesPerSecond;
     app->frameskip = 3;
 
@@ -308,6 +312,7 @@ void snes_main(void)
 
     while (1)
     {
+        RG_PROFILE_ZONE("frame");
         uint32_t joystick = rg_input_read_gamepad();
 
         if (menuPressed && !(joystick & RG_KEY_MENU))
@@ -338,7 +343,10 @@ void snes_main(void)
         IPPU.RenderThisFrame = drawFrame;
         GFX.Screen = currentUpdate->data;
 
-        S9xMainLoop();
+        {
+            RG_STAGE_ZONE(RG_STAGE_EMULATE);
+            S9xMainLoop();
+        }
 
         if (drawFrame)
         {
@@ -5,6 +5,8 @@ import shutil
 import glob
 import math
 import sys
+import struct
+import zlib
 import re
 import os
 
@@ -69,7 +71,15 @@ def build_firmware(output_file, apps, fw_format="odroid-go", fatsize=0):
     run(args)
 
 
-def build_image(output_file, apps, img_format="esp32", fatsize=0):
+def build_wad_partition(wad_file):
+    # prboom-go only maps the partition if this trailer matches the WAD it's about to open from the SD card
+    with open(wad_file, "rb") as f:
+        data = f.read()
+    data += struct.pack("<4sII", b"WADP", len(data), zlib.crc32(data))
+    return data + b"\xFF" * (math.ceil(len(data) / 0x10000) * 0x10000 - len(data))
+
+
+def build_image(output_file, apps, img_format="esp32", fatsize=0, wad_file=None):
     print("Building image with: %s\n" % " ".join(apps))
     image_data = bytearray(b"\xFF" * 0x10000)
     table_ota = 0
@@ -87,6 +97,11 @@ def build_image(output_file, apps, img_format="esp32", fatsize=0):
         table_ota += 1
         image_data += data + b"\xFF" * (part_size - len(data))
 
+    if wad_file:
+        data = build_wad_partition(wad_file)
+        table_csv.append("wad, data, undefined, %d, %d" % (len(image_data), len(data)))
+        image_data += data
+
     if fatsize:
         # Use "vfs" label, same as MicroPython, in case the storage is to be shared with a MicroPython install
         table_csv.append("vfs, data, fat, %d, %s" % (len(image_data), fatsize))
@@ -157,6 +172,21 @@ def flash_app(app, port, baudrate=1152000):
     run([PARTTOOL_PY, "--partition-table-file", "partitions.bin", "write_partition", "--partition-name", app, "--input", app_bin])
 
 
+def flash_wad(wad_file, port, baudrate=1152000):
+    os.putenv("ESPTOOL_CHIP", os.getenv("IDF_TARGET", "auto"))
+    os.putenv("ESPTOOL_BAUD", str(baudrate))
+    os.putenv("ESPTOOL_PORT", port)
+    if not os.path.exists("partitions.bin"):
+        print("Reading device's partition table...")
+        run([ESPTOOL_PY, "read_flash", "0x8000", "0x1000", "partitions.bin"], check=False)
+        run([GEN_ESP32PART_PY, "partitions.bin"], check=False)
+    with open("wad_partition.bin", "wb") as f:
+        f.write(build_wad_partition(wad_file))
+    print(f"Flashing '{wad_file}' to the wad partition on port {port}")
+    run([PARTTOOL_PY, "--partition-table-file", "partitions.bin", "write_partition", "--partition-name", "wad", "--input", "wad_partition.bin"])
+    os.unlink("wad_partition.bin")
+
+
 def flash_image(image_file, port, baudrate=1152000):
     os.putenv("ESPTOOL_CHIP", os.getenv("IDF_TARGET", "auto"))
     os.putenv("ESPTOOL_BAUD", str(baudrate))
@@ -197,6 +227,9 @@ parser.add_argument(
 parser.add_argument(
     "--fatsize", help="Add FAT storage partition of provided size (500K, 5M,...) to the built image."
 )
+parser.add_argument(
+    "--wad", help="IWAD to store in a 'wad' partition (build-img, install), or to write to it (flash)"
+)
 args = parser.parse_args()
 
 command = args.command
@@ -233,7 +266,7 @@ try:
     if command in ["build-img", "release", "install"]:
         print("=== Step: Packing ===\n")
         img_file = ("%s_%s_%s.img" % (PROJECT_NAME, PROJECT_VER, args.target)).lower()
-        build_image(img_file, apps, os.getenv("IMG_FORMAT", os.getenv("IDF_TARGET")), args.fatsize)
+        build_image(img_file, apps, os.getenv("IMG_FORMAT", os.getenv("IDF_TARGET")), args.fatsize, args.wad)
 
     if command in ["install"]:
         print("=== Step: Flashing entire image to device ===\n")
@@ -246,6 +279,8 @@ try:
         except: pass
         for app in apps:
             flash_app(app, args.port, args.baud)
+        if args.wad:
+            flash_wad(args.wad, args.port, args.baud)
 
     if command in ["monitor", "run", "profile"]:
         print("=== Step: Monitoring ===\n")